@@ -3,6 +3,9 @@
 #include <Utf8.h>
 
 #include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <new>
 
 void EpdFont::getTextBounds(const char* string, const int startX, const int startY, int* minX, int* minY, int* maxX,
                             int* maxY) const {
@@ -98,13 +101,75 @@ static uint8_t lookupKernClass(const EpdKernClassEntry* entries, const uint16_t
   return 0;
 }
 
+EpdFont::~EpdFont() { releaseLatinTable(); }
+
+void EpdFont::releaseLatinTable() const { delete latinTable.exchange(nullptr, std::memory_order_acq_rel); }
+
+const EpdFont::LatinTable* EpdFont::getLatinTable() const {
+  const LatinTable* table = latinTable.load(std::memory_order_acquire);
+  return table ? table : buildLatinTable();
+}
+
+// Layout and rendering can run on different tasks, so two may build the table at once; the first one stored wins
+const EpdFont::LatinTable* EpdFont::buildLatinTable() const {
+  auto* table = new (std::nothrow) LatinTable;
+  if (!table) {
+    return nullptr;
+  }
+  std::fill(std::begin(table->glyphIndex), std::end(table->glyphIndex), NO_GLYPH);
+  memset(table->kernLeft, 0, sizeof(table->kernLeft));
+  memset(table->kernRight, 0, sizeof(table->kernRight));
+  memset(table->ligatureStart, 0, sizeof(table->ligatureStart));
+
+  for (uint32_t i = 0; i < data->intervalCount && data->intervals[i].first < LATIN_TABLE_END; i++) {
+    const EpdUnicodeInterval& interval = data->intervals[i];
+    for (uint32_t cp = interval.first; cp <= interval.last && cp < LATIN_TABLE_END; cp++) {
+      const uint32_t index = interval.offset + (cp - interval.first);
+      if (index < NO_GLYPH) {
+        table->glyphIndex[cp] = static_cast<uint16_t>(index);
+      }
+    }
+  }
+  if (data->kernLeftClasses) {
+    for (uint16_t i = 0; i < data->kernLeftEntryCount && data->kernLeftClasses[i].codepoint < LATIN_TABLE_END; i++) {
+      table->kernLeft[data->kernLeftClasses[i].codepoint] = data->kernLeftClasses[i].classId;
+    }
+  }
+  if (data->kernRightClasses) {
+    for (uint16_t i = 0; i < data->kernRightEntryCount && data->kernRightClasses[i].codepoint < LATIN_TABLE_END;
+         i++) {
+      table->kernRight[data->kernRightClasses[i].codepoint] = data->kernRightClasses[i].classId;
+    }
+  }
+  if (data->ligaturePairs) {
+    for (uint32_t i = 0; i < data->ligaturePairCount; i++) {
+      const uint32_t leftCp = data->ligaturePairs[i].pair >> 16;
+      if (leftCp < LATIN_TABLE_END) {
+        table->ligatureStart[leftCp >> 3] |= 0x80 >> (leftCp & 7);
+      }
+    }
+  }
+
+  const LatinTable* expected = nullptr;
+  if (!latinTable.compare_exchange_strong(expected, table, std::memory_order_acq_rel)) {
+    delete table;
+    return expected;
+  }
+  return table;
+}
+
 int8_t EpdFont::getKerning(const uint32_t leftCp, const uint32_t rightCp) const {
   if (!data->kernMatrix) {
     return 0;
   }
-  const uint8_t lc = lookupKernClass(data->kernLeftClasses, data->kernLeftEntryCount, leftCp);
+  const LatinTable* table = getLatinTable();
+  const uint8_t lc = table && leftCp < LATIN_TABLE_END
+                         ? table->kernLeft[leftCp]
+                         : lookupKernClass(data->kernLeftClasses, data->kernLeftEntryCount, leftCp);
   if (lc == 0) return 0;
-  const uint8_t rc = lookupKernClass(data->kernRightClasses, data->kernRightEntryCount, rightCp);
+  const uint8_t rc = table && rightCp < LATIN_TABLE_END
+                         ? table->kernRight[rightCp]
+                         : lookupKernClass(data->kernRightClasses, data->kernRightEntryCount, rightCp);
   if (rc == 0) return 0;
   return data->kernMatrix[(lc - 1) * data->kernRightClassCount + (rc - 1)];
 }
@@ -115,6 +180,12 @@ uint32_t EpdFont::getLigature(const uint32_t leftCp, const uint32_t rightCp) con
   if (!pairs || count == 0 || leftCp > 0xFFFF || rightCp > 0xFFFF) {
     return 0;
   }
+  if (leftCp < LATIN_TABLE_END) {
+    const LatinTable* table = getLatinTable();
+    if (table && !(table->ligatureStart[leftCp >> 3] & (0x80 >> (leftCp & 7)))) {
+      return 0;
+    }
+  }
 
   const uint32_t key = (leftCp << 16) | rightCp;
   int left = 0;
@@ -139,7 +210,10 @@ uint32_t EpdFont::applyLigatures(uint32_t cp, const char*& text) const {
   if (!data->ligaturePairs || data->ligaturePairCount == 0) {
     return cp;
   }
+  const LatinTable* table = getLatinTable();
   while (true) {
+    // Most codepoints start no ligature, so don't decode the next one for them
+    if (table && cp < LATIN_TABLE_END && !(table->ligatureStart[cp >> 3] & (0x80 >> (cp & 7)))) break;
     const auto saved = reinterpret_cast<const uint8_t*>(text);
     const uint32_t nextCp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text));
     if (nextCp == 0) break;
@@ -154,6 +228,13 @@ uint32_t EpdFont::applyLigatures(uint32_t cp, const char*& text) const {
 }
 
 const EpdGlyph* EpdFont::getGlyph(const uint32_t cp) const {
+  if (cp < LATIN_TABLE_END) {
+    const LatinTable* table = getLatinTable();
+    if (table && table->glyphIndex[cp] != NO_GLYPH) {
+      return &data->glyph[table->glyphIndex[cp]];
+    }
+  }
+
   const EpdUnicodeInterval* intervals = data->intervals;
   const int count = data->intervalCount;
 
@@ -1,14 +1,34 @@
 #pragma once
+#include <atomic>
+
 #include "EpdFontData.h"
 
 class EpdFont {
+  // Direct-indexed glyphs, kerning classes and ligature starts for codepoints below LATIN_TABLE_END, which covers
+  // nearly every character of Western text. Built on first use; everything else goes through the binary searches.
+  static constexpr uint32_t LATIN_TABLE_END = 0x250;
+  static constexpr uint16_t NO_GLYPH = 0xFFFF;
+  struct LatinTable {
+    uint16_t glyphIndex[LATIN_TABLE_END];        // NO_GLYPH if the font has none
+    uint8_t kernLeft[LATIN_TABLE_END];           // Left kerning class, 0 for none
+    uint8_t kernRight[LATIN_TABLE_END];          // Right kerning class, 0 for none
+    uint8_t ligatureStart[LATIN_TABLE_END / 8];  // Bit set if a ligature pair starts with the codepoint
+  };
+  mutable std::atomic<const LatinTable*> latinTable{nullptr};
+
   void getTextBounds(const char* string, int startX, int startY, int* minX, int* minY, int* maxX, int* maxY) const;
+  const LatinTable* getLatinTable() const;
+  const LatinTable* buildLatinTable() const;
 
  public:
   const EpdFontData* data;
   explicit EpdFont(const EpdFontData* data) : data(data) {}
-  ~EpdFont() = default;
+  ~EpdFont();
+  EpdFont(const EpdFont&) = delete;
+  EpdFont& operator=(const EpdFont&) = delete;
   void getTextDimensions(const char* string, int* w, int* h) const;
+  // Frees the Latin table, which is built again on next use. Nothing else may be using the font meanwhile.
+  void releaseLatinTable() const;
 
   const EpdGlyph* getGlyph(uint32_t cp) const;
 
@@ -1,5 +1,7 @@
 #include "EpdFontFamily.h"
 
+#include <initializer_list>
+
 const EpdFont* EpdFontFamily::getFont(const Style style) const {
   // Extract font style bits (ignore UNDERLINE bit for font selection)
   const bool hasBold = (style & BOLD) != 0;
@@ -35,3 +37,9 @@ int8_t EpdFontFamily::getKerning(const uint32_t leftCp, const uint32_t rightCp,
 uint32_t EpdFontFamily::applyLigatures(const uint32_t cp, const char*& text, const Style style) const {
   return getFont(style)->applyLigatures(cp, text);
 }
+
+void EpdFontFamily::releaseLatinTables() const {
+  for (const EpdFont* font : {regular, bold, italic, boldItalic}) {
+    if (font) font->releaseLatinTable();
+  }
+}
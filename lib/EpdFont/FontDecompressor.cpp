@@ -1,8 +1,12 @@
 #include "FontDecompressor.h"
 
+#include <HeapTrace.h>
 #include <Logging.h>
+#include <PerfTrace.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 
 bool FontDecompressor::init() {
   clearCache();
@@ -10,13 +14,14 @@ bool FontDecompressor::init() {
 }
 
 void FontDecompressor::freeAllEntries() {
+  HEAP_SCOPE(FontDecompressor);
   for (auto& entry : cache) {
-    if (entry.data) {
-      free(entry.data);
-      entry.data = nullptr;
-    }
     entry.valid = false;
   }
+  free(slab);
+  slab = nullptr;
+  slabSize = 0;
+  slabUsed = 0;
 }
 
 void FontDecompressor::deinit() { freeAllEntries(); }
@@ -26,11 +31,22 @@ void FontDecompressor::clearCache() {
   accessCounter = 0;
 }
 
+// Groups are stored in glyph order, so the last one starting at or before the glyph holds it
 uint16_t FontDecompressor::getGroupIndex(const EpdFontData* fontData, uint16_t glyphIndex) {
-  for (uint16_t i = 0; i < fontData->groupCount; i++) {
-    uint16_t first = fontData->groups[i].firstGlyphIndex;
-    if (glyphIndex >= first && glyphIndex < first + fontData->groups[i].glyphCount) {
-      return i;
+  uint16_t lo = 0;
+  uint16_t hi = fontData->groupCount;
+  while (lo < hi) {
+    const uint16_t mid = (lo + hi) / 2;
+    if (fontData->groups[mid].firstGlyphIndex <= glyphIndex) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo > 0) {
+    const EpdFontGroup& group = fontData->groups[lo - 1];
+    if (glyphIndex < group.firstGlyphIndex + group.glyphCount) {
+      return lo - 1;
     }
   }
   return fontData->groupCount;  // sentinel = not found
@@ -45,53 +61,79 @@ FontDecompressor::CacheEntry* FontDecompressor::findInCache(const EpdFontData* f
   return nullptr;
 }
 
-FontDecompressor::CacheEntry* FontDecompressor::findEvictionCandidate() {
-  // Find an invalid slot first
-  for (auto& entry : cache) {
-    if (!entry.valid) {
-      return &entry;
+// Evicts least recently used groups until `size` more bytes fit in the budget (or, for a group bigger than the budget,
+// until the cache is empty) and an entry is free, then packs the remaining groups to the front of the slab and grows
+// it if needed. Returns the free entry, or nullptr if the slab can't grow.
+FontDecompressor::CacheEntry* FontDecompressor::makeRoom(const uint32_t size) {
+  const uint32_t limit = std::max(CACHE_BUDGET, size);
+  CacheEntry* freeEntry = nullptr;
+  while (true) {
+    uint32_t used = 0;
+    CacheEntry* lru = nullptr;
+    freeEntry = nullptr;
+    for (auto& entry : cache) {
+      if (!entry.valid) {
+        if (!freeEntry) freeEntry = &entry;
+        continue;
+      }
+      used += entry.dataSize;
+      if (!lru || entry.lastUsed < lru->lastUsed) lru = &entry;
     }
+    if (freeEntry && used + size <= limit) {
+      break;
+    }
+    lru->valid = false;
   }
-  // Otherwise evict LRU
-  CacheEntry* lru = &cache[0];
+
+  CacheEntry* live[MAX_ENTRIES];
+  int liveCount = 0;
   for (auto& entry : cache) {
-    if (entry.lastUsed < lru->lastUsed) {
-      lru = &entry;
+    if (entry.valid) live[liveCount++] = &entry;
+  }
+  std::sort(live, live + liveCount, [](const CacheEntry* a, const CacheEntry* b) { return a->offset < b->offset; });
+  slabUsed = 0;
+  for (int i = 0; i < liveCount; i++) {
+    if (live[i]->offset != slabUsed) {
+      memmove(slab + slabUsed, slab + live[i]->offset, live[i]->dataSize);
+      live[i]->offset = slabUsed;
+    }
+    slabUsed += live[i]->dataSize;
+  }
+
+  if (slabUsed + size > slabSize) {
+    HEAP_SCOPE(FontDecompressor);
+    const uint32_t newSize = std::max(CACHE_BUDGET, slabUsed + size);
+    auto* grown = static_cast<uint8_t*>(realloc(slab, newSize));
+    if (!grown) {
+      LOG_ERR("FDC", "Failed to grow the group cache to %u bytes", newSize);
+      return nullptr;
     }
+    slab = grown;
+    slabSize = newSize;
   }
-  return lru;
+  return freeEntry;
 }
 
 bool FontDecompressor::decompressGroup(const EpdFontData* fontData, uint16_t groupIndex, CacheEntry* entry) {
+  PERF_SCOPE(FontDecompress);
   const EpdFontGroup& group = fontData->groups[groupIndex];
+  uint8_t* outBuf = slab + slabUsed;
 
-  // Free old buffer if reusing a slot
-  if (entry->data) {
-    free(entry->data);
-    entry->data = nullptr;
-  }
-  entry->valid = false;
-
-  // Allocate output buffer
-  auto* outBuf = static_cast<uint8_t*>(malloc(group.uncompressedSize));
-  if (!outBuf) {
-    LOG_ERR("FDC", "Failed to allocate %u bytes for group %u", group.uncompressedSize, groupIndex);
-    return false;
-  }
-
+  const uint32_t start = perf::nowUs();
   inflateReader.init(false);
   inflateReader.setSource(&fontData->bitmap[group.compressedOffset], group.compressedSize);
   if (!inflateReader.read(outBuf, group.uncompressedSize)) {
     LOG_ERR("FDC", "Decompression failed for group %u", groupIndex);
-    free(outBuf);
     return false;
   }
+  stats.inflateUs += perf::nowUs() - start;
 
   entry->font = fontData;
   entry->groupIndex = groupIndex;
-  entry->data = outBuf;
+  entry->offset = slabUsed;
   entry->dataSize = group.uncompressedSize;
   entry->valid = true;
+  slabUsed += group.uncompressedSize;
   return true;
 }
 
@@ -109,19 +151,14 @@ const uint8_t* FontDecompressor::getBitmap(const EpdFontData* fontData, const Ep
   // Check cache
   CacheEntry* entry = findInCache(fontData, groupIndex);
   if (entry) {
-    entry->lastUsed = ++accessCounter;
-    if (glyph->dataOffset + glyph->dataLength > entry->dataSize) {
-      LOG_ERR("FDC", "dataOffset %u + dataLength %u out of bounds for group %u (size %u)", glyph->dataOffset,
-              glyph->dataLength, groupIndex, entry->dataSize);
+    stats.hits++;
+  } else {
+    // Cache miss - decompress
+    stats.misses++;
+    entry = makeRoom(fontData->groups[groupIndex].uncompressedSize);
+    if (!entry || !decompressGroup(fontData, groupIndex, entry)) {
       return nullptr;
     }
-    return &entry->data[glyph->dataOffset];
-  }
-
-  // Cache miss - decompress
-  entry = findEvictionCandidate();
-  if (!decompressGroup(fontData, groupIndex, entry)) {
-    return nullptr;
   }
 
   entry->lastUsed = ++accessCounter;
@@ -130,5 +167,5 @@ const uint8_t* FontDecompressor::getBitmap(const EpdFontData* fontData, const Ep
             glyph->dataLength, groupIndex, entry->dataSize);
     return nullptr;
   }
-  return &entry->data[glyph->dataOffset];
+  return &slab[entry->offset + glyph->dataOffset];
 }
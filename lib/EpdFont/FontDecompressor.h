@@ -6,35 +6,54 @@
 
 class FontDecompressor {
  public:
+  // Decompressed groups stay cached while they fit in this many bytes. A page of Latin text in four styles needs
+  // about 30 KB; a single bigger group still gets decompressed, on its own.
+  static constexpr uint32_t CACHE_BUDGET = 32 * 1024;
+
+  struct Stats {
+    uint32_t hits = 0;       // Glyph lookups served from the cache
+    uint32_t misses = 0;     // Glyph lookups that inflated their group
+    uint32_t inflateUs = 0;  // Time spent inflating
+  };
+
   bool init();
   void deinit();
 
   // Returns pointer to decompressed bitmap data for the given glyph.
-  // Valid until LRU eviction (safe for the duration of one glyph render).
+  // Valid until the next call, which may evict or move cached groups (safe for the duration of one glyph render).
   const uint8_t* getBitmap(const EpdFontData* fontData, const EpdGlyph* glyph, uint16_t glyphIndex);
 
-  // Evict all cached decompressed groups (call between pages for within-page-only caching).
+  // Evict all cached decompressed groups and free their storage. The cache is kept from page to page, so only call
+  // this when the heap runs short or the fonts change.
   void clearCache();
 
+  const Stats& getStats() const { return stats; }
+  void resetStats() { stats = {}; }
+
  private:
-  static constexpr uint8_t CACHE_SLOTS = 4;
+  static constexpr uint8_t MAX_ENTRIES = 16;
 
   struct CacheEntry {
     const EpdFontData* font = nullptr;
     uint16_t groupIndex = 0;
-    uint8_t* data = nullptr;
+    uint32_t offset = 0;  // Into the slab
     uint32_t dataSize = 0;
     uint32_t lastUsed = 0;
     bool valid = false;
   };
 
   InflateReader inflateReader;
-  CacheEntry cache[CACHE_SLOTS] = {};
+  CacheEntry cache[MAX_ENTRIES] = {};
+  // One block holding every cached group, packed from its start; allocated on the first miss
+  uint8_t* slab = nullptr;
+  uint32_t slabSize = 0;
+  uint32_t slabUsed = 0;
   uint32_t accessCounter = 0;
+  Stats stats;
 
   void freeAllEntries();
   uint16_t getGroupIndex(const EpdFontData* fontData, uint16_t glyphIndex);
   CacheEntry* findInCache(const EpdFontData* fontData, uint16_t groupIndex);
-  CacheEntry* findEvictionCandidate();
+  CacheEntry* makeRoom(uint32_t size);
   bool decompressGroup(const EpdFontData* fontData, uint16_t groupIndex, CacheEntry* entry);
 };
@@ -12,6 +12,51 @@
 #include "Epub/parsers/TocNavParser.h"
 #include "Epub/parsers/TocNcxParser.h"
 
+namespace {
+constexpr size_t ITEM_CHUNK_SIZE = 1024;
+
+// Push an inflated entry or a staged temp file into a Print-based parser in fixed-size chunks.
+// readChunk returns the number of bytes read, 0 at the end of the input, or -1 on error.
+template <typename ReadChunk>
+bool feedParserChunks(Print& parser, ReadChunk&& readChunk, const char* what) {
+  const auto buffer = static_cast<uint8_t*>(malloc(ITEM_CHUNK_SIZE));
+  if (!buffer) {
+    LOG_ERR("EBP", "Could not allocate memory for %s parser", what);
+    return false;
+  }
+
+  bool success = true;
+  while (true) {
+    const int readSize = readChunk(buffer, ITEM_CHUNK_SIZE);
+    if (readSize < 0) {
+      LOG_ERR("EBP", "Could not read %s data", what);
+      success = false;
+      break;
+    }
+    if (readSize == 0) break;
+    if (parser.write(buffer, readSize) != static_cast<size_t>(readSize)) {
+      LOG_ERR("EBP", "Could not process all %s data", what);
+      success = false;
+      break;
+    }
+  }
+
+  free(buffer);
+  return success;
+}
+
+bool feedParser(Print& parser, ZipFile::EntryReader& entry, const char* what) {
+  return feedParserChunks(parser, [&entry](uint8_t* buf, const size_t len) { return entry.read(buf, len); }, what);
+}
+
+bool feedParser(Print& parser, FsFile& file, const char* what) {
+  return feedParserChunks(
+      parser,
+      [&file](uint8_t* buf, const size_t len) { return file.available() ? static_cast<int>(file.read(buf, len)) : 0; },
+      what);
+}
+}  // namespace
+
 bool Epub::findContentOpfFile(std::string* contentOpfFile) const {
   const auto containerPath = "META-INF/container.xml";
   size_t containerSize;
@@ -152,50 +197,40 @@ bool Epub::parseTocNcxFile() const {
 
   LOG_DBG("EBP", "Parsing toc ncx file: %s", tocNcxItem.c_str());
 
+  // Inflate straight into the parser; only stage the ncx on SD if the entry can't be opened for streaming
   const auto tmpNcxPath = getCachePath() + "/toc.ncx";
+  ZipFile::EntryReader ncxEntry;
   FsFile tempNcxFile;
-  if (!Storage.openFileForWrite("EBP", tmpNcxPath, tempNcxFile)) {
-    return false;
-  }
-  readItemContentsToStream(tocNcxItem, tempNcxFile, 1024);
-  tempNcxFile.close();
-  if (!Storage.openFileForRead("EBP", tmpNcxPath, tempNcxFile)) {
-    return false;
+  size_t ncxSize;
+  if (openItemReader(tocNcxItem, ncxEntry, ITEM_CHUNK_SIZE)) {
+    ncxSize = ncxEntry.size();
+  } else {
+    LOG_DBG("EBP", "Could not stream toc ncx, falling back to temp file");
+    if (!extractItemToTempFile(tocNcxItem, tmpNcxPath, tempNcxFile)) {
+      return false;
+    }
+    ncxSize = tempNcxFile.size();
   }
-  const auto ncxSize = tempNcxFile.size();
 
   TocNcxParser ncxParser(contentBasePath, ncxSize, bookMetadataCache.get());
 
+  bool success = false;
   if (!ncxParser.setup()) {
     LOG_ERR("EBP", "Could not setup toc ncx parser");
-    tempNcxFile.close();
-    return false;
+  } else if (ncxEntry.isOpen()) {
+    success = feedParser(ncxParser, ncxEntry, "toc ncx");
+  } else {
+    success = feedParser(ncxParser, tempNcxFile, "toc ncx");
   }
 
-  const auto ncxBuffer = static_cast<uint8_t*>(malloc(1024));
-  if (!ncxBuffer) {
-    LOG_ERR("EBP", "Could not allocate memory for toc ncx parser");
+  if (tempNcxFile) {
     tempNcxFile.close();
-    return false;
+    Storage.remove(tmpNcxPath.c_str());
   }
-
-  while (tempNcxFile.available()) {
-    const auto readSize = tempNcxFile.read(ncxBuffer, 1024);
-    if (readSize == 0) break;
-    const auto processedSize = ncxParser.write(ncxBuffer, readSize);
-
-    if (processedSize != readSize) {
-      LOG_ERR("EBP", "Could not process all toc ncx data");
-      free(ncxBuffer);
-      tempNcxFile.close();
-      return false;
-    }
+  if (!success) {
+    return false;
   }
 
-  free(ncxBuffer);
-  tempNcxFile.close();
-  Storage.remove(tmpNcxPath.c_str());
-
   LOG_DBG("EBP", "Parsed TOC items");
   return true;
 }
@@ -209,51 +244,62 @@ bool Epub::parseTocNavFile() const {
 
   LOG_DBG("EBP", "Parsing toc nav file: %s", tocNavItem.c_str());
 
+  // Inflate straight into the parser; only stage the nav on SD if the entry can't be opened for streaming
   const auto tmpNavPath = getCachePath() + "/toc.nav";
+  ZipFile::EntryReader navEntry;
   FsFile tempNavFile;
-  if (!Storage.openFileForWrite("EBP", tmpNavPath, tempNavFile)) {
-    return false;
-  }
-  readItemContentsToStream(tocNavItem, tempNavFile, 1024);
-  tempNavFile.close();
-  if (!Storage.openFileForRead("EBP", tmpNavPath, tempNavFile)) {
-    return false;
+  size_t navSize;
+  if (openItemReader(tocNavItem, navEntry, ITEM_CHUNK_SIZE)) {
+    navSize = navEntry.size();
+  } else {
+    LOG_DBG("EBP", "Could not stream toc nav, falling back to temp file");
+    if (!extractItemToTempFile(tocNavItem, tmpNavPath, tempNavFile)) {
+      return false;
+    }
+    navSize = tempNavFile.size();
   }
-  const auto navSize = tempNavFile.size();
 
   // Note: We can't use `contentBasePath` here as the nav file may be in a different folder to the content.opf
   // and the HTMLX nav file will have hrefs relative to itself
   const std::string navContentBasePath = tocNavItem.substr(0, tocNavItem.find_last_of('/') + 1);
   TocNavParser navParser(navContentBasePath, navSize, bookMetadataCache.get());
 
+  bool success = false;
   if (!navParser.setup()) {
     LOG_ERR("EBP", "Could not setup toc nav parser");
-    return false;
+  } else if (navEntry.isOpen()) {
+    success = feedParser(navParser, navEntry, "toc nav");
+  } else {
+    success = feedParser(navParser, tempNavFile, "toc nav");
   }
 
-  const auto navBuffer = static_cast<uint8_t*>(malloc(1024));
-  if (!navBuffer) {
-    LOG_ERR("EBP", "Could not allocate memory for toc nav parser");
+  if (tempNavFile) {
+    tempNavFile.close();
+    Storage.remove(tmpNavPath.c_str());
+  }
+  if (!success) {
     return false;
   }
 
-  while (tempNavFile.available()) {
-    const auto readSize = tempNavFile.read(navBuffer, 1024);
-    const auto processedSize = navParser.write(navBuffer, readSize);
+  LOG_DBG("EBP", "Parsed TOC nav items");
+  return true;
+}
 
-    if (processedSize != readSize) {
-      LOG_ERR("EBP", "Could not process all toc nav data");
-      free(navBuffer);
-      tempNavFile.close();
-      return false;
-    }
+bool Epub::extractItemToTempFile(const std::string& itemHref, const std::string& tmpPath, FsFile& file) const {
+  if (!Storage.openFileForWrite("EBP", tmpPath, file)) {
+    return false;
+  }
+  const bool extracted = readItemContentsToStream(itemHref, file, ITEM_CHUNK_SIZE);
+  file.close();
+  if (!extracted) {
+    LOG_ERR("EBP", "Could not extract %s to temp file", itemHref.c_str());
+    Storage.remove(tmpPath.c_str());
+    return false;
+  }
+  if (!Storage.openFileForRead("EBP", tmpPath, file)) {
+    Storage.remove(tmpPath.c_str());
+    return false;
   }
-
-  free(navBuffer);
-  tempNavFile.close();
-  Storage.remove(tmpNavPath.c_str());
-
-  LOG_DBG("EBP", "Parsed TOC nav items");
   return true;
 }
 
@@ -277,6 +323,7 @@ void Epub::parseCssFiles() const {
   }
 
   // No cache yet - parse CSS files
+  bool rulesComplete = true;
   for (const auto& cssPath : cssFiles) {
     LOG_DBG("EBP", "Parsing CSS file: %s", cssPath.c_str());
 
@@ -298,34 +345,42 @@ void Epub::parseCssFiles() const {
       }
     }
 
-    // Extract CSS file to temp location
+    // A stream that fails midway leaves this file's rules half applied; reparsing it in full from a temp file
+    // overwrites them with the same values
+    bool partiallyParsed = false;
+    {
+      ZipFile::EntryReader cssEntry;
+      if (openItemReader(cssPath, cssEntry, ITEM_CHUNK_SIZE)) {
+        if (cssParser->loadFromStream(cssEntry)) {
+          continue;
+        }
+        partiallyParsed = true;
+      }
+    }
+
+    // Fall back to extracting the CSS file to a temp location
+    LOG_DBG("EBP", "Could not stream CSS file, falling back to temp file");
     const auto tmpCssPath = getCachePath() + "/.tmp.css";
     FsFile tempCssFile;
-    if (!Storage.openFileForWrite("EBP", tmpCssPath, tempCssFile)) {
-      LOG_ERR("EBP", "Could not create temp CSS file");
-      continue;
-    }
-    if (!readItemContentsToStream(cssPath, tempCssFile, 1024)) {
+    if (!extractItemToTempFile(cssPath, tmpCssPath, tempCssFile)) {
       LOG_ERR("EBP", "Could not read CSS file: %s", cssPath.c_str());
-      tempCssFile.close();
-      Storage.remove(tmpCssPath.c_str());
+      if (partiallyParsed) {
+        rulesComplete = false;
+      }
       continue;
     }
-    tempCssFile.close();
-
-    // Parse the CSS file
-    if (!Storage.openFileForRead("EBP", tmpCssPath, tempCssFile)) {
-      LOG_ERR("EBP", "Could not open temp CSS file for reading");
-      Storage.remove(tmpCssPath.c_str());
-      continue;
+    if (!cssParser->loadFromStream(tempCssFile)) {
+      LOG_ERR("EBP", "Could not parse CSS file: %s", cssPath.c_str());
+      rulesComplete = false;
     }
-    cssParser->loadFromStream(tempCssFile);
     tempCssFile.close();
     Storage.remove(tmpCssPath.c_str());
   }
 
-  // Save to cache for next time
-  if (!cssParser->saveToCache()) {
+  // Save to cache for next time, unless a file's rules are incomplete: they would stick until the cache is cleared
+  if (!rulesComplete) {
+    LOG_ERR("EBP", "Not caching CSS rules, a CSS file could only be read in part");
+  } else if (!cssParser->saveToCache()) {
     LOG_ERR("EBP", "Failed to save CSS rules to cache");
   }
   cssParser->clear();
@@ -341,9 +396,11 @@ bool Epub::load(const bool buildIfMissing, const bool skipLoadingCss) {
   bookMetadataCache.reset(new BookMetadataCache(cachePath));
   // Always create CssParser - needed for inline style parsing even without CSS files
   cssParser.reset(new CssParser(cachePath));
+  zipIndex.reset(new ZipIndex(cachePath + "/zip_index.bin"));
 
   // Try to load existing cache first
   if (bookMetadataCache->load()) {
+    loadZipIndex(buildIfMissing);
     if (!skipLoadingCss) {
       // Rebuild CSS cache when missing or when cache version changed (loadFromCache removes stale file)
       if (!cssParser->hasCache() || !cssParser->loadFromCache()) {
@@ -373,6 +430,7 @@ bool Epub::load(const bool buildIfMissing, const bool skipLoadingCss) {
   setupCacheDir();
 
   const uint32_t indexingStart = millis();
+  loadZipIndex(true);
 
   // Begin building cache - stream entries to disk immediately
   if (!bookMetadataCache->beginWrite()) {
@@ -437,7 +495,7 @@ bool Epub::load(const bool buildIfMissing, const bool skipLoadingCss) {
 
   // Build final book.bin
   const uint32_t buildStart = millis();
-  if (!bookMetadataCache->buildBookBin(filepath, bookMetadata)) {
+  if (!bookMetadataCache->buildBookBin(filepath, bookMetadata, zipIndex.get())) {
     LOG_ERR("EBP", "Could not update mappings and sizes");
     return false;
   }
@@ -465,12 +523,33 @@ bool Epub::load(const bool buildIfMissing, const bool skipLoadingCss) {
   return true;
 }
 
+void Epub::loadZipIndex(const bool buildIfMissing) {
+  ZipFile zip(filepath);
+  if (zipIndex->load(zip)) {
+    LOG_DBG("EBP", "Loaded zip index with %u entries", zipIndex->size());
+    return;
+  }
+  if (!buildIfMissing) {
+    return;
+  }
+
+  // Missing or stale: build it now, every later item lookup reads a single index block
+  if (!zipIndex->build(zip) || !zipIndex->load(zip)) {
+    LOG_ERR("EBP", "Could not build zip index, falling back to central directory scans");
+  }
+}
+
 bool Epub::clearCache() const {
   if (!Storage.exists(cachePath.c_str())) {
     LOG_DBG("EPB", "Cache does not exist, no action needed");
     return true;
   }
 
+  // The zip index lives in the cache dir, don't leave it open while the dir is removed
+  if (zipIndex) {
+    zipIndex->close();
+  }
+
   if (!Storage.removeDir(cachePath.c_str())) {
     LOG_ERR("EPB", "Failed to clear cache");
     return false;
@@ -719,7 +798,7 @@ uint8_t* Epub::readItemContentsToBytes(const std::string& itemHref, size_t* size
 
   const std::string path = FsHelpers::normalisePath(itemHref);
 
-  const auto content = ZipFile(filepath).readFileToMemory(path.c_str(), size, trailingNullByte);
+  const auto content = ZipFile(filepath, zipIndex.get()).readFileToMemory(path.c_str(), size, trailingNullByte);
   if (!content) {
     LOG_DBG("EBP", "Failed to read item %s", path.c_str());
     return nullptr;
@@ -735,12 +814,22 @@ bool Epub::readItemContentsToStream(const std::string& itemHref, Print& out, con
   }
 
   const std::string path = FsHelpers::normalisePath(itemHref);
-  return ZipFile(filepath).readFileToStream(path.c_str(), out, chunkSize);
+  return ZipFile(filepath, zipIndex.get()).readFileToStream(path.c_str(), out, chunkSize);
+}
+
+bool Epub::openItemReader(const std::string& itemHref, ZipFile::EntryReader& reader, const size_t chunkSize) const {
+  if (itemHref.empty()) {
+    LOG_DBG("EBP", "Failed to open item, empty href");
+    return false;
+  }
+
+  const std::string path = FsHelpers::normalisePath(itemHref);
+  return ZipFile(filepath, zipIndex.get()).openEntry(path.c_str(), reader, chunkSize);
 }
 
 bool Epub::getItemSize(const std::string& itemHref, size_t* size) const {
   const std::string path = FsHelpers::normalisePath(itemHref);
-  return ZipFile(filepath).getInflatedFileSize(path.c_str(), size);
+  return ZipFile(filepath, zipIndex.get()).getInflatedFileSize(path.c_str(), size);
 }
 
 int Epub::getSpineItemsCount() const {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Print.h>
+#include <ZipFile.h>
+#include <ZipIndex.h>
 
 #include <memory>
 #include <string>
@@ -10,8 +12,6 @@
 #include "Epub/BookMetadataCache.h"
 #include "Epub/css/CssParser.h"
 
-class ZipFile;
-
 class Epub {
   // the ncx file (EPUB 2)
   std::string tocNcxItem;
@@ -25,6 +25,8 @@ class Epub {
   std::string cachePath;
   // Spine and TOC cache
   std::unique_ptr<BookMetadataCache> bookMetadataCache;
+  // Sorted central directory index, so item lookups skip the zip directory scan
+  std::unique_ptr<ZipIndex> zipIndex;
   // CSS parser for styling
   std::unique_ptr<CssParser> cssParser;
   // CSS files
@@ -35,6 +37,8 @@ class Epub {
   bool parseTocNcxFile() const;
   bool parseTocNavFile() const;
   void parseCssFiles() const;
+  void loadZipIndex(bool buildIfMissing);
+  bool extractItemToTempFile(const std::string& itemHref, const std::string& tmpPath, FsFile& file) const;
 
  public:
   explicit Epub(std::string filepath, const std::string& cacheDir) : filepath(std::move(filepath)) {
@@ -59,6 +63,8 @@ class Epub {
   uint8_t* readItemContentsToBytes(const std::string& itemHref, size_t* size = nullptr,
                                    bool trailingNullByte = false) const;
   bool readItemContentsToStream(const std::string& itemHref, Print& out, size_t chunkSize) const;
+  // Open an item for incremental inflation, so parsers can consume it without a temp file on SD
+  bool openItemReader(const std::string& itemHref, ZipFile::EntryReader& reader, size_t chunkSize) const;
   bool getItemSize(const std::string& itemHref, size_t* size) const;
   BookMetadataCache::SpineEntry getSpineItem(int spineIndex) const;
   BookMetadataCache::TocEntry getTocItem(int tocIndex) const;
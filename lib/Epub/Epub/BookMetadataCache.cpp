@@ -3,6 +3,7 @@
 #include <Logging.h>
 #include <Serialization.h>
 #include <ZipFile.h>
+#include <ZipIndex.h>
 
 #include <vector>
 
@@ -13,6 +14,8 @@ constexpr uint8_t BOOK_CACHE_VERSION = 5;
 constexpr char bookBinFile[] = "/book.bin";
 constexpr char tmpSpineBinFile[] = "/spine.bin.tmp";
 constexpr char tmpTocBinFile[] = "/toc.bin.tmp";
+// Stack buffer for random-access reads of a single entry from book.bin
+constexpr size_t ENTRY_READ_BUFFER_SIZE = 256;
 }  // namespace
 
 /* ============= WRITING / BUILDING FUNCTIONS ================ */
@@ -29,12 +32,21 @@ bool BookMetadataCache::beginContentOpfPass() {
   LOG_DBG("BMC", "Beginning content opf pass");
 
   // Open spine file for writing
-  return Storage.openFileForWrite("BMC", cachePath + tmpSpineBinFile, spineFile);
+  if (!Storage.openFileForWrite("BMC", cachePath + tmpSpineBinFile, spineFile)) {
+    return false;
+  }
+  spineWriter.reset(new BufferedFsWriter(spineFile));
+  return true;
 }
 
 bool BookMetadataCache::endContentOpfPass() {
+  const bool flushed = !spineWriter || spineWriter->flush();
+  spineWriter.reset();
   spineFile.close();
-  return true;
+  if (!flushed) {
+    LOG_ERR("BMC", "Failed to write spine entries");
+  }
+  return flushed;
 }
 
 bool BookMetadataCache::beginTocPass() {
@@ -47,13 +59,15 @@ bool BookMetadataCache::beginTocPass() {
     spineFile.close();
     return false;
   }
+  spineReader.reset(new BufferedFsReader(spineFile));
+  tocWriter.reset(new BufferedFsWriter(tocFile));
 
   if (spineCount >= LARGE_SPINE_THRESHOLD) {
     spineHrefIndex.clear();
     spineHrefIndex.reserve(spineCount);
-    spineFile.seek(0);
+    spineReader->seek(0);
     for (int i = 0; i < spineCount; i++) {
-      auto entry = readSpineEntry(spineFile);
+      auto entry = readSpineEntry(*spineReader);
       SpineHrefIndexEntry idx;
       idx.hrefHash = fnvHash64(entry.href);
       idx.hrefLen = static_cast<uint16_t>(entry.href.size());
@@ -64,7 +78,7 @@ bool BookMetadataCache::beginTocPass() {
               [](const SpineHrefIndexEntry& a, const SpineHrefIndexEntry& b) {
                 return a.hrefHash < b.hrefHash || (a.hrefHash == b.hrefHash && a.hrefLen < b.hrefLen);
               });
-    spineFile.seek(0);
+    spineReader->seek(0);
     useSpineHrefIndex = true;
     LOG_DBG("BMC", "Using fast index for %d spine items", spineCount);
   } else {
@@ -75,6 +89,9 @@ bool BookMetadataCache::beginTocPass() {
 }
 
 bool BookMetadataCache::endTocPass() {
+  const bool flushed = !tocWriter || tocWriter->flush();
+  tocWriter.reset();
+  spineReader.reset();
   tocFile.close();
   spineFile.close();
 
@@ -82,7 +99,10 @@ bool BookMetadataCache::endTocPass() {
   spineHrefIndex.shrink_to_fit();
   useSpineHrefIndex = false;
 
-  return true;
+  if (!flushed) {
+    LOG_ERR("BMC", "Failed to write TOC entries");
+  }
+  return flushed;
 }
 
 bool BookMetadataCache::endWrite() {
@@ -96,7 +116,8 @@ bool BookMetadataCache::endWrite() {
   return true;
 }
 
-bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMetadata& metadata) {
+bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMetadata& metadata,
+                                     const ZipIndex* zipIndex) {
   // Open all three files, writing to meta, reading from spine and toc
   if (!Storage.openFileForWrite("BMC", cachePath + bookBinFile, bookFile)) {
     return false;
@@ -113,6 +134,10 @@ bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMeta
     return false;
   }
 
+  BufferedFsWriter bookWriter(bookFile);
+  spineReader.reset(new BufferedFsReader(spineFile));
+  tocReader.reset(new BufferedFsReader(tocFile));
+
   constexpr uint32_t headerASize =
       sizeof(BOOK_CACHE_VERSION) + /* LUT Offset */ sizeof(uint32_t) + sizeof(spineCount) + sizeof(tocCount);
   const uint32_t metadataSize = metadata.title.size() + metadata.author.size() + metadata.language.size() +
@@ -122,31 +147,31 @@ bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMeta
   const uint32_t lutOffset = headerASize + metadataSize;
 
   // Header A
-  serialization::writePod(bookFile, BOOK_CACHE_VERSION);
-  serialization::writePod(bookFile, lutOffset);
-  serialization::writePod(bookFile, spineCount);
-  serialization::writePod(bookFile, tocCount);
+  serialization::writePod(bookWriter, BOOK_CACHE_VERSION);
+  serialization::writePod(bookWriter, lutOffset);
+  serialization::writePod(bookWriter, spineCount);
+  serialization::writePod(bookWriter, tocCount);
   // Metadata
-  serialization::writeString(bookFile, metadata.title);
-  serialization::writeString(bookFile, metadata.author);
-  serialization::writeString(bookFile, metadata.language);
-  serialization::writeString(bookFile, metadata.coverItemHref);
-  serialization::writeString(bookFile, metadata.textReferenceHref);
+  serialization::writeString(bookWriter, metadata.title);
+  serialization::writeString(bookWriter, metadata.author);
+  serialization::writeString(bookWriter, metadata.language);
+  serialization::writeString(bookWriter, metadata.coverItemHref);
+  serialization::writeString(bookWriter, metadata.textReferenceHref);
 
   // Loop through spine entries, writing LUT positions
-  spineFile.seek(0);
+  spineReader->seek(0);
   for (int i = 0; i < spineCount; i++) {
-    uint32_t pos = spineFile.position();
-    auto spineEntry = readSpineEntry(spineFile);
-    serialization::writePod(bookFile, pos + lutOffset + lutSize);
+    uint32_t pos = spineReader->position();
+    auto spineEntry = readSpineEntry(*spineReader);
+    serialization::writePod(bookWriter, pos + lutOffset + lutSize);
   }
 
   // Loop through toc entries, writing LUT positions
-  tocFile.seek(0);
+  tocReader->seek(0);
   for (int i = 0; i < tocCount; i++) {
-    uint32_t pos = tocFile.position();
-    auto tocEntry = readTocEntry(tocFile);
-    serialization::writePod(bookFile, pos + lutOffset + lutSize + static_cast<uint32_t>(spineFile.position()));
+    uint32_t pos = tocReader->position();
+    auto tocEntry = readTocEntry(*tocReader);
+    serialization::writePod(bookWriter, pos + lutOffset + lutSize + spineReader->position());
   }
 
   // LUTs complete
@@ -154,9 +179,9 @@ bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMeta
 
   // Build spineIndex->tocIndex mapping in one pass (O(n) instead of O(n*m))
   std::vector<int16_t> spineToTocIndex(spineCount, -1);
-  tocFile.seek(0);
+  tocReader->seek(0);
   for (int j = 0; j < tocCount; j++) {
-    auto tocEntry = readTocEntry(tocFile);
+    auto tocEntry = readTocEntry(*tocReader);
     if (tocEntry.spineIndex >= 0 && tocEntry.spineIndex < spineCount) {
       if (spineToTocIndex[tocEntry.spineIndex] == -1) {
         spineToTocIndex[tocEntry.spineIndex] = static_cast<int16_t>(j);
@@ -164,10 +189,12 @@ bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMeta
     }
   }
 
-  ZipFile zip(epubPath);
+  ZipFile zip(epubPath, zipIndex);
   // Pre-open zip file to speed up size calculations
   if (!zip.open()) {
     LOG_ERR("BMC", "Could not open EPUB zip for size calculations");
+    spineReader.reset();
+    tocReader.reset();
     bookFile.close();
     spineFile.close();
     tocFile.close();
@@ -184,15 +211,17 @@ bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMeta
   std::vector<uint32_t> spineSizes;
   bool useBatchSizes = false;
 
-  if (spineCount >= LARGE_SPINE_THRESHOLD) {
+  // A loaded zip index already answers each lookup with a single block read
+  const bool haveZipIndex = zipIndex && zipIndex->isLoaded();
+  if (spineCount >= LARGE_SPINE_THRESHOLD && !haveZipIndex) {
     LOG_DBG("BMC", "Using batch size lookup for %d spine items", spineCount);
 
     std::vector<ZipFile::SizeTarget> targets;
     targets.reserve(spineCount);
 
-    spineFile.seek(0);
+    spineReader->seek(0);
     for (int i = 0; i < spineCount; i++) {
-      auto entry = readSpineEntry(spineFile);
+      auto entry = readSpineEntry(*spineReader);
       std::string path = FsHelpers::normalisePath(entry.href);
 
       ZipFile::SizeTarget t;
@@ -217,10 +246,10 @@ bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMeta
   }
 
   uint32_t cumSize = 0;
-  spineFile.seek(0);
+  spineReader->seek(0);
   int lastSpineTocIndex = -1;
   for (int i = 0; i < spineCount; i++) {
-    auto spineEntry = readSpineEntry(spineFile);
+    auto spineEntry = readSpineEntry(*spineReader);
 
     spineEntry.tocIndex = spineToTocIndex[i];
 
@@ -253,22 +282,30 @@ bool BookMetadataCache::buildBookBin(const std::string& epubPath, const BookMeta
     spineEntry.cumulativeSize = cumSize;
 
     // Write out spine data to book.bin
-    writeSpineEntry(bookFile, spineEntry);
+    writeSpineEntry(bookWriter, spineEntry);
   }
   // Close opened zip file
   zip.close();
 
   // Loop through toc entries from toc file writing to book.bin
-  tocFile.seek(0);
+  tocReader->seek(0);
   for (int i = 0; i < tocCount; i++) {
-    auto tocEntry = readTocEntry(tocFile);
-    writeTocEntry(bookFile, tocEntry);
+    auto tocEntry = readTocEntry(*tocReader);
+    writeTocEntry(bookWriter, tocEntry);
   }
 
+  const bool flushed = bookWriter.flush();
+  spineReader.reset();
+  tocReader.reset();
   bookFile.close();
   spineFile.close();
   tocFile.close();
 
+  if (!flushed) {
+    LOG_ERR("BMC", "Failed to write book.bin");
+    return false;
+  }
+
   LOG_DBG("BMC", "Successfully built book.bin");
   return true;
 }
@@ -283,40 +320,40 @@ bool BookMetadataCache::cleanupTmpFiles() const {
   return true;
 }
 
-uint32_t BookMetadataCache::writeSpineEntry(FsFile& file, const SpineEntry& entry) const {
-  const uint32_t pos = file.position();
-  serialization::writeString(file, entry.href);
-  serialization::writePod(file, entry.cumulativeSize);
-  serialization::writePod(file, entry.tocIndex);
+uint32_t BookMetadataCache::writeSpineEntry(BufferedFsWriter& writer, const SpineEntry& entry) const {
+  const uint32_t pos = writer.position();
+  serialization::writeString(writer, entry.href);
+  serialization::writePod(writer, entry.cumulativeSize);
+  serialization::writePod(writer, entry.tocIndex);
   return pos;
 }
 
-uint32_t BookMetadataCache::writeTocEntry(FsFile& file, const TocEntry& entry) const {
-  const uint32_t pos = file.position();
-  serialization::writeString(file, entry.title);
-  serialization::writeString(file, entry.href);
-  serialization::writeString(file, entry.anchor);
-  serialization::writePod(file, entry.level);
-  serialization::writePod(file, entry.spineIndex);
+uint32_t BookMetadataCache::writeTocEntry(BufferedFsWriter& writer, const TocEntry& entry) const {
+  const uint32_t pos = writer.position();
+  serialization::writeString(writer, entry.title);
+  serialization::writeString(writer, entry.href);
+  serialization::writeString(writer, entry.anchor);
+  serialization::writePod(writer, entry.level);
+  serialization::writePod(writer, entry.spineIndex);
   return pos;
 }
 
 // Note: for the LUT to be accurate, this **MUST** be called for all spine items before `addTocEntry` is ever called
 // this is because in this function we're marking positions of the items
 void BookMetadataCache::createSpineEntry(const std::string& href) {
-  if (!buildMode || !spineFile) {
+  if (!buildMode || !spineWriter) {
     LOG_DBG("BMC", "createSpineEntry called but not in build mode");
     return;
   }
 
   const SpineEntry entry(href, 0, -1);
-  writeSpineEntry(spineFile, entry);
+  writeSpineEntry(*spineWriter, entry);
   spineCount++;
 }
 
 void BookMetadataCache::createTocEntry(const std::string& title, const std::string& href, const std::string& anchor,
                                        const uint8_t level) {
-  if (!buildMode || !tocFile || !spineFile) {
+  if (!buildMode || !tocWriter || !spineReader) {
     LOG_DBG("BMC", "createTocEntry called but not in build mode");
     return;
   }
@@ -342,9 +379,9 @@ void BookMetadataCache::createTocEntry(const std::string& title, const std::stri
       LOG_DBG("BMC", "createTocEntry: Could not find spine item for TOC href %s", href.c_str());
     }
   } else {
-    spineFile.seek(0);
+    spineReader->seek(0);
     for (int i = 0; i < spineCount; i++) {
-      auto spineEntry = readSpineEntry(spineFile);
+      auto spineEntry = readSpineEntry(*spineReader);
       if (spineEntry.href == href) {
         spineIndex = static_cast<int16_t>(i);
         break;
@@ -356,7 +393,7 @@ void BookMetadataCache::createTocEntry(const std::string& title, const std::stri
   }
 
   const TocEntry entry(title, href, anchor, level, spineIndex);
-  writeTocEntry(tocFile, entry);
+  writeTocEntry(*tocWriter, entry);
   tocCount++;
 }
 
@@ -367,23 +404,26 @@ bool BookMetadataCache::load() {
     return false;
   }
 
+  uint8_t headerBuffer[ENTRY_READ_BUFFER_SIZE];
+  BufferedFsReader reader(bookFile, headerBuffer, sizeof(headerBuffer));
+
   uint8_t version;
-  serialization::readPod(bookFile, version);
+  serialization::readPod(reader, version);
   if (version != BOOK_CACHE_VERSION) {
     LOG_DBG("BMC", "Cache version mismatch: expected %d, got %d", BOOK_CACHE_VERSION, version);
     bookFile.close();
     return false;
   }
 
-  serialization::readPod(bookFile, lutOffset);
-  serialization::readPod(bookFile, spineCount);
-  serialization::readPod(bookFile, tocCount);
+  serialization::readPod(reader, lutOffset);
+  serialization::readPod(reader, spineCount);
+  serialization::readPod(reader, tocCount);
 
-  serialization::readString(bookFile, coreMetadata.title);
-  serialization::readString(bookFile, coreMetadata.author);
-  serialization::readString(bookFile, coreMetadata.language);
-  serialization::readString(bookFile, coreMetadata.coverItemHref);
-  serialization::readString(bookFile, coreMetadata.textReferenceHref);
+  serialization::readString(reader, coreMetadata.title);
+  serialization::readString(reader, coreMetadata.author);
+  serialization::readString(reader, coreMetadata.language);
+  serialization::readString(reader, coreMetadata.coverItemHref);
+  serialization::readString(reader, coreMetadata.textReferenceHref);
 
   loaded = true;
   LOG_DBG("BMC", "Loaded cache data: %d spine, %d TOC entries", spineCount, tocCount);
@@ -406,7 +446,9 @@ BookMetadataCache::SpineEntry BookMetadataCache::getSpineEntry(const int index)
   uint32_t spineEntryPos;
   serialization::readPod(bookFile, spineEntryPos);
   bookFile.seek(spineEntryPos);
-  return readSpineEntry(bookFile);
+  uint8_t entryBuffer[ENTRY_READ_BUFFER_SIZE];
+  BufferedFsReader reader(bookFile, entryBuffer, sizeof(entryBuffer));
+  return readSpineEntry(reader);
 }
 
 BookMetadataCache::TocEntry BookMetadataCache::getTocEntry(const int index) {
@@ -425,23 +467,25 @@ BookMetadataCache::TocEntry BookMetadataCache::getTocEntry(const int index) {
   uint32_t tocEntryPos;
   serialization::readPod(bookFile, tocEntryPos);
   bookFile.seek(tocEntryPos);
-  return readTocEntry(bookFile);
+  uint8_t entryBuffer[ENTRY_READ_BUFFER_SIZE];
+  BufferedFsReader reader(bookFile, entryBuffer, sizeof(entryBuffer));
+  return readTocEntry(reader);
 }
 
-BookMetadataCache::SpineEntry BookMetadataCache::readSpineEntry(FsFile& file) const {
+BookMetadataCache::SpineEntry BookMetadataCache::readSpineEntry(BufferedFsReader& reader) const {
   SpineEntry entry;
-  serialization::readString(file, entry.href);
-  serialization::readPod(file, entry.cumulativeSize);
-  serialization::readPod(file, entry.tocIndex);
+  serialization::readString(reader, entry.href);
+  serialization::readPod(reader, entry.cumulativeSize);
+  serialization::readPod(reader, entry.tocIndex);
   return entry;
 }
 
-BookMetadataCache::TocEntry BookMetadataCache::readTocEntry(FsFile& file) const {
+BookMetadataCache::TocEntry BookMetadataCache::readTocEntry(BufferedFsReader& reader) const {
   TocEntry entry;
-  serialization::readString(file, entry.title);
-  serialization::readString(file, entry.href);
-  serialization::readString(file, entry.anchor);
-  serialization::readPod(file, entry.level);
-  serialization::readPod(file, entry.spineIndex);
+  serialization::readString(reader, entry.title);
+  serialization::readString(reader, entry.href);
+  serialization::readString(reader, entry.anchor);
+  serialization::readPod(reader, entry.level);
+  serialization::readPod(reader, entry.spineIndex);
   return entry;
 }
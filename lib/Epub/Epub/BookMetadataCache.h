@@ -1,11 +1,15 @@
 #pragma once
 
+#include <BufferedFs.h>
 #include <HalStorage.h>
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
+class ZipIndex;
+
 class BookMetadataCache {
  public:
   struct BookMetadata {
@@ -44,7 +48,7 @@ class BookMetadataCache {
 
  private:
   std::string cachePath;
-  size_t lutOffset;
+  uint32_t lutOffset;
   uint16_t spineCount;
   uint16_t tocCount;
   bool loaded;
@@ -54,6 +58,11 @@ class BookMetadataCache {
   // Temp file handles during build
   FsFile spineFile;
   FsFile tocFile;
+  // Buffers over the temp files, alive only for the pass that uses them
+  std::unique_ptr<BufferedFsWriter> spineWriter;
+  std::unique_ptr<BufferedFsWriter> tocWriter;
+  std::unique_ptr<BufferedFsReader> spineReader;
+  std::unique_ptr<BufferedFsReader> tocReader;
 
   // Index for fast href→spineIndex lookup (used only for large EPUBs)
   struct SpineHrefIndexEntry {
@@ -76,10 +85,10 @@ class BookMetadataCache {
     return hash;
   }
 
-  uint32_t writeSpineEntry(FsFile& file, const SpineEntry& entry) const;
-  uint32_t writeTocEntry(FsFile& file, const TocEntry& entry) const;
-  SpineEntry readSpineEntry(FsFile& file) const;
-  TocEntry readTocEntry(FsFile& file) const;
+  uint32_t writeSpineEntry(BufferedFsWriter& writer, const SpineEntry& entry) const;
+  uint32_t writeTocEntry(BufferedFsWriter& writer, const TocEntry& entry) const;
+  SpineEntry readSpineEntry(BufferedFsReader& reader) const;
+  TocEntry readTocEntry(BufferedFsReader& reader) const;
 
  public:
   BookMetadata coreMetadata;
@@ -99,8 +108,8 @@ class BookMetadataCache {
   bool endWrite();
   bool cleanupTmpFiles() const;
 
-  // Post-processing to update mappings and sizes
-  bool buildBookBin(const std::string& epubPath, const BookMetadata& metadata);
+  // Post-processing to update mappings and sizes. With a loaded zipIndex, sizes come from the index.
+  bool buildBookBin(const std::string& epubPath, const BookMetadata& metadata, const ZipIndex* zipIndex = nullptr);
 
   // Reading phase (read mode)
   bool load();
@@ -0,0 +1,158 @@
+#include "BookPageMap.h"
+
+#include <HalStorage.h>
+#include <Logging.h>
+#include <Serialization.h>
+
+#include <algorithm>
+
+#include "Section.h"
+
+namespace {
+constexpr uint8_t PAGE_MAP_FILE_VERSION = 1;
+}  // namespace
+
+void BookPageMap::open(const std::string& cachePath, const uint16_t spineCount, const Layout& layout) {
+  const std::string path = cachePath + "/pagemap.bin";
+  if (path == filePath && layout == this->layout && spineCount == pageCounts.size()) {
+    return;
+  }
+  filePath = path;
+  this->layout = layout;
+  reset(spineCount);
+  if (Storage.exists(filePath.c_str()) && !load()) {
+    LOG_DBG("BPM", "Page map is for another layout, starting over");
+    reset(spineCount);
+  }
+  LOG_DBG("BPM", "Page map: %u of %u spine items known", spineCount - missing, spineCount);
+}
+
+void BookPageMap::reset(const uint16_t spineCount) {
+  pageCounts.assign(spineCount, UNKNOWN);
+  pagesBefore.clear();
+  missing = spineCount;
+}
+
+bool BookPageMap::load() {
+  FsFile file;
+  if (!Storage.openFileForRead("BPM", filePath, file)) {
+    return false;
+  }
+
+  uint8_t version = 0, sectionVersion = 0;
+  Layout fileLayout;
+  uint16_t fileSpineCount = 0;
+  serialization::readPod(file, version);
+  serialization::readPod(file, sectionVersion);
+  serialization::readPod(file, fileLayout.fontId);
+  serialization::readPod(file, fileLayout.lineCompression);
+  serialization::readPod(file, fileLayout.extraParagraphSpacing);
+  serialization::readPod(file, fileLayout.paragraphAlignment);
+  serialization::readPod(file, fileLayout.viewportWidth);
+  serialization::readPod(file, fileLayout.viewportHeight);
+  serialization::readPod(file, fileLayout.hyphenationEnabled);
+  serialization::readPod(file, fileLayout.embeddedStyle);
+  serialization::readPod(file, fileSpineCount);
+  // Counts from another section format may come from another line breaker, so they are only kept for this one
+  if (version != PAGE_MAP_FILE_VERSION || sectionVersion != Section::FILE_VERSION || fileLayout != layout ||
+      fileSpineCount != pageCounts.size()) {
+    file.close();
+    return false;
+  }
+
+  const int bytes = fileSpineCount * sizeof(uint16_t);
+  const bool complete = file.read(pageCounts.data(), bytes) == bytes;
+  file.close();
+  if (!complete) {
+    LOG_ERR("BPM", "Truncated page map");
+    return false;
+  }
+  missing = std::count(pageCounts.begin(), pageCounts.end(), UNKNOWN);
+  updateTotals();
+  return true;
+}
+
+bool BookPageMap::save() const {
+  if (!isOpen()) {
+    return false;
+  }
+  FsFile file;
+  if (!Storage.openFileForWrite("BPM", filePath, file)) {
+    return false;
+  }
+  serialization::writePod(file, PAGE_MAP_FILE_VERSION);
+  serialization::writePod(file, Section::FILE_VERSION);
+  serialization::writePod(file, layout.fontId);
+  serialization::writePod(file, layout.lineCompression);
+  serialization::writePod(file, layout.extraParagraphSpacing);
+  serialization::writePod(file, layout.paragraphAlignment);
+  serialization::writePod(file, layout.viewportWidth);
+  serialization::writePod(file, layout.viewportHeight);
+  serialization::writePod(file, layout.hyphenationEnabled);
+  serialization::writePod(file, layout.embeddedStyle);
+  serialization::writePod(file, spineCount());
+  const size_t bytes = pageCounts.size() * sizeof(uint16_t);
+  const bool written = file.write(reinterpret_cast<const uint8_t*>(pageCounts.data()), bytes) == bytes;
+  file.close();
+  if (!written) {
+    LOG_ERR("BPM", "Failed to write page map");
+    Storage.remove(filePath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool BookPageMap::setPageCount(const int spineIndex, const uint16_t pageCount) {
+  if (spineIndex < 0 || spineIndex >= static_cast<int>(pageCounts.size()) || pageCount == UNKNOWN ||
+      pageCounts[spineIndex] == pageCount) {
+    return false;
+  }
+  if (pageCounts[spineIndex] == UNKNOWN) {
+    missing--;
+  }
+  pageCounts[spineIndex] = pageCount;
+  updateTotals();
+  return true;
+}
+
+void BookPageMap::updateTotals() {
+  pagesBefore.clear();
+  if (missing > 0) {
+    return;
+  }
+  pagesBefore.reserve(pageCounts.size() + 1);
+  uint32_t total = 0;
+  for (const uint16_t count : pageCounts) {
+    pagesBefore.push_back(total);
+    total += count;
+  }
+  pagesBefore.push_back(total);
+}
+
+int BookPageMap::nextMissing(const int start) const {
+  for (int i = std::max(start, 0); i < static_cast<int>(pageCounts.size()); i++) {
+    if (pageCounts[i] == UNKNOWN) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+uint32_t BookPageMap::bookPage(const int spineIndex, const int page) const {
+  if (!isComplete() || spineIndex < 0 || spineIndex >= static_cast<int>(pageCounts.size())) {
+    return 0;
+  }
+  return pagesBefore[spineIndex] + std::max(page, 0);
+}
+
+bool BookPageMap::locate(uint32_t bookPage, int& spineIndex, int& page) const {
+  if (!isComplete() || totalPages() == 0) {
+    return false;
+  }
+  bookPage = std::min(bookPage, totalPages() - 1);
+  // Last spine item starting at or before bookPage; empty items start where the next one does, so they are skipped
+  const auto next = std::upper_bound(pagesBefore.begin(), pagesBefore.end() - 1, bookPage);
+  spineIndex = static_cast<int>(next - pagesBefore.begin()) - 1;
+  page = static_cast<int>(bookPage - pagesBefore[spineIndex]);
+  return true;
+}
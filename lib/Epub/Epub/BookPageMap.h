@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Page count of every spine item for one layout, so a position can be expressed as a page of the whole book.
+//
+// Counts are filled in as sections get built (by the reader, the background indexer or a "prepare book" run) and
+// the map is saved after each one, so an interrupted run picks up where it left off. The map is tied to the layout
+// and section format its counts came from; opening it with anything else starts a fresh, empty map.
+class BookPageMap {
+ public:
+  static constexpr uint16_t UNKNOWN = 0xFFFF;
+
+  // The layout parameters a section file is matched on
+  struct Layout {
+    int fontId = 0;
+    float lineCompression = 0;
+    bool extraParagraphSpacing = false;
+    uint8_t paragraphAlignment = 0;
+    uint16_t viewportWidth = 0;
+    uint16_t viewportHeight = 0;
+    bool hyphenationEnabled = false;
+    bool embeddedStyle = false;
+
+    bool operator==(const Layout& other) const {
+      return fontId == other.fontId && lineCompression == other.lineCompression &&
+             extraParagraphSpacing == other.extraParagraphSpacing && paragraphAlignment == other.paragraphAlignment &&
+             viewportWidth == other.viewportWidth && viewportHeight == other.viewportHeight &&
+             hyphenationEnabled == other.hyphenationEnabled && embeddedStyle == other.embeddedStyle;
+    }
+    bool operator!=(const Layout& other) const { return !(*this == other); }
+  };
+
+  // Load the map saved in cachePath if it was built for this layout, otherwise start with every count unknown.
+  // Does nothing if the map is already open for the same book and layout.
+  void open(const std::string& cachePath, uint16_t spineCount, const Layout& layout);
+  bool isOpen() const { return !filePath.empty(); }
+  // Record the page count of a spine item. Returns whether it changed, i.e. whether the map needs saving.
+  bool setPageCount(int spineIndex, uint16_t pageCount);
+  bool save() const;
+
+  // Every spine item has a known page count
+  bool isComplete() const { return isOpen() && missing == 0; }
+  uint16_t missingCount() const { return missing; }
+  uint16_t spineCount() const { return static_cast<uint16_t>(pageCounts.size()); }
+  uint16_t pageCount(const int spineIndex) const {
+    return spineIndex >= 0 && spineIndex < static_cast<int>(pageCounts.size()) ? pageCounts[spineIndex] : UNKNOWN;
+  }
+  const Layout& getLayout() const { return layout; }
+  // First spine item from start on whose page count is unknown, or -1
+  int nextMissing(int start) const;
+
+  // The following need isComplete()
+  uint32_t totalPages() const { return pagesBefore.empty() ? 0 : pagesBefore.back(); }
+  // Zero-based page of the whole book
+  uint32_t bookPage(int spineIndex, int page) const;
+  // Spine item and page holding a zero-based book page, clamped to the last page of the book
+  bool locate(uint32_t bookPage, int& spineIndex, int& page) const;
+
+ private:
+  std::string filePath;
+  Layout layout;
+  std::vector<uint16_t> pageCounts;
+  // pagesBefore[i] pages precede spine item i; the last entry is the book total. Only valid while complete.
+  std::vector<uint32_t> pagesBefore;
+  uint16_t missing = 0;
+
+  void reset(uint16_t spineCount);
+  bool load();
+  void updateTotals();
+};
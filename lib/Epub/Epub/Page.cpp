@@ -3,26 +3,95 @@
 #include <Logging.h>
 #include <Serialization.h>
 
+namespace {
+// Element counts of a serialized page, used to size its arena before decoding
+struct PageShape {
+  uint32_t elements = 0;
+  uint32_t lines = 0;
+  uint32_t images = 0;
+  uint32_t words = 0;
+};
+
+// Walks a serialized page without modifying it. Everything the decoding pass relies on is validated here.
+bool measurePage(ByteReader& reader, const SectionDictionary& dictionary, PageShape& shape) {
+  if (!serialization::readVarUint(reader, shape.elements)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < shape.elements; i++) {
+    uint8_t tag = 0;
+    int32_t xPos, yPos;
+    if (reader.read(&tag, 1) != 1 || !serialization::readVarInt(reader, xPos) ||
+        !serialization::readVarInt(reader, yPos)) {
+      return false;
+    }
+    if (tag == TAG_PageLine) {
+      uint32_t wordCount;
+      if (!TextBlock::skip(reader, dictionary, wordCount)) {
+        return false;
+      }
+      shape.lines++;
+      shape.words += wordCount;
+    } else if (tag == TAG_PageImage) {
+      if (!ImageBlock::skip(reader)) {
+        return false;
+      }
+      shape.images++;
+    } else {
+      LOG_ERR("PGE", "Deserialization failed: Unknown tag %u", tag);
+      return false;
+    }
+  }
+
+  uint32_t fnCount;
+  if (!serialization::readVarUint(reader, fnCount) || fnCount > Page::MAX_FOOTNOTES_PER_PAGE) {
+    return false;
+  }
+  for (uint32_t i = 0; i < fnCount; i++) {
+    uint32_t numberLen, hrefLen;
+    if (!serialization::readVarUint(reader, numberLen) || numberLen >= sizeof(FootnoteEntry::number) ||
+        !reader.take(numberLen) || !serialization::readVarUint(reader, hrefLen) ||
+        hrefLen >= sizeof(FootnoteEntry::href) || !reader.take(hrefLen)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t decodedSize(const PageShape& shape) {
+  constexpr size_t perLine = PageArena::objectFootprint<PageLine>() + PageArena::objectFootprint<TextBlock>() +
+                             PageArena::arrayFootprint<std::string_view>(0) + PageArena::arrayFootprint<uint16_t>(0) +
+                             PageArena::arrayFootprint<EpdFontFamily::Style>(0);
+  constexpr size_t perWord = sizeof(std::string_view) + sizeof(uint16_t) + sizeof(EpdFontFamily::Style);
+  return shape.lines * perLine + shape.words * perWord + shape.images * PageArena::objectFootprint<PageImage>();
+}
+}  // namespace
+
 void PageLine::render(GfxRenderer& renderer, const int fontId, const int xOffset, const int yOffset) {
   block->render(renderer, fontId, xPos + xOffset, yPos + yOffset);
 }
 
-bool PageLine::serialize(FsFile& file) {
-  serialization::writePod(file, xPos);
-  serialization::writePod(file, yPos);
+bool PageLine::serialize(BufferedFsWriter& file, SectionDictionary& dictionary) {
+  serialization::writeVarInt(file, xPos);
+  serialization::writeVarInt(file, yPos);
 
   // serialize TextBlock pointed to by PageLine
-  return block->serialize(file);
+  return block->serialize(file, dictionary);
 }
 
-std::unique_ptr<PageLine> PageLine::deserialize(FsFile& file) {
-  int16_t xPos;
-  int16_t yPos;
-  serialization::readPod(file, xPos);
-  serialization::readPod(file, yPos);
+PageLine* PageLine::deserialize(ByteReader& file, const SectionDictionary& dictionary, PageArena& arena) {
+  int32_t xPos;
+  int32_t yPos;
+  if (!serialization::readVarInt(file, xPos) || !serialization::readVarInt(file, yPos)) {
+    return nullptr;
+  }
 
-  auto tb = TextBlock::deserialize(file);
-  return std::unique_ptr<PageLine>(new PageLine(std::move(tb), xPos, yPos));
+  auto* tb = TextBlock::deserialize(file, dictionary, arena);
+  if (!tb) {
+    return nullptr;
+  }
+  // The block lives in the arena as well, so the line only holds a non-owning handle to it
+  return arena.create<PageLine>(std::shared_ptr<TextBlock>(std::shared_ptr<TextBlock>(), tb),
+                                static_cast<int16_t>(xPos), static_cast<int16_t>(yPos));
 }
 
 void PageImage::render(GfxRenderer& renderer, const int fontId, const int xOffset, const int yOffset) {
@@ -30,22 +99,26 @@ void PageImage::render(GfxRenderer& renderer, const int fontId, const int xOffse
   imageBlock->render(renderer, xPos + xOffset, yPos + yOffset);
 }
 
-bool PageImage::serialize(FsFile& file) {
-  serialization::writePod(file, xPos);
-  serialization::writePod(file, yPos);
+bool PageImage::serialize(BufferedFsWriter& file, SectionDictionary&) {
+  serialization::writeVarInt(file, xPos);
+  serialization::writeVarInt(file, yPos);
 
   // serialize ImageBlock
   return imageBlock->serialize(file);
 }
 
-std::unique_ptr<PageImage> PageImage::deserialize(FsFile& file) {
-  int16_t xPos;
-  int16_t yPos;
-  serialization::readPod(file, xPos);
-  serialization::readPod(file, yPos);
+PageImage* PageImage::deserialize(ByteReader& file, PageArena& arena) {
+  int32_t xPos;
+  int32_t yPos;
+  if (!serialization::readVarInt(file, xPos) || !serialization::readVarInt(file, yPos)) {
+    return nullptr;
+  }
 
   auto ib = ImageBlock::deserialize(file);
-  return std::unique_ptr<PageImage>(new PageImage(std::move(ib), xPos, yPos));
+  if (!ib) {
+    return nullptr;
+  }
+  return arena.create<PageImage>(std::move(ib), static_cast<int16_t>(xPos), static_cast<int16_t>(yPos));
 }
 
 void Page::render(GfxRenderer& renderer, const int fontId, const int xOffset, const int yOffset) const {
@@ -54,73 +127,92 @@ void Page::render(GfxRenderer& renderer, const int fontId, const int xOffset, co
   }
 }
 
-bool Page::serialize(FsFile& file) const {
-  const uint16_t count = elements.size();
-  serialization::writePod(file, count);
+bool Page::serialize(BufferedFsWriter& file, SectionDictionary& dictionary) const {
+  serialization::writeVarUint(file, elements.size());
 
   for (const auto& el : elements) {
     // Use getTag() method to determine type
     serialization::writePod(file, static_cast<uint8_t>(el->getTag()));
 
-    if (!el->serialize(file)) {
+    if (!el->serialize(file, dictionary)) {
       return false;
     }
   }
 
   // Serialize footnotes (clamp to MAX_FOOTNOTES_PER_PAGE to match addFootnote/deserialize limits)
   const uint16_t fnCount = std::min<uint16_t>(footnotes.size(), MAX_FOOTNOTES_PER_PAGE);
-  serialization::writePod(file, fnCount);
+  serialization::writeVarUint(file, fnCount);
   for (uint16_t i = 0; i < fnCount; i++) {
     const auto& fn = footnotes[i];
-    if (file.write(fn.number, sizeof(fn.number)) != sizeof(fn.number) ||
-        file.write(fn.href, sizeof(fn.href)) != sizeof(fn.href)) {
-      LOG_ERR("PGE", "Failed to write footnote");
-      return false;
-    }
+    const size_t numberLen = strnlen(fn.number, sizeof(fn.number) - 1);
+    const size_t hrefLen = strnlen(fn.href, sizeof(fn.href) - 1);
+    serialization::writeVarUint(file, numberLen);
+    file.write(fn.number, numberLen);
+    serialization::writeVarUint(file, hrefLen);
+    file.write(fn.href, hrefLen);
   }
 
-  return true;
+  return !file.hasError();
 }
 
-std::unique_ptr<Page> Page::deserialize(FsFile& file) {
+std::unique_ptr<Page> Page::deserialize(FsFile& file, const uint32_t size, const SectionDictionary& dictionary) {
   auto page = std::unique_ptr<Page>(new Page());
+  PageArena& arena = page->arena;
 
-  uint16_t count;
-  serialization::readPod(file, count);
+  // The whole page comes in with a single read
+  if (size == 0 || !arena.reserve(size) || file.read(arena.allocate(size, 1), size) != static_cast<int>(size)) {
+    LOG_ERR("PGE", "Failed to read %u byte page", size);
+    return nullptr;
+  }
 
-  for (uint16_t i = 0; i < count; i++) {
+  // Size the arena for everything decoded from the page, then decode into it. Nothing points into the arena
+  // before the second reserve(), so it is free to move.
+  PageShape shape;
+  {
+    ByteReader reader(arena.data(), size);
+    if (!measurePage(reader, dictionary, shape)) {
+      LOG_ERR("PGE", "Deserialization failed: malformed page");
+      return nullptr;
+    }
+  }
+  if (!arena.reserve(size + decodedSize(shape))) {
+    return nullptr;
+  }
+  page->elements.reserve(shape.elements);
+
+  ByteReader reader(arena.data(), size);
+  uint32_t count;
+  serialization::readVarUint(reader, count);
+  for (uint32_t i = 0; i < count; i++) {
     uint8_t tag;
-    serialization::readPod(file, tag);
+    serialization::readPod(reader, tag);
 
+    PageElement* element = nullptr;
     if (tag == TAG_PageLine) {
-      auto pl = PageLine::deserialize(file);
-      page->elements.push_back(std::move(pl));
+      element = PageLine::deserialize(reader, dictionary, arena);
     } else if (tag == TAG_PageImage) {
-      auto pi = PageImage::deserialize(file);
-      page->elements.push_back(std::move(pi));
-    } else {
-      LOG_ERR("PGE", "Deserialization failed: Unknown tag %u", tag);
+      element = PageImage::deserialize(reader, arena);
+    }
+    if (!element) {
+      LOG_ERR("PGE", "Deserialization failed: bad element %u", i);
       return nullptr;
     }
+    page->elements.emplace_back(std::shared_ptr<PageElement>(), element);
   }
 
   // Deserialize footnotes
-  uint16_t fnCount;
-  serialization::readPod(file, fnCount);
-  if (fnCount > MAX_FOOTNOTES_PER_PAGE) {
-    LOG_ERR("PGE", "Invalid footnote count %u", fnCount);
-    return nullptr;
-  }
+  uint32_t fnCount;
+  serialization::readVarUint(reader, fnCount);
   page->footnotes.resize(fnCount);
-  for (uint16_t i = 0; i < fnCount; i++) {
+  for (uint32_t i = 0; i < fnCount; i++) {
     auto& entry = page->footnotes[i];
-    if (file.read(entry.number, sizeof(entry.number)) != sizeof(entry.number) ||
-        file.read(entry.href, sizeof(entry.href)) != sizeof(entry.href)) {
-      LOG_ERR("PGE", "Failed to read footnote %u", i);
-      return nullptr;
-    }
-    entry.number[sizeof(entry.number) - 1] = '\0';
-    entry.href[sizeof(entry.href) - 1] = '\0';
+    uint32_t numberLen, hrefLen;
+    serialization::readVarUint(reader, numberLen);
+    memcpy(entry.number, reader.take(numberLen), numberLen);
+    entry.number[numberLen] = '\0';
+    serialization::readVarUint(reader, hrefLen);
+    memcpy(entry.href, reader.take(hrefLen), hrefLen);
+    entry.href[hrefLen] = '\0';
   }
 
   return page;
@@ -1,14 +1,17 @@
 #pragma once
-#include <HalStorage.h>
+#include <BufferedFs.h>
 
 #include <algorithm>
 #include <utility>
 #include <vector>
 
 #include "FootnoteEntry.h"
+#include "PageArena.h"
 #include "blocks/ImageBlock.h"
 #include "blocks/TextBlock.h"
 
+class SectionDictionary;
+
 enum PageElementTag : uint8_t {
   TAG_PageLine = 1,
   TAG_PageImage = 2,  // New tag
@@ -22,7 +25,7 @@ class PageElement {
   explicit PageElement(const int16_t xPos, const int16_t yPos) : xPos(xPos), yPos(yPos) {}
   virtual ~PageElement() = default;
   virtual void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) = 0;
-  virtual bool serialize(FsFile& file) = 0;
+  virtual bool serialize(BufferedFsWriter& file, SectionDictionary& dictionary) = 0;
   virtual PageElementTag getTag() const = 0;  // Add type identification
 };
 
@@ -35,9 +38,9 @@ class PageLine final : public PageElement {
       : PageElement(xPos, yPos), block(std::move(block)) {}
   const std::shared_ptr<TextBlock>& getBlock() const { return block; }
   void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) override;
-  bool serialize(FsFile& file) override;
+  bool serialize(BufferedFsWriter& file, SectionDictionary& dictionary) override;
   PageElementTag getTag() const override { return TAG_PageLine; }
-  static std::unique_ptr<PageLine> deserialize(FsFile& file);
+  static PageLine* deserialize(ByteReader& file, const SectionDictionary& dictionary, PageArena& arena);
 };
 
 // New PageImage class
@@ -48,15 +51,19 @@ class PageImage final : public PageElement {
   PageImage(std::shared_ptr<ImageBlock> block, const int16_t xPos, const int16_t yPos)
       : PageElement(xPos, yPos), imageBlock(std::move(block)) {}
   void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) override;
-  bool serialize(FsFile& file) override;
+  bool serialize(BufferedFsWriter& file, SectionDictionary& dictionary) override;
   PageElementTag getTag() const override { return TAG_PageImage; }
-  static std::unique_ptr<PageImage> deserialize(FsFile& file);
+  static PageImage* deserialize(ByteReader& file, PageArena& arena);
   const ImageBlock& getImageBlock() const { return *imageBlock; }
 };
 
 class Page {
+  // Backing store of a page loaded from a section file, released with the page. Unused while building pages.
+  PageArena arena;
+
  public:
-  // the list of block index and line numbers on this page
+  // the list of block index and line numbers on this page. For a loaded page these are non-owning handles into the
+  // arena: they must not outlive the page.
   std::vector<std::shared_ptr<PageElement>> elements;
   std::vector<FootnoteEntry> footnotes;
   static constexpr uint16_t MAX_FOOTNOTES_PER_PAGE = 16;
@@ -72,8 +79,9 @@ class Page {
   }
 
   void render(GfxRenderer& renderer, int fontId, int xOffset, int yOffset) const;
-  bool serialize(FsFile& file) const;
-  static std::unique_ptr<Page> deserialize(FsFile& file);
+  bool serialize(BufferedFsWriter& file, SectionDictionary& dictionary) const;
+  // Load a page of size bytes at the current position of file, with a single read into the page arena
+  static std::unique_ptr<Page> deserialize(FsFile& file, uint32_t size, const SectionDictionary& dictionary);
 
   // Check if page contains any images (used to force full refresh)
   bool hasImages() const {
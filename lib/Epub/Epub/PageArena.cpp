@@ -0,0 +1,50 @@
+#include "PageArena.h"
+
+#include <Logging.h>
+
+#include <cstdlib>
+
+bool PageArena::reserve(const size_t capacity) {
+  if (capacity == size) {
+    return true;
+  }
+  if (capacity < head) {
+    LOG_ERR("PAR", "Cannot shrink arena below %u used bytes", static_cast<uint32_t>(head));
+    return false;
+  }
+
+  auto* grown = static_cast<uint8_t*>(realloc(buffer, capacity > 0 ? capacity : 1));
+  if (!grown) {
+    LOG_ERR("PAR", "Not enough memory for page arena (%u bytes)", static_cast<uint32_t>(capacity));
+    return false;
+  }
+  buffer = grown;
+  size = capacity;
+  return true;
+}
+
+void PageArena::reset() {
+  while (finalizers) {
+    Finalizer* finalizer = finalizers;
+    finalizers = finalizer->next;
+    finalizer->destroy(finalizer->object);
+  }
+  head = 0;
+}
+
+void PageArena::release() {
+  reset();
+  free(buffer);
+  buffer = nullptr;
+  size = 0;
+}
+
+void* PageArena::allocate(const size_t bytes, const size_t align) {
+  const size_t start = (reinterpret_cast<uintptr_t>(buffer) + head + align - 1) / align * align -
+                       reinterpret_cast<uintptr_t>(buffer);
+  if (!buffer || start + bytes > size) {
+    return nullptr;
+  }
+  head = start + bytes;
+  return buffer + start;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Single-allocation backing store for a page loaded from a section file. The raw page bytes and every object
+// decoded from them (lines, text blocks, word slices) are bump-allocated from one buffer, so loading a page costs
+// one heap block instead of a few per word, and dropping the page frees everything in one shot.
+//
+// Objects made with create() have their destructors run, in reverse order, by reset() and the destructor.
+class PageArena {
+ public:
+  PageArena() = default;
+  ~PageArena() { release(); }
+
+  PageArena(const PageArena&) = delete;
+  PageArena& operator=(const PageArena&) = delete;
+
+  // Resize the buffer to capacity bytes, keeping what has been allocated so far. The buffer may move, so this is
+  // only safe before any pointer into it has been handed out (other than through data()).
+  bool reserve(size_t capacity);
+  // Run the finalizers and rewind, keeping the buffer for the next page
+  void reset();
+  // reset() and free the buffer
+  void release();
+
+  void* allocate(size_t size, size_t align);
+
+  template <typename T>
+  T* allocateArray(const size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>, "Array elements are never destroyed");
+    auto* items = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    for (size_t i = 0; items && i < count; i++) {
+      new (items + i) T();
+    }
+    return items;
+  }
+
+  template <typename T, typename... Args>
+  T* create(Args&&... args) {
+    void* mem = allocate(sizeof(T), alignof(T));
+    if (!mem) {
+      return nullptr;
+    }
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      auto* finalizer = static_cast<Finalizer*>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+      if (!finalizer) {
+        return nullptr;
+      }
+      *finalizer = {[](void* p) { static_cast<T*>(p)->~T(); }, mem, finalizers};
+      finalizers = finalizer;
+    }
+    return new (mem) T(std::forward<Args>(args)...);
+  }
+
+  // Worst-case bytes taken by create<T>() / allocateArray<T>(count), alignment padding included
+  template <typename T>
+  static constexpr size_t objectFootprint() {
+    return sizeof(T) + alignof(T) - 1 +
+           (std::is_trivially_destructible_v<T> ? 0 : sizeof(Finalizer) + alignof(Finalizer) - 1);
+  }
+  template <typename T>
+  static constexpr size_t arrayFootprint(const size_t count) {
+    return count * sizeof(T) + alignof(T) - 1;
+  }
+
+  uint8_t* data() const { return buffer; }
+  size_t capacity() const { return size; }
+  size_t used() const { return head; }
+
+ private:
+  struct Finalizer {
+    void (*destroy)(void*);
+    void* object;
+    Finalizer* next;
+  };
+
+  uint8_t* buffer = nullptr;
+  size_t size = 0;
+  size_t head = 0;
+  Finalizer* finalizers = nullptr;  // Most recently created first
+};
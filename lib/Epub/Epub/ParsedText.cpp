@@ -1,27 +1,61 @@
 #include "ParsedText.h"
 
 #include <GfxRenderer.h>
+#include <Logging.h>
+#include <PerfTrace.h>
 #include <Utf8.h>
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <functional>
 #include <limits>
+#include <new>
+#include <string>
 #include <vector>
 
+#include "WordWidthCache.h"
 #include "hyphenation/Hyphenator.h"
 
-constexpr int MAX_COST = std::numeric_limits<int>::max();
+ParsedText::LineStats ParsedText::lineTotals;
 
 namespace {
 
+// A hyphenation point where a line may end: the word up to byteOffset, plus a hyphen if needed, ends the line and the
+// remainder starts the next.
+struct WordBreak {
+  uint32_t byteOffset : 31;
+  uint32_t needsHyphen : 1;
+  uint16_t prefixWidth;  // Including the inserted hyphen
+  uint16_t remainderWidth;
+};
+
+constexpr int32_t NO_WORD_BREAK = -1;
+
+// A place where a line may start: the start of a word, or the remainder of a word after one of its WordBreaks
+struct BreakNode {
+  uint32_t word;
+  int32_t wordBreak;  // Index into the paragraph's WordBreaks, or NO_WORD_BREAK
+  int32_t lineStart;  // Where the line that starts here begins, with the whole paragraph on one line
+  uint32_t lineFrom;  // Start of the line that ends here in the cheapest layout up to here
+  int32_t cost;       // Cost of that layout, saturating at MAX_COST
+};
+
+constexpr int32_t MAX_COST = std::numeric_limits<int32_t>::max();
+// Cost of an overflowing line, or one that splits a continuation group, taken only when nothing else fits
+constexpr int64_t FORCED_LINE_COST = int64_t{1} << 28;
+// A line ending on a hyphen costs as much as a line left short by this many spaces, CONSECUTIVE_HYPHEN_FACTOR times as
+// much when the line before it ended on a hyphen too
+constexpr int HYPHEN_COST_SPACES = 3;
+constexpr int CONSECUTIVE_HYPHEN_FACTOR = 3;
+
 // Soft hyphen byte pattern used throughout EPUBs (UTF-8 for U+00AD).
 constexpr char SOFT_HYPHEN_UTF8[] = "\xC2\xAD";
 constexpr size_t SOFT_HYPHEN_BYTES = 2;
 
-// Returns the first rendered codepoint of a word (skipping leading soft hyphens).
-uint32_t firstCodepoint(const std::string& word) {
-  const auto* ptr = reinterpret_cast<const unsigned char*>(word.c_str());
+// Returns the first rendered codepoint of a NUL-terminated word (skipping leading soft hyphens).
+uint32_t firstCodepoint(const std::string_view word) {
+  const auto* ptr = reinterpret_cast<const unsigned char*>(word.data());
   while (true) {
     const uint32_t cp = utf8NextCodepoint(&ptr);
     if (cp == 0) return 0;
@@ -30,43 +64,48 @@ uint32_t firstCodepoint(const std::string& word) {
 }
 
 // Returns the last codepoint of a word by scanning backward for the start of the last UTF-8 sequence.
-uint32_t lastCodepoint(const std::string& word) {
+uint32_t lastCodepoint(const std::string_view word) {
   if (word.empty()) return 0;
   // UTF-8 continuation bytes start with 10xxxxxx; scan backward to find the leading byte.
   size_t i = word.size() - 1;
   while (i > 0 && (static_cast<uint8_t>(word[i]) & 0xC0) == 0x80) {
     --i;
   }
-  const auto* ptr = reinterpret_cast<const unsigned char*>(word.c_str() + i);
+  const auto* ptr = reinterpret_cast<const unsigned char*>(word.data() + i);
   return utf8NextCodepoint(&ptr);
 }
 
-bool containsSoftHyphen(const std::string& word) { return word.find(SOFT_HYPHEN_UTF8) != std::string::npos; }
+bool containsSoftHyphen(const std::string_view word) { return word.find(SOFT_HYPHEN_UTF8) != std::string_view::npos; }
 
-// Removes every soft hyphen in-place so rendered glyphs match measured widths.
-void stripSoftHyphensInPlace(std::string& word) {
-  size_t pos = 0;
-  while ((pos = word.find(SOFT_HYPHEN_UTF8, pos)) != std::string::npos) {
-    word.erase(pos, SOFT_HYPHEN_BYTES);
+// Removes every soft hyphen in-place so rendered glyphs match measured widths. Returns the new length.
+size_t stripSoftHyphens(char* word, const size_t length) {
+  size_t kept = 0;
+  for (size_t i = 0; i < length; i++) {
+    if (i + SOFT_HYPHEN_BYTES <= length && memcmp(word + i, SOFT_HYPHEN_UTF8, SOFT_HYPHEN_BYTES) == 0) {
+      i += SOFT_HYPHEN_BYTES - 1;
+      continue;
+    }
+    word[kept++] = word[i];
   }
+  return kept;
 }
 
-// Returns the advance width for a word while ignoring soft hyphen glyphs and optionally appending a visible hyphen.
-// Uses advance width (sum of glyph advances + kerning) rather than bounding box width so that italic glyph overhangs
-// don't inflate inter-word spacing.
-uint16_t measureWordWidth(const GfxRenderer& renderer, const int fontId, const std::string& word,
+// Returns the advance width for a NUL-terminated word while ignoring soft hyphen glyphs and optionally appending a
+// visible hyphen. Uses advance width (sum of glyph advances + kerning) rather than bounding box width so that italic
+// glyph overhangs don't inflate inter-word spacing.
+uint16_t measureWordWidth(const GfxRenderer& renderer, const int fontId, const std::string_view word,
                           const EpdFontFamily::Style style, const bool appendHyphen = false) {
   if (word.size() == 1 && word[0] == ' ' && !appendHyphen) {
     return renderer.getSpaceWidth(fontId, style);
   }
   const bool hasSoftHyphen = containsSoftHyphen(word);
   if (!hasSoftHyphen && !appendHyphen) {
-    return renderer.getTextAdvanceX(fontId, word.c_str(), style);
+    return renderer.getTextAdvanceX(fontId, word.data(), style);
   }
 
-  std::string sanitized = word;
+  std::string sanitized(word);
   if (hasSoftHyphen) {
-    stripSoftHyphensInPlace(sanitized);
+    sanitized.resize(stripSoftHyphens(sanitized.data(), sanitized.size()));
   }
   if (appendHyphen) {
     sanitized.push_back('-');
@@ -74,26 +113,137 @@ uint16_t measureWordWidth(const GfxRenderer& renderer, const int fontId, const s
   return renderer.getTextAdvanceX(fontId, sanitized.c_str(), style);
 }
 
+uint16_t measureWordWidth(const GfxRenderer& renderer, const int fontId, const std::string_view word,
+                          const EpdFontFamily::Style style, WordWidthCache* cache) {
+  const auto measure = [&] { return measureWordWidth(renderer, fontId, word, style); };
+  return cache ? cache->getOrMeasure(fontId, style, word.data(), word.size(), measure) : measure();
+}
+
+// Returns the width of the word's first byteOffset bytes, plus a visible hyphen if requested, as they end a line. Short
+// prefixes go through the cache with their hyphen, since the same few syllables start many words.
+uint16_t measurePrefixWidth(const GfxRenderer& renderer, const int fontId, const std::string_view word,
+                            const size_t byteOffset, const EpdFontFamily::Style style, const bool appendHyphen,
+                            WordWidthCache* cache) {
+  const size_t length = byteOffset + (appendHyphen ? 1 : 0);
+  if (!cache || length > WordWidthCache::MAX_WORD_BYTES) {
+    return measureWordWidth(renderer, fontId, std::string(word.substr(0, byteOffset)), style, appendHyphen);
+  }
+  char prefix[WordWidthCache::MAX_WORD_BYTES + 1];
+  memcpy(prefix, word.data(), byteOffset);
+  if (appendHyphen) {
+    prefix[byteOffset] = '-';
+  }
+  prefix[length] = '\0';
+  return measureWordWidth(renderer, fontId, std::string_view(prefix, length), style, cache);
+}
+
+// Calls visit(byteOffset, needsHyphen) for each hyphenation point inside the word, in ascending order, until it returns
+// false. The points of short words are looked up once per section and kept in the cache.
+template <typename Visit>
+void forEachWordBreak(const std::string_view word, const int fontId, const EpdFontFamily::Style style,
+                      WordWidthCache* cache, Visit&& visit) {
+  if (!cache || word.size() > WordWidthCache::MAX_WORD_BYTES) {
+    for (const auto& info : Hyphenator::breakOffsets(word, /*includeFallback=*/false)) {
+      if (info.byteOffset > 0 && info.byteOffset < word.size() &&
+          !visit(info.byteOffset, info.requiresInsertedHyphen)) {
+        return;
+      }
+    }
+    return;
+  }
+
+  const auto breaks = cache->getOrFindBreaks(fontId, style, word.data(), word.size(), [&] {
+    WordWidthCache::Breaks found;
+    for (const auto& info : Hyphenator::breakOffsets(word, /*includeFallback=*/false)) {
+      if (info.byteOffset > 0 && info.byteOffset < word.size()) {
+        found.offsets |= 1u << info.byteOffset;
+        found.hyphens |= info.requiresInsertedHyphen ? 1u << info.byteOffset : 0u;
+      }
+    }
+    return found;
+  });
+  for (size_t offset = 1; offset < word.size(); ++offset) {
+    if ((breaks.offsets >> offset & 1) && !visit(offset, (breaks.hyphens >> offset & 1) != 0)) {
+      return;
+    }
+  }
+}
+
 }  // namespace
 
-void ParsedText::addWord(std::string word, const EpdFontFamily::Style fontStyle, const bool underline,
+void ParsedText::addWord(const std::string_view word, const EpdFontFamily::Style fontStyle, const bool underline,
                          const bool attachToPrevious) {
   if (word.empty()) return;
 
-  words.push_back(std::move(word));
   EpdFontFamily::Style combinedStyle = fontStyle;
   if (underline) {
     combinedStyle = static_cast<EpdFontFamily::Style>(combinedStyle | EpdFontFamily::UNDERLINE);
   }
-  wordStyles.push_back(combinedStyle);
-  wordContinues.push_back(attachToPrevious);
+  Word entry{0, 0, 0, combinedStyle, attachToPrevious};
+  if (!store(entry, word)) {
+    return;
+  }
+  // Drop the records of laid out words only when the vector would have to grow anyway
+  if (head > 0 && words.size() == words.capacity()) {
+    words.erase(words.begin(), words.begin() + head);
+    head = 0;
+  }
+  words.push_back(entry);
+}
+
+// Copies first and second, NUL-terminated, to the end of the last chunk, or to a new one if they don't fit, and points
+// word at them
+bool ParsedText::store(Word& word, const std::string_view first, const std::string_view second) {
+  const size_t length = first.size() + second.size();
+  if (length >= UINT16_MAX) {
+    LOG_ERR("PTX", "Dropping word of %u bytes", static_cast<unsigned>(length));
+    return false;
+  }
+  if (chunks.empty() || chunkUsed + length + 1 > chunkCapacity) {
+    const size_t capacity = std::max(CHUNK_BYTES, length + 1);
+    TextBlock::WordChunk chunk(new (std::nothrow) char[capacity]);
+    if (!chunk) {
+      LOG_ERR("PTX", "Not enough memory for %u bytes of words", static_cast<unsigned>(capacity));
+      return false;
+    }
+    chunks.push_back(std::move(chunk));
+    chunkUsed = 0;
+    chunkCapacity = static_cast<uint16_t>(capacity);
+  }
+
+  char* dest = chunks.back().get() + chunkUsed;
+  if (!first.empty()) memcpy(dest, first.data(), first.size());
+  if (!second.empty()) memcpy(dest + first.size(), second.data(), second.size());
+  dest[length] = '\0';
+  word.chunk = static_cast<uint16_t>(chunkBase + chunks.size() - 1);
+  word.offset = chunkUsed;
+  word.length = static_cast<uint16_t>(length);
+  chunkUsed += length + 1;
+  return true;
+}
+
+// Lets go of the chunks that only laid out words use. The last chunk is kept for the words still to come.
+void ParsedText::releaseLaidOutWords() {
+  if (head == words.size()) {
+    words.clear();
+    head = 0;
+  }
+  if (chunks.empty()) {
+    return;
+  }
+  size_t firstUsed = chunks.size() - 1;
+  for (size_t i = head; i < words.size(); i++) {
+    firstUsed = std::min<size_t>(firstUsed, static_cast<uint16_t>(words[i].chunk - chunkBase));
+  }
+  chunks.erase(chunks.begin(), chunks.begin() + firstUsed);
+  chunkBase += firstUsed;
 }
 
 // Consumes data to minimize memory usage
 void ParsedText::layoutAndExtractLines(const GfxRenderer& renderer, const int fontId, const uint16_t viewportWidth,
                                        const std::function<void(std::shared_ptr<TextBlock>)>& processLine,
                                        const bool includeLastLine) {
-  if (words.empty()) {
+  if (isEmpty()) {
     return;
   }
 
@@ -104,43 +254,41 @@ void ParsedText::layoutAndExtractLines(const GfxRenderer& renderer, const int fo
   const int spaceWidth = renderer.getSpaceWidth(fontId, EpdFontFamily::REGULAR);
   auto wordWidths = calculateWordWidths(renderer, fontId);
 
-  std::vector<size_t> lineBreakIndices;
-  if (hyphenationEnabled) {
-    // Use greedy layout that can split words mid-loop when a hyphenated prefix fits.
-    lineBreakIndices = computeHyphenatedLineBreaks(renderer, fontId, pageWidth, spaceWidth, wordWidths, wordContinues);
-  } else {
-    lineBreakIndices = computeLineBreaks(renderer, fontId, pageWidth, spaceWidth, wordWidths, wordContinues);
-  }
+  const uint32_t breakStart = perf::nowUs();
+  const std::vector<size_t> lineBreakIndices = computeLineBreaks(renderer, fontId, pageWidth, spaceWidth, wordWidths);
+  lineTotals.breakUs += perf::nowUs() - breakStart;
   const size_t lineCount = includeLastLine ? lineBreakIndices.size() : lineBreakIndices.size() - 1;
 
+  LineBuffers line;
   for (size_t i = 0; i < lineCount; ++i) {
-    extractLine(i, pageWidth, spaceWidth, wordWidths, wordContinues, lineBreakIndices, processLine, renderer, fontId);
+    extractLine(i, pageWidth, spaceWidth, wordWidths, lineBreakIndices, processLine, renderer, fontId, line);
   }
 
-  // Remove consumed words so size() reflects only remaining words
+  // Move past the consumed words so size() reflects only remaining words
   if (lineCount > 0) {
-    const size_t consumed = lineBreakIndices[lineCount - 1];
-    words.erase(words.begin(), words.begin() + consumed);
-    wordStyles.erase(wordStyles.begin(), wordStyles.begin() + consumed);
-    wordContinues.erase(wordContinues.begin(), wordContinues.begin() + consumed);
+    head += lineBreakIndices[lineCount - 1];
+    releaseLaidOutWords();
   }
 }
 
 std::vector<uint16_t> ParsedText::calculateWordWidths(const GfxRenderer& renderer, const int fontId) {
   std::vector<uint16_t> wordWidths;
-  wordWidths.reserve(words.size());
+  wordWidths.reserve(wordCount());
 
-  for (size_t i = 0; i < words.size(); ++i) {
-    wordWidths.push_back(measureWordWidth(renderer, fontId, words[i], wordStyles[i]));
+  for (size_t i = 0; i < wordCount(); ++i) {
+    wordWidths.push_back(measureWordWidth(renderer, fontId, text(word(i)), word(i).style, widthCache));
   }
 
   return wordWidths;
 }
 
+// Optimal-fit line breaking. Lines may end between words and, with hyphenation on, at the hyphenation points of any
+// word that does not fit whole at the end of some line. A line costs its squared spare width (nothing for the last
+// line), plus a penalty when it ends on a hyphen. Line widths are differences of running sums, and each line end only
+// looks back over the starts whose lines still fit, so the work grows with the words times the words per line.
 std::vector<size_t> ParsedText::computeLineBreaks(const GfxRenderer& renderer, const int fontId, const int pageWidth,
-                                                  const int spaceWidth, std::vector<uint16_t>& wordWidths,
-                                                  std::vector<bool>& continuesVec) {
-  if (words.empty()) {
+                                                  const int spaceWidth, std::vector<uint16_t>& wordWidths) {
+  if (isEmpty()) {
     return {};
   }
 
@@ -162,102 +310,152 @@ std::vector<size_t> ParsedText::computeLineBreaks(const GfxRenderer& renderer, c
     }
   }
 
-  const size_t totalWordCount = words.size();
-
-  // DP table to store the minimum badness (cost) of lines starting at index i
-  std::vector<int> dp(totalWordCount);
-  // 'ans[i]' stores the index 'j' of the *last word* in the optimal line starting at 'i'
-  std::vector<size_t> ans(totalWordCount);
-
-  // Base Case
-  dp[totalWordCount - 1] = 0;
-  ans[totalWordCount - 1] = totalWordCount - 1;
+  const size_t totalWordCount = wordCount();
 
-  for (int i = totalWordCount - 2; i >= 0; --i) {
-    int currlen = 0;
-    dp[i] = MAX_COST;
-
-    // First line has reduced width due to text-indent
-    const int effectivePageWidth = i == 0 ? pageWidth - firstLineIndent : pageWidth;
-
-    for (size_t j = i; j < totalWordCount; ++j) {
-      // Add space before word j, unless it's the first word on the line or a continuation
-      int gap = 0;
-      if (j > static_cast<size_t>(i) && !continuesVec[j]) {
-        gap = spaceWidth;
-        gap += renderer.getSpaceKernAdjust(fontId, lastCodepoint(words[j - 1]), firstCodepoint(words[j]),
-                                           wordStyles[j - 1]);
-      } else if (j > static_cast<size_t>(i) && continuesVec[j]) {
-        // Cross-boundary kerning for continuation words (e.g. nonbreaking spaces, attached punctuation)
-        gap = renderer.getKerning(fontId, lastCodepoint(words[j - 1]), firstCodepoint(words[j]), wordStyles[j - 1]);
-      }
-      currlen += wordWidths[j] + gap;
-
-      if (currlen > effectivePageWidth) {
+  // Space between word i - 1 and word i when they share a line
+  const auto gapBefore = [&](const size_t i) {
+    if (!word(i).continues) {
+      return spaceWidth + renderer.getSpaceKernAdjust(fontId, lastCodepoint(text(word(i - 1))),
+                                                      firstCodepoint(text(word(i))), word(i - 1).style);
+    }
+    // Cross-boundary kerning for continuation words (e.g. nonbreaking spaces, attached punctuation)
+    return renderer.getKerning(fontId, lastCodepoint(text(word(i - 1))), firstCodepoint(text(word(i))),
+                               word(i - 1).style);
+  };
+
+  // Node 0 starts the paragraph; every other node is both the end of a line and the start of the next
+  std::vector<BreakNode> nodes;
+  std::vector<WordBreak> wordBreaks;
+  // Hyphenation points add about one node for every five words, so this rarely has to grow
+  nodes.reserve(hyphenationEnabled ? totalWordCount + totalWordCount / 2 + 1 : totalWordCount + 1);
+  // Positions are measured along the whole paragraph laid out on one line, so a line from node n to position x is
+  // x - nodes[n].lineStart wide
+  nodes.push_back({0, NO_WORD_BREAK, 0, 0, 0});
+
+  // First line has reduced width due to text-indent
+  const auto availableWidth = [&](const size_t startNode) {
+    return startNode == 0 ? pageWidth - firstLineIndent : pageWidth;
+  };
+  const int hyphenSpace = HYPHEN_COST_SPACES * spaceWidth;
+  const int64_t hyphenCost = static_cast<int64_t>(hyphenSpace) * hyphenSpace;
+
+  // Picks the cheapest start among nodes[0..lastStart] for a line ending at lineEnd
+  const auto chooseLineStart = [&](BreakNode& node, const size_t lastStart, const int32_t lineEnd,
+                                   const bool lastLine) {
+    const int64_t hyphenPenalty = node.wordBreak == NO_WORD_BREAK ? 0 : hyphenCost;
+    int64_t best = std::numeric_limits<int64_t>::max();
+    uint32_t lineFrom = 0;
+    for (size_t i = lastStart + 1; i-- > 0;) {
+      const BreakNode& start = nodes[i];
+      const int spare = availableWidth(i) - (lineEnd - start.lineStart);
+      if (spare < 0) {
+        // Starts further back only make the line wider. If even the nearest one overflows, overflow from it.
+        if (best == std::numeric_limits<int64_t>::max()) {
+          best = start.cost + FORCED_LINE_COST;
+          lineFrom = static_cast<uint32_t>(i);
+        }
         break;
       }
-
-      // Cannot break after word j if the next word attaches to it (continuation group)
-      if (j + 1 < totalWordCount && continuesVec[j + 1]) {
-        continue;
+      const int64_t cost = start.cost + (lastLine ? 0 : static_cast<int64_t>(spare) * spare) +
+                           (start.wordBreak == NO_WORD_BREAK ? 1 : CONSECUTIVE_HYPHEN_FACTOR) * hyphenPenalty;
+      if (cost < best) {
+        best = cost;
+        lineFrom = static_cast<uint32_t>(i);
       }
-
-      int cost;
-      if (j == totalWordCount - 1) {
-        cost = 0;  // Last line
-      } else {
-        const int remainingSpace = effectivePageWidth - currlen;
-        // Use long long for the square to prevent overflow
-        const long long cost_ll = static_cast<long long>(remainingSpace) * remainingSpace + dp[j + 1];
-
-        if (cost_ll > MAX_COST) {
-          cost = MAX_COST;
-        } else {
-          cost = static_cast<int>(cost_ll);
-        }
+    }
+    node.lineFrom = lineFrom;
+    node.cost = static_cast<int32_t>(std::min<int64_t>(best, MAX_COST));
+  };
+
+  size_t fitStart = 0;  // First start the current word fits on a line from, whole
+
+  for (size_t i = 0; i < totalWordCount; ++i) {
+    const size_t wordNode = nodes.size() - 1;  // The line start just before word i
+    const int32_t wordStart = nodes[wordNode].lineStart;
+    const int32_t wordEnd = wordStart + wordWidths[i];
+
+    // Only a line that cannot take the whole word would end inside it. The latest such start leaves the most room,
+    // and prefixes that don't fit from there don't fit from anywhere. Lines with no more room than the hyphen
+    // penalty are cheaper left short, so their words are not looked up at all, and with them every word no wider
+    // than the penalty.
+    if (hyphenationEnabled && wordNode > 0 && wordWidths[i] > hyphenSpace) {
+      while (fitStart < wordNode && wordEnd - nodes[fitStart].lineStart > availableWidth(fitStart)) {
+        fitStart++;
       }
-
-      if (cost < dp[i]) {
-        dp[i] = cost;
-        ans[i] = j;  // j is the index of the last word in this optimal line
+      const int room = fitStart > 0 ? availableWidth(fitStart - 1) - (wordStart - nodes[fitStart - 1].lineStart) : 0;
+      const std::string_view wordText = text(word(i));
+      const auto style = word(i).style;
+      // Finding a word's breaks costs far more than measuring a few of its letters, and most words looked up have
+      // none that fit
+      const Hyphenator::BreakInfo shortest = room > hyphenSpace ? Hyphenator::shortestBreak(wordText)
+                                                                : Hyphenator::BreakInfo{0, false};
+      if (shortest.byteOffset > 0 && measurePrefixWidth(renderer, fontId, wordText, shortest.byteOffset, style,
+                                                        shortest.requiresInsertedHyphen, widthCache) <= room) {
+        forEachWordBreak(wordText, fontId, style, widthCache, [&](const size_t byteOffset, const bool needsHyphen) {
+          const uint16_t prefixWidth =
+              measurePrefixWidth(renderer, fontId, wordText, byteOffset, style, needsHyphen, widthCache);
+          if (prefixWidth > room) {
+            return false;  // Offsets ascend, so the longer prefixes don't fit either
+          }
+          const uint16_t remainderWidth =
+              measureWordWidth(renderer, fontId, wordText.substr(byteOffset), style, widthCache);
+          wordBreaks.push_back({static_cast<uint32_t>(byteOffset), needsHyphen, prefixWidth, remainderWidth});
+          BreakNode node{static_cast<uint32_t>(i), static_cast<int32_t>(wordBreaks.size() - 1),
+                         wordEnd - remainderWidth, 0, 0};
+          chooseLineStart(node, wordNode - 1, wordStart + prefixWidth, false);
+          nodes.push_back(node);
+          return true;
+        });
       }
     }
 
-    // Handle oversized word: if no valid configuration found, force single-word line
-    // This prevents cascade failure where one oversized word breaks all preceding words
-    if (dp[i] == MAX_COST) {
-      ans[i] = i;  // Just this word on its own line
-      // Inherit cost from next word to allow subsequent words to find valid configurations
-      if (i + 1 < static_cast<int>(totalWordCount)) {
-        dp[i] = dp[i + 1];
-      } else {
-        dp[i] = 0;
-      }
+    const bool lastWord = i + 1 == totalWordCount;
+    BreakNode node{static_cast<uint32_t>(i + 1), NO_WORD_BREAK, lastWord ? wordEnd : wordEnd + gapBefore(i + 1), 0, 0};
+    chooseLineStart(node, nodes.size() - 1, wordEnd, lastWord);
+    // Cannot break after word i if the next word attaches to it (continuation group), unless nothing else fits
+    if (!lastWord && word(i + 1).continues) {
+      node.cost = static_cast<int32_t>(std::min<int64_t>(node.cost + FORCED_LINE_COST, MAX_COST));
     }
+    nodes.push_back(node);
   }
 
-  // Stores the index of the word that starts the next line (last_word_index + 1)
-  std::vector<size_t> lineBreakIndices;
-  size_t currentWordIndex = 0;
-
-  while (currentWordIndex < totalWordCount) {
-    size_t nextBreakIndex = ans[currentWordIndex] + 1;
+  // Turn the chain of chosen lines around so that it runs forward from the start of the paragraph
+  size_t lineCount = 0;
+  uint32_t firstEnd = 0;
+  for (uint32_t n = static_cast<uint32_t>(nodes.size() - 1); n != 0; lineCount++) {
+    const uint32_t lineFrom = nodes[n].lineFrom;
+    nodes[n].lineFrom = firstEnd;  // Now the end of the next line
+    firstEnd = n;
+    n = lineFrom;
+  }
 
-    // Safety check: prevent infinite loop if nextBreakIndex doesn't advance
-    if (nextBreakIndex <= currentWordIndex) {
-      // Force advance by at least one word to avoid infinite loop
-      nextBreakIndex = currentWordIndex + 1;
+  // Stores the index of the word that starts the next line (last_word_index + 1), splitting the words that the
+  // chosen lines end inside. Each split inserts the remainder after the prefix, moving the later words along by one.
+  std::vector<size_t> lineBreakIndices;
+  lineBreakIndices.reserve(lineCount);
+  size_t splitsBefore = 0;
+  for (uint32_t n = firstEnd; n != 0; n = nodes[n].lineFrom) {
+    const BreakNode& node = nodes[n];
+    const size_t wordIndex = node.word + splitsBefore;
+    if (node.wordBreak == NO_WORD_BREAK) {
+      lineBreakIndices.push_back(wordIndex);
+      continue;
     }
-
-    lineBreakIndices.push_back(nextBreakIndex);
-    currentWordIndex = nextBreakIndex;
+    // The line ends with the prefix and the remainder starts the next. With no memory for the prefix, the line ends
+    // after the whole word instead.
+    const WordBreak& wordBreak = wordBreaks[node.wordBreak];
+    if (splitWord(wordIndex, wordBreak.byteOffset, wordBreak.needsHyphen, wordBreak.prefixWidth,
+                  wordBreak.remainderWidth, wordWidths)) {
+      splitsBefore++;
+    }
+    lineBreakIndices.push_back(wordIndex + 1);
   }
 
   return lineBreakIndices;
 }
 
 void ParsedText::applyParagraphIndent() {
-  if (extraParagraphSpacing || words.empty()) {
+  if (extraParagraphSpacing || isEmpty()) {
     return;
   }
 
@@ -266,100 +464,23 @@ void ParsedText::applyParagraphIndent() {
     // The actual indent positioning is handled in extractLine()
   } else if (blockStyle.alignment == CssTextAlign::Justify || blockStyle.alignment == CssTextAlign::Left) {
     // No CSS text-indent defined - use EmSpace fallback for visual indent
-    words.front().insert(0, "\xe2\x80\x83");
+    Word& first = word(0);
+    store(first, "\xe2\x80\x83", text(first));
   }
 }
 
-// Builds break indices while opportunistically splitting the word that would overflow the current line.
-std::vector<size_t> ParsedText::computeHyphenatedLineBreaks(const GfxRenderer& renderer, const int fontId,
-                                                            const int pageWidth, const int spaceWidth,
-                                                            std::vector<uint16_t>& wordWidths,
-                                                            std::vector<bool>& continuesVec) {
-  // Calculate first line indent (only for left/justified text without extra paragraph spacing)
-  const int firstLineIndent =
-      blockStyle.textIndent > 0 && !extraParagraphSpacing &&
-              (blockStyle.alignment == CssTextAlign::Justify || blockStyle.alignment == CssTextAlign::Left)
-          ? blockStyle.textIndent
-          : 0;
-
-  std::vector<size_t> lineBreakIndices;
-  size_t currentIndex = 0;
-  bool isFirstLine = true;
-
-  while (currentIndex < wordWidths.size()) {
-    const size_t lineStart = currentIndex;
-    int lineWidth = 0;
-
-    // First line has reduced width due to text-indent
-    const int effectivePageWidth = isFirstLine ? pageWidth - firstLineIndent : pageWidth;
-
-    // Consume as many words as possible for current line, splitting when prefixes fit
-    while (currentIndex < wordWidths.size()) {
-      const bool isFirstWord = currentIndex == lineStart;
-      int spacing = 0;
-      if (!isFirstWord && !continuesVec[currentIndex]) {
-        spacing = spaceWidth;
-        spacing += renderer.getSpaceKernAdjust(fontId, lastCodepoint(words[currentIndex - 1]),
-                                               firstCodepoint(words[currentIndex]), wordStyles[currentIndex - 1]);
-      } else if (!isFirstWord && continuesVec[currentIndex]) {
-        // Cross-boundary kerning for continuation words (e.g. nonbreaking spaces, attached punctuation)
-        spacing = renderer.getKerning(fontId, lastCodepoint(words[currentIndex - 1]),
-                                      firstCodepoint(words[currentIndex]), wordStyles[currentIndex - 1]);
-      }
-      const int candidateWidth = spacing + wordWidths[currentIndex];
-
-      // Word fits on current line
-      if (lineWidth + candidateWidth <= effectivePageWidth) {
-        lineWidth += candidateWidth;
-        ++currentIndex;
-        continue;
-      }
-
-      // Word would overflow — try to split based on hyphenation points
-      const int availableWidth = effectivePageWidth - lineWidth - spacing;
-      const bool allowFallbackBreaks = isFirstWord;  // Only for first word on line
-
-      if (availableWidth > 0 &&
-          hyphenateWordAtIndex(currentIndex, availableWidth, renderer, fontId, wordWidths, allowFallbackBreaks)) {
-        // Prefix now fits; append it to this line and move to next line
-        lineWidth += spacing + wordWidths[currentIndex];
-        ++currentIndex;
-        break;
-      }
-
-      // Could not split: force at least one word per line to avoid infinite loop
-      if (currentIndex == lineStart) {
-        lineWidth += candidateWidth;
-        ++currentIndex;
-      }
-      break;
-    }
-
-    // Don't break before a continuation word (e.g., orphaned "?" after "question").
-    // Backtrack to the start of the continuation group so the whole group moves to the next line.
-    while (currentIndex > lineStart + 1 && currentIndex < wordWidths.size() && continuesVec[currentIndex]) {
-      --currentIndex;
-    }
-
-    lineBreakIndices.push_back(currentIndex);
-    isFirstLine = false;
-  }
-
-  return lineBreakIndices;
-}
-
-// Splits words[wordIndex] into prefix (adding a hyphen only when needed) and remainder when a legal breakpoint fits the
-// available width.
+// Splits the word at wordIndex into prefix (adding a hyphen only when needed) and remainder when a legal breakpoint
+// fits the available width.
 bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availableWidth, const GfxRenderer& renderer,
                                       const int fontId, std::vector<uint16_t>& wordWidths,
                                       const bool allowFallbackBreaks) {
   // Guard against invalid indices or zero available width before attempting to split.
-  if (availableWidth <= 0 || wordIndex >= words.size()) {
+  if (availableWidth <= 0 || wordIndex >= wordCount()) {
     return false;
   }
 
-  const std::string& word = words[wordIndex];
-  const auto style = wordStyles[wordIndex];
+  const std::string_view word = text(this->word(wordIndex));
+  const auto style = this->word(wordIndex).style;
 
   // Collect candidate breakpoints (byte offsets and hyphen requirements).
   auto breakInfos = Hyphenator::breakOffsets(word, allowFallbackBreaks);
@@ -379,7 +500,7 @@ bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availabl
     }
 
     const bool needsHyphen = info.requiresInsertedHyphen;
-    const int prefixWidth = measureWordWidth(renderer, fontId, word.substr(0, offset), style, needsHyphen);
+    const int prefixWidth = measurePrefixWidth(renderer, fontId, word, offset, style, needsHyphen, widthCache);
     if (prefixWidth > availableWidth || prefixWidth <= chosenWidth) {
       continue;  // Skip if too wide or not an improvement
     }
@@ -394,16 +515,29 @@ bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availabl
     return false;
   }
 
-  // Split the word at the selected breakpoint and append a hyphen if required.
-  std::string remainder = word.substr(chosenOffset);
-  words[wordIndex].resize(chosenOffset);
-  if (chosenNeedsHyphen) {
-    words[wordIndex].push_back('-');
+  const uint16_t remainderWidth = measureWordWidth(renderer, fontId, word.substr(chosenOffset), style, widthCache);
+  return splitWord(wordIndex, chosenOffset, chosenNeedsHyphen, static_cast<uint16_t>(chosenWidth), remainderWidth,
+                   wordWidths);
+}
+
+// Splits the word at wordIndex at byteOffset into a prefix (with a hyphen appended if needed) and the remainder,
+// inserted after it, with their measured widths. The remainder keeps the word's own bytes from byteOffset on; the
+// prefix is copied to make room for the hyphen and its NUL. Returns false, leaving the word whole, when out of memory.
+bool ParsedText::splitWord(const size_t wordIndex, const size_t byteOffset, const bool needsHyphen,
+                           const uint16_t prefixWidth, const uint16_t remainderWidth,
+                           std::vector<uint16_t>& wordWidths) {
+  Word prefix = word(wordIndex);
+  Word remainder = prefix;
+  remainder.offset += byteOffset;
+  remainder.length -= byteOffset;
+  remainder.continues = false;
+  if (!store(prefix, text(prefix).substr(0, byteOffset), needsHyphen ? "-" : "")) {
+    return false;
   }
 
-  // Insert the remainder word (with matching style and continuation flag) directly after the prefix.
-  words.insert(words.begin() + wordIndex + 1, remainder);
-  wordStyles.insert(wordStyles.begin() + wordIndex + 1, style);
+  // Insert the remainder word (with matching style) directly after the prefix.
+  word(wordIndex) = prefix;
+  words.insert(words.begin() + head + wordIndex + 1, remainder);
 
   // Continuation flag handling after splitting a word into prefix + remainder.
   //
@@ -422,26 +556,25 @@ bool ParsedText::hyphenateWordAtIndex(const size_t wordIndex, const int availabl
   //   [2] "Quadrat-"    continues=true   (KEPT — still attached to the no-break group)
   //   [3] "kilometer"   continues=false  (NEW — starts fresh on the next line)
   //
-  // This lets the backtracking loop keep the entire prefix group ("200 Quadrat-") on one
-  // line, while "kilometer" moves to the next line.
-  // wordContinues[wordIndex] is intentionally left unchanged — the prefix keeps its original attachment.
-  wordContinues.insert(wordContinues.begin() + wordIndex + 1, false);
+  // This keeps the entire prefix group ("200 Quadrat-") on one line, while "kilometer" moves to
+  // the next line.
+  // The prefix's continues flag is intentionally left unchanged — it keeps its original attachment.
 
   // Update cached widths to reflect the new prefix/remainder pairing.
-  wordWidths[wordIndex] = static_cast<uint16_t>(chosenWidth);
-  const uint16_t remainderWidth = measureWordWidth(renderer, fontId, remainder, style);
+  wordWidths[wordIndex] = prefixWidth;
   wordWidths.insert(wordWidths.begin() + wordIndex + 1, remainderWidth);
+  lineTotals.splitWords++;
   return true;
 }
 
 void ParsedText::extractLine(const size_t breakIndex, const int pageWidth, const int spaceWidth,
-                             const std::vector<uint16_t>& wordWidths, const std::vector<bool>& continuesVec,
-                             const std::vector<size_t>& lineBreakIndices,
+                             const std::vector<uint16_t>& wordWidths, const std::vector<size_t>& lineBreakIndices,
                              const std::function<void(std::shared_ptr<TextBlock>)>& processLine,
-                             const GfxRenderer& renderer, const int fontId) {
+                             const GfxRenderer& renderer, const int fontId, LineBuffers& line) {
   const size_t lineBreak = lineBreakIndices[breakIndex];
   const size_t lastBreakAt = breakIndex > 0 ? lineBreakIndices[breakIndex - 1] : 0;
   const size_t lineWordCount = lineBreak - lastBreakAt;
+  const auto lineWord = [&](const size_t wordIdx) -> Word& { return word(lastBreakAt + wordIdx); };
 
   // Calculate first line indent (only for left/justified text without extra paragraph spacing)
   const bool isFirstLine = breakIndex == 0;
@@ -460,18 +593,16 @@ void ParsedText::extractLine(const size_t breakIndex, const int pageWidth, const
   for (size_t wordIdx = 0; wordIdx < lineWordCount; wordIdx++) {
     lineWordWidthSum += wordWidths[lastBreakAt + wordIdx];
     // Count gaps: each word after the first creates a gap, unless it's a continuation
-    if (wordIdx > 0 && !continuesVec[lastBreakAt + wordIdx]) {
+    if (wordIdx > 0 && !lineWord(wordIdx).continues) {
       actualGapCount++;
       int naturalGap = spaceWidth;
-      naturalGap += renderer.getSpaceKernAdjust(fontId, lastCodepoint(words[lastBreakAt + wordIdx - 1]),
-                                                firstCodepoint(words[lastBreakAt + wordIdx]),
-                                                wordStyles[lastBreakAt + wordIdx - 1]);
+      naturalGap += renderer.getSpaceKernAdjust(fontId, lastCodepoint(text(lineWord(wordIdx - 1))),
+                                                firstCodepoint(text(lineWord(wordIdx))), lineWord(wordIdx - 1).style);
       totalNaturalGaps += naturalGap;
-    } else if (wordIdx > 0 && continuesVec[lastBreakAt + wordIdx]) {
+    } else if (wordIdx > 0 && lineWord(wordIdx).continues) {
       // Cross-boundary kerning for continuation words (e.g. nonbreaking spaces, attached punctuation)
-      totalNaturalGaps +=
-          renderer.getKerning(fontId, lastCodepoint(words[lastBreakAt + wordIdx - 1]),
-                              firstCodepoint(words[lastBreakAt + wordIdx]), wordStyles[lastBreakAt + wordIdx - 1]);
+      totalNaturalGaps += renderer.getKerning(fontId, lastCodepoint(text(lineWord(wordIdx - 1))),
+                                              firstCodepoint(text(lineWord(wordIdx))), lineWord(wordIdx - 1).style);
     }
   }
 
@@ -484,6 +615,10 @@ void ParsedText::extractLine(const size_t breakIndex, const int pageWidth, const
   const int justifyExtra = (blockStyle.alignment == CssTextAlign::Justify && !isLastLine && actualGapCount >= 1)
                                ? spareSpace / static_cast<int>(actualGapCount)
                                : 0;
+  lineTotals.lines++;
+  if (!isLastLine) {
+    lineTotals.badness += static_cast<int64_t>(spareSpace) * spareSpace;
+  }
 
   // Calculate initial x position (first line starts at indent for left/justified text)
   auto xpos = static_cast<uint16_t>(firstLineIndent);
@@ -495,26 +630,22 @@ void ParsedText::extractLine(const size_t breakIndex, const int pageWidth, const
 
   // Pre-calculate X positions for words
   // Continuation words attach to the previous word with no space before them
-  std::vector<uint16_t> lineXPos;
-  lineXPos.reserve(lineWordCount);
-
+  line.xpos.clear();
   for (size_t wordIdx = 0; wordIdx < lineWordCount; wordIdx++) {
-    lineXPos.push_back(xpos);
+    line.xpos.push_back(xpos);
 
-    const bool nextIsContinuation = wordIdx + 1 < lineWordCount && continuesVec[lastBreakAt + wordIdx + 1];
+    const bool nextIsContinuation = wordIdx + 1 < lineWordCount && lineWord(wordIdx + 1).continues;
     if (nextIsContinuation) {
       int advance = wordWidths[lastBreakAt + wordIdx];
       // Cross-boundary kerning for continuation words (e.g. nonbreaking spaces, attached punctuation)
-      advance +=
-          renderer.getKerning(fontId, lastCodepoint(words[lastBreakAt + wordIdx]),
-                              firstCodepoint(words[lastBreakAt + wordIdx + 1]), wordStyles[lastBreakAt + wordIdx]);
+      advance += renderer.getKerning(fontId, lastCodepoint(text(lineWord(wordIdx))),
+                                     firstCodepoint(text(lineWord(wordIdx + 1))), lineWord(wordIdx).style);
       xpos += advance;
     } else {
       int gap = spaceWidth;
       if (wordIdx + 1 < lineWordCount) {
-        gap += renderer.getSpaceKernAdjust(fontId, lastCodepoint(words[lastBreakAt + wordIdx]),
-                                           firstCodepoint(words[lastBreakAt + wordIdx + 1]),
-                                           wordStyles[lastBreakAt + wordIdx]);
+        gap += renderer.getSpaceKernAdjust(fontId, lastCodepoint(text(lineWord(wordIdx))),
+                                           firstCodepoint(text(lineWord(wordIdx + 1))), lineWord(wordIdx).style);
       }
       if (blockStyle.alignment == CssTextAlign::Justify && !isLastLine) {
         gap += justifyExtra;
@@ -523,17 +654,24 @@ void ParsedText::extractLine(const size_t breakIndex, const int pageWidth, const
     }
   }
 
-  // Build line data by moving from the original vectors using index range
-  std::vector<std::string> lineWords(std::make_move_iterator(words.begin() + lastBreakAt),
-                                     std::make_move_iterator(words.begin() + lineBreak));
-  std::vector<EpdFontFamily::Style> lineWordStyles(wordStyles.begin() + lastBreakAt, wordStyles.begin() + lineBreak);
-
-  for (auto& word : lineWords) {
-    if (containsSoftHyphen(word)) {
-      stripSoftHyphensInPlace(word);
+  // The line points into the chunks its words are in, and keeps them alive
+  line.chunks.clear();
+  line.words.clear();
+  line.styles.clear();
+  for (size_t wordIdx = 0; wordIdx < lineWordCount; wordIdx++) {
+    Word& lw = lineWord(wordIdx);
+    char* wordBytes = bytes(lw);
+    if (containsSoftHyphen(text(lw))) {
+      lw.length = static_cast<uint16_t>(stripSoftHyphens(wordBytes, lw.length));
+      wordBytes[lw.length] = '\0';
+    }
+    line.words.emplace_back(wordBytes, lw.length);
+    line.styles.push_back(lw.style);
+    const TextBlock::WordChunk& chunk = chunks[static_cast<uint16_t>(lw.chunk - chunkBase)];
+    if (std::find(line.chunks.begin(), line.chunks.end(), chunk) == line.chunks.end()) {
+      line.chunks.push_back(chunk);
     }
   }
 
-  processLine(
-      std::make_shared<TextBlock>(std::move(lineWords), std::move(lineXPos), std::move(lineWordStyles), blockStyle));
+  processLine(std::make_shared<TextBlock>(line.chunks, line.words, line.xpos, line.styles, blockStyle));
 }
@@ -4,48 +4,102 @@
 
 #include <functional>
 #include <memory>
-#include <string>
+#include <string_view>
 #include <vector>
 
 #include "blocks/BlockStyle.h"
 #include "blocks/TextBlock.h"
 
 class GfxRenderer;
+class WordWidthCache;
 
 class ParsedText {
-  std::vector<std::string> words;
-  std::vector<EpdFontFamily::Style> wordStyles;
-  std::vector<bool> wordContinues;  // true = word attaches to previous (no space before it)
+ public:
+  // Totals over every paragraph laid out so far, for benchmarks
+  struct LineStats {
+    uint32_t lines = 0;
+    uint32_t splitWords = 0;  // Words broken across two lines
+    uint64_t badness = 0;     // Sum of the squared spare width of every line but a paragraph's last
+    uint64_t breakUs = 0;     // Time spent choosing the line breaks
+  };
+
+ private:
+  // A word's bytes sit NUL-terminated at offset in a chunk. Chunks are numbered in the order they were allocated.
+  struct Word {
+    uint16_t chunk;
+    uint16_t offset;
+    uint16_t length;  // Bytes, not counting the NUL
+    EpdFontFamily::Style style;
+    bool continues;  // true = word attaches to previous (no space before it)
+  };
+
+  // Arrays of the line being extracted, reused from line to line
+  struct LineBuffers {
+    std::vector<TextBlock::WordChunk> chunks;
+    std::vector<std::string_view> words;
+    std::vector<uint16_t> xpos;
+    std::vector<EpdFontFamily::Style> styles;
+  };
+
+  // Word bytes are appended to chunks of CHUNK_BYTES, so a paragraph takes a heap block per chunk rather than one or
+  // more per word. Laying out lines moves head past their words instead of erasing them, and lets go of the chunks
+  // that no remaining word uses; the lines hold on to the chunks their words point into.
+  static constexpr size_t CHUNK_BYTES = 512;
+  std::vector<Word> words;
+  size_t head = 0;  // First word not laid out yet
+  std::vector<TextBlock::WordChunk> chunks;
+  uint16_t chunkBase = 0;      // Number of chunks[0]
+  uint16_t chunkUsed = 0;      // Bytes used in chunks.back()
+  uint16_t chunkCapacity = 0;  // Size of chunks.back()
   BlockStyle blockStyle;
   bool extraParagraphSpacing;
   bool hyphenationEnabled;
+  WordWidthCache* widthCache;  // Shared by the paragraphs of a section, may be null
+
+  size_t wordCount() const { return words.size() - head; }
+  Word& word(const size_t index) { return words[head + index]; }
+  char* bytes(const Word& word) const {
+    return chunks[static_cast<uint16_t>(word.chunk - chunkBase)].get() + word.offset;
+  }
+  std::string_view text(const Word& word) const { return {bytes(word), word.length}; }
+  bool store(Word& word, std::string_view first, std::string_view second = {});
+  void releaseLaidOutWords();
 
   void applyParagraphIndent();
   std::vector<size_t> computeLineBreaks(const GfxRenderer& renderer, int fontId, int pageWidth, int spaceWidth,
-                                        std::vector<uint16_t>& wordWidths, std::vector<bool>& continuesVec);
-  std::vector<size_t> computeHyphenatedLineBreaks(const GfxRenderer& renderer, int fontId, int pageWidth,
-                                                  int spaceWidth, std::vector<uint16_t>& wordWidths,
-                                                  std::vector<bool>& continuesVec);
+                                        std::vector<uint16_t>& wordWidths);
   bool hyphenateWordAtIndex(size_t wordIndex, int availableWidth, const GfxRenderer& renderer, int fontId,
                             std::vector<uint16_t>& wordWidths, bool allowFallbackBreaks);
+  bool splitWord(size_t wordIndex, size_t byteOffset, bool needsHyphen, uint16_t prefixWidth, uint16_t remainderWidth,
+                 std::vector<uint16_t>& wordWidths);
   void extractLine(size_t breakIndex, int pageWidth, int spaceWidth, const std::vector<uint16_t>& wordWidths,
-                   const std::vector<bool>& continuesVec, const std::vector<size_t>& lineBreakIndices,
+                   const std::vector<size_t>& lineBreakIndices,
                    const std::function<void(std::shared_ptr<TextBlock>)>& processLine, const GfxRenderer& renderer,
-                   int fontId);
+                   int fontId, LineBuffers& line);
   std::vector<uint16_t> calculateWordWidths(const GfxRenderer& renderer, int fontId);
 
  public:
   explicit ParsedText(const bool extraParagraphSpacing, const bool hyphenationEnabled = false,
-                      const BlockStyle& blockStyle = BlockStyle())
-      : blockStyle(blockStyle), extraParagraphSpacing(extraParagraphSpacing), hyphenationEnabled(hyphenationEnabled) {}
+                      const BlockStyle& blockStyle = BlockStyle(), WordWidthCache* widthCache = nullptr)
+      : blockStyle(blockStyle),
+        extraParagraphSpacing(extraParagraphSpacing),
+        hyphenationEnabled(hyphenationEnabled),
+        widthCache(widthCache) {}
   ~ParsedText() = default;
 
-  void addWord(std::string word, EpdFontFamily::Style fontStyle, bool underline = false, bool attachToPrevious = false);
+  void addWord(std::string_view word, EpdFontFamily::Style fontStyle, bool underline = false,
+               bool attachToPrevious = false);
   void setBlockStyle(const BlockStyle& blockStyle) { this->blockStyle = blockStyle; }
   BlockStyle& getBlockStyle() { return blockStyle; }
-  size_t size() const { return words.size(); }
-  bool isEmpty() const { return words.empty(); }
+  size_t size() const { return wordCount(); }
+  bool isEmpty() const { return wordCount() == 0; }
   void layoutAndExtractLines(const GfxRenderer& renderer, int fontId, uint16_t viewportWidth,
                              const std::function<void(std::shared_ptr<TextBlock>)>& processLine,
                              bool includeLastLine = true);
-};
\ No newline at end of file
+
+  static LineStats getLineTotals() { return lineTotals; }
+  static void resetLineTotals() { lineTotals = {}; }
+
+ private:
+  static LineStats lineTotals;
+};
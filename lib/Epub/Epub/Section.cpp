@@ -1,62 +1,84 @@
 #include "Section.h"
 
 #include <HalStorage.h>
+#include <HeapTrace.h>
 #include <Logging.h>
+#include <PerfTrace.h>
 #include <Serialization.h>
 
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
 #include "Epub/css/CssParser.h"
 #include "Page.h"
 #include "hyphenation/Hyphenator.h"
 #include "parsers/ChapterHtmlSlimParser.h"
 
 namespace {
-constexpr uint8_t SECTION_FILE_VERSION = 14;
 constexpr uint32_t HEADER_SIZE = sizeof(uint8_t) + sizeof(int) + sizeof(float) + sizeof(bool) + sizeof(uint8_t) +
                                  sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(bool) + sizeof(bool) +
-                                 sizeof(uint32_t);
+                                 sizeof(uint32_t) + sizeof(uint32_t);
+// pageCount, lutOffset and dictionaryOffset close the header and are patched once the section is complete
+constexpr uint32_t HEADER_TRAILER_OFFSET = HEADER_SIZE - sizeof(uint16_t) - 2 * sizeof(uint32_t);
 }  // namespace
 
-uint32_t Section::onPageComplete(std::unique_ptr<Page> page) {
+uint32_t Section::onPageComplete(BufferedFsWriter& writer, std::unique_ptr<Page> page, const size_t index) {
   if (!file) {
-    LOG_ERR("SCT", "File not open for writing page %d", pageCount);
+    LOG_ERR("SCT", "File not open for writing page %u", static_cast<uint32_t>(index));
     return 0;
   }
 
-  const uint32_t position = file.position();
-  if (!page->serialize(file)) {
-    LOG_ERR("SCT", "Failed to serialize page %d", pageCount);
+  const uint32_t position = writer.position();
+  if (!page->serialize(writer, dictionary)) {
+    LOG_ERR("SCT", "Failed to serialize page %u", static_cast<uint32_t>(index));
     return 0;
   }
-  LOG_DBG("SCT", "Page %d processed", pageCount);
-
-  pageCount++;
+  LOG_DBG("SCT", "Page %u processed", static_cast<uint32_t>(index));
   return position;
 }
 
-void Section::writeSectionFileHeader(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
-                                     const uint8_t paragraphAlignment, const uint16_t viewportWidth,
-                                     const uint16_t viewportHeight, const bool hyphenationEnabled,
-                                     const bool embeddedStyle) {
+void Section::commitPages(BufferedFsWriter& writer, const std::vector<uint32_t>& lut) {
+  // A page that failed to serialize fails the whole build, so it is never shown
+  if (lut.size() <= pageCount || std::find(lut.begin() + pageCount, lut.end(), 0) != lut.end() || !writer.flush()) {
+    return;
+  }
+  if (!pageLut.empty()) {
+    pageLut.pop_back();
+  }
+  pageLut.insert(pageLut.end(), lut.begin() + pageLut.size(), lut.end());
+  pageLut.push_back(writer.position());
+  if (pageCount == 0) {
+    LOG_DBG("SCT", "First page committed after %lums", millis() - buildStartTime);
+  }
+  pageCount = lut.size();
+}
+
+void Section::writeSectionFileHeader(BufferedFsWriter& writer, const int fontId, const float lineCompression,
+                                     const bool extraParagraphSpacing, const uint8_t paragraphAlignment,
+                                     const uint16_t viewportWidth, const uint16_t viewportHeight,
+                                     const bool hyphenationEnabled, const bool embeddedStyle) {
   if (!file) {
     LOG_DBG("SCT", "File not open for writing header");
     return;
   }
-  static_assert(HEADER_SIZE == sizeof(SECTION_FILE_VERSION) + sizeof(fontId) + sizeof(lineCompression) +
+  static_assert(HEADER_SIZE == sizeof(FILE_VERSION) + sizeof(fontId) + sizeof(lineCompression) +
                                    sizeof(extraParagraphSpacing) + sizeof(paragraphAlignment) + sizeof(viewportWidth) +
                                    sizeof(viewportHeight) + sizeof(pageCount) + sizeof(hyphenationEnabled) +
-                                   sizeof(embeddedStyle) + sizeof(uint32_t),
+                                   sizeof(embeddedStyle) + sizeof(uint32_t) + sizeof(uint32_t),
                 "Header size mismatch");
-  serialization::writePod(file, SECTION_FILE_VERSION);
-  serialization::writePod(file, fontId);
-  serialization::writePod(file, lineCompression);
-  serialization::writePod(file, extraParagraphSpacing);
-  serialization::writePod(file, paragraphAlignment);
-  serialization::writePod(file, viewportWidth);
-  serialization::writePod(file, viewportHeight);
-  serialization::writePod(file, hyphenationEnabled);
-  serialization::writePod(file, embeddedStyle);
-  serialization::writePod(file, pageCount);  // Placeholder for page count (will be initially 0 when written)
-  serialization::writePod(file, static_cast<uint32_t>(0));  // Placeholder for LUT offset
+  serialization::writePod(writer, FILE_VERSION);
+  serialization::writePod(writer, fontId);
+  serialization::writePod(writer, lineCompression);
+  serialization::writePod(writer, extraParagraphSpacing);
+  serialization::writePod(writer, paragraphAlignment);
+  serialization::writePod(writer, viewportWidth);
+  serialization::writePod(writer, viewportHeight);
+  serialization::writePod(writer, hyphenationEnabled);
+  serialization::writePod(writer, embeddedStyle);
+  serialization::writePod(writer, pageCount);  // Placeholder for page count (will be initially 0 when written)
+  serialization::writePod(writer, static_cast<uint32_t>(0));  // Placeholder for LUT offset
+  serialization::writePod(writer, static_cast<uint32_t>(0));  // Placeholder for dictionary offset
 }
 
 bool Section::loadSectionFile(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
@@ -66,11 +88,15 @@ bool Section::loadSectionFile(const int fontId, const float lineCompression, con
     return false;
   }
 
+  // The whole header comes in with a single card read
+  uint8_t headerBuffer[HEADER_SIZE];
+  BufferedFsReader reader(file, headerBuffer, sizeof(headerBuffer));
+
   // Match parameters
   {
     uint8_t version;
-    serialization::readPod(file, version);
-    if (version != SECTION_FILE_VERSION) {
+    serialization::readPod(reader, version);
+    if (version != FILE_VERSION) {
       file.close();
       LOG_ERR("SCT", "Deserialization failed: Unknown version %u", version);
       clearCache();
@@ -84,14 +110,14 @@ bool Section::loadSectionFile(const int fontId, const float lineCompression, con
     uint8_t fileParagraphAlignment;
     bool fileHyphenationEnabled;
     bool fileEmbeddedStyle;
-    serialization::readPod(file, fileFontId);
-    serialization::readPod(file, fileLineCompression);
-    serialization::readPod(file, fileExtraParagraphSpacing);
-    serialization::readPod(file, fileParagraphAlignment);
-    serialization::readPod(file, fileViewportWidth);
-    serialization::readPod(file, fileViewportHeight);
-    serialization::readPod(file, fileHyphenationEnabled);
-    serialization::readPod(file, fileEmbeddedStyle);
+    serialization::readPod(reader, fileFontId);
+    serialization::readPod(reader, fileLineCompression);
+    serialization::readPod(reader, fileExtraParagraphSpacing);
+    serialization::readPod(reader, fileParagraphAlignment);
+    serialization::readPod(reader, fileViewportWidth);
+    serialization::readPod(reader, fileViewportHeight);
+    serialization::readPod(reader, fileHyphenationEnabled);
+    serialization::readPod(reader, fileEmbeddedStyle);
 
     if (fontId != fileFontId || lineCompression != fileLineCompression ||
         extraParagraphSpacing != fileExtraParagraphSpacing || paragraphAlignment != fileParagraphAlignment ||
@@ -104,14 +130,69 @@ bool Section::loadSectionFile(const int fontId, const float lineCompression, con
     }
   }
 
-  serialization::readPod(file, pageCount);
-  file.close();
-  LOG_DBG("SCT", "Deserialization succeeded: %d pages", pageCount);
+  uint32_t lutOffset, dictionaryOffset;
+  serialization::readPod(reader, pageCount);
+  serialization::readPod(reader, lutOffset);
+  serialization::readPod(reader, dictionaryOffset);
+
+  // The word and style tables stay resident so page loads can resolve references without touching the card
+  bool dictionaryLoaded = false;
+  {
+    BufferedFsReader dictionaryReader(file);
+    dictionaryLoaded = dictionaryOffset > lutOffset && dictionaryReader.seek(dictionaryOffset) &&
+                       dictionary.read(dictionaryReader);
+  }
+  if (!dictionaryLoaded) {
+    file.close();
+    LOG_ERR("SCT", "Deserialization failed: Bad dictionary at %u", dictionaryOffset);
+    clearCache();
+    return false;
+  }
+  if (!loadPageLut(lutOffset)) {
+    file.close();
+    clearCache();
+    return false;
+  }
+  LOG_DBG("SCT", "Deserialization succeeded: %d pages, %u words, %u styles", pageCount, dictionary.wordCount(),
+          dictionary.styleCount());
+  return true;
+}
+
+bool Section::loadPageLut(const uint32_t lutOffset) {
+  pageLut.clear();
+  pageLut.resize(pageCount + 1);
+  pageLut[pageCount] = lutOffset;
+
+  const int lutBytes = pageCount * sizeof(uint32_t);
+  if (!file.seek(lutOffset) || file.read(pageLut.data(), lutBytes) != lutBytes) {
+    LOG_ERR("SCT", "Deserialization failed: Truncated LUT at %u", lutOffset);
+    pageLut.clear();
+    return false;
+  }
+
+  // Checked once here, so a page turn can trust the table
+  for (uint16_t i = 0; i < pageCount; i++) {
+    if (pageLut[i] < HEADER_SIZE || pageLut[i] >= pageLut[i + 1]) {
+      LOG_ERR("SCT", "Deserialization failed: Invalid LUT entry for page %u", i);
+      pageLut.clear();
+      return false;
+    }
+  }
   return true;
 }
 
+void Section::close() {
+  if (file) {
+    file.close();
+  }
+}
+
 // Your updated class method (assuming you are using the 'SD' object, which is a wrapper for a specific filesystem)
-bool Section::clearCache() const {
+bool Section::clearCache() {
+  close();
+  pageLut.clear();
+  dropPageCache();
+
   if (!Storage.exists(filePath.c_str())) {
     LOG_DBG("SCT", "Cache does not exist, no action needed");
     return true;
@@ -129,7 +210,9 @@ bool Section::clearCache() const {
 bool Section::createSectionFile(const int fontId, const float lineCompression, const bool extraParagraphSpacing,
                                 const uint8_t paragraphAlignment, const uint16_t viewportWidth,
                                 const uint16_t viewportHeight, const bool hyphenationEnabled, const bool embeddedStyle,
-                                const std::function<void()>& popupFn) {
+                                const std::function<void()>& popupFn,
+                                const std::function<bool()>& checkpointFn) {
+  PERF_SCOPE(SectionBuild);
   const auto localPath = epub->getSpineItem(spineIndex).href;
   const auto tmpHtmlPath = epub->getCachePath() + "/.tmp_" + std::to_string(spineIndex) + ".html";
 
@@ -139,49 +222,6 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
     Storage.mkdir(sectionsDir.c_str());
   }
 
-  // Retry logic for SD card timing issues
-  bool success = false;
-  uint32_t fileSize = 0;
-  for (int attempt = 0; attempt < 3 && !success; attempt++) {
-    if (attempt > 0) {
-      LOG_DBG("SCT", "Retrying stream (attempt %d)...", attempt + 1);
-      delay(50);  // Brief delay before retry
-    }
-
-    // Remove any incomplete file from previous attempt before retrying
-    if (Storage.exists(tmpHtmlPath.c_str())) {
-      Storage.remove(tmpHtmlPath.c_str());
-    }
-
-    FsFile tmpHtml;
-    if (!Storage.openFileForWrite("SCT", tmpHtmlPath, tmpHtml)) {
-      continue;
-    }
-    success = epub->readItemContentsToStream(localPath, tmpHtml, 1024);
-    fileSize = tmpHtml.size();
-    tmpHtml.close();
-
-    // If streaming failed, remove the incomplete file immediately
-    if (!success && Storage.exists(tmpHtmlPath.c_str())) {
-      Storage.remove(tmpHtmlPath.c_str());
-      LOG_DBG("SCT", "Removed incomplete temp file after failed attempt");
-    }
-  }
-
-  if (!success) {
-    LOG_ERR("SCT", "Failed to stream item contents to temp file after retries");
-    return false;
-  }
-
-  LOG_DBG("SCT", "Streamed temp HTML to %s (%d bytes)", tmpHtmlPath.c_str(), fileSize);
-
-  if (!Storage.openFileForWrite("SCT", filePath, file)) {
-    return false;
-  }
-  writeSectionFileHeader(fontId, lineCompression, extraParagraphSpacing, paragraphAlignment, viewportWidth,
-                         viewportHeight, hyphenationEnabled, embeddedStyle);
-  std::vector<uint32_t> lut = {};
-
   // Derive the content base directory and image cache path prefix for the parser
   size_t lastSlash = localPath.find_last_of('/');
   std::string contentBase = (lastSlash != std::string::npos) ? localPath.substr(0, lastSlash + 1) : "";
@@ -197,26 +237,150 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
     }
   }
 
-  ChapterHtmlSlimParser visitor(
-      epub, tmpHtmlPath, renderer, fontId, lineCompression, extraParagraphSpacing, paragraphAlignment, viewportWidth,
-      viewportHeight, hyphenationEnabled,
-      [this, &lut](std::unique_ptr<Page> page) { lut.emplace_back(this->onPageComplete(std::move(page))); },
-      embeddedStyle, contentBase, imageBasePath, popupFn, cssParser);
-  Hyphenator::setPreferredLanguage(epub->getLanguage());
-  success = visitor.parseAndBuildPages();
+  // Lay out the chapter into a fresh section file. On failure the partial section file is removed, so a
+  // second attempt from another source starts clean.
+  std::vector<uint32_t> lut = {};
+  close();
+  pageLut.clear();
+  dropPageCache();
+  pageCount = 0;
+  buildStartTime = millis();
+  // A build with a checkpoint runs in the background. Pages are committed to pageLut / pageCount at every
+  // checkpoint, so they can be shown while the rest of the chapter is still being laid out.
+  indexing = checkpointFn != nullptr;
+  // Drops the pages committed so far along with the partial file
+  const auto abandonBuild = [this] {
+    file.close();
+    dropPageCache();
+    pageLut.clear();
+    pageCount = 0;
+    dictionary.clear();
+    Storage.remove(filePath.c_str());
+  };
+  // A build stopped by its checkpoint is abandoned, not retried through the temp file
+  bool stopped = false;
+  const auto buildPages = [&](const std::function<bool(ChapterHtmlSlimParser&)>& parse) {
+    if (!Storage.openFileForWrite("SCT", filePath, file)) {
+      return false;
+    }
+    pageCount = 0;
+    pageLut.clear();
+    lut.clear();
+    dictionary.beginBuild();
+    BufferedFsWriter writer(file);
+    writeSectionFileHeader(writer, fontId, lineCompression, extraParagraphSpacing, paragraphAlignment, viewportWidth,
+                           viewportHeight, hyphenationEnabled, embeddedStyle);
+
+    std::function<bool()> checkpoint = nullptr;
+    if (checkpointFn) {
+      checkpoint = [this, &checkpointFn, &stopped, &writer, &lut] {
+        commitPages(writer, lut);
+        stopped = stopped || !checkpointFn();
+        return !stopped;
+      };
+    }
+    ChapterHtmlSlimParser visitor(
+        epub, tmpHtmlPath, renderer, fontId, lineCompression, extraParagraphSpacing, paragraphAlignment, viewportWidth,
+        viewportHeight, hyphenationEnabled,
+        [this, &lut, &writer](std::unique_ptr<Page> page) {
+          lut.emplace_back(this->onPageComplete(writer, std::move(page), lut.size()));
+        },
+        embeddedStyle, contentBase, imageBasePath, popupFn, cssParser, checkpoint);
+    Hyphenator::setPreferredLanguage(epub->getLanguage());
+    if (!parse(visitor) || !writer.flush()) {
+      abandonBuild();
+      return false;
+    }
+    return true;
+  };
 
-  Storage.remove(tmpHtmlPath.c_str());
+  // Parse while inflating straight out of the EPUB, so the chapter never round-trips through SD
+  bool success = false;
+  // Only a chapter that could not be opened or inflated is worth another try from a temp file; bad markup fails the
+  // same way twice
+  bool sourceFailed = false;
+  {
+    ZipFile::EntryReader entry;
+    if (!epub->openItemReader(localPath, entry, 1024)) {
+      sourceFailed = true;
+    } else {
+      success = buildPages([&entry, &sourceFailed](ChapterHtmlSlimParser& visitor) {
+        const bool parsed = visitor.parseAndBuildPages(entry);
+        sourceFailed = visitor.failedReadingSource();
+        return parsed;
+      });
+      if (!success && !stopped && sourceFailed) {
+        LOG_DBG("SCT", "Streaming the chapter failed, falling back to temp file");
+      }
+    }
+  }
+
+  // Fallback: stage the chapter in a temp file first. Costs an extra write and read of the whole chapter, but
+  // never holds the inflate window and the parser in memory at the same time.
+  if (!success && !stopped && sourceFailed) {
+    bool staged = false;
+    uint32_t fileSize = 0;
+    // Retry logic for SD card timing issues
+    for (int attempt = 0; attempt < 3 && !staged; attempt++) {
+      if (attempt > 0) {
+        LOG_DBG("SCT", "Retrying stream (attempt %d)...", attempt + 1);
+        delay(50);  // Brief delay before retry
+      }
+
+      // Remove any incomplete file from previous attempt before retrying
+      if (Storage.exists(tmpHtmlPath.c_str())) {
+        Storage.remove(tmpHtmlPath.c_str());
+      }
+
+      FsFile tmpHtml;
+      if (!Storage.openFileForWrite("SCT", tmpHtmlPath, tmpHtml)) {
+        continue;
+      }
+      staged = epub->readItemContentsToStream(localPath, tmpHtml, 1024);
+      fileSize = tmpHtml.size();
+      tmpHtml.close();
+
+      // If streaming failed, remove the incomplete file immediately
+      if (!staged && Storage.exists(tmpHtmlPath.c_str())) {
+        Storage.remove(tmpHtmlPath.c_str());
+        LOG_DBG("SCT", "Removed incomplete temp file after failed attempt");
+      }
+    }
+
+    if (!staged) {
+      LOG_ERR("SCT", "Failed to stream item contents to temp file after retries");
+      indexing = false;
+      if (cssParser) {
+        cssParser->clear();
+      }
+      return false;
+    }
+
+    LOG_DBG("SCT", "Streamed temp HTML to %s (%d bytes)", tmpHtmlPath.c_str(), fileSize);
+    success = buildPages([](ChapterHtmlSlimParser& visitor) { return visitor.parseAndBuildPages(); });
+    Storage.remove(tmpHtmlPath.c_str());
+  }
+
+  if (!success) {
+    indexing = false;
+  }
+  if (stopped) {
+    LOG_DBG("SCT", "Section build stopped");
+    if (cssParser) {
+      cssParser->clear();
+    }
+    return false;
+  }
   if (!success) {
     LOG_ERR("SCT", "Failed to parse XML and build pages");
-    file.close();
-    Storage.remove(filePath.c_str());
     if (cssParser) {
       cssParser->clear();
     }
     return false;
   }
 
-  const uint32_t lutOffset = file.position();
+  BufferedFsWriter writer(file);
+  const uint32_t lutOffset = writer.position();
   bool hasFailedLutRecords = false;
   // Write LUT
   for (const uint32_t& pos : lut) {
@@ -224,41 +388,135 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
       hasFailedLutRecords = true;
       break;
     }
-    serialization::writePod(file, pos);
+    serialization::writePod(writer, pos);
   }
 
   if (hasFailedLutRecords) {
     LOG_ERR("SCT", "Failed to write LUT due to invalid page positions");
-    file.close();
-    Storage.remove(filePath.c_str());
+    abandonBuild();
+    indexing = false;
     return false;
   }
 
-  // Go back and write LUT offset
-  file.seek(HEADER_SIZE - sizeof(uint32_t) - sizeof(pageCount));
-  serialization::writePod(file, pageCount);
-  serialization::writePod(file, lutOffset);
+  const uint32_t dictionaryOffset = writer.position();
+  dictionary.write(writer);
+  // Pages decoded during the build point into the word table, which endBuild() shrinks in place
+  dropPageCache();
+  dictionary.endBuild();
+  LOG_DBG("SCT", "Interned %u words, %u styles", dictionary.wordCount(), dictionary.styleCount());
+
+  // Go back and write LUT and dictionary offsets
+  const uint16_t totalPages = lut.size();
+  writer.seek(HEADER_TRAILER_OFFSET);
+  serialization::writePod(writer, totalPages);
+  serialization::writePod(writer, lutOffset);
+  serialization::writePod(writer, dictionaryOffset);
+  if (!writer.flush()) {
+    LOG_ERR("SCT", "Failed to write section file");
+    abandonBuild();
+    indexing = false;
+    return false;
+  }
   file.close();
   if (cssParser) {
     cssParser->clear();
   }
+
+  // The offsets just written double as the resident page table; the first page load reopens the file for reading
+  pageLut = std::move(lut);
+  pageLut.push_back(lutOffset);
+  pageCount = totalPages;
+  indexing = false;
+  LOG_DBG("SCT", "Built %u pages in %lums", pageCount, millis() - buildStartTime);
   return true;
 }
 
-std::unique_ptr<Page> Section::loadPageFromSectionFile() {
-  if (!Storage.openFileForRead("SCT", filePath, file)) {
+std::unique_ptr<Page> Section::loadPage(const int index) {
+  if (index < 0 || index + 1 >= static_cast<int>(pageLut.size())) {
+    LOG_ERR("SCT", "No LUT entry for page %d", index);
+    return nullptr;
+  }
+  if (!file && !Storage.openFileForRead("SCT", filePath, file)) {
     return nullptr;
   }
 
-  file.seek(HEADER_SIZE - sizeof(uint32_t));
-  uint32_t lutOffset;
-  serialization::readPod(file, lutOffset);
-  file.seek(lutOffset + sizeof(uint32_t) * currentPage);
-  uint32_t pagePos;
-  serialization::readPod(file, pagePos);
-  file.seek(pagePos);
-
-  auto page = Page::deserialize(file);
-  file.close();
+  // A page runs up to the start of the next one, the last page up to the LUT (or, while indexing, to the end of
+  // what has been written so far)
+  const uint32_t pageStart = pageLut[index];
+  if (!file.seek(pageStart)) {
+    LOG_ERR("SCT", "Failed to seek to page %d at %u", index, pageStart);
+    close();
+    return nullptr;
+  }
+  auto page = Page::deserialize(file, pageLut[index + 1] - pageStart, dictionary);
+  // While indexing this is the build's write handle; put it back where the writer left it
+  if (indexing && !file.seek(pageLut.back())) {
+    LOG_ERR("SCT", "Failed to restore write position %u", pageLut.back());
+  }
   return page;
 }
+
+std::unique_ptr<Page> Section::loadPageFromSectionFile() { return loadPage(currentPage); }
+
+Section::CachedPage* Section::findCachedPage(const int index) {
+  for (auto& slot : pageCache) {
+    if (slot.page && slot.index == index) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+bool Section::cachePage(const int index, const int center) {
+  HEAP_SCOPE(Page);
+  // Reuse the slot furthest from the page being shown; with three slots one is always outside center +/- 1
+  CachedPage* victim = &pageCache[0];
+  const auto distance = [center](const CachedPage& slot) {
+    return slot.page ? std::abs(slot.index - center) : INT_MAX;
+  };
+  for (auto& slot : pageCache) {
+    if (distance(slot) > distance(*victim)) {
+      victim = &slot;
+    }
+  }
+
+  // Free the old page first so its arena is back on the heap before the new one is allocated
+  victim->page.reset();
+  victim->index = -1;
+  auto page = loadPage(index);
+  if (!page) {
+    return false;
+  }
+  victim->index = index;
+  victim->page = std::move(page);
+  return true;
+}
+
+void Section::dropPageCache() {
+  HEAP_SCOPE(Page);
+  for (auto& slot : pageCache) {
+    slot.page.reset();
+    slot.index = -1;
+  }
+}
+
+const Page* Section::getCurrentPage(bool& hit) {
+  const CachedPage* cached = findCachedPage(currentPage);
+  hit = cached != nullptr;
+  if (!cached) {
+    if (!cachePage(currentPage, currentPage)) {
+      return nullptr;
+    }
+    cached = findCachedPage(currentPage);
+  }
+  return cached->page.get();
+}
+
+void Section::prefetchAdjacentPages(const bool forward) {
+  const int step = forward ? 1 : -1;
+  for (const int index : {currentPage + step, currentPage - step}) {
+    if (index >= 0 && index < pageCount && !findCachedPage(index)) {
+      cachePage(index, currentPage);
+    }
+  }
+}
@@ -1,25 +1,57 @@
 #pragma once
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "Epub.h"
+#include "Page.h"
+#include "SectionDictionary.h"
 
-class Page;
+class BufferedFsWriter;
 class GfxRenderer;
 
 class Section {
+  // Previous, current and next page
+  static constexpr int PAGE_CACHE_SLOTS = 3;
+
   std::shared_ptr<Epub> epub;
   const int spineIndex;
   GfxRenderer& renderer;
   std::string filePath;
+  // Kept open for reading while this is the active section, so a page turn is one seek and one read
   FsFile file;
+  SectionDictionary dictionary;
+  // Page start offsets followed by the LUT offset, so page i spans pageLut[i] .. pageLut[i + 1]
+  std::vector<uint32_t> pageLut;
+
+  // Recently shown and prefetched pages, so a turn to an adjacent page skips the card
+  struct CachedPage {
+    int index = -1;
+    std::unique_ptr<Page> page;
+  };
+  CachedPage pageCache[PAGE_CACHE_SLOTS];
+
+  std::atomic<bool> indexing{false};
+  unsigned long buildStartTime = 0;
 
-  void writeSectionFileHeader(int fontId, float lineCompression, bool extraParagraphSpacing, uint8_t paragraphAlignment,
-                              uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled,
-                              bool embeddedStyle);
-  uint32_t onPageComplete(std::unique_ptr<Page> page);
+  bool loadPageLut(uint32_t lutOffset);
+  std::unique_ptr<Page> loadPage(int index);
+  CachedPage* findCachedPage(int index);
+  bool cachePage(int index, int center);
+  void dropPageCache();
+
+  void writeSectionFileHeader(BufferedFsWriter& writer, int fontId, float lineCompression, bool extraParagraphSpacing,
+                              uint8_t paragraphAlignment, uint16_t viewportWidth, uint16_t viewportHeight,
+                              bool hyphenationEnabled, bool embeddedStyle);
+  uint32_t onPageComplete(BufferedFsWriter& writer, std::unique_ptr<Page> page, size_t index);
+  // Make the pages completed since the last call readable: flush them and extend pageLut / pageCount
+  void commitPages(BufferedFsWriter& writer, const std::vector<uint32_t>& lut);
 
  public:
+  // Bumped whenever the file layout or the pagination changes, which invalidates every section file
+  static constexpr uint8_t FILE_VERSION = 16;
+
   uint16_t pageCount = 0;
   int currentPage = 0;
 
@@ -28,12 +60,28 @@ class Section {
         spineIndex(spineIndex),
         renderer(renderer),
         filePath(epub->getCachePath() + "/sections/" + std::to_string(spineIndex) + ".bin") {}
-  ~Section() = default;
+  ~Section() {
+    close();
+    dropPageCache();
+  }
   bool loadSectionFile(int fontId, float lineCompression, bool extraParagraphSpacing, uint8_t paragraphAlignment,
                        uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled, bool embeddedStyle);
-  bool clearCache() const;
+  // Release the file handle, e.g. before the card is used for something else. The next page load reopens it.
+  void close();
+  bool clearCache();
+  // With a checkpointFn the build is progressive: it is meant to run off the render task (see SectionPreIndexer),
+  // and pageCount / the page loads cover the pages committed so far until isIndexing() turns false.
   bool createSectionFile(int fontId, float lineCompression, bool extraParagraphSpacing, uint8_t paragraphAlignment,
                          uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled, bool embeddedStyle,
-                         const std::function<void()>& popupFn = nullptr);
+                         const std::function<void()>& popupFn = nullptr,
+                         const std::function<bool()>& checkpointFn = nullptr);
+  // Always reads the card, for callers outside the render task
   std::unique_ptr<Page> loadPageFromSectionFile();
+  // currentPage through the page cache, or nullptr if it cannot be loaded. hit is set if it was already cached.
+  // The page stays valid until the next getCurrentPage() or prefetchAdjacentPages() call.
+  const Page* getCurrentPage(bool& hit);
+  // Load the pages either side of currentPage that are not cached yet, the one in the reading direction first
+  void prefetchAdjacentPages(bool forward);
+  // A progressive build is still running; pages past pageCount may be on their way
+  bool isIndexing() const { return indexing; }
 };
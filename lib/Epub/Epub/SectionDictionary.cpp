@@ -0,0 +1,322 @@
+#include "SectionDictionary.h"
+
+#include <Logging.h>
+#include <Serialization.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+// Inline words longer than this are treated as corrupt
+constexpr uint32_t MAX_INLINE_WORD_LEN = 4096;
+
+uint32_t fnvHash32(const char* data, const size_t len) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool sameStyle(const BlockStyle& a, const BlockStyle& b) {
+  return a.alignment == b.alignment && a.textAlignDefined == b.textAlignDefined && a.marginTop == b.marginTop &&
+         a.marginBottom == b.marginBottom && a.marginLeft == b.marginLeft && a.marginRight == b.marginRight &&
+         a.paddingTop == b.paddingTop && a.paddingBottom == b.paddingBottom && a.paddingLeft == b.paddingLeft &&
+         a.paddingRight == b.paddingRight && a.textIndent == b.textIndent &&
+         a.textIndentDefined == b.textIndentDefined;
+}
+
+template <typename Reader>
+bool readStyleFields(Reader& reader, BlockStyle& style) {
+  uint8_t flags = 0;
+  if (reader.read(&style.alignment, sizeof(style.alignment)) != sizeof(style.alignment) ||
+      reader.read(&flags, 1) != 1) {
+    return false;
+  }
+  style.textAlignDefined = (flags & 1) != 0;
+  style.textIndentDefined = (flags & 2) != 0;
+
+  int32_t values[9];
+  for (auto& value : values) {
+    if (!serialization::readVarInt(reader, value)) {
+      return false;
+    }
+  }
+  style.marginTop = static_cast<int16_t>(values[0]);
+  style.marginBottom = static_cast<int16_t>(values[1]);
+  style.marginLeft = static_cast<int16_t>(values[2]);
+  style.marginRight = static_cast<int16_t>(values[3]);
+  style.paddingTop = static_cast<int16_t>(values[4]);
+  style.paddingBottom = static_cast<int16_t>(values[5]);
+  style.paddingLeft = static_cast<int16_t>(values[6]);
+  style.paddingRight = static_cast<int16_t>(values[7]);
+  style.textIndent = static_cast<int16_t>(values[8]);
+  return true;
+}
+}  // namespace
+
+void SectionDictionary::clear() {
+  free(blob);
+  free(offsets);
+  free(slots);
+  free(seen);
+  blob = nullptr;
+  offsets = nullptr;
+  slots = nullptr;
+  seen = nullptr;
+  wordTotal = 0;
+  styles.clear();
+  styles.shrink_to_fit();
+}
+
+bool SectionDictionary::beginBuild() {
+  clear();
+  blob = static_cast<char*>(malloc(MAX_WORD_BYTES));
+  offsets = static_cast<uint16_t*>(malloc((MAX_WORDS + 1) * sizeof(uint16_t)));
+  slots = static_cast<uint16_t*>(calloc(HASH_SLOTS, sizeof(uint16_t)));
+  seen = static_cast<uint8_t*>(calloc(SEEN_BITS / 8, 1));
+  if (!blob || !offsets || !slots || !seen) {
+    LOG_ERR("SDC", "Not enough memory for word table, writing words inline");
+    clear();
+    return false;
+  }
+  offsets[0] = 0;
+  return true;
+}
+
+void SectionDictionary::endBuild() {
+  free(slots);
+  free(seen);
+  slots = nullptr;
+  seen = nullptr;
+
+  // Shrink the resident tables to what was actually used
+  if (blob && wordTotal > 0) {
+    if (auto* shrunk = static_cast<char*>(realloc(blob, offsets[wordTotal]))) {
+      blob = shrunk;
+    }
+    if (auto* shrunk = static_cast<uint16_t*>(realloc(offsets, (wordTotal + 1) * sizeof(uint16_t)))) {
+      offsets = shrunk;
+    }
+  }
+}
+
+int SectionDictionary::findOrInternWord(const std::string_view word) {
+  const size_t len = word.size();
+  if (!slots || len == 0 || len > MAX_INTERNED_WORD_LEN) {
+    return -1;
+  }
+
+  const uint32_t hash = fnvHash32(word.data(), len);
+  uint16_t slot = hash & (HASH_SLOTS - 1);
+  while (slots[slot] != 0) {
+    const uint16_t id = slots[slot] - 1;
+    const size_t stored = offsets[id + 1] - offsets[id];
+    if (stored == len + 1 && memcmp(blob + offsets[id], word.data(), len) == 0) {
+      return id;
+    }
+    slot = (slot + 1) & (HASH_SLOTS - 1);
+  }
+
+  // Only intern on the second sighting, so single-use words do not take up the table
+  const uint16_t seenBit = (hash >> 16) & (SEEN_BITS - 1);
+  if ((seen[seenBit / 8] & (1 << (seenBit % 8))) == 0) {
+    seen[seenBit / 8] |= 1 << (seenBit % 8);
+    return -1;
+  }
+
+  if (wordTotal >= MAX_WORDS || offsets[wordTotal] + len + 1 > MAX_WORD_BYTES) {
+    return -1;
+  }
+  memcpy(blob + offsets[wordTotal], word.data(), len);
+  blob[offsets[wordTotal] + len] = '\0';
+  offsets[wordTotal + 1] = offsets[wordTotal] + len + 1;
+  slots[slot] = wordTotal + 1;
+  return wordTotal++;
+}
+
+int SectionDictionary::internStyle(const BlockStyle& style) {
+  for (size_t i = 0; i < styles.size(); i++) {
+    if (sameStyle(styles[i], style)) {
+      return static_cast<int>(i);
+    }
+  }
+  if (styles.size() >= MAX_STYLES) {
+    return -1;
+  }
+  styles.push_back(style);
+  return static_cast<int>(styles.size() - 1);
+}
+
+void SectionDictionary::writeWord(BufferedFsWriter& writer, const std::string_view word) {
+  const int id = findOrInternWord(word);
+  if (id >= 0) {
+    serialization::writeVarUint(writer, static_cast<uint32_t>(id) << 1);
+    return;
+  }
+  serialization::writeVarUint(writer, static_cast<uint32_t>(word.size()) << 1 | 1);
+  writer.write(word.data(), word.size());
+}
+
+bool SectionDictionary::readWord(ByteReader& reader, std::string_view& word) const {
+  const size_t start = reader.position();
+  uint32_t ref;
+  if (!serialization::readVarUint(reader, ref)) {
+    return false;
+  }
+  if ((ref & 1) == 0) {
+    if ((ref >> 1) >= wordTotal) {
+      LOG_ERR("SDC", "Word id %u out of range (%u words)", ref >> 1, wordTotal);
+      return false;
+    }
+    word = getWord(ref >> 1);
+    return true;
+  }
+
+  // Slide the bytes back over the (at least one byte) reference to make room for the terminator
+  const uint32_t len = ref >> 1;
+  const uint8_t* bytes = len <= MAX_INLINE_WORD_LEN ? reader.take(len) : nullptr;
+  if (!bytes) {
+    LOG_ERR("SDC", "Invalid inline word of %u bytes", len);
+    return false;
+  }
+  char* dest = reinterpret_cast<char*>(reader.base() + start);
+  memmove(dest, bytes, len);
+  dest[len] = '\0';
+  word = std::string_view(dest, len);
+  return true;
+}
+
+bool SectionDictionary::skipWord(ByteReader& reader) const {
+  uint32_t ref;
+  if (!serialization::readVarUint(reader, ref)) {
+    return false;
+  }
+  if ((ref & 1) == 0) {
+    return (ref >> 1) < wordTotal;
+  }
+  return (ref >> 1) <= MAX_INLINE_WORD_LEN && reader.take(ref >> 1) != nullptr;
+}
+
+void SectionDictionary::writeStyle(BufferedFsWriter& writer, const BlockStyle& style) {
+  const int id = internStyle(style);
+  if (id >= 0) {
+    serialization::writeVarUint(writer, static_cast<uint32_t>(id) << 1);
+    return;
+  }
+  serialization::writeVarUint(writer, 1);
+  writeStyleFields(writer, style);
+}
+
+bool SectionDictionary::readStyle(ByteReader& reader, BlockStyle& style) const {
+  uint32_t ref;
+  if (!serialization::readVarUint(reader, ref)) {
+    return false;
+  }
+  if (ref & 1) {
+    return readStyleFields(reader, style);
+  }
+  if ((ref >> 1) >= styles.size()) {
+    LOG_ERR("SDC", "Style id %u out of range (%u styles)", ref >> 1, static_cast<uint32_t>(styles.size()));
+    return false;
+  }
+  style = styles[ref >> 1];
+  return true;
+}
+
+void SectionDictionary::writeStyleFields(BufferedFsWriter& writer, const BlockStyle& style) {
+  const uint8_t flags = (style.textAlignDefined ? 1 : 0) | (style.textIndentDefined ? 2 : 0);
+  serialization::writePod(writer, style.alignment);
+  serialization::writePod(writer, flags);
+  serialization::writeVarInt(writer, style.marginTop);
+  serialization::writeVarInt(writer, style.marginBottom);
+  serialization::writeVarInt(writer, style.marginLeft);
+  serialization::writeVarInt(writer, style.marginRight);
+  serialization::writeVarInt(writer, style.paddingTop);
+  serialization::writeVarInt(writer, style.paddingBottom);
+  serialization::writeVarInt(writer, style.paddingLeft);
+  serialization::writeVarInt(writer, style.paddingRight);
+  serialization::writeVarInt(writer, style.textIndent);
+}
+
+bool SectionDictionary::write(BufferedFsWriter& writer) const {
+  // The terminators are a RAM-only convenience, the file holds the bare bytes
+  const uint16_t bytes = wordTotal > 0 ? offsets[wordTotal] - wordTotal : 0;
+  serialization::writeVarUint(writer, wordTotal);
+  serialization::writeVarUint(writer, bytes);
+  for (uint16_t i = 0; i < wordTotal; i++) {
+    serialization::writeVarUint(writer, getWord(i).size());
+  }
+  for (uint16_t i = 0; i < wordTotal; i++) {
+    writer.write(blob + offsets[i], getWord(i).size());
+  }
+
+  serialization::writeVarUint(writer, styles.size());
+  for (const auto& style : styles) {
+    writeStyleFields(writer, style);
+  }
+  return !writer.hasError();
+}
+
+bool SectionDictionary::read(BufferedFsReader& reader) {
+  clear();
+
+  uint32_t count, bytes;
+  if (!serialization::readVarUint(reader, count) || !serialization::readVarUint(reader, bytes) ||
+      count > MAX_WORDS || bytes + count > MAX_WORD_BYTES) {
+    LOG_ERR("SDC", "Invalid word table header");
+    return false;
+  }
+
+  if (count > 0) {
+    offsets = static_cast<uint16_t*>(malloc((count + 1) * sizeof(uint16_t)));
+    blob = static_cast<char*>(malloc(bytes + count));
+    if (!offsets || !blob) {
+      LOG_ERR("SDC", "Not enough memory for word table (%u words, %u bytes)", count, bytes);
+      clear();
+      return false;
+    }
+    offsets[0] = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t len;
+      if (!serialization::readVarUint(reader, len) || offsets[i] + len + 1 > bytes + count) {
+        LOG_ERR("SDC", "Invalid word table entry %u", i);
+        clear();
+        return false;
+      }
+      offsets[i + 1] = offsets[i] + len + 1;
+    }
+    if (offsets[count] != bytes + count) {
+      LOG_ERR("SDC", "Word table lengths do not add up");
+      clear();
+      return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+      const int len = offsets[i + 1] - offsets[i] - 1;
+      if (reader.read(blob + offsets[i], len) != len) {
+        LOG_ERR("SDC", "Truncated word table");
+        clear();
+        return false;
+      }
+      blob[offsets[i] + len] = '\0';
+    }
+    wordTotal = count;
+  }
+
+  uint32_t styleTotal;
+  if (!serialization::readVarUint(reader, styleTotal) || styleTotal > MAX_STYLES) {
+    LOG_ERR("SDC", "Invalid style table header");
+    clear();
+    return false;
+  }
+  styles.resize(styleTotal);
+  for (auto& style : styles) {
+    if (!readStyleFields(reader, style)) {
+      LOG_ERR("SDC", "Truncated style table");
+      clear();
+      return false;
+    }
+  }
+  return true;
+}
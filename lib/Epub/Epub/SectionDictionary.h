@@ -0,0 +1,78 @@
+#pragma once
+#include <BufferedFs.h>
+#include <ByteReader.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "blocks/BlockStyle.h"
+
+// Words and block styles shared by every page of a section file.
+//
+// While a section is built, a word is interned the second time it is seen (the first occurrence is written
+// inline), so the table fills with words that actually repeat instead of whatever appeared first. The table is
+// capped at MAX_WORDS / MAX_WORD_BYTES; once full, new words are written inline. Block styles are deduplicated, so
+// every line of a paragraph references the same entry.
+//
+// The table is written after the page LUT and stays resident while the section is open, so resolving a word
+// reference never touches the card. Resident words are NUL-terminated, so a resolved word can be drawn directly.
+class SectionDictionary {
+ public:
+  static constexpr uint16_t MAX_WORDS = 1024;
+  static constexpr uint16_t MAX_WORD_BYTES = 8192;
+  static constexpr uint8_t MAX_INTERNED_WORD_LEN = 32;
+  static constexpr uint16_t MAX_STYLES = 256;
+
+  SectionDictionary() = default;
+  ~SectionDictionary() { clear(); }
+
+  SectionDictionary(const SectionDictionary&) = delete;
+  SectionDictionary& operator=(const SectionDictionary&) = delete;
+
+  void clear();
+  // Allocate the interning tables. Without them every word is written inline, which is still a valid section.
+  bool beginBuild();
+  // Drop the build-only lookup tables, keeping the words and styles for page loads
+  void endBuild();
+
+  // Word reference: varuint (id << 1) for an interned word, or (length << 1 | 1) followed by the bytes
+  void writeWord(BufferedFsWriter& writer, std::string_view word);
+  // Resolve a word reference to a NUL-terminated slice of either this table or the reader's buffer. Inline words
+  // are terminated in place, which overwrites the reference bytes, so a record can only be decoded once.
+  bool readWord(ByteReader& reader, std::string_view& word) const;
+  // Validate a word reference without touching the buffer
+  bool skipWord(ByteReader& reader) const;
+  // Style reference: varuint (id << 1), or 1 followed by the style fields
+  void writeStyle(BufferedFsWriter& writer, const BlockStyle& style);
+  bool readStyle(ByteReader& reader, BlockStyle& style) const;
+
+  bool write(BufferedFsWriter& writer) const;
+  bool read(BufferedFsReader& reader);
+
+  uint16_t wordCount() const { return wordTotal; }
+  uint16_t styleCount() const { return static_cast<uint16_t>(styles.size()); }
+  // The returned view is NUL-terminated
+  std::string_view getWord(const uint16_t id) const {
+    if (id >= wordTotal) return {};
+    return std::string_view(blob + offsets[id], offsets[id + 1] - offsets[id] - 1);
+  }
+
+ private:
+  static constexpr uint16_t HASH_SLOTS = 2048;  // Power of two, twice MAX_WORDS
+  static constexpr uint16_t SEEN_BITS = 8192;   // Power of two
+
+  char* blob = nullptr;         // Concatenated NUL-terminated words
+  uint16_t* offsets = nullptr;  // offsets[id] .. offsets[id + 1] is word id (and its terminator) in blob
+  uint16_t wordTotal = 0;
+  std::vector<BlockStyle> styles;
+
+  // Build only
+  uint16_t* slots = nullptr;  // Open addressing, id + 1 (0 = empty)
+  uint8_t* seen = nullptr;    // One bit per hash, set when a word is first written inline
+
+  int findOrInternWord(std::string_view word);
+  int internStyle(const BlockStyle& style);
+  static void writeStyleFields(BufferedFsWriter& writer, const BlockStyle& style);
+};
@@ -0,0 +1,77 @@
+#include "WordWidthCache.h"
+
+#include <Logging.h>
+
+#include <cstring>
+#include <new>
+
+WordWidthCache::Stats WordWidthCache::totals;
+
+WordWidthCache::~WordWidthCache() {
+  if (stats.hits + stats.misses > 0) {
+    LOG_DBG("WWC", "Word widths: %u hits, %u misses", stats.hits, stats.misses);
+  }
+  totals.hits += stats.hits;
+  totals.misses += stats.misses;
+  delete[] slots;
+}
+
+WordWidthCache::Entry* WordWidthCache::lookup(const int fontId, const EpdFontFamily::Style style, const char* word,
+                                             const size_t length) {
+  if (!slots) {
+    if (unavailable) {
+      return nullptr;
+    }
+    slots = new (std::nothrow) Entry[SLOTS]();
+    if (!slots) {
+      LOG_ERR("WWC", "Not enough memory for word width cache, measuring every word");
+      unavailable = true;
+      return nullptr;
+    }
+  }
+
+  // FNV-1a over the word, seeded with the font and style
+  uint32_t hash = (2166136261u ^ static_cast<uint32_t>(fontId)) * 16777619u ^ style;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ static_cast<uint8_t>(word[i])) * 16777619u;
+  }
+  hash = hash ? hash : 1;
+
+  const size_t start = hash & (SLOTS - 1);
+  Entry* victim = nullptr;
+  for (size_t i = 0; i < MAX_PROBE; i++) {
+    Entry& entry = slots[(start + i) & (SLOTS - 1)];
+    if (entry.hash == 0) {
+      // Slots are filled in probe order and never emptied, so the word cannot be further along
+      victim = &entry;
+      break;
+    }
+    if (entry.hash == hash && entry.fontId == fontId && entry.style == style && entry.length == length &&
+        memcmp(entry.word, word, length) == 0) {
+      stats.hits++;
+      entry.referenced = 1;
+      return &entry;
+    }
+  }
+  // Window full: give every word that was hit a second chance, and replace the first one that wasn't. The scan starts
+  // at a slot picked by the upper hash bits so that no slot of the window is always the first to go.
+  for (size_t i = (hash >> 24) % MAX_PROBE; !victim; i = (i + 1) % MAX_PROBE) {
+    Entry& entry = slots[(start + i) & (SLOTS - 1)];
+    if (entry.referenced) {
+      entry.referenced = 0;
+    } else {
+      victim = &entry;
+    }
+  }
+
+  stats.misses++;
+  victim->hash = hash;
+  victim->fontId = fontId;
+  victim->width = UNMEASURED;
+  victim->breaks = {UNSEARCHED, 0};
+  victim->style = style;
+  victim->length = static_cast<uint8_t>(length);
+  victim->referenced = 0;
+  memcpy(victim->word, word, length);
+  return victim;
+}
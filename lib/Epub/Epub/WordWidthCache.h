@@ -0,0 +1,97 @@
+#pragma once
+#include <EpdFontFamily.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Advance widths of the words measured while one section is laid out. Prose reuses a small vocabulary ("the", "and",
+// "said"...), so most words are measured many times per chapter, each time walking every glyph and kerning pair.
+//
+// The table is a fixed array of slots allocated on first use, keyed by font, style and the word bytes themselves, so
+// a hit is always exact. Lookups probe a short window of slots; when the window is full a new word replaces the first
+// one that has not been hit since it was last passed over (second chance), so the common words stay. Slots are never
+// emptied, which keeps the probe sequence valid without tombstones. Words longer than MAX_WORD_BYTES are measured
+// every time.
+//
+// With hyphenation on, a slot also keeps where its word may be hyphenated, which the line breaker asks for far more
+// often than it lays out lines.
+class WordWidthCache {
+ public:
+  struct Stats {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+  };
+
+  // Bit n of offsets is set when the word may be broken before byte n, and bit n of hyphens when that break needs an
+  // inserted hyphen
+  struct Breaks {
+    uint16_t offsets = 0;
+    uint16_t hyphens = 0;
+  };
+
+  static constexpr size_t SLOTS = 512;  // Power of two
+  static constexpr size_t MAX_PROBE = 8;
+  static constexpr size_t MAX_WORD_BYTES = 12;
+
+  WordWidthCache() = default;
+  ~WordWidthCache();
+
+  WordWidthCache(const WordWidthCache&) = delete;
+  WordWidthCache& operator=(const WordWidthCache&) = delete;
+
+  // The cached width of the word, or measure() of it, stored for next time
+  template <typename Measure>
+  uint16_t getOrMeasure(const int fontId, const EpdFontFamily::Style style, const char* word, const size_t length,
+                        Measure&& measure) {
+    Entry* entry = length <= MAX_WORD_BYTES ? lookup(fontId, style, word, length) : nullptr;
+    if (!entry) {
+      return measure();
+    }
+    if (entry->width == UNMEASURED) {
+      entry->width = measure();
+    }
+    return entry->width;
+  }
+
+  // The cached break points of the word, or find() of them, stored for next time
+  template <typename Find>
+  Breaks getOrFindBreaks(const int fontId, const EpdFontFamily::Style style, const char* word, const size_t length,
+                         Find&& find) {
+    Entry* entry = length <= MAX_WORD_BYTES ? lookup(fontId, style, word, length) : nullptr;
+    if (!entry) {
+      return find();
+    }
+    if (entry->breaks.offsets == UNSEARCHED) {
+      entry->breaks = find();
+    }
+    return entry->breaks;
+  }
+
+  const Stats& getStats() const { return stats; }
+  // Totals over every cache destroyed so far, for benchmarks
+  static Stats getTotals() { return totals; }
+  static void resetTotals() { totals = {}; }
+
+ private:
+  struct Entry {
+    uint32_t hash;  // 0 marks an empty slot
+    int32_t fontId;
+    uint16_t width;
+    Breaks breaks;
+    uint8_t style;
+    uint8_t length : 7;
+    uint8_t referenced : 1;  // Hit since eviction last passed over it
+    char word[MAX_WORD_BYTES];
+  };
+  static constexpr uint16_t UNMEASURED = 0xFFFF;
+  static constexpr uint16_t UNSEARCHED = 1;  // No word breaks before its first byte
+
+  // The slot of the word, claimed and set to UNMEASURED and UNSEARCHED on a miss, or null when the table can't be
+  // allocated
+  Entry* lookup(int fontId, EpdFontFamily::Style style, const char* word, size_t length);
+
+  Entry* slots = nullptr;
+  bool unavailable = false;  // Allocation failed, measure every word
+  Stats stats;
+  static Stats totals;
+};
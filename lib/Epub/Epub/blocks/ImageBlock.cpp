@@ -156,18 +156,28 @@ void ImageBlock::render(GfxRenderer& renderer, const int x, const int y) {
   LOG_DBG("IMG", "Decode successful");
 }
 
-bool ImageBlock::serialize(FsFile& file) {
+bool ImageBlock::serialize(BufferedFsWriter& file) {
   serialization::writeString(file, imagePath);
   serialization::writePod(file, width);
   serialization::writePod(file, height);
   return true;
 }
 
-std::unique_ptr<ImageBlock> ImageBlock::deserialize(FsFile& file) {
+std::unique_ptr<ImageBlock> ImageBlock::deserialize(ByteReader& file) {
   std::string path;
-  serialization::readString(file, path);
   int16_t w, h;
+  if (!serialization::readString(file, path) || file.available() < sizeof(w) + sizeof(h)) {
+    return nullptr;
+  }
   serialization::readPod(file, w);
   serialization::readPod(file, h);
   return std::unique_ptr<ImageBlock>(new ImageBlock(path, w, h));
 }
+
+bool ImageBlock::skip(ByteReader& file) {
+  uint32_t pathLen = 0;
+  if (file.read(&pathLen, sizeof(pathLen)) != sizeof(pathLen)) {
+    return false;
+  }
+  return file.take(pathLen) && file.take(sizeof(width) + sizeof(height));
+}
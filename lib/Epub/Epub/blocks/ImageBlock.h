@@ -1,5 +1,6 @@
 #pragma once
-#include <HalStorage.h>
+#include <BufferedFs.h>
+#include <ByteReader.h>
 
 #include <memory>
 #include <string>
@@ -21,8 +22,9 @@ class ImageBlock final : public Block {
   bool isEmpty() override { return false; }
 
   void render(GfxRenderer& renderer, const int x, const int y);
-  bool serialize(FsFile& file);
-  static std::unique_ptr<ImageBlock> deserialize(FsFile& file);
+  bool serialize(BufferedFsWriter& file);
+  static std::unique_ptr<ImageBlock> deserialize(ByteReader& file);
+  static bool skip(ByteReader& file);
 
  private:
   std::string imagePath;
@@ -4,22 +4,64 @@
 #include <Logging.h>
 #include <Serialization.h>
 
-void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int x, const int y) const {
-  // Validate iterator bounds before rendering
-  if (words.size() != wordXpos.size() || words.size() != wordStyles.size()) {
-    LOG_ERR("TXB", "Render skipped: size mismatch (words=%u, xpos=%u, styles=%u)\n", (uint32_t)words.size(),
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include "../PageArena.h"
+#include "../SectionDictionary.h"
+
+TextBlock::TextBlock(const std::span<const WordChunk> chunks, const std::span<const std::string_view> words,
+                     const std::span<const uint16_t> wordXpos, const std::span<const EpdFontFamily::Style> wordStyles,
+                     const BlockStyle& blockStyle)
+    : blockStyle(blockStyle) {
+  const size_t wc = words.size();
+  if (wc != wordXpos.size() || wc != wordStyles.size() || wc > MAX_WORDS || chunks.size() > UINT16_MAX) {
+    LOG_ERR("TXB", "Dropping line: size mismatch (words=%u, xpos=%u, styles=%u)", (uint32_t)wc,
             (uint32_t)wordXpos.size(), (uint32_t)wordStyles.size());
     return;
   }
 
-  for (size_t i = 0; i < words.size(); i++) {
+  // Arrays in decreasing alignment, so each one starts aligned after the one before
+  const size_t bytes = chunks.size() * sizeof(WordChunk) + wc * (sizeof(std::string_view) + sizeof(uint16_t) +
+                                                                 sizeof(EpdFontFamily::Style));
+  owned = ::operator new(bytes, std::nothrow);
+  if (!owned) {
+    LOG_ERR("TXB", "Dropping line: not enough memory for %u words", (uint32_t)wc);
+    return;
+  }
+  auto* chunkRefs = static_cast<WordChunk*>(owned);
+  auto* views = reinterpret_cast<std::string_view*>(chunkRefs + chunks.size());
+  auto* xpos = reinterpret_cast<uint16_t*>(views + wc);
+  auto* styles = reinterpret_cast<EpdFontFamily::Style*>(xpos + wc);
+  std::uninitialized_copy(chunks.begin(), chunks.end(), chunkRefs);
+  std::uninitialized_copy(words.begin(), words.end(), views);
+  std::copy(wordXpos.begin(), wordXpos.end(), xpos);
+  std::copy(wordStyles.begin(), wordStyles.end(), styles);
+
+  this->words = views;
+  this->wordXpos = xpos;
+  this->wordStyles = styles;
+  count = static_cast<uint16_t>(wc);
+  chunkCount = static_cast<uint16_t>(chunks.size());
+}
+
+TextBlock::~TextBlock() {
+  if (owned) {
+    std::destroy_n(static_cast<WordChunk*>(owned), chunkCount);
+    ::operator delete(owned);
+  }
+}
+
+void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int x, const int y) const {
+  for (size_t i = 0; i < count; i++) {
     const int wordX = wordXpos[i] + x;
     const EpdFontFamily::Style currentStyle = wordStyles[i];
-    renderer.drawText(fontId, wordX, y, words[i].c_str(), true, currentStyle);
+    renderer.drawText(fontId, wordX, y, words[i].data(), true, currentStyle);
 
     if ((currentStyle & EpdFontFamily::UNDERLINE) != 0) {
-      const std::string& w = words[i];
-      const int fullWordWidth = renderer.getTextWidth(fontId, w.c_str(), currentStyle);
+      const std::string_view w = words[i];
+      const int fullWordWidth = renderer.getTextWidth(fontId, w.data(), currentStyle);
       // y is the top of the text line; add ascender to reach baseline, then offset 2px below
       const int underlineY = y + renderer.getFontAscenderSize(fontId) + 2;
 
@@ -29,7 +71,7 @@ void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int
       // if word starts with em-space ("\xe2\x80\x83"), account for the additional indent before drawing the line
       if (w.size() >= 3 && static_cast<uint8_t>(w[0]) == 0xE2 && static_cast<uint8_t>(w[1]) == 0x80 &&
           static_cast<uint8_t>(w[2]) == 0x83) {
-        const char* visiblePtr = w.c_str() + 3;
+        const char* visiblePtr = w.data() + 3;
         const int prefixWidth = renderer.getTextAdvanceX(fontId, "\xe2\x80\x83", currentStyle);
         const int visibleWidth = renderer.getTextWidth(fontId, visiblePtr, currentStyle);
         startX = wordX + prefixWidth;
@@ -41,74 +83,128 @@ void TextBlock::render(const GfxRenderer& renderer, const int fontId, const int
   }
 }
 
-bool TextBlock::serialize(FsFile& file) const {
-  if (words.size() != wordXpos.size() || words.size() != wordStyles.size()) {
-    LOG_ERR("TXB", "Serialization failed: size mismatch (words=%u, xpos=%u, styles=%u)\n", words.size(),
-            wordXpos.size(), wordStyles.size());
-    return false;
-  }
+bool TextBlock::serialize(BufferedFsWriter& file, SectionDictionary& dictionary) const {
+  // Style (alignment + margins/padding/indent), shared by all lines of the paragraph
+  dictionary.writeStyle(file, blockStyle);
 
   // Word data
-  serialization::writePod(file, static_cast<uint16_t>(words.size()));
-  for (const auto& w : words) serialization::writeString(file, w);
-  for (auto x : wordXpos) serialization::writePod(file, x);
-  for (auto s : wordStyles) serialization::writePod(file, s);
-
-  // Style (alignment + margins/padding/indent)
-  serialization::writePod(file, blockStyle.alignment);
-  serialization::writePod(file, blockStyle.textAlignDefined);
-  serialization::writePod(file, blockStyle.marginTop);
-  serialization::writePod(file, blockStyle.marginBottom);
-  serialization::writePod(file, blockStyle.marginLeft);
-  serialization::writePod(file, blockStyle.marginRight);
-  serialization::writePod(file, blockStyle.paddingTop);
-  serialization::writePod(file, blockStyle.paddingBottom);
-  serialization::writePod(file, blockStyle.paddingLeft);
-  serialization::writePod(file, blockStyle.paddingRight);
-  serialization::writePod(file, blockStyle.textIndent);
-  serialization::writePod(file, blockStyle.textIndentDefined);
+  serialization::writeVarUint(file, count);
+  for (size_t i = 0; i < count; i++) dictionary.writeWord(file, words[i]);
+
+  // X positions as deltas from the previous word
+  int32_t prevX = 0;
+  for (size_t i = 0; i < count; i++) {
+    serialization::writeVarInt(file, wordXpos[i] - prevX);
+    prevX = wordXpos[i];
+  }
+
+  // Styles as (style, run length) pairs
+  uint32_t runCount = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (i == 0 || wordStyles[i] != wordStyles[i - 1]) runCount++;
+  }
+  serialization::writeVarUint(file, runCount);
+  for (size_t i = 0; i < count;) {
+    size_t runEnd = i + 1;
+    while (runEnd < count && wordStyles[runEnd] == wordStyles[i]) runEnd++;
+    serialization::writePod(file, wordStyles[i]);
+    serialization::writeVarUint(file, runEnd - i);
+    i = runEnd;
+  }
 
   return true;
 }
 
-std::unique_ptr<TextBlock> TextBlock::deserialize(FsFile& file) {
-  uint16_t wc;
-  std::vector<std::string> words;
-  std::vector<uint16_t> wordXpos;
-  std::vector<EpdFontFamily::Style> wordStyles;
+bool TextBlock::skip(ByteReader& reader, const SectionDictionary& dictionary, uint32_t& wordCount) {
+  BlockStyle style;
+  uint32_t wc;
+  if (!dictionary.readStyle(reader, style) || !serialization::readVarUint(reader, wc) || wc > MAX_WORDS) {
+    return false;
+  }
+  for (uint32_t i = 0; i < wc; i++) {
+    if (!dictionary.skipWord(reader)) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < wc; i++) {
+    int32_t delta;
+    if (!serialization::readVarInt(reader, delta)) {
+      return false;
+    }
+  }
+
+  uint32_t runCount;
+  if (!serialization::readVarUint(reader, runCount) || runCount > wc) {
+    return false;
+  }
+  uint32_t covered = 0;
+  for (uint32_t r = 0; r < runCount; r++) {
+    uint32_t runLength;
+    if (!reader.take(sizeof(EpdFontFamily::Style)) || !serialization::readVarUint(reader, runLength) ||
+        runLength > wc - covered) {
+      return false;
+    }
+    covered += runLength;
+  }
+  wordCount = wc;
+  return covered == wc;
+}
+
+TextBlock* TextBlock::deserialize(ByteReader& reader, const SectionDictionary& dictionary, PageArena& arena) {
   BlockStyle blockStyle;
+  uint32_t wc;
+  if (!dictionary.readStyle(reader, blockStyle) || !serialization::readVarUint(reader, wc) || wc > MAX_WORDS) {
+    LOG_ERR("TXB", "Deserialization failed: bad block header");
+    return nullptr;
+  }
 
-  // Word count
-  serialization::readPod(file, wc);
+  auto* words = arena.allocateArray<std::string_view>(wc);
+  auto* wordXpos = arena.allocateArray<uint16_t>(wc);
+  auto* wordStyles = arena.allocateArray<EpdFontFamily::Style>(wc);
+  if (!words || !wordXpos || !wordStyles) {
+    LOG_ERR("TXB", "Deserialization failed: page arena exhausted");
+    return nullptr;
+  }
 
-  // Sanity check: prevent allocation of unreasonably large vectors (max 10000 words per block)
-  if (wc > 10000) {
-    LOG_ERR("TXB", "Deserialization failed: word count %u exceeds maximum", wc);
+  for (uint32_t i = 0; i < wc; i++) {
+    if (!dictionary.readWord(reader, words[i])) {
+      LOG_ERR("TXB", "Deserialization failed: bad word reference");
+      return nullptr;
+    }
+  }
+
+  int32_t x = 0;
+  for (uint32_t i = 0; i < wc; i++) {
+    int32_t delta;
+    if (!serialization::readVarInt(reader, delta)) {
+      LOG_ERR("TXB", "Deserialization failed: truncated positions");
+      return nullptr;
+    }
+    x += delta;
+    wordXpos[i] = static_cast<uint16_t>(x);
+  }
+
+  uint32_t runCount;
+  if (!serialization::readVarUint(reader, runCount) || runCount > wc) {
+    LOG_ERR("TXB", "Deserialization failed: bad style runs");
+    return nullptr;
+  }
+  uint32_t covered = 0;
+  for (uint32_t r = 0; r < runCount; r++) {
+    EpdFontFamily::Style style;
+    uint32_t runLength;
+    if (reader.read(&style, sizeof(style)) != sizeof(style) || !serialization::readVarUint(reader, runLength) ||
+        runLength > wc - covered) {
+      LOG_ERR("TXB", "Deserialization failed: bad style runs");
+      return nullptr;
+    }
+    std::fill_n(wordStyles + covered, runLength, style);
+    covered += runLength;
+  }
+  if (covered != wc) {
+    LOG_ERR("TXB", "Deserialization failed: style runs cover %u of %u words", covered, wc);
     return nullptr;
   }
 
-  // Word data
-  words.resize(wc);
-  wordXpos.resize(wc);
-  wordStyles.resize(wc);
-  for (auto& w : words) serialization::readString(file, w);
-  for (auto& x : wordXpos) serialization::readPod(file, x);
-  for (auto& s : wordStyles) serialization::readPod(file, s);
-
-  // Style (alignment + margins/padding/indent)
-  serialization::readPod(file, blockStyle.alignment);
-  serialization::readPod(file, blockStyle.textAlignDefined);
-  serialization::readPod(file, blockStyle.marginTop);
-  serialization::readPod(file, blockStyle.marginBottom);
-  serialization::readPod(file, blockStyle.marginLeft);
-  serialization::readPod(file, blockStyle.marginRight);
-  serialization::readPod(file, blockStyle.paddingTop);
-  serialization::readPod(file, blockStyle.paddingBottom);
-  serialization::readPod(file, blockStyle.paddingLeft);
-  serialization::readPod(file, blockStyle.paddingRight);
-  serialization::readPod(file, blockStyle.textIndent);
-  serialization::readPod(file, blockStyle.textIndentDefined);
-
-  return std::unique_ptr<TextBlock>(
-      new TextBlock(std::move(words), std::move(wordXpos), std::move(wordStyles), blockStyle));
+  return arena.create<TextBlock>(words, wordXpos, wordStyles, static_cast<uint16_t>(wc), blockStyle);
 }
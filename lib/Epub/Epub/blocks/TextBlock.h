@@ -1,38 +1,66 @@
 #pragma once
+#include <BufferedFs.h>
+#include <ByteReader.h>
 #include <EpdFontFamily.h>
-#include <HalStorage.h>
 
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Block.h"
 #include "BlockStyle.h"
 
-// Represents a line of text on a page
+class PageArena;
+class SectionDictionary;
+
+// Represents a line of text on a page.
+//
+// Lines produced by layout point into the word chunks of the paragraph they were laid out from, and hold a reference
+// to each chunk they use. Lines loaded from a section file are views into the page's PageArena (and the section
+// dictionary), which must outlive them. Either way every word is NUL-terminated.
 class TextBlock final : public Block {
+ public:
+  // Block of word bytes shared by a paragraph being laid out and the lines laid out from it
+  using WordChunk = std::shared_ptr<char[]>;
+
  private:
-  std::vector<std::string> words;
-  std::vector<uint16_t> wordXpos;
-  std::vector<EpdFontFamily::Style> wordStyles;
+  const std::string_view* words = nullptr;
+  const uint16_t* wordXpos = nullptr;
+  const EpdFontFamily::Style* wordStyles = nullptr;
+  uint16_t count = 0;
+  uint16_t chunkCount = 0;
   BlockStyle blockStyle;
+  // Only for lines built by layout: the chunk references, then the word, x position and style arrays
+  void* owned = nullptr;
 
  public:
-  explicit TextBlock(std::vector<std::string> words, std::vector<uint16_t> word_xpos,
-                     std::vector<EpdFontFamily::Style> word_styles, const BlockStyle& blockStyle = BlockStyle())
-      : words(std::move(words)),
-        wordXpos(std::move(word_xpos)),
-        wordStyles(std::move(word_styles)),
-        blockStyle(blockStyle) {}
-  ~TextBlock() override = default;
+  static constexpr uint16_t MAX_WORDS = 10000;
+
+  // A line built by layout. The arrays are copied into a single heap block; the words must point into the chunks.
+  TextBlock(std::span<const WordChunk> chunks, std::span<const std::string_view> words,
+            std::span<const uint16_t> wordXpos, std::span<const EpdFontFamily::Style> wordStyles,
+            const BlockStyle& blockStyle = BlockStyle());
+  TextBlock(const std::string_view* words, const uint16_t* wordXpos, const EpdFontFamily::Style* wordStyles,
+            const uint16_t count, const BlockStyle& blockStyle)
+      : words(words), wordXpos(wordXpos), wordStyles(wordStyles), count(count), blockStyle(blockStyle) {}
+  ~TextBlock() override;
+
+  TextBlock(const TextBlock&) = delete;
+  TextBlock& operator=(const TextBlock&) = delete;
+
   void setBlockStyle(const BlockStyle& blockStyle) { this->blockStyle = blockStyle; }
   const BlockStyle& getBlockStyle() const { return blockStyle; }
-  const std::vector<std::string>& getWords() const { return words; }
-  bool isEmpty() override { return words.empty(); }
-  size_t wordCount() const { return words.size(); }
+  std::span<const std::string_view> getWords() const { return {words, count}; }
+  bool isEmpty() override { return count == 0; }
+  size_t wordCount() const { return count; }
   // given a renderer works out where to break the words into lines
   void render(const GfxRenderer& renderer, int fontId, int x, int y) const;
   BlockType getType() override { return TEXT_BLOCK; }
-  bool serialize(FsFile& file) const;
-  static std::unique_ptr<TextBlock> deserialize(FsFile& file);
+  bool serialize(BufferedFsWriter& file, SectionDictionary& dictionary) const;
+  // Validate a serialized block and count its words without modifying the buffer
+  static bool skip(ByteReader& reader, const SectionDictionary& dictionary, uint32_t& wordCount);
+  // Decode a block validated by skip() into the arena. Inline words are terminated in place in the reader's buffer.
+  static TextBlock* deserialize(ByteReader& reader, const SectionDictionary& dictionary, PageArena& arena);
 };
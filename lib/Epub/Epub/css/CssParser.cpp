@@ -1,6 +1,8 @@
 #include "CssParser.h"
 
 #include <Arduino.h>
+#include <BufferedFs.h>
+#include <HeapTrace.h>
 #include <Logging.h>
 
 #include <algorithm>
@@ -433,12 +435,9 @@ void CssParser::processRuleBlockWithStyle(const std::string& selectorGroup, cons
 
 // Main parsing entry point
 
-bool CssParser::loadFromStream(FsFile& source) {
-  if (!source) {
-    LOG_ERR("CSS", "Cannot read from invalid file");
-    return false;
-  }
-
+template <typename ReadChunk>
+bool CssParser::parseChunks(ReadChunk&& readChunk) {
+  HEAP_SCOPE(Css);
   size_t totalRead = 0;
 
   // Use stack-allocated buffers for parsing to avoid heap reallocations
@@ -531,9 +530,13 @@ bool CssParser::loadFromStream(FsFile& source) {
   };
 
   char buffer[READ_BUFFER_SIZE];
-  while (source.available()) {
-    int bytesRead = source.read(buffer, sizeof(buffer));
-    if (bytesRead <= 0) break;
+  while (true) {
+    const int bytesRead = readChunk(buffer, sizeof(buffer));
+    if (bytesRead < 0) {
+      LOG_ERR("CSS", "Read failed after %zu bytes", totalRead);
+      return false;
+    }
+    if (bytesRead == 0) break;
 
     totalRead += static_cast<size_t>(bytesRead);
 
@@ -579,6 +582,28 @@ bool CssParser::loadFromStream(FsFile& source) {
   return true;
 }
 
+bool CssParser::loadFromStream(FsFile& source) {
+  if (!source) {
+    LOG_ERR("CSS", "Cannot read from invalid file");
+    return false;
+  }
+
+  return parseChunks([&source](char* buffer, const size_t size) {
+    return source.available() ? static_cast<int>(source.read(buffer, size)) : 0;
+  });
+}
+
+bool CssParser::loadFromStream(ZipFile::EntryReader& source) {
+  if (!source.isOpen()) {
+    LOG_ERR("CSS", "Cannot read from closed zip entry");
+    return false;
+  }
+
+  return parseChunks([&source](char* buffer, const size_t size) {
+    return source.read(reinterpret_cast<uint8_t*>(buffer), size);
+  });
+}
+
 // Style resolution
 
 CssStyle CssParser::resolveStyle(const std::string& tagName, const std::string& classAttr) const {
@@ -633,6 +658,11 @@ CssStyle CssParser::resolveStyle(const std::string& tagName, const std::string&
 
 CssStyle CssParser::parseInlineStyle(const std::string& styleValue) { return parseDeclarations(styleValue); }
 
+void CssParser::clear() {
+  HEAP_SCOPE(Css);
+  rulesBySelector_.clear();
+}
+
 // Cache serialization
 
 // Cache file name (version is CssParser::CSS_CACHE_VERSION)
@@ -653,32 +683,33 @@ bool CssParser::saveToCache() const {
   if (!Storage.openFileForWrite("CSS", cachePath + rulesCache, file)) {
     return false;
   }
+  BufferedFsWriter writer(file);
 
   // Write version
-  file.write(CssParser::CSS_CACHE_VERSION);
+  writer.write(CssParser::CSS_CACHE_VERSION);
 
   // Write rule count
   const auto ruleCount = static_cast<uint16_t>(rulesBySelector_.size());
-  file.write(reinterpret_cast<const uint8_t*>(&ruleCount), sizeof(ruleCount));
+  writer.write(reinterpret_cast<const uint8_t*>(&ruleCount), sizeof(ruleCount));
 
   // Write each rule: selector string + CssStyle fields
   for (const auto& pair : rulesBySelector_) {
     // Write selector string (length-prefixed)
     const auto selectorLen = static_cast<uint16_t>(pair.first.size());
-    file.write(reinterpret_cast<const uint8_t*>(&selectorLen), sizeof(selectorLen));
-    file.write(reinterpret_cast<const uint8_t*>(pair.first.data()), selectorLen);
+    writer.write(reinterpret_cast<const uint8_t*>(&selectorLen), sizeof(selectorLen));
+    writer.write(reinterpret_cast<const uint8_t*>(pair.first.data()), selectorLen);
 
     // Write CssStyle fields (all are POD types)
     const CssStyle& style = pair.second;
-    file.write(static_cast<uint8_t>(style.textAlign));
-    file.write(static_cast<uint8_t>(style.fontStyle));
-    file.write(static_cast<uint8_t>(style.fontWeight));
-    file.write(static_cast<uint8_t>(style.textDecoration));
+    writer.write(static_cast<uint8_t>(style.textAlign));
+    writer.write(static_cast<uint8_t>(style.fontStyle));
+    writer.write(static_cast<uint8_t>(style.fontWeight));
+    writer.write(static_cast<uint8_t>(style.textDecoration));
 
     // Write CssLength fields (value + unit)
-    auto writeLength = [&file](const CssLength& len) {
-      file.write(reinterpret_cast<const uint8_t*>(&len.value), sizeof(len.value));
-      file.write(static_cast<uint8_t>(len.unit));
+    auto writeLength = [&writer](const CssLength& len) {
+      writer.write(reinterpret_cast<const uint8_t*>(&len.value), sizeof(len.value));
+      writer.write(static_cast<uint8_t>(len.unit));
     };
 
     writeLength(style.textIndent);
@@ -710,7 +741,14 @@ bool CssParser::saveToCache() const {
     if (style.defined.paddingRight) definedBits |= 1 << 12;
     if (style.defined.imageHeight) definedBits |= 1 << 13;
     if (style.defined.imageWidth) definedBits |= 1 << 14;
-    file.write(reinterpret_cast<const uint8_t*>(&definedBits), sizeof(definedBits));
+    writer.write(reinterpret_cast<const uint8_t*>(&definedBits), sizeof(definedBits));
+  }
+
+  if (!writer.flush()) {
+    LOG_ERR("CSS", "Failed to write rules cache");
+    file.close();
+    Storage.remove((cachePath + rulesCache).c_str());
+    return false;
   }
 
   LOG_DBG("CSS", "Saved %u rules to cache", ruleCount);
@@ -719,6 +757,7 @@ bool CssParser::saveToCache() const {
 }
 
 bool CssParser::loadFromCache() {
+  HEAP_SCOPE(Css);
   if (cachePath.empty()) {
     return false;
   }
@@ -727,13 +766,14 @@ bool CssParser::loadFromCache() {
   if (!Storage.openFileForRead("CSS", cachePath + rulesCache, file)) {
     return false;
   }
+  BufferedFsReader reader(file);
 
   // Clear existing rules
   clear();
 
   // Read and verify version
   uint8_t version = 0;
-  if (file.read(&version, 1) != 1 || version != CssParser::CSS_CACHE_VERSION) {
+  if (reader.read(&version, 1) != 1 || version != CssParser::CSS_CACHE_VERSION) {
     LOG_DBG("CSS", "Cache version mismatch (got %u, expected %u), removing stale cache for rebuild", version,
             CssParser::CSS_CACHE_VERSION);
     file.close();
@@ -743,7 +783,7 @@ bool CssParser::loadFromCache() {
 
   // Read rule count
   uint16_t ruleCount = 0;
-  if (file.read(&ruleCount, sizeof(ruleCount)) != sizeof(ruleCount)) {
+  if (reader.read(&ruleCount, sizeof(ruleCount)) != sizeof(ruleCount)) {
     file.close();
     return false;
   }
@@ -752,7 +792,7 @@ bool CssParser::loadFromCache() {
   for (uint16_t i = 0; i < ruleCount; ++i) {
     // Read selector string
     uint16_t selectorLen = 0;
-    if (file.read(&selectorLen, sizeof(selectorLen)) != sizeof(selectorLen)) {
+    if (reader.read(&selectorLen, sizeof(selectorLen)) != sizeof(selectorLen)) {
       rulesBySelector_.clear();
       file.close();
       return false;
@@ -760,7 +800,7 @@ bool CssParser::loadFromCache() {
 
     std::string selector;
     selector.resize(selectorLen);
-    if (file.read(&selector[0], selectorLen) != selectorLen) {
+    if (reader.read(&selector[0], selectorLen) != selectorLen) {
       rulesBySelector_.clear();
       file.close();
       return false;
@@ -770,28 +810,28 @@ bool CssParser::loadFromCache() {
     CssStyle style;
     uint8_t enumVal;
 
-    if (file.read(&enumVal, 1) != 1) {
+    if (reader.read(&enumVal, 1) != 1) {
       rulesBySelector_.clear();
       file.close();
       return false;
     }
     style.textAlign = static_cast<CssTextAlign>(enumVal);
 
-    if (file.read(&enumVal, 1) != 1) {
+    if (reader.read(&enumVal, 1) != 1) {
       rulesBySelector_.clear();
       file.close();
       return false;
     }
     style.fontStyle = static_cast<CssFontStyle>(enumVal);
 
-    if (file.read(&enumVal, 1) != 1) {
+    if (reader.read(&enumVal, 1) != 1) {
       rulesBySelector_.clear();
       file.close();
       return false;
     }
     style.fontWeight = static_cast<CssFontWeight>(enumVal);
 
-    if (file.read(&enumVal, 1) != 1) {
+    if (reader.read(&enumVal, 1) != 1) {
       rulesBySelector_.clear();
       file.close();
       return false;
@@ -799,12 +839,12 @@ bool CssParser::loadFromCache() {
     style.textDecoration = static_cast<CssTextDecoration>(enumVal);
 
     // Read CssLength fields
-    auto readLength = [&file](CssLength& len) -> bool {
-      if (file.read(&len.value, sizeof(len.value)) != sizeof(len.value)) {
+    auto readLength = [&reader](CssLength& len) -> bool {
+      if (reader.read(&len.value, sizeof(len.value)) != sizeof(len.value)) {
         return false;
       }
       uint8_t unitVal;
-      if (file.read(&unitVal, 1) != 1) {
+      if (reader.read(&unitVal, 1) != 1) {
         return false;
       }
       len.unit = static_cast<CssUnit>(unitVal);
@@ -822,7 +862,7 @@ bool CssParser::loadFromCache() {
 
     // Read defined flags
     uint16_t definedBits = 0;
-    if (file.read(&definedBits, sizeof(definedBits)) != sizeof(definedBits)) {
+    if (reader.read(&definedBits, sizeof(definedBits)) != sizeof(definedBits)) {
       rulesBySelector_.clear();
       file.close();
       return false;
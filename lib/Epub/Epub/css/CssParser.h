@@ -1,6 +1,7 @@
 #pragma once
 
 #include <HalStorage.h>
+#include <ZipFile.h>
 
 #include <string>
 #include <unordered_map>
@@ -34,7 +35,7 @@ class CssParser {
   static constexpr uint8_t CSS_CACHE_VERSION = 3;
 
   explicit CssParser(std::string cachePath) : cachePath(std::move(cachePath)) {}
-  ~CssParser() = default;
+  ~CssParser() { clear(); }
 
   // Non-copyable
   CssParser(const CssParser&) = delete;
@@ -48,6 +49,13 @@ class CssParser {
    */
   bool loadFromStream(FsFile& source);
 
+  /**
+   * Load and parse CSS inflated on the fly from an EPUB entry, without staging it on SD.
+   * @param source Open entry reader to consume
+   * @return true if parsing completed (even if no rules found)
+   */
+  bool loadFromStream(ZipFile::EntryReader& source);
+
   /**
    * Look up the style for an HTML element, considering tag name and class attributes.
    * Applies CSS cascade: element style < class style < element.class style
@@ -78,7 +86,7 @@ class CssParser {
   /**
    * Clear all loaded rules
    */
-  void clear() { rulesBySelector_.clear(); }
+  void clear();
 
   /**
    * Check if CSS rules cache file exists
@@ -110,6 +118,9 @@ class CssParser {
   std::string cachePath;
 
   // Internal parsing helpers
+  // readChunk(buffer, size) returns bytes read, 0 at end of input, or a negative value on error
+  template <typename ReadChunk>
+  bool parseChunks(ReadChunk&& readChunk);
   void processRuleBlockWithStyle(const std::string& selectorGroup, const CssStyle& style);
   static CssStyle parseDeclarations(const std::string& declBlock);
   static void parseDeclarationIntoStyle(const std::string& decl, CssStyle& style, std::string& propNameBuf,
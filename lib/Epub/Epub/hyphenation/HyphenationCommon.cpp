@@ -168,13 +168,14 @@ void trimSurroundingPunctuationAndFootnote(std::vector<CodepointInfo>& cps) {
   }
 }
 
-std::vector<CodepointInfo> collectCodepoints(const std::string& word) {
+std::vector<CodepointInfo> collectCodepoints(const std::string_view word) {
   std::vector<CodepointInfo> cps;
   cps.reserve(word.size());
 
-  const unsigned char* base = reinterpret_cast<const unsigned char*>(word.c_str());
+  const unsigned char* base = reinterpret_cast<const unsigned char*>(word.data());
+  const unsigned char* end = base + word.size();
   const unsigned char* ptr = base;
-  while (*ptr != 0) {
+  while (ptr < end && *ptr != 0) {
     const unsigned char* current = ptr;
     const uint32_t cp = utf8NextCodepoint(&ptr);
     // If this is a combining diacritic (e.g., U+0301 = acute) and there's
@@ -2,7 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <string>
+#include <string_view>
 #include <vector>
 
 struct CodepointInfo {
@@ -22,4 +22,4 @@ bool isAsciiDigit(uint32_t cp);
 bool isExplicitHyphen(uint32_t cp);
 bool isSoftHyphen(uint32_t cp);
 void trimSurroundingPunctuationAndFootnote(std::vector<CodepointInfo>& cps);
-std::vector<CodepointInfo> collectCodepoints(const std::string& word);
+std::vector<CodepointInfo> collectCodepoints(std::string_view word);
@@ -1,5 +1,7 @@
 #include "Hyphenator.h"
 
+#include <Utf8.h>
+
 #include <algorithm>
 #include <vector>
 
@@ -33,6 +35,24 @@ size_t byteOffsetForIndex(const std::vector<CodepointInfo>& cps, const size_t in
   return (index < cps.size()) ? cps[index].byteOffset : (cps.empty() ? 0 : cps.back().byteOffset);
 }
 
+// True when the word has fewer than minLetters codepoints and no explicit hyphen, so it has no break of any kind.
+// Checked before decoding the word, because most words of running text are this short.
+bool tooShortToBreak(const std::string_view word, const size_t minLetters) {
+  size_t count = 0;
+  const auto* ptr = reinterpret_cast<const unsigned char*>(word.data());
+  const auto* end = ptr + word.size();
+  while (ptr < end) {
+    const uint32_t cp = utf8NextCodepoint(&ptr);
+    if (cp == 0) {
+      break;
+    }
+    if (isExplicitHyphen(cp) || ++count >= minLetters) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Builds a vector of break information from explicit hyphen markers in the given codepoints.
 // Only hyphens that appear between two alphabetic characters are considered valid breaks.
 //
@@ -61,15 +81,17 @@ std::vector<Hyphenator::BreakInfo> buildExplicitBreakInfos(const std::vector<Cod
 
 }  // namespace
 
-std::vector<Hyphenator::BreakInfo> Hyphenator::breakOffsets(const std::string& word, const bool includeFallback) {
-  if (word.empty()) {
+std::vector<Hyphenator::BreakInfo> Hyphenator::breakOffsets(const std::string_view word, const bool includeFallback) {
+  const auto* hyphenator = cachedHyphenator_;
+  const size_t minPrefix = hyphenator ? hyphenator->minPrefix() : LiangWordConfig::kDefaultMinPrefix;
+  const size_t minSuffix = hyphenator ? hyphenator->minSuffix() : LiangWordConfig::kDefaultMinSuffix;
+  if (word.empty() || tooShortToBreak(word, minPrefix + minSuffix)) {
     return {};
   }
 
   // Convert to codepoints and normalize word boundaries.
   auto cps = collectCodepoints(word);
   trimSurroundingPunctuationAndFootnote(cps);
-  const auto* hyphenator = cachedHyphenator_;
 
   // Explicit hyphen markers (soft or hard) take precedence over language breaks.
   auto explicitBreakInfos = buildExplicitBreakInfos(cps);
@@ -122,8 +144,6 @@ std::vector<Hyphenator::BreakInfo> Hyphenator::breakOffsets(const std::string& w
 
   // Only add fallback breaks if needed
   if (includeFallback && indexes.empty()) {
-    const size_t minPrefix = hyphenator ? hyphenator->minPrefix() : LiangWordConfig::kDefaultMinPrefix;
-    const size_t minSuffix = hyphenator ? hyphenator->minSuffix() : LiangWordConfig::kDefaultMinSuffix;
     for (size_t idx = minPrefix; idx + minSuffix <= cps.size(); ++idx) {
       indexes.push_back(idx);
     }
@@ -142,4 +162,41 @@ std::vector<Hyphenator::BreakInfo> Hyphenator::breakOffsets(const std::string& w
   return breaks;
 }
 
+Hyphenator::BreakInfo Hyphenator::shortestBreak(const std::string_view word) {
+  const auto* hyphenator = cachedHyphenator_;
+  const size_t minPrefix = hyphenator ? hyphenator->minPrefix() : LiangWordConfig::kDefaultMinPrefix;
+  const size_t minSuffix = hyphenator ? hyphenator->minSuffix() : LiangWordConfig::kDefaultMinSuffix;
+
+  // One pass over the word counts its codepoints, finds any explicit hyphen, and notes where the first two and the
+  // first minPrefix codepoints end
+  bool hasExplicitHyphen = false;
+  size_t count = 0;
+  size_t twoEnd = word.size();
+  size_t minPrefixEnd = word.size();
+  const auto* begin = reinterpret_cast<const unsigned char*>(word.data());
+  const auto* end = begin + word.size();
+  for (const auto* ptr = begin; ptr < end;) {
+    const uint32_t cp = utf8NextCodepoint(&ptr);
+    if (cp == 0) {
+      break;
+    }
+    hasExplicitHyphen = hasExplicitHyphen || isExplicitHyphen(cp);
+    ++count;
+    if (count == 2) {
+      twoEnd = static_cast<size_t>(ptr - begin);
+    }
+    if (count == minPrefix) {
+      minPrefixEnd = static_cast<size_t>(ptr - begin);
+    }
+  }
+  if (!hasExplicitHyphen && (count < minPrefix + minSuffix || !hyphenator)) {
+    return {0, false};
+  }
+
+  // An explicit hyphen may follow the first letter, and needs no hyphen added. Pattern breaks keep at least minPrefix
+  // letters after any leading punctuation, so the first minPrefix codepoints are always part of them.
+  const size_t offset = hasExplicitHyphen ? twoEnd : minPrefixEnd;
+  return offset < word.size() ? BreakInfo{offset, !hasExplicitHyphen} : BreakInfo{0, false};
+}
+
 void Hyphenator::setPreferredLanguage(const std::string& lang) { cachedHyphenator_ = hyphenatorForLanguage(lang); }
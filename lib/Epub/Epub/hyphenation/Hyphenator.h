@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class LanguageHyphenator;
@@ -27,7 +28,13 @@ class Hyphenator {
   //   3. Fallback every-N-chars splitting (only when includeFallback is true AND no
   //      pattern breaks were found). Used as a last resort to prevent a single oversized
   //      word from overflowing the page width.
-  static std::vector<BreakInfo> breakOffsets(const std::string& word, bool includeFallback);
+  static std::vector<BreakInfo> breakOffsets(std::string_view word, bool includeFallback);
+
+  // Returns a prefix that every break breakOffsets(word, false) finds leaves on the line, or more: the first letters
+  // that the shortest pattern break keeps, with its hyphen, or for words with explicit hyphens just their first two
+  // codepoints. Cheap next to finding the breaks, so a line breaker can pass over words whose breaks can't fit.
+  // byteOffset is 0 when the word has no breaks at all.
+  static BreakInfo shortestBreak(std::string_view word);
 
   // Provide a publication-level language hint (e.g. "en", "en-US", "ru") used to select hyphenation rules.
   static void setPreferredLanguage(const std::string& lang);
@@ -319,6 +319,7 @@ std::vector<size_t> collectBreakIndexes(const std::vector<CodepointInfo>& cps, c
   if (cpCount < 2) {
     return indexes;
   }
+  indexes.reserve(cpCount);
 
   for (size_t breakIndex = 1; breakIndex < cpCount; ++breakIndex) {
     if (breakIndex < minPrefix) {
@@ -375,11 +376,10 @@ std::vector<size_t> liangBreakIndexes(const std::vector<CodepointInfo>& cps,
     AutomatonState state = root;
 
     for (size_t cursor = byteStart; cursor < augmented.byteLen; ++cursor) {
-      AutomatonState next;
-      if (!transition(automaton, state, augmented.bytes[cursor], next)) {
+      // transition() reads everything it needs from `state` before overwriting it.
+      if (!transition(automaton, state, augmented.bytes[cursor], state)) {
         break;  // No more matches for this prefix.
       }
-      state = next;
 
       if (state.levels && state.levelsLen > 0) {
         size_t offset = 0;
@@ -3,6 +3,7 @@
 #include <FsHelpers.h>
 #include <GfxRenderer.h>
 #include <HalStorage.h>
+#include <HeapTrace.h>
 #include <Logging.h>
 #include <expat.h>
 
@@ -138,7 +139,7 @@ void ChapterHtmlSlimParser::startNewTextBlock(const BlockStyle& blockStyle) {
 
     makePages();
   }
-  currentTextBlock.reset(new ParsedText(extraParagraphSpacing, hyphenationEnabled, blockStyle));
+  currentTextBlock.reset(new ParsedText(extraParagraphSpacing, hyphenationEnabled, blockStyle, &wordWidthCache));
   wordsExtractedInBlock = 0;
 }
 
@@ -897,7 +898,10 @@ void XMLCALL ChapterHtmlSlimParser::endElement(void* userData, const XML_Char* n
   }
 }
 
-bool ChapterHtmlSlimParser::parseAndBuildPages() {
+template <typename ReadChunk>
+bool ChapterHtmlSlimParser::parseSource(const size_t sourceSize, ReadChunk&& readChunk) {
+  HEAP_SCOPE(Parser);
+  sourceReadFailed = false;
   auto paragraphAlignmentBlockStyle = BlockStyle();
   paragraphAlignmentBlockStyle.textAlignDefined = true;
   // Resolve None sentinel to Justify for initial block (no CSS context yet)
@@ -919,14 +923,8 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
   // Using DefaultHandlerExpand preserves normal entity expansion from DOCTYPE
   XML_SetDefaultHandlerExpand(parser, defaultHandlerExpand);
 
-  FsFile file;
-  if (!Storage.openFileForRead("EHP", filepath, file)) {
-    XML_ParserFree(parser);
-    return false;
-  }
-
-  // Get file size to decide whether to show indexing popup.
-  if (popupFn && file.size() >= MIN_SIZE_FOR_POPUP) {
+  // Use the source size to decide whether to show indexing popup.
+  if (popupFn && sourceSize >= MIN_SIZE_FOR_POPUP) {
     popupFn();
   }
 
@@ -937,6 +935,16 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
   // Compute the time taken to parse and build pages
   const uint32_t chapterStartTime = millis();
   do {
+    // Lets a background build hand the card back between chunks, or stop early
+    if (checkpointFn && !checkpointFn()) {
+      LOG_DBG("EHP", "Parse stopped at checkpoint");
+      XML_StopParser(parser, XML_FALSE);                // Stop any pending processing
+      XML_SetElementHandler(parser, nullptr, nullptr);  // Clear callbacks
+      XML_SetCharacterDataHandler(parser, nullptr);
+      XML_ParserFree(parser);
+      return false;
+    }
+
     void* const buf = XML_GetBuffer(parser, PARSE_BUFFER_SIZE);
     if (!buf) {
       LOG_ERR("EHP", "Couldn't allocate memory for buffer");
@@ -944,32 +952,29 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
       XML_SetElementHandler(parser, nullptr, nullptr);  // Clear callbacks
       XML_SetCharacterDataHandler(parser, nullptr);
       XML_ParserFree(parser);
-      file.close();
       return false;
     }
 
-    const size_t len = file.read(buf, PARSE_BUFFER_SIZE);
-
-    if (len == 0 && file.available() > 0) {
-      LOG_ERR("EHP", "File read error");
+    // Fill expat's buffer in place; a zero-length read marks the end of the input
+    const int len = readChunk(buf, PARSE_BUFFER_SIZE);
+    if (len < 0) {
+      sourceReadFailed = true;
       XML_StopParser(parser, XML_FALSE);                // Stop any pending processing
       XML_SetElementHandler(parser, nullptr, nullptr);  // Clear callbacks
       XML_SetCharacterDataHandler(parser, nullptr);
       XML_ParserFree(parser);
-      file.close();
       return false;
     }
 
-    done = file.available() == 0;
+    done = len == 0;
 
-    if (XML_ParseBuffer(parser, static_cast<int>(len), done) == XML_STATUS_ERROR) {
+    if (XML_ParseBuffer(parser, len, done) == XML_STATUS_ERROR) {
       LOG_ERR("EHP", "Parse error at line %lu:\n%s", XML_GetCurrentLineNumber(parser),
               XML_ErrorString(XML_GetErrorCode(parser)));
       XML_StopParser(parser, XML_FALSE);                // Stop any pending processing
       XML_SetElementHandler(parser, nullptr, nullptr);  // Clear callbacks
       XML_SetCharacterDataHandler(parser, nullptr);
       XML_ParserFree(parser);
-      file.close();
       return false;
     }
   } while (!done);
@@ -979,7 +984,6 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
   XML_SetElementHandler(parser, nullptr, nullptr);  // Clear callbacks
   XML_SetCharacterDataHandler(parser, nullptr);
   XML_ParserFree(parser);
-  file.close();
 
   // Process last page if there is still text
   if (currentTextBlock) {
@@ -992,10 +996,40 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
   return true;
 }
 
+bool ChapterHtmlSlimParser::parseAndBuildPages() {
+  FsFile file;
+  if (!Storage.openFileForRead("EHP", filepath, file)) {
+    return false;
+  }
+
+  const bool success = parseSource(file.size(), [&file](void* buf, const size_t len) {
+    const int read = file.read(buf, len);
+    if (read <= 0 && file.available() > 0) {
+      LOG_ERR("EHP", "File read error");
+      return -1;
+    }
+    return read < 0 ? 0 : read;
+  });
+  file.close();
+  return success;
+}
+
+bool ChapterHtmlSlimParser::parseAndBuildPages(ZipFile::EntryReader& source) {
+  if (!source.isOpen()) {
+    LOG_ERR("EHP", "Chapter entry is not open");
+    return false;
+  }
+
+  return parseSource(source.size(),
+                     [&source](void* buf, const size_t len) { return source.read(static_cast<uint8_t*>(buf), len); });
+}
+
 void ChapterHtmlSlimParser::addLineToPage(std::shared_ptr<TextBlock> line) {
   const int lineHeight = renderer.getLineHeight(fontId) * lineCompression;
 
   if (currentPageNextY + lineHeight > viewportHeight) {
+    // A full page is the most the parser holds at once
+    HEAP_SAMPLE();
     completePageFn(std::move(currentPage));
     currentPage.reset(new Page());
     currentPageNextY = 0;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <ZipFile.h>
 #include <expat.h>
 
 #include <climits>
@@ -9,6 +10,7 @@
 
 #include "../FootnoteEntry.h"
 #include "../ParsedText.h"
+#include "../WordWidthCache.h"
 #include "../blocks/ImageBlock.h"
 #include "../blocks/TextBlock.h"
 #include "../css/CssParser.h"
@@ -25,7 +27,8 @@ class ChapterHtmlSlimParser {
   const std::string& filepath;
   GfxRenderer& renderer;
   std::function<void(std::unique_ptr<Page>)> completePageFn;
-  std::function<void()> popupFn;  // Popup callback
+  std::function<void()> popupFn;       // Popup callback
+  std::function<bool()> checkpointFn;  // Called between input chunks, returning false stops the parse
   int depth = 0;
   int skipUntilDepth = INT_MAX;
   int boldUntilDepth = INT_MAX;
@@ -37,6 +40,7 @@ class ChapterHtmlSlimParser {
   int partWordBufferIndex = 0;
   bool nextWordContinues = false;  // true when next flushed word attaches to previous (inline element boundary)
   std::unique_ptr<ParsedText> currentTextBlock = nullptr;
+  WordWidthCache wordWidthCache;
   std::unique_ptr<Page> currentPage = nullptr;
   int16_t currentPageNextY = 0;
   int fontId;
@@ -76,11 +80,15 @@ class ChapterHtmlSlimParser {
   char currentFootnoteLinkHref[64] = {};
   std::vector<std::pair<int, FootnoteEntry>> pendingFootnotes;  // <wordIndex, entry>
   int wordsExtractedInBlock = 0;
+  bool sourceReadFailed = false;
 
   void updateEffectiveInlineStyle();
   void startNewTextBlock(const BlockStyle& blockStyle);
   void flushPartWordBuffer();
   void makePages();
+  // readChunk(buf, len) fills expat's buffer and returns bytes read, 0 at end of input, or -1 on error
+  template <typename ReadChunk>
+  bool parseSource(size_t sourceSize, ReadChunk&& readChunk);
   // XML callbacks
   static void XMLCALL startElement(void* userData, const XML_Char* name, const XML_Char** atts);
   static void XMLCALL characterData(void* userData, const XML_Char* s, int len);
@@ -95,7 +103,8 @@ class ChapterHtmlSlimParser {
                                  const std::function<void(std::unique_ptr<Page>)>& completePageFn,
                                  const bool embeddedStyle, const std::string& contentBase,
                                  const std::string& imageBasePath, const std::function<void()>& popupFn = nullptr,
-                                 const CssParser* cssParser = nullptr)
+                                 const CssParser* cssParser = nullptr,
+                                 const std::function<bool()>& checkpointFn = nullptr)
 
       : epub(epub),
         filepath(filepath),
@@ -109,12 +118,18 @@ class ChapterHtmlSlimParser {
         hyphenationEnabled(hyphenationEnabled),
         completePageFn(completePageFn),
         popupFn(popupFn),
+        checkpointFn(checkpointFn),
         cssParser(cssParser),
         embeddedStyle(embeddedStyle),
         contentBase(contentBase),
         imageBasePath(imageBasePath) {}
 
   ~ChapterHtmlSlimParser() = default;
+  // Parse the chapter staged at filepath
   bool parseAndBuildPages();
+  // Parse the chapter while it is being inflated from the EPUB, with no temp file on SD
+  bool parseAndBuildPages(ZipFile::EntryReader& source);
+  // Whether the last parse failed because its source could not be read, rather than on the markup or memory
+  bool failedReadingSource() const { return sourceReadFailed; }
   void addLineToPage(std::shared_ptr<TextBlock> line);
 };
@@ -1,6 +1,7 @@
 #include "GfxRenderer.h"
 
 #include <Logging.h>
+#include <PerfTrace.h>
 #include <Utf8.h>
 
 const uint8_t* GfxRenderer::getGlyphBitmap(const EpdFontData* fontData, const EpdGlyph* glyph) const {
@@ -59,14 +60,225 @@ static inline void rotateCoordinates(const GfxRenderer::Orientation orientation,
   }
 }
 
+// What a glyph pixel does to the frame (and, while capturing, to the gray bits): plain black or white, or in
+// BW_AND_GRAYSCALE mode, the gray level of an anti-aliased pixel, see drawGrayPixel()
+enum class GlyphOp { Black, White, CaptureBlack, CaptureWhite, CaptureGray };
+
+// Eight glyph pixels, MSB first, split by level. 1-bit glyphs only have black; for the plain ops black holds whichever
+// levels the render mode draws.
+struct GlyphSpan {
+  uint8_t black;
+  uint8_t dark;
+  uint8_t light;
+};
+
+struct GlyphTables {
+  uint8_t split[256];    // Four 2-bit pixels: their high bits in the top nibble, their low bits in the bottom one
+  uint8_t reverse[256];  // Bit order reversed, for glyph rows that run right to left on the panel
+};
+
+static constexpr GlyphTables makeGlyphTables() {
+  GlyphTables tables{};
+  for (int value = 0; value < 256; value++) {
+    uint8_t high = 0, low = 0, reversed = 0;
+    for (int pixel = 0; pixel < 4; pixel++) {
+      high |= ((value >> (7 - pixel * 2)) & 1) << (3 - pixel);
+      low |= ((value >> (6 - pixel * 2)) & 1) << (3 - pixel);
+    }
+    for (int bit = 0; bit < 8; bit++) {
+      reversed |= ((value >> bit) & 1) << (7 - bit);
+    }
+    tables.split[value] = static_cast<uint8_t>(high << 4 | low);
+    tables.reverse[value] = reversed;
+  }
+  return tables;
+}
+
+static constexpr GlyphTables GLYPH_TABLES = makeGlyphTables();
+
+// Everything a glyph blit needs, with the panel position of glyph pixel (gx, gy) at
+// (x0 + gx * xStepX + gy * xStepY, y0 + gx * yStepX + gy * yStepY). Each step is -1, 0 or 1, and glyph rows either
+// run along panel rows (xStepX != 0) or along panel columns (yStepX != 0). Only columns [colLo, colHi) and rows
+// [rowLo, rowHi) of the glyph are on the panel.
+struct GlyphBlit {
+  const uint8_t* bitmap;
+  int bitmapSize;
+  bool is2Bit;
+  int width;
+  int x0, y0, xStepX, xStepY, yStepX, yStepY;
+  int colLo, colHi, rowLo, rowHi;
+  uint8_t selectBlack, selectDark, selectLight;  // 0xFF for the levels a plain op draws
+  uint8_t* frame;
+  uint8_t* const* grayChunks;
+  int grayChunkSize;
+};
+
+// 16 bits of a glyph bitmap from bit `bit` on, with zeros past its end
+static inline uint16_t readGlyphBits(const uint8_t* bitmap, const int size, const int bit) {
+  const int i = bit >> 3;
+  uint32_t window = static_cast<uint32_t>(bitmap[i]) << 16;
+  if (i + 1 < size) window |= static_cast<uint32_t>(bitmap[i + 1]) << 8;
+  if (i + 2 < size) window |= bitmap[i + 2];
+  return static_cast<uint16_t>(window >> (8 - (bit & 7)));
+}
+
+// `count` (1 to 8) glyph pixels from pixel `pixel` on
+template <GlyphOp op>
+static inline GlyphSpan readGlyphSpan(const GlyphBlit& b, const int pixel, const int count) {
+  const uint8_t valid = static_cast<uint8_t>(0xFF00 >> count);
+  GlyphSpan span;
+  if (!b.is2Bit) {
+    span = {static_cast<uint8_t>((readGlyphBits(b.bitmap, b.bitmapSize, pixel) >> 8) & valid), 0, 0};
+  } else {
+    // The font's 3 is black, 2 dark gray and 1 light gray
+    const uint16_t bits = readGlyphBits(b.bitmap, b.bitmapSize, pixel * 2);
+    const uint8_t first = GLYPH_TABLES.split[bits >> 8];
+    const uint8_t second = GLYPH_TABLES.split[bits & 0xFF];
+    const uint8_t high = ((first & 0xF0) | (second >> 4)) & valid;
+    const uint8_t low = ((first << 4) | (second & 0x0F)) & valid;
+    span = {static_cast<uint8_t>(high & low), static_cast<uint8_t>(high & ~low), static_cast<uint8_t>(~high & low)};
+  }
+  if constexpr (op != GlyphOp::CaptureGray) {
+    span = {static_cast<uint8_t>((span.black & b.selectBlack) | (span.dark & b.selectDark) |
+                                 (span.light & b.selectLight)),
+            0, 0};
+  }
+  return span;
+}
+
+// Applies the masked bits of one frame byte (and its gray byte while capturing); the plain ops only use black
+template <GlyphOp op>
+static inline void applyGlyphBits(uint8_t* frame, uint8_t* gray, const uint8_t black, const uint8_t dark,
+                                  const uint8_t light) {
+  if constexpr (op == GlyphOp::Black) {
+    *frame &= ~black;
+  } else if constexpr (op == GlyphOp::White) {
+    *frame |= black;
+  } else if constexpr (op == GlyphOp::CaptureBlack) {
+    *gray &= ~black;
+    *frame &= ~black;
+  } else if constexpr (op == GlyphOp::CaptureWhite) {
+    *gray &= ~black;
+    *frame |= black;
+  } else {
+    // Black only where not gray yet, dark gray always, light gray only over white
+    const uint8_t wasGray = *gray;
+    *frame = (*frame & ~((black & ~wasGray) | dark)) | (light & ~wasGray);
+    *gray = wasGray | dark | light;
+  }
+}
+
+// Glyph rows along panel rows (the landscape orientations): each row is shifted into place in a panel-aligned row
+// buffer, reversed first if it runs right to left, and then applied a byte at a time. The panel width is a whole
+// number of bytes, so horizontal clipping just skips bytes.
+template <GlyphOp op>
+static void blitGlyphRows(const GlyphBlit& b) {
+  // Spare byte in front, shift, the widest row (a bitmap row across the panel), tail
+  constexpr int ROW_BYTES = (8 + 7 + HalDisplay::DISPLAY_WIDTH + 7) / 8 + 1;
+  constexpr int LEVELS = op == GlyphOp::CaptureGray ? 3 : 1;
+  uint8_t rows[LEVELS][ROW_BYTES];
+  const bool reversed = b.xStepX < 0;
+  const int startX = reversed ? b.x0 - b.width + 1 : b.x0;
+  const int firstColumn = (startX >> 3) - 1;
+  const int offset = 8 + (startX & 7);
+  const int bytes = (offset + b.width + 7) >> 3;
+  const int byteLo = std::max(0, -firstColumn);
+  const int byteHi = std::min(bytes, HalDisplay::DISPLAY_WIDTH_BYTES - firstColumn);
+
+  for (int gy = b.rowLo; gy < b.rowHi; gy++) {
+    for (int level = 0; level < LEVELS; level++) {
+      memset(rows[level], 0, bytes + 1);
+    }
+    for (int gx = 0; gx < b.width; gx += 8) {
+      const GlyphSpan span = readGlyphSpan<op>(b, gy * b.width + gx, std::min(8, b.width - gx));
+      const uint8_t levels[3] = {span.black, span.dark, span.light};
+      const int pos = reversed ? offset + b.width - 8 - gx : offset + gx;
+      const int shift = pos & 7;
+      for (int level = 0; level < LEVELS; level++) {
+        const uint8_t bits = reversed ? GLYPH_TABLES.reverse[levels[level]] : levels[level];
+        rows[level][pos >> 3] |= bits >> shift;
+        rows[level][(pos >> 3) + 1] |= static_cast<uint8_t>(bits << (8 - shift));
+      }
+    }
+
+    const int rowIndex = (b.y0 + gy * b.yStepY) * HalDisplay::DISPLAY_WIDTH_BYTES;
+    uint8_t* frame = b.frame + rowIndex + firstColumn;
+    uint8_t* gray = nullptr;
+    if constexpr (op == GlyphOp::CaptureBlack || op == GlyphOp::CaptureWhite || op == GlyphOp::CaptureGray) {
+      // A panel row never straddles two chunks
+      gray = b.grayChunks[rowIndex / b.grayChunkSize] + rowIndex % b.grayChunkSize + firstColumn;
+    }
+    for (int i = byteLo; i < byteHi; i++) {
+      if constexpr (LEVELS == 3) {
+        if (rows[0][i] | rows[1][i] | rows[2][i]) {
+          applyGlyphBits<op>(frame + i, gray + i, rows[0][i], rows[1][i], rows[2][i]);
+        }
+      } else if (rows[0][i]) {
+        applyGlyphBits<op>(frame + i, gray + i, rows[0][i], 0, 0);
+      }
+    }
+  }
+}
+
+// Glyph rows down panel columns (the portrait orientations): a glyph row is one bit of one column byte, and each
+// glyph pixel moves a whole panel row up or down from the last. Only pixels with ink are visited.
+template <GlyphOp op>
+static void blitGlyphColumns(const GlyphBlit& b) {
+  const int stride = b.yStepX * HalDisplay::DISPLAY_WIDTH_BYTES;
+  for (int gy = b.rowLo; gy < b.rowHi; gy++) {
+    const int phyX = b.x0 + gy * b.xStepY;
+    const uint8_t mask = 0x80 >> (phyX & 7);
+    for (int gx = b.colLo; gx < b.colHi; gx += 8) {
+      GlyphSpan span = readGlyphSpan<op>(b, gy * b.width + gx, std::min(8, b.colHi - gx));
+      int index = (b.y0 + gx * b.yStepX) * HalDisplay::DISPLAY_WIDTH_BYTES + (phyX >> 3);
+      for (; span.black | span.dark | span.light; index += stride) {
+        if ((span.black | span.dark | span.light) & 0x80) {
+          uint8_t* gray = nullptr;
+          if constexpr (op == GlyphOp::CaptureBlack || op == GlyphOp::CaptureWhite || op == GlyphOp::CaptureGray) {
+            gray = b.grayChunks[index / b.grayChunkSize] + index % b.grayChunkSize;
+          }
+          applyGlyphBits<op>(b.frame + index, gray, span.black & 0x80 ? mask : 0, span.dark & 0x80 ? mask : 0,
+                             span.light & 0x80 ? mask : 0);
+        }
+        span.black <<= 1;
+        span.dark <<= 1;
+        span.light <<= 1;
+      }
+    }
+  }
+}
+
+template <GlyphOp op>
+static void blitGlyph(const GlyphBlit& b) {
+  if (b.xStepX != 0) {
+    blitGlyphRows<op>(b);
+  } else {
+    blitGlyphColumns<op>(b);
+  }
+}
+
+// Narrows the glyph columns or rows, whichever the panel coordinate moves with, to those that land in [0, limit)
+static inline void clipGlyphAxis(const int base, const int stepX, const int stepY, const int limit, int* colLo,
+                                 int* colHi, int* rowLo, int* rowHi) {
+  const int step = stepX != 0 ? stepX : stepY;
+  int* lo = stepX != 0 ? colLo : rowLo;
+  int* hi = stepX != 0 ? colHi : rowHi;
+  if (step > 0) {
+    *lo = std::max(*lo, -base);
+    *hi = std::min(*hi, limit - base);
+  } else {
+    *lo = std::max(*lo, base - limit + 1);
+    *hi = std::min(*hi, base + 1);
+  }
+}
+
 enum class TextRotation { None, Rotated90CW };
 
 // Shared glyph rendering logic for normal and rotated text.
 // Coordinate mapping and cursor advance direction are selected at compile time via the template parameter.
 template <TextRotation rotation>
-static void renderCharImpl(const GfxRenderer& renderer, GfxRenderer::RenderMode renderMode,
-                           const EpdFontFamily& fontFamily, const uint32_t cp, int* cursorX, int* cursorY,
-                           const bool pixelState, const EpdFontFamily::Style style) {
+static void renderCharImpl(const GfxRenderer& renderer, const EpdFontFamily& fontFamily, const uint32_t cp,
+                           int* cursorX, int* cursorY, const bool pixelState, const EpdFontFamily::Style style) {
   const EpdGlyph* glyph = fontFamily.getGlyph(cp, style);
   if (!glyph) {
     LOG_ERR("GFX", "No glyph for codepoint %d", cp);
@@ -83,73 +295,12 @@ static void renderCharImpl(const GfxRenderer& renderer, GfxRenderer::RenderMode
   const uint8_t* bitmap = renderer.getGlyphBitmap(fontData, glyph);
 
   if (bitmap != nullptr) {
-    // For Normal:  outer loop advances screenY, inner loop advances screenX
-    // For Rotated: outer loop advances screenX, inner loop advances screenY (in reverse)
-    int outerBase, innerBase;
+    // Glyph pixel (0, 0) on screen; rotated glyphs run their rows down the screen and their columns up it
     if constexpr (rotation == TextRotation::Rotated90CW) {
-      outerBase = *cursorX + fontData->ascender - top;  // screenX = outerBase + glyphY
-      innerBase = *cursorY - left;                      // screenY = innerBase - glyphX
+      renderer.drawGlyphBitmap(bitmap, is2Bit, width, height, *cursorX + fontData->ascender - top, *cursorY - left,
+                               true, pixelState);
     } else {
-      outerBase = *cursorY - top;   // screenY = outerBase + glyphY
-      innerBase = *cursorX + left;  // screenX = innerBase + glyphX
-    }
-
-    if (is2Bit) {
-      int pixelPosition = 0;
-      for (int glyphY = 0; glyphY < height; glyphY++) {
-        const int outerCoord = outerBase + glyphY;
-        for (int glyphX = 0; glyphX < width; glyphX++, pixelPosition++) {
-          int screenX, screenY;
-          if constexpr (rotation == TextRotation::Rotated90CW) {
-            screenX = outerCoord;
-            screenY = innerBase - glyphX;
-          } else {
-            screenX = innerBase + glyphX;
-            screenY = outerCoord;
-          }
-
-          const uint8_t byte = bitmap[pixelPosition >> 2];
-          const uint8_t bit_index = (3 - (pixelPosition & 3)) * 2;
-          // the direct bit from the font is 0 -> white, 1 -> light gray, 2 -> dark gray, 3 -> black
-          // we swap this to better match the way images and screen think about colors:
-          // 0 -> black, 1 -> dark grey, 2 -> light grey, 3 -> white
-          const uint8_t bmpVal = 3 - ((byte >> bit_index) & 0x3);
-
-          if (renderMode == GfxRenderer::BW && bmpVal < 3) {
-            // Black (also paints over the grays in BW mode)
-            renderer.drawPixel(screenX, screenY, pixelState);
-          } else if (renderMode == GfxRenderer::GRAYSCALE_MSB && (bmpVal == 1 || bmpVal == 2)) {
-            // Light gray (also mark the MSB if it's going to be a dark gray too)
-            // We have to flag pixels in reverse for the gray buffers, as 0 leave alone, 1 update
-            renderer.drawPixel(screenX, screenY, false);
-          } else if (renderMode == GfxRenderer::GRAYSCALE_LSB && bmpVal == 1) {
-            // Dark gray
-            renderer.drawPixel(screenX, screenY, false);
-          }
-        }
-      }
-    } else {
-      int pixelPosition = 0;
-      for (int glyphY = 0; glyphY < height; glyphY++) {
-        const int outerCoord = outerBase + glyphY;
-        for (int glyphX = 0; glyphX < width; glyphX++, pixelPosition++) {
-          int screenX, screenY;
-          if constexpr (rotation == TextRotation::Rotated90CW) {
-            screenX = outerCoord;
-            screenY = innerBase - glyphX;
-          } else {
-            screenX = innerBase + glyphX;
-            screenY = outerCoord;
-          }
-
-          const uint8_t byte = bitmap[pixelPosition >> 3];
-          const uint8_t bit_index = 7 - (pixelPosition & 7);
-
-          if ((byte >> bit_index) & 1) {
-            renderer.drawPixel(screenX, screenY, pixelState);
-          }
-        }
-      }
+      renderer.drawGlyphBitmap(bitmap, is2Bit, width, height, *cursorX + left, *cursorY - top, false, pixelState);
     }
   }
 
@@ -179,6 +330,18 @@ void GfxRenderer::drawPixel(const int x, const int y, const bool state) const {
   const uint16_t byteIndex = phyY * HalDisplay::DISPLAY_WIDTH_BYTES + (phyX / 8);
   const uint8_t bitPosition = 7 - (phyX % 8);  // MSB first
 
+  if (renderMode == BW_AND_GRAYSCALE) {
+    // Plain black or white replaces any gray level, as it would have cleared the grayscale planes' bit
+    const uint8_t mask = 1 << bitPosition;
+    bwBufferChunks[byteIndex / BW_BUFFER_CHUNK_SIZE][byteIndex % BW_BUFFER_CHUNK_SIZE] &= ~mask;
+    if (state) {
+      frameBuffer[byteIndex] &= ~mask;
+    } else {
+      frameBuffer[byteIndex] |= mask;
+    }
+    return;
+  }
+
   if (state) {
     frameBuffer[byteIndex] &= ~(1 << bitPosition);  // Clear bit
   } else {
@@ -186,6 +349,103 @@ void GfxRenderer::drawPixel(const int x, const int y, const bool state) const {
   }
 }
 
+// Draws glyphs a row at a time instead of through drawPixel(): the orientation and text rotation are resolved to
+// panel steps and the glyph clipped once, then every pixel ends up exactly as drawPixel() or drawGrayPixel() would
+// have left it.
+void GfxRenderer::drawGlyphBitmap(const uint8_t* bitmap, const bool is2Bit, const int width, const int height,
+                                  const int x, const int y, const bool rotated90, const bool pixelState) const {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  int panel[3][2];
+  for (int i = 0; i < 3; i++) {
+    const int gx = i == 1, gy = i == 2;
+    if (rotated90) {
+      rotateCoordinates(orientation, x + gy, y - gx, &panel[i][0], &panel[i][1]);
+    } else {
+      rotateCoordinates(orientation, x + gx, y + gy, &panel[i][0], &panel[i][1]);
+    }
+  }
+
+  GlyphBlit b{};
+  b.bitmap = bitmap;
+  b.bitmapSize = (width * height * (is2Bit ? 2 : 1) + 7) / 8;
+  b.is2Bit = is2Bit;
+  b.width = width;
+  b.x0 = panel[0][0];
+  b.y0 = panel[0][1];
+  b.xStepX = panel[1][0] - b.x0;
+  b.yStepX = panel[1][1] - b.y0;
+  b.xStepY = panel[2][0] - b.x0;
+  b.yStepY = panel[2][1] - b.y0;
+  b.colLo = 0;
+  b.colHi = width;
+  b.rowLo = 0;
+  b.rowHi = height;
+  clipGlyphAxis(b.x0, b.xStepX, b.xStepY, HalDisplay::DISPLAY_WIDTH, &b.colLo, &b.colHi, &b.rowLo, &b.rowHi);
+  clipGlyphAxis(b.y0, b.yStepX, b.yStepY, HalDisplay::DISPLAY_HEIGHT, &b.colLo, &b.colHi, &b.rowLo, &b.rowHi);
+  if (b.colLo != 0 || b.colHi != width || b.rowLo != 0 || b.rowHi != height) {
+    LOG_ERR("GFX", "!! Glyph at (%d, %d) clipped to the panel", x, y);
+    if (b.colLo >= b.colHi || b.rowLo >= b.rowHi) {
+      return;
+    }
+  }
+  b.frame = frameBuffer;
+  b.grayChunks = bwBufferChunks;
+  b.grayChunkSize = BW_BUFFER_CHUNK_SIZE;
+
+  // The levels each mode draws, as the per-pixel loop did: in BW every non-white pixel, in the grayscale passes the
+  // gray levels of 2-bit glyphs (as white, which marks them) and all of a 1-bit glyph
+  const bool drawsBlack = !is2Bit || renderMode == BW || renderMode == BW_AND_GRAYSCALE;
+  b.selectBlack = drawsBlack ? 0xFF : 0;
+  b.selectDark = is2Bit ? 0xFF : 0;
+  b.selectLight = is2Bit && renderMode != GRAYSCALE_LSB ? 0xFF : 0;
+  const bool state = drawsBlack && pixelState;
+
+  if (renderMode == BW_AND_GRAYSCALE) {
+    if (is2Bit && pixelState) {
+      blitGlyph<GlyphOp::CaptureGray>(b);
+    } else if (state) {
+      blitGlyph<GlyphOp::CaptureBlack>(b);
+    } else {
+      blitGlyph<GlyphOp::CaptureWhite>(b);
+    }
+  } else if (state) {
+    blitGlyph<GlyphOp::Black>(b);
+  } else {
+    blitGlyph<GlyphOp::White>(b);
+  }
+}
+
+// While capturing, a pixel's gray bit and frame bit together hold one of four states: white (frame 1, gray 0), black
+// (0, 0), light gray (1, 1) and dark gray (0, 1). Levels combine like the three separate passes would: dark wins over
+// light, and a glyph's or bitmap's black leaves either in place.
+void GfxRenderer::drawGrayPixel(const int x, const int y, const uint8_t level) const {
+  int phyX = 0;
+  int phyY = 0;
+  rotateCoordinates(orientation, x, y, &phyX, &phyY);
+  if (phyX < 0 || phyX >= HalDisplay::DISPLAY_WIDTH || phyY < 0 || phyY >= HalDisplay::DISPLAY_HEIGHT) {
+    LOG_ERR("GFX", "!! Outside range (%d, %d) -> (%d, %d)", x, y, phyX, phyY);
+    return;
+  }
+  const uint16_t byteIndex = phyY * HalDisplay::DISPLAY_WIDTH_BYTES + (phyX / 8);
+  const uint8_t mask = 1 << (7 - (phyX % 8));
+  uint8_t& gray = bwBufferChunks[byteIndex / BW_BUFFER_CHUNK_SIZE][byteIndex % BW_BUFFER_CHUNK_SIZE];
+  if (level == 0) {
+    if (!(gray & mask)) {
+      frameBuffer[byteIndex] &= ~mask;
+    }
+    return;
+  }
+  if (level == 1) {
+    frameBuffer[byteIndex] &= ~mask;
+  } else if (!(gray & mask)) {
+    frameBuffer[byteIndex] |= mask;
+  }
+  gray |= mask;
+}
+
 int GfxRenderer::getTextWidth(const int fontId, const char* text, const EpdFontFamily::Style style) const {
   const auto fontIt = fontMap.find(fontId);
   if (fontIt == fontMap.end()) {
@@ -263,20 +523,8 @@ void GfxRenderer::drawText(const int fontId, const int x, const int y, const cha
 }
 
 void GfxRenderer::drawLine(int x1, int y1, int x2, int y2, const bool state) const {
-  if (x1 == x2) {
-    if (y2 < y1) {
-      std::swap(y1, y2);
-    }
-    for (int y = y1; y <= y2; y++) {
-      drawPixel(x1, y, state);
-    }
-  } else if (y1 == y2) {
-    if (x2 < x1) {
-      std::swap(x1, x2);
-    }
-    for (int x = x1; x <= x2; x++) {
-      drawPixel(x, y1, state);
-    }
+  if (x1 == x2 || y1 == y2) {
+    fillSpans(x1, y1, x2, y2, state ? Color::Black : Color::White);
   } else {
     // Bresenham's line algorithm — integer arithmetic only
     int dx = x2 - x1;
@@ -333,15 +581,19 @@ void GfxRenderer::drawArc(const int maxRadius, const int cx, const int cy, const
   const int innerRadius = std::max(maxRadius - stroke, 0);
   const int outerRadiusSq = maxRadius * maxRadius;
   const int innerRadiusSq = innerRadius * innerRadius;
+  // Each row of the quarter ring is one run of dx, from the inner circle out to the outer one
+  int outerDx = maxRadius;
+  int innerDx = innerRadius;
   for (int dy = 0; dy <= maxRadius; ++dy) {
-    for (int dx = 0; dx <= maxRadius; ++dx) {
-      const int distSq = dx * dx + dy * dy;
-      if (distSq > outerRadiusSq || distSq < innerRadiusSq) {
-        continue;
-      }
-      const int px = cx + xDir * dx;
+    while (outerDx >= 0 && outerDx * outerDx + dy * dy > outerRadiusSq) {
+      outerDx--;
+    }
+    while (innerDx > 0 && (innerDx - 1) * (innerDx - 1) + dy * dy >= innerRadiusSq) {
+      innerDx--;
+    }
+    if (innerDx <= outerDx) {
       const int py = cy + yDir * dy;
-      drawPixel(px, py, state);
+      fillSpans(cx + xDir * innerDx, py, cx + xDir * outerDx, py, state ? Color::Black : Color::White);
     }
   }
 };
@@ -405,71 +657,104 @@ void GfxRenderer::drawRoundedRect(const int x, const int y, const int width, con
 }
 
 void GfxRenderer::fillRect(const int x, const int y, const int width, const int height, const bool state) const {
-  for (int fillY = y; fillY < y + height; fillY++) {
-    drawLine(x, fillY, x + width - 1, fillY, state);
+  // Like the row of lines this used to draw, a width below 1 still covers x + width - 1 to x
+  if (height > 0) {
+    fillSpans(x, y, x + width - 1, y + height - 1, state ? Color::Black : Color::White);
   }
 }
 
-// NOTE: Those are in critical path, and need to be templated to avoid runtime checks for every pixel.
-// Any branching must be done outside the loops to avoid performance degradation.
-template <>
-void GfxRenderer::drawPixelDither<Color::Clear>(const int x, const int y) const {
-  // Do nothing
-}
-
-template <>
-void GfxRenderer::drawPixelDither<Color::Black>(const int x, const int y) const {
-  drawPixel(x, y, true);
+// Sets bits first to last of a panel row to `value`, leaving the bits outside them alone
+static inline void fillRowBits(uint8_t* row, const int first, const int last, const uint8_t value) {
+  const int firstByte = first >> 3;
+  const int lastByte = last >> 3;
+  const uint8_t firstMask = 0xFF >> (first & 7);
+  const uint8_t lastMask = 0xFF << (7 - (last & 7));
+  if (firstByte == lastByte) {
+    const uint8_t mask = firstMask & lastMask;
+    row[firstByte] = (row[firstByte] & ~mask) | (value & mask);
+    return;
+  }
+  row[firstByte] = (row[firstByte] & ~firstMask) | (value & firstMask);
+  memset(row + firstByte + 1, value, lastByte - firstByte - 1);
+  row[lastByte] = (row[lastByte] & ~lastMask) | (value & lastMask);
 }
 
-template <>
-void GfxRenderer::drawPixelDither<Color::White>(const int x, const int y) const {
-  drawPixel(x, y, false);
-}
+// Fills the logical rectangle with corners (x1, y1) and (x2, y2), in either order, as drawPixel() would pixel by pixel.
+// Any orientation maps it to a panel rectangle, so each panel row is one run of bytes: masked at the ends and
+// memset in between. LightGray and DarkGray keep their dither pattern on logical coordinates (x and y even, and
+// x + y even), which on the panel is a byte that only depends on the row's parity.
+void GfxRenderer::fillSpans(const int x1, const int y1, const int x2, const int y2, const Color color) const {
+  if (color == Color::Clear) {
+    return;
+  }
+  int ax = 0, ay = 0, bx = 0, by = 0;
+  rotateCoordinates(orientation, x1, y1, &ax, &ay);
+  rotateCoordinates(orientation, x2, y2, &bx, &by);
+  int left = std::min(ax, bx);
+  int right = std::max(ax, bx);
+  int top = std::min(ay, by);
+  int bottom = std::max(ay, by);
+  if (left < 0 || right >= HalDisplay::DISPLAY_WIDTH || top < 0 || bottom >= HalDisplay::DISPLAY_HEIGHT) {
+    LOG_ERR("GFX", "!! Fill (%d, %d)-(%d, %d) clipped to the panel", x1, y1, x2, y2);
+    left = std::max(left, 0);
+    right = std::min(right, HalDisplay::DISPLAY_WIDTH - 1);
+    top = std::max(top, 0);
+    bottom = std::min(bottom, HalDisplay::DISPLAY_HEIGHT - 1);
+    if (left > right || top > bottom) {
+      return;
+    }
+  }
 
-template <>
-void GfxRenderer::drawPixelDither<Color::LightGray>(const int x, const int y) const {
-  drawPixel(x, y, x % 2 == 0 && y % 2 == 0);
-}
+  // Frame bytes for even and odd panel rows; a set bit is white
+  uint8_t rowValues[2] = {0x00, 0x00};
+  if (color == Color::White) {
+    rowValues[0] = rowValues[1] = 0xFF;
+  } else if (color == Color::LightGray || color == Color::DarkGray) {
+    // Logical x runs along panel x in landscape and along panel y in portrait, so each logical parity is a panel one
+    int originX = 0, originY = 0;
+    rotateCoordinates(orientation, 0, 0, &originX, &originY);
+    const bool landscape = orientation == LandscapeClockwise || orientation == LandscapeCounterClockwise;
+    for (int rowParity = 0; rowParity < 2; rowParity++) {
+      uint8_t black = 0;
+      for (int columnParity = 0; columnParity < 2; columnParity++) {
+        const bool xEven = ((landscape ? columnParity - originX : rowParity - originY) & 1) == 0;
+        const bool yEven = ((landscape ? rowParity - originY : columnParity - originX) & 1) == 0;
+        if (color == Color::LightGray ? xEven && yEven : xEven == yEven) {
+          black |= columnParity == 0 ? 0xAA : 0x55;
+        }
+      }
+      rowValues[rowParity] = ~black;
+    }
+  }
 
-template <>
-void GfxRenderer::drawPixelDither<Color::DarkGray>(const int x, const int y) const {
-  drawPixel(x, y, (x + y) % 2 == 0);  // TODO: maybe find a better pattern?
+  for (int row = top; row <= bottom; row++) {
+    const int rowIndex = row * HalDisplay::DISPLAY_WIDTH_BYTES;
+    fillRowBits(frameBuffer + rowIndex, left, right, rowValues[row & 1]);
+    if (renderMode == BW_AND_GRAYSCALE) {
+      // Plain black and white replace any gray level, see drawPixel(); a panel row never straddles two chunks
+      fillRowBits(bwBufferChunks[rowIndex / BW_BUFFER_CHUNK_SIZE] + rowIndex % BW_BUFFER_CHUNK_SIZE, left, right, 0);
+    }
+  }
 }
 
 void GfxRenderer::fillRectDither(const int x, const int y, const int width, const int height, Color color) const {
-  if (color == Color::Clear) {
-  } else if (color == Color::Black) {
-    fillRect(x, y, width, height, true);
-  } else if (color == Color::White) {
-    fillRect(x, y, width, height, false);
-  } else if (color == Color::LightGray) {
-    for (int fillY = y; fillY < y + height; fillY++) {
-      for (int fillX = x; fillX < x + width; fillX++) {
-        drawPixelDither<Color::LightGray>(fillX, fillY);
-      }
-    }
-  } else if (color == Color::DarkGray) {
-    for (int fillY = y; fillY < y + height; fillY++) {
-      for (int fillX = x; fillX < x + width; fillX++) {
-        drawPixelDither<Color::DarkGray>(fillX, fillY);
-      }
-    }
+  if (color == Color::Black || color == Color::White) {
+    fillRect(x, y, width, height, color == Color::Black);
+  } else if (width > 0 && height > 0) {
+    fillSpans(x, y, x + width - 1, y + height - 1, color);
   }
 }
 
-template <Color color>
-void GfxRenderer::fillArc(const int maxRadius, const int cx, const int cy, const int xDir, const int yDir) const {
+void GfxRenderer::fillArc(const int maxRadius, const int cx, const int cy, const int xDir, const int yDir,
+                          const Color color) const {
   const int radiusSq = maxRadius * maxRadius;
+  int dx = maxRadius;
   for (int dy = 0; dy <= maxRadius; ++dy) {
-    for (int dx = 0; dx <= maxRadius; ++dx) {
-      const int distSq = dx * dx + dy * dy;
-      const int px = cx + xDir * dx;
-      const int py = cy + yDir * dy;
-      if (distSq <= radiusSq) {
-        drawPixelDither<color>(px, py);
-      }
+    while (dx * dx + dy * dy > radiusSq) {
+      dx--;
     }
+    const int py = cy + yDir * dy;
+    fillSpans(cx, py, cx + xDir * dx, py, color);
   }
 }
 
@@ -510,39 +795,20 @@ void GfxRenderer::fillRoundedRect(const int x, const int y, const int width, con
     fillRectDither(x + width - maxRadius - 1, rightFillTop, maxRadius + 1, rightFillBottom - rightFillTop + 1, color);
   }
 
-  auto fillArcTemplated = [this](int maxRadius, int cx, int cy, int xDir, int yDir, Color color) {
-    switch (color) {
-      case Color::Clear:
-        break;
-      case Color::Black:
-        fillArc<Color::Black>(maxRadius, cx, cy, xDir, yDir);
-        break;
-      case Color::White:
-        fillArc<Color::White>(maxRadius, cx, cy, xDir, yDir);
-        break;
-      case Color::LightGray:
-        fillArc<Color::LightGray>(maxRadius, cx, cy, xDir, yDir);
-        break;
-      case Color::DarkGray:
-        fillArc<Color::DarkGray>(maxRadius, cx, cy, xDir, yDir);
-        break;
-    }
-  };
-
   if (roundTopLeft) {
-    fillArcTemplated(maxRadius, x + maxRadius, y + maxRadius, -1, -1, color);
+    fillArc(maxRadius, x + maxRadius, y + maxRadius, -1, -1, color);
   }
 
   if (roundTopRight) {
-    fillArcTemplated(maxRadius, x + width - maxRadius - 1, y + maxRadius, 1, -1, color);
+    fillArc(maxRadius, x + width - maxRadius - 1, y + maxRadius, 1, -1, color);
   }
 
   if (roundBottomRight) {
-    fillArcTemplated(maxRadius, x + width - maxRadius - 1, y + height - maxRadius - 1, 1, 1, color);
+    fillArc(maxRadius, x + width - maxRadius - 1, y + height - maxRadius - 1, 1, 1, color);
   }
 
   if (roundBottomLeft) {
-    fillArcTemplated(maxRadius, x + maxRadius, y + height - maxRadius - 1, -1, 1, color);
+    fillArc(maxRadius, x + maxRadius, y + height - maxRadius - 1, -1, 1, color);
   }
 }
 
@@ -573,6 +839,162 @@ void GfxRenderer::drawIcon(const uint8_t bitmap[], const int x, const int y, con
   display.drawImageTransparent(bitmap, y, getScreenWidth() - width - x, height, width);
 }
 
+// Bitmap rows are drawn through drawGlyphBitmap() in the 2-bit glyph format (0 white, 1 light gray, 2 dark gray,
+// 3 black), which is readNextRow()'s output inverted. Where several bitmap pixels land on one screen pixel, dark gray
+// wins over light gray, light gray over black and black over white: in every render mode that leaves the pixel as
+// drawing them one after another would.
+static constexpr uint8_t BITMAP_RANK[4] = {0, 2, 3, 1};   // Glyph level to strength
+static constexpr uint8_t BITMAP_LEVEL[4] = {0, 3, 1, 2};  // And back
+
+struct BitmapTables {
+  uint8_t pairs[256];  // Four pixels to the stronger of each pair, in the low nibble
+  uint8_t ink[256];    // Four pixels to a nibble of which ones are not white
+};
+
+static constexpr BitmapTables makeBitmapTables() {
+  BitmapTables tables{};
+  for (int value = 0; value < 256; value++) {
+    uint8_t pairs = 0, ink = 0;
+    for (int pixel = 0; pixel < 4; pixel++) {
+      const int level = (value >> (6 - pixel * 2)) & 3;
+      ink |= (level != 0) << (3 - pixel);
+    }
+    for (int pair = 0; pair < 2; pair++) {
+      const int first = (value >> (6 - pair * 4)) & 3;
+      const int second = (value >> (4 - pair * 4)) & 3;
+      const int level = BITMAP_RANK[first] >= BITMAP_RANK[second] ? first : second;
+      pairs |= level << (2 - pair * 2);
+    }
+    tables.pairs[value] = pairs;
+    tables.ink[value] = ink;
+  }
+  return tables;
+}
+
+static constexpr BitmapTables BITMAP_TABLES = makeBitmapTables();
+
+// How the pixels of a bitmap row map onto a screen row, worked out once per bitmap
+struct GfxRenderer::BitmapColumns {
+  int screenX;             // Screen column of the first one on screen
+  int count;               // Screen columns on screen
+  int first;               // First bitmap pixel that lands on them
+  int pixels;              // Bitmap pixels from there on that do
+  int ratio;               // 1 or 2 for an exact 1:1 or 2:1 scale, 0 for any other
+  const int16_t* columns;  // For any other, the screen column (from screenX) of each of those pixels
+};
+
+// `count` pixels of a readNextRow() row from pixel `first` on, in glyph format and moved to the start of `out`. The row
+// needs a spare byte at its end.
+static void alignBitmapPixels(const uint8_t* row, const int first, const int count, uint8_t* out) {
+  const uint8_t* in = row + first / 4;
+  const int shift = (first % 4) * 2;
+  const int bytes = (count + 3) / 4;
+  for (int i = 0; i < bytes; i++) {
+    out[i] = ~static_cast<uint8_t>(shift ? in[i] << shift | in[i + 1] >> (8 - shift) : in[i]);
+  }
+  if (count % 4 != 0) {
+    out[bytes - 1] &= static_cast<uint8_t>(0xFF00 >> (count % 4 * 2));
+  }
+}
+
+// Builds screen row `screenY` from a readNextRow() row into `out` and draws it, either as is or as 1-bit ink
+void GfxRenderer::drawBitmapRow(const BitmapColumns& cols, const uint8_t* row, uint8_t* levels, uint8_t* out,
+                                const int screenY, const bool oneBit) const {
+  const int bytes = (cols.count + 3) / 4;
+  if (cols.ratio == 1) {
+    alignBitmapPixels(row, cols.first, cols.pixels, out);
+  } else if (cols.ratio == 2) {
+    const int alignedBytes = (cols.pixels + 3) / 4;
+    alignBitmapPixels(row, cols.first, cols.pixels, out);
+    out[alignedBytes] = 0;
+    for (int i = 0; i < bytes; i++) {
+      out[i] = static_cast<uint8_t>(BITMAP_TABLES.pairs[out[i * 2]] << 4 | BITMAP_TABLES.pairs[out[i * 2 + 1]]);
+    }
+  } else {
+    memset(levels, 0, cols.count);
+    for (int i = 0; i < cols.pixels; i++) {
+      const int pixel = cols.first + i;
+      const uint8_t rank = BITMAP_RANK[3 - ((row[pixel / 4] >> (6 - pixel % 4 * 2)) & 3)];
+      uint8_t& level = levels[cols.columns[i]];
+      level = std::max(level, rank);
+    }
+    memset(out, 0, bytes);
+    for (int i = 0; i < cols.count; i++) {
+      out[i / 4] |= BITMAP_LEVEL[levels[i]] << (6 - i % 4 * 2);
+    }
+  }
+
+  if (oneBit) {
+    out[bytes] = 0;
+    for (int i = 0; i < (cols.count + 7) / 8; i++) {
+      out[i] = static_cast<uint8_t>(BITMAP_TABLES.ink[out[i * 2]] << 4 | BITMAP_TABLES.ink[out[i * 2 + 1]]);
+    }
+  }
+  drawGlyphBitmap(out, !oneBit, cols.count, 1, cols.screenX, screenY, false, true);
+}
+
+// Maps the `width` bitmap pixels from `first` on to screen columns from x on, and sets up `scratch` for the rows:
+// the column table, a level per screen column, the built screen row, then readNextRow()'s two buffers. Returns the
+// start of readNextRow()'s output row, or nullptr if nothing lands on screen or out of memory.
+uint8_t* GfxRenderer::prepareBitmapRows(const Bitmap& bitmap, const int x, const int first, const int width,
+                                        const bool isScaled, const float scale, BitmapColumns* cols) const {
+  if (width <= 0) {
+    return nullptr;
+  }
+  // Screen columns only ever go up with the bitmap pixel, so the ones on screen are a single run
+  const int screenWidth = isScaled ? static_cast<int>(std::floor((width - 1) * scale)) + 1 : width;
+  const int lo = std::max(0, -x);
+  const int hi = std::min(screenWidth, getScreenWidth() - x);
+  if (lo >= hi) {
+    return nullptr;
+  }
+  cols->screenX = x + lo;
+  cols->count = hi - lo;
+  cols->ratio = !isScaled ? 1 : scale == 0.5f ? 2 : 0;
+  int pixelLo = 0, pixelHi = width;
+  if (cols->ratio != 0) {
+    pixelLo = lo * cols->ratio;
+    pixelHi = std::min(width, hi * cols->ratio);
+  } else {
+    while (static_cast<int>(std::floor(pixelLo * scale)) < lo) pixelLo++;
+    pixelHi = pixelLo;
+    while (pixelHi < width && static_cast<int>(std::floor(pixelHi * scale)) < hi) pixelHi++;
+  }
+  cols->first = first + pixelLo;
+  cols->pixels = pixelHi - pixelLo;
+
+  const size_t columnBytes = cols->ratio != 0 ? 0 : cols->pixels * sizeof(int16_t);
+  const size_t levelBytes = cols->ratio != 0 ? 0 : cols->count;
+  const size_t outBytes = (std::max(cols->pixels, cols->count) + 3) / 4 + 2;
+  const size_t rowBytes = (bitmap.getWidth() + 3) / 4 + 1;
+  const size_t size = columnBytes + levelBytes + outBytes + rowBytes + bitmap.getRowBytes();
+  if (size > bitmapScratchSize) {
+    free(bitmapScratch);
+    bitmapScratch = static_cast<uint8_t*>(malloc(size));
+    bitmapScratchSize = bitmapScratch ? size : 0;
+    if (!bitmapScratch) {
+      LOG_ERR("GFX", "!! Failed to allocate %u bytes of BMP row buffers", static_cast<unsigned>(size));
+      return nullptr;
+    }
+  }
+
+  auto* columns = reinterpret_cast<int16_t*>(bitmapScratch);
+  for (int i = 0; i < static_cast<int>(columnBytes / sizeof(int16_t)); i++) {
+    columns[i] = static_cast<int16_t>(static_cast<int>(std::floor((pixelLo + i) * scale)) - lo);
+  }
+  cols->columns = columns;
+  return bitmapScratch + columnBytes + levelBytes + outBytes;
+}
+
+// Large scratch buffers are only kept until the bitmap is drawn
+void GfxRenderer::releaseBitmapScratch() const {
+  if (bitmapScratchSize > BITMAP_SCRATCH_KEEP) {
+    free(bitmapScratch);
+    bitmapScratch = nullptr;
+    bitmapScratchSize = 0;
+  }
+}
+
 void GfxRenderer::drawBitmap(const Bitmap& bitmap, const int x, const int y, const int maxWidth, const int maxHeight,
                              const float cropX, const float cropY) const {
   // For 1-bit bitmaps, use optimized 1-bit rendering path (no crop support for 1-bit)
@@ -598,18 +1020,15 @@ void GfxRenderer::drawBitmap(const Bitmap& bitmap, const int x, const int y, con
   }
   LOG_DBG("GFX", "Scaling by %f - %s", scale, isScaled ? "scaled" : "not scaled");
 
-  // Calculate output row size (2 bits per pixel, packed into bytes)
-  // IMPORTANT: Use int, not uint8_t, to avoid overflow for images > 1020 pixels wide
-  const int outputRowSize = (bitmap.getWidth() + 3) / 4;
-  auto* outputRow = static_cast<uint8_t*>(malloc(outputRowSize));
-  auto* rowBytes = static_cast<uint8_t*>(malloc(bitmap.getRowBytes()));
-
-  if (!outputRow || !rowBytes) {
-    LOG_ERR("GFX", "!! Failed to allocate BMP row buffers");
-    free(outputRow);
-    free(rowBytes);
+  BitmapColumns cols{};
+  uint8_t* outputRow =
+      prepareBitmapRows(bitmap, x, cropPixX, bitmap.getWidth() - 2 * cropPixX, isScaled, scale, &cols);
+  if (!outputRow) {
     return;
   }
+  uint8_t* rowBytes = outputRow + (bitmap.getWidth() + 3) / 4 + 1;
+  uint8_t* out = outputRow - ((std::max(cols.pixels, cols.count) + 3) / 4 + 2);
+  uint8_t* levels = out - (cols.ratio != 0 ? 0 : cols.count);
 
   for (int bmpY = 0; bmpY < (bitmap.getHeight() - cropPixY); bmpY++) {
     // The BMP's (0, 0) is the bottom-left corner (if the height is positive, top-left if negative).
@@ -625,9 +1044,7 @@ void GfxRenderer::drawBitmap(const Bitmap& bitmap, const int x, const int y, con
 
     if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
       LOG_ERR("GFX", "Failed to read row %d from bitmap", bmpY);
-      free(outputRow);
-      free(rowBytes);
-      return;
+      break;
     }
 
     if (screenY < 0) {
@@ -639,33 +1056,10 @@ void GfxRenderer::drawBitmap(const Bitmap& bitmap, const int x, const int y, con
       continue;
     }
 
-    for (int bmpX = cropPixX; bmpX < bitmap.getWidth() - cropPixX; bmpX++) {
-      int screenX = bmpX - cropPixX;
-      if (isScaled) {
-        screenX = std::floor(screenX * scale);
-      }
-      screenX += x;  // the offset should not be scaled
-      if (screenX >= getScreenWidth()) {
-        break;
-      }
-      if (screenX < 0) {
-        continue;
-      }
-
-      const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
-
-      if (renderMode == BW && val < 3) {
-        drawPixel(screenX, screenY);
-      } else if (renderMode == GRAYSCALE_MSB && (val == 1 || val == 2)) {
-        drawPixel(screenX, screenY, false);
-      } else if (renderMode == GRAYSCALE_LSB && val == 1) {
-        drawPixel(screenX, screenY, false);
-      }
-    }
+    drawBitmapRow(cols, outputRow, levels, out, screenY, false);
   }
 
-  free(outputRow);
-  free(rowBytes);
+  releaseBitmapScratch();
 }
 
 void GfxRenderer::drawBitmap1Bit(const Bitmap& bitmap, const int x, const int y, const int maxWidth,
@@ -682,24 +1076,20 @@ void GfxRenderer::drawBitmap1Bit(const Bitmap& bitmap, const int x, const int y,
   }
 
   // For 1-bit BMP, output is still 2-bit packed (for consistency with readNextRow)
-  const int outputRowSize = (bitmap.getWidth() + 3) / 4;
-  auto* outputRow = static_cast<uint8_t*>(malloc(outputRowSize));
-  auto* rowBytes = static_cast<uint8_t*>(malloc(bitmap.getRowBytes()));
-
-  if (!outputRow || !rowBytes) {
-    LOG_ERR("GFX", "!! Failed to allocate 1-bit BMP row buffers");
-    free(outputRow);
-    free(rowBytes);
+  BitmapColumns cols{};
+  uint8_t* outputRow = prepareBitmapRows(bitmap, x, 0, bitmap.getWidth(), isScaled, scale, &cols);
+  if (!outputRow) {
     return;
   }
+  uint8_t* rowBytes = outputRow + (bitmap.getWidth() + 3) / 4 + 1;
+  uint8_t* out = outputRow - ((std::max(cols.pixels, cols.count) + 3) / 4 + 2);
+  uint8_t* levels = out - (cols.ratio != 0 ? 0 : cols.count);
 
   for (int bmpY = 0; bmpY < bitmap.getHeight(); bmpY++) {
     // Read rows sequentially using readNextRow
     if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
       LOG_ERR("GFX", "Failed to read row %d from 1-bit bitmap", bmpY);
-      free(outputRow);
-      free(rowBytes);
-      return;
+      break;
     }
 
     // Calculate screen Y based on whether BMP is top-down or bottom-up
@@ -712,29 +1102,11 @@ void GfxRenderer::drawBitmap1Bit(const Bitmap& bitmap, const int x, const int y,
       continue;
     }
 
-    for (int bmpX = 0; bmpX < bitmap.getWidth(); bmpX++) {
-      int screenX = x + (isScaled ? static_cast<int>(std::floor(bmpX * scale)) : bmpX);
-      if (screenX >= getScreenWidth()) {
-        break;
-      }
-      if (screenX < 0) {
-        continue;
-      }
-
-      // Get 2-bit value (result of readNextRow quantization)
-      const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
-
-      // For 1-bit source: 0 or 1 -> map to black (0,1,2) or white (3)
-      // val < 3 means black pixel (draw it)
-      if (val < 3) {
-        drawPixel(screenX, screenY, true);
-      }
-      // White pixels (val == 3) are not drawn (leave background)
-    }
+    // For 1-bit source: 0 or 1 -> map to black (0,1,2) or white (3); white pixels leave the background
+    drawBitmapRow(cols, outputRow, levels, out, screenY, true);
   }
 
-  free(outputRow);
-  free(rowBytes);
+  releaseBitmapScratch();
 }
 
 void GfxRenderer::fillPolygon(const int* xPoints, const int* yPoints, int numPoints, bool state) const {
@@ -820,6 +1192,7 @@ void GfxRenderer::invertScreen() const {
 }
 
 void GfxRenderer::displayBuffer(const HalDisplay::RefreshMode refreshMode) const {
+  PERF_SCOPE(DisplayRefresh);
   auto elapsed = millis() - start_ms;
   LOG_DBG("GFX", "Time = %lu ms from clearScreen to displayBuffer", elapsed);
   display.displayBuffer(refreshMode, fadingFix);
@@ -1057,7 +1430,7 @@ void GfxRenderer::drawTextRotated90CW(const int fontId, const int x, const int y
 
       int combiningX = lastBaseX - raiseBy;
       int combiningY = lastBaseY - lastBaseAdvance / 2;
-      renderCharImpl<TextRotation::Rotated90CW>(*this, renderMode, font, cp, &combiningX, &combiningY, black, style);
+      renderCharImpl<TextRotation::Rotated90CW>(*this, font, cp, &combiningX, &combiningY, black, style);
       continue;
     }
 
@@ -1073,7 +1446,7 @@ void GfxRenderer::drawTextRotated90CW(const int fontId, const int x, const int y
     lastBaseAdvance = glyph ? glyph->advanceX : 0;
     lastBaseTop = glyph ? glyph->top : 0;
 
-    renderCharImpl<TextRotation::Rotated90CW>(*this, renderMode, font, cp, &xPos, &yPos, black, style);
+    renderCharImpl<TextRotation::Rotated90CW>(*this, font, cp, &xPos, &yPos, black, style);
     prevCp = cp;
   }
 }
@@ -1100,14 +1473,8 @@ void GfxRenderer::freeBwBufferChunks() {
   }
 }
 
-/**
- * This should be called before grayscale buffers are populated.
- * A `restoreBwBuffer` call should always follow the grayscale render if this method was called.
- * Uses chunked allocation to avoid needing 48KB of contiguous memory.
- * Returns true if buffer was stored successfully, false if allocation failed.
- */
-bool GfxRenderer::storeBwBuffer() {
-  // Allocate and copy each chunk
+// Uses chunked allocation to avoid needing 48KB of contiguous memory
+bool GfxRenderer::allocateBwBufferChunks() {
   for (size_t i = 0; i < BW_BUFFER_NUM_CHUNKS; i++) {
     // Check if any chunks are already allocated
     if (bwBufferChunks[i]) {
@@ -1116,7 +1483,6 @@ bool GfxRenderer::storeBwBuffer() {
       bwBufferChunks[i] = nullptr;
     }
 
-    const size_t offset = i * BW_BUFFER_CHUNK_SIZE;
     bwBufferChunks[i] = static_cast<uint8_t*>(malloc(BW_BUFFER_CHUNK_SIZE));
 
     if (!bwBufferChunks[i]) {
@@ -1125,8 +1491,21 @@ bool GfxRenderer::storeBwBuffer() {
       freeBwBufferChunks();
       return false;
     }
+  }
+  return true;
+}
 
-    memcpy(bwBufferChunks[i], frameBuffer + offset, BW_BUFFER_CHUNK_SIZE);
+/**
+ * This should be called before grayscale buffers are populated.
+ * A `restoreBwBuffer` call should always follow the grayscale render if this method was called.
+ * Returns true if buffer was stored successfully, false if allocation failed.
+ */
+bool GfxRenderer::storeBwBuffer() {
+  if (!allocateBwBufferChunks()) {
+    return false;
+  }
+  for (size_t i = 0; i < BW_BUFFER_NUM_CHUNKS; i++) {
+    memcpy(bwBufferChunks[i], frameBuffer + i * BW_BUFFER_CHUNK_SIZE, BW_BUFFER_CHUNK_SIZE);
   }
 
   LOG_DBG("GFX", "Stored BW buffer in %zu chunks (%zu bytes each)", BW_BUFFER_NUM_CHUNKS, BW_BUFFER_CHUNK_SIZE);
@@ -1164,6 +1543,215 @@ void GfxRenderer::restoreBwBuffer() {
   LOG_DBG("GFX", "Restored and freed BW buffer chunks");
 }
 
+bool GfxRenderer::beginGrayscaleCapture() {
+  if (!allocateBwBufferChunks()) {
+    return false;
+  }
+  for (auto* chunk : bwBufferChunks) {
+    memset(chunk, 0, BW_BUFFER_CHUNK_SIZE);
+  }
+  renderMode = BW_AND_GRAYSCALE;
+  return true;
+}
+
+// Bit extract and deposit on nibbles, to pack the bits of a byte selected by a mask and unpack them again
+struct NibbleTables {
+  uint8_t extract[16][16];  // [mask][value]: the value's bits under the mask, moved down to the low end
+  uint8_t deposit[16][16];  // [mask][bits]: the low bits spread out to the mask's positions
+  uint8_t count[16];
+};
+
+static constexpr NibbleTables makeNibbleTables() {
+  NibbleTables t{};
+  for (int mask = 0; mask < 16; mask++) {
+    for (int value = 0; value < 16; value++) {
+      int out = 0;
+      int in = 0;
+      for (int bit = 0; bit < 4; bit++) {
+        if (mask & (1 << bit)) {
+          t.extract[mask][value] |= ((value >> bit) & 1) << out++;
+          t.deposit[mask][value] |= ((value >> in++) & 1) << bit;
+        }
+      }
+      t.count[mask] = out;
+    }
+  }
+  return t;
+}
+
+static constexpr NibbleTables NIBBLES = makeNibbleTables();
+
+static inline uint8_t extractBits(const uint8_t value, const uint8_t mask) {
+  return NIBBLES.extract[mask & 15][value & 15] | NIBBLES.extract[mask >> 4][value >> 4] << NIBBLES.count[mask & 15];
+}
+
+static inline uint8_t depositBits(const uint8_t bits, const uint8_t mask) {
+  return NIBBLES.deposit[mask & 15][bits & 15] | NIBBLES.deposit[mask >> 4][(bits >> NIBBLES.count[mask & 15]) & 15]
+                                                     << 4;
+}
+
+static inline int countBits(const uint8_t mask) { return NIBBLES.count[mask & 15] + NIBBLES.count[mask >> 4]; }
+
+// Neither the ESP32-C3 nor baseline x86-64 has a popcount instruction, and the library call is slow
+static inline int countBits32(uint32_t word) {
+  word = word - ((word >> 1) & 0x55555555);
+  word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+  return (((word + (word >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+namespace {
+
+inline uint32_t loadWord(const uint8_t* bytes) {
+  uint32_t word;
+  memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+// Up to 32 bits at a time, first written first read
+class BitWriter {
+  uint8_t* out;
+  uint64_t pending = 0;
+  int pendingBits = 0;
+
+ public:
+  explicit BitWriter(uint8_t* out) : out(out) {}
+  void write(const uint32_t bits, const int count) {
+    pending |= static_cast<uint64_t>(bits) << pendingBits;
+    pendingBits += count;
+    while (pendingBits >= 8) {
+      *out++ = pending;
+      pending >>= 8;
+      pendingBits -= 8;
+    }
+  }
+  void flush() const {
+    if (pendingBits) *out = pending;
+  }
+};
+
+class BitReader {
+  const uint8_t* in;
+  uint64_t pending = 0;
+  int pendingBits = 0;
+
+ public:
+  explicit BitReader(const uint8_t* in) : in(in) {}
+  uint32_t read(const int count) {
+    while (pendingBits < count) {
+      pending |= static_cast<uint64_t>(*in++) << pendingBits;
+      pendingBits += 8;
+    }
+    const uint32_t bits = pending & ((1ULL << count) - 1);
+    pending >>= count;
+    pendingBits -= count;
+    return bits;
+  }
+};
+
+}  // namespace
+
+/**
+ * Turns the capture into the BW frame, which is also stored for displayCapturedGrayscale(), and two bit streams: for
+ * every black pixel of the frame whether it is gray (gray ones are always among them), and for every gray pixel whether
+ * it is dark. For a page of text that is about a twelfth of the size of the two grayscale planes.
+ */
+bool GfxRenderer::endGrayscaleCapture() {
+  renderMode = BW;
+  size_t grayBits = 0;
+  size_t darkBits = 0;
+  for (size_t c = 0; c < BW_BUFFER_NUM_CHUNKS; c++) {
+    const uint8_t* frame = frameBuffer + c * BW_BUFFER_CHUNK_SIZE;
+    const uint8_t* gray = bwBufferChunks[c];
+    for (size_t i = 0; i < BW_BUFFER_CHUNK_SIZE; i += 4) {
+      const uint32_t grayWord = loadWord(gray + i);
+      grayBits += countBits32(~loadWord(frame + i) | grayWord);
+      darkBits += countBits32(grayWord);
+    }
+  }
+  capturedDarkOffset = grayBits / 8 + 1;
+  const size_t capturedBytes = capturedDarkOffset + darkBits / 8 + 1;
+
+  free(capturedGray);
+  capturedGray = static_cast<uint8_t*>(malloc(capturedBytes));
+  if (!capturedGray) {
+    LOG_ERR("GFX", "!! Failed to allocate %zu bytes for captured gray levels", capturedBytes);
+    // Keep the BW frame at least
+    for (size_t i = 0; i < HalDisplay::BUFFER_SIZE; i++) {
+      frameBuffer[i] &= ~bwBufferChunks[i / BW_BUFFER_CHUNK_SIZE][i % BW_BUFFER_CHUNK_SIZE];
+    }
+    freeBwBufferChunks();
+    return false;
+  }
+
+  // Four bytes at a time, as most words are white or have no gray pixel
+  BitWriter grayOut(capturedGray);
+  BitWriter darkOut(capturedGray + capturedDarkOffset);
+  for (size_t c = 0; c < BW_BUFFER_NUM_CHUNKS; c++) {
+    uint8_t* frame = frameBuffer + c * BW_BUFFER_CHUNK_SIZE;
+    const uint8_t* grayPlane = bwBufferChunks[c];
+    for (size_t i = 0; i < BW_BUFFER_CHUNK_SIZE; i += 4) {
+      const uint32_t grayWord = loadWord(grayPlane + i);
+      if (grayWord == 0) {
+        grayOut.write(0, countBits32(~loadWord(frame + i)));
+        continue;
+      }
+      for (size_t j = i; j < i + 4; j++) {
+        const uint8_t gray = grayPlane[j];
+        const uint8_t black = ~frame[j] | gray;
+        grayOut.write(extractBits(gray, black), countBits(black));
+        darkOut.write(extractBits(~frame[j], gray), countBits(gray));
+        frame[j] = ~black;
+      }
+    }
+    memcpy(bwBufferChunks[c], frame, BW_BUFFER_CHUNK_SIZE);
+  }
+  grayOut.flush();
+  darkOut.flush();
+  LOG_DBG("GFX", "Captured gray levels in %zu bytes", capturedBytes);
+  return true;
+}
+
+// Writes the LSB (dark gray) or MSB (any gray) plane of the capture into the frame buffer
+void GfxRenderer::expandCapturedPlane(const bool msb) const {
+  BitReader grayIn(capturedGray);
+  BitReader darkIn(capturedGray + capturedDarkOffset);
+  for (size_t c = 0; c < BW_BUFFER_NUM_CHUNKS; c++) {
+    uint8_t* plane = frameBuffer + c * BW_BUFFER_CHUNK_SIZE;
+    const uint8_t* bw = bwBufferChunks[c];
+    for (size_t i = 0; i < BW_BUFFER_CHUNK_SIZE; i += 4) {
+      uint32_t grayBits = grayIn.read(countBits32(~loadWord(bw + i)));
+      if (grayBits == 0) {
+        memset(plane + i, 0, 4);
+        continue;
+      }
+      for (size_t j = i; j < i + 4; j++) {
+        const uint8_t black = ~bw[j];
+        uint8_t gray = depositBits(grayBits, black);
+        grayBits >>= countBits(black);
+        if (gray && !msb) {
+          gray = depositBits(darkIn.read(countBits(gray)), gray);
+        }
+        plane[j] = gray;
+      }
+    }
+  }
+}
+
+void GfxRenderer::displayCapturedGrayscale() {
+  if (!capturedGray) {
+    LOG_ERR("GFX", "!! No captured grayscale to display");
+    return;
+  }
+  expandCapturedPlane(false);
+  display.copyGrayscaleLsbBuffers(frameBuffer);
+  expandCapturedPlane(true);
+  display.copyGrayscaleMsbBuffers(frameBuffer);
+  display.displayGrayBuffer(fadingFix);
+  free(capturedGray);
+  capturedGray = nullptr;
+  restoreBwBuffer();
+}
+
 /**
  * Cleanup grayscale buffers using the current frame buffer.
  * Use this when BW buffer was re-rendered instead of stored/restored.
@@ -1176,7 +1764,7 @@ void GfxRenderer::cleanupGrayscaleWithFrameBuffer() const {
 
 void GfxRenderer::renderChar(const EpdFontFamily& fontFamily, uint32_t cp, int* x, int* y, bool pixelState,
                              EpdFontFamily::Style style) const {
-  renderCharImpl<TextRotation::None>(*this, renderMode, fontFamily, cp, x, y, pixelState, style);
+  renderCharImpl<TextRotation::None>(*this, fontFamily, cp, x, y, pixelState, style);
 }
 
 void GfxRenderer::getOrientedViewableTRBL(int* outTop, int* outRight, int* outBottom, int* outLeft) const {
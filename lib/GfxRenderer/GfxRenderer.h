@@ -16,7 +16,8 @@ enum Color : uint8_t { Clear = 0x00, White = 0x01, LightGray = 0x05, DarkGray =
 
 class GfxRenderer {
  public:
-  enum RenderMode { BW, GRAYSCALE_LSB, GRAYSCALE_MSB };
+  // BW_AND_GRAYSCALE draws the BW frame and captures both grayscale planes in one pass, see beginGrayscaleCapture()
+  enum RenderMode { BW, GRAYSCALE_LSB, GRAYSCALE_MSB, BW_AND_GRAYSCALE };
 
   // Logical screen orientation from the perspective of callers
   enum Orientation {
@@ -31,27 +32,45 @@ class GfxRenderer {
   static constexpr size_t BW_BUFFER_NUM_CHUNKS = HalDisplay::BUFFER_SIZE / BW_BUFFER_CHUNK_SIZE;
   static_assert(BW_BUFFER_CHUNK_SIZE * BW_BUFFER_NUM_CHUNKS == HalDisplay::BUFFER_SIZE,
                 "BW buffer chunking does not line up with display buffer size");
+  static constexpr size_t BITMAP_SCRATCH_KEEP = 4096;  // Bitmap row buffers up to this size stay allocated
 
   HalDisplay& display;
   RenderMode renderMode;
   Orientation orientation;
   bool fadingFix;
   uint8_t* frameBuffer = nullptr;
+  // Holds the stored BW frame, or while capturing in BW_AND_GRAYSCALE mode, which pixels are gray
   uint8_t* bwBufferChunks[BW_BUFFER_NUM_CHUNKS] = {nullptr};
+  // Gray levels of a finished capture: a gray bit per black pixel of the stored frame, then a dark bit per gray pixel
+  uint8_t* capturedGray = nullptr;
+  size_t capturedDarkOffset = 0;  // Where the dark bits start
   std::map<int, EpdFontFamily> fontMap;
   FontDecompressor* fontDecompressor = nullptr;
+  // Row buffers for drawBitmap(), reused from one bitmap to the next
+  mutable uint8_t* bitmapScratch = nullptr;
+  mutable size_t bitmapScratchSize = 0;
+  struct BitmapColumns;
   void renderChar(const EpdFontFamily& fontFamily, uint32_t cp, int* x, int* y, bool pixelState,
                   EpdFontFamily::Style style) const;
+  bool allocateBwBufferChunks();
   void freeBwBufferChunks();
-  template <Color color>
-  void drawPixelDither(int x, int y) const;
-  template <Color color>
-  void fillArc(int maxRadius, int cx, int cy, int xDir, int yDir) const;
+  void expandCapturedPlane(bool msb) const;
+  void fillSpans(int x1, int y1, int x2, int y2, Color color) const;
+  void fillArc(int maxRadius, int cx, int cy, int xDir, int yDir, Color color) const;
+  uint8_t* prepareBitmapRows(const Bitmap& bitmap, int x, int first, int width, bool isScaled, float scale,
+                             BitmapColumns* cols) const;
+  void drawBitmapRow(const BitmapColumns& cols, const uint8_t* row, uint8_t* levels, uint8_t* out, int screenY,
+                     bool oneBit) const;
+  void releaseBitmapScratch() const;
 
  public:
   explicit GfxRenderer(HalDisplay& halDisplay)
       : display(halDisplay), renderMode(BW), orientation(Portrait), fadingFix(false) {}
-  ~GfxRenderer() { freeBwBufferChunks(); }
+  ~GfxRenderer() {
+    freeBwBufferChunks();
+    free(capturedGray);
+    free(bitmapScratch);
+  }
 
   static constexpr int VIEWABLE_MARGIN_TOP = 9;
   static constexpr int VIEWABLE_MARGIN_RIGHT = 3;
@@ -62,8 +81,11 @@ class GfxRenderer {
   void begin();  // must be called right after display.begin()
   void insertFont(int fontId, EpdFontFamily font);
   void setFontDecompressor(FontDecompressor* d) { fontDecompressor = d; }
+  // Frees the decompressed glyph groups and every font's Latin lookup table; both are rebuilt as fonts are used again.
+  // Call it with RenderLock held, so that no layout or render is using the fonts.
   void clearFontCache() {
     if (fontDecompressor) fontDecompressor->clearCache();
+    for (const auto& [fontId, family] : fontMap) family.releaseLatinTables();
   }
 
   // Orientation control (affects logical width/height and coordinate transforms)
@@ -142,9 +164,24 @@ class GfxRenderer {
   bool storeBwBuffer();    // Returns true if buffer was stored successfully
   void restoreBwBuffer();  // Restore and free the stored buffer
   void cleanupGrayscaleWithFrameBuffer() const;
+  // Single-pass anti-aliasing. beginGrayscaleCapture() switches to BW_AND_GRAYSCALE; what is drawn until
+  // endGrayscaleCapture() lands in the BW frame as usual, and glyphs and bitmaps also record their gray levels
+  // (clearScreen(), drawImage() and drawIcon() write the frame directly and are not tracked, so don't use them). The
+  // end packs the levels, leaves the BW frame to display and stores it like storeBwBuffer();
+  // displayCapturedGrayscale() then shows the grayscale layer and restores the frame like restoreBwBuffer(). Both
+  // return false if out of memory, with nothing captured and the BW frame intact.
+  bool beginGrayscaleCapture();
+  bool endGrayscaleCapture();
+  void displayCapturedGrayscale();
+  // Level 0 (black) to 2 (light gray) of a glyph or bitmap pixel in BW_AND_GRAYSCALE mode
+  void drawGrayPixel(int x, int y, uint8_t level) const;
 
   // Font helpers
   const uint8_t* getGlyphBitmap(const EpdFontData* fontData, const EpdGlyph* glyph) const;
+  // Draws a glyph bitmap in the current render mode with its pixel (0, 0) at logical (x, y). rotated90 runs the glyph's
+  // rows down the screen and its columns up it, as drawTextRotated90CW() does.
+  void drawGlyphBitmap(const uint8_t* bitmap, bool is2Bit, int width, int height, int x, int y, bool rotated90,
+                       bool pixelState) const;
 
   // Low level functions
   uint8_t* getFrameBuffer() const;
@@ -1,6 +1,7 @@
 #include "JpegToBmpConverter.h"
 
 #include <HalStorage.h>
+#include <HeapTrace.h>
 #include <Logging.h>
 #include <picojpeg.h>
 
@@ -201,6 +202,7 @@ unsigned char JpegToBmpConverter::jpegReadCallback(unsigned char* pBuf, const un
 // Internal implementation with configurable target size and bit depth
 bool JpegToBmpConverter::jpegFileToBmpStreamInternal(FsFile& jpegFile, Print& bmpOut, int targetWidth, int targetHeight,
                                                      bool oneBit, bool crop) {
+  HEAP_SCOPE(ImageDecode);
   LOG_DBG("JPG", "Converting JPEG to %s BMP (target: %dx%d)", oneBit ? "1-bit" : "2-bit", targetWidth, targetHeight);
 
   // Setup context for picojpeg callback
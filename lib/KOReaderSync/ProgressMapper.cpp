@@ -2,9 +2,11 @@
 
 #include <Logging.h>
 
+#include <algorithm>
 #include <cmath>
 
-KOReaderPosition ProgressMapper::toKOReader(const std::shared_ptr<Epub>& epub, const CrossPointPosition& pos) {
+KOReaderPosition ProgressMapper::toKOReader(const std::shared_ptr<Epub>& epub, const CrossPointPosition& pos,
+                                            const BookPageMap* pageMap) {
   KOReaderPosition result;
 
   // Calculate page progress within current spine item
@@ -14,7 +16,12 @@ KOReaderPosition ProgressMapper::toKOReader(const std::shared_ptr<Epub>& epub, c
   }
 
   // Calculate overall book progress (0.0-1.0)
-  result.percentage = epub->calculateProgress(pos.spineIndex, intraSpineProgress);
+  if (pageMap && pageMap->isComplete() && pageMap->totalPages() > 0) {
+    result.percentage = static_cast<float>(pageMap->bookPage(pos.spineIndex, pos.pageNumber)) /
+                        static_cast<float>(pageMap->totalPages());
+  } else {
+    result.percentage = epub->calculateProgress(pos.spineIndex, intraSpineProgress);
+  }
 
   // Generate XPath with estimated paragraph position based on page
   result.xpath = generateXPath(pos.spineIndex, pos.pageNumber, pos.totalPages);
@@ -30,12 +37,23 @@ KOReaderPosition ProgressMapper::toKOReader(const std::shared_ptr<Epub>& epub, c
 }
 
 CrossPointPosition ProgressMapper::toCrossPoint(const std::shared_ptr<Epub>& epub, const KOReaderPosition& koPos,
-                                                int currentSpineIndex, int totalPagesInCurrentSpine) {
+                                                int currentSpineIndex, int totalPagesInCurrentSpine,
+                                                const BookPageMap* pageMap) {
   CrossPointPosition result;
   result.spineIndex = 0;
   result.pageNumber = 0;
   result.totalPages = 0;
 
+  // With every page counted, the percentage lands on an exact page
+  if (pageMap && pageMap->isComplete() &&
+      pageMap->locate(static_cast<uint32_t>(std::max(0.0f, koPos.percentage) * pageMap->totalPages()),
+                      result.spineIndex, result.pageNumber)) {
+    result.totalPages = pageMap->pageCount(result.spineIndex);
+    LOG_DBG("ProgressMapper", "KOReader -> CrossPoint: %.2f%% at %s -> spine=%d, page=%d (page map)",
+            koPos.percentage * 100, koPos.xpath.c_str(), result.spineIndex, result.pageNumber);
+    return result;
+  }
+
   const size_t bookSize = epub->getBookSize();
   if (bookSize == 0) {
     return result;
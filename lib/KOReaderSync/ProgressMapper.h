@@ -1,5 +1,6 @@
 #pragma once
 #include <Epub.h>
+#include <Epub/BookPageMap.h>
 
 #include <memory>
 #include <string>
@@ -38,9 +39,12 @@ class ProgressMapper {
    *
    * @param epub The EPUB book
    * @param pos CrossPoint position
+   * @param pageMap Page counts of the whole book; when complete, the percentage is exact instead of estimated
+   *                from spine item sizes
    * @return KOReader position
    */
-  static KOReaderPosition toKOReader(const std::shared_ptr<Epub>& epub, const CrossPointPosition& pos);
+  static KOReaderPosition toKOReader(const std::shared_ptr<Epub>& epub, const CrossPointPosition& pos,
+                                     const BookPageMap* pageMap = nullptr);
 
   /**
    * Convert KOReader position to CrossPoint format.
@@ -52,10 +56,12 @@ class ProgressMapper {
    * @param koPos KOReader position
    * @param currentSpineIndex Index of the currently open spine item (for density estimation)
    * @param totalPagesInCurrentSpine Total pages in the current spine item (for density estimation)
+   * @param pageMap Page counts of the whole book; when complete, the percentage maps to an exact page
    * @return CrossPoint position
    */
   static CrossPointPosition toCrossPoint(const std::shared_ptr<Epub>& epub, const KOReaderPosition& koPos,
-                                         int currentSpineIndex = -1, int totalPagesInCurrentSpine = 0);
+                                         int currentSpineIndex = -1, int totalPagesInCurrentSpine = 0,
+                                         const BookPageMap* pageMap = nullptr);
 
  private:
   /**
@@ -0,0 +1,142 @@
+#include "HeapTrace.h"
+
+#include <Arduino.h>
+#include <Logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+namespace perf {
+
+namespace {
+
+constexpr int TAG_COUNT = static_cast<int>(HeapTag::COUNT);
+
+struct TagState {
+  std::atomic<uint16_t> depth{0};
+  std::atomic<uint32_t> baseline{0};
+  std::atomic<uint32_t> peak{0};
+  std::atomic<uint32_t> scopes{0};
+  std::atomic<int32_t> net{0};
+};
+
+TagState tags[TAG_COUNT];
+std::atomic<uint32_t> minFree{UINT32_MAX};
+std::atomic<uint32_t> minLargestBlock{UINT32_MAX};
+
+constexpr const char* TAG_NAMES[TAG_COUNT] = {
+    "parser", "css", "fontDecompressor", "imageDecode", "webServer", "page",
+};
+
+void atomicMax(std::atomic<uint32_t>& target, const uint32_t value) {
+  uint32_t seen = target.load(std::memory_order_relaxed);
+  while (value > seen && !target.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+  }
+}
+
+void atomicMin(std::atomic<uint32_t>& target, const uint32_t value) {
+  uint32_t seen = target.load(std::memory_order_relaxed);
+  while (value < seen && !target.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+  }
+}
+
+uint32_t growth(const TagState& state, const uint32_t used) {
+  const uint32_t baseline = state.baseline.load(std::memory_order_relaxed);
+  return used > baseline ? used - baseline : 0;
+}
+
+// Returns the heap in use after charging it to every open scope
+uint32_t sample() {
+  const uint32_t free = ESP.getFreeHeap();
+  const uint32_t used = ESP.getHeapSize() - free;
+  atomicMin(minFree, free);
+  for (auto& state : tags) {
+    if (state.depth.load(std::memory_order_relaxed) > 0) {
+      atomicMax(state.peak, growth(state, used));
+    }
+  }
+  return used;
+}
+
+}  // namespace
+
+const char* heapTagName(const HeapTag tag) { return TAG_NAMES[static_cast<int>(tag)]; }
+
+void heapEnter(const HeapTag tag) {
+  TagState& state = tags[static_cast<int>(tag)];
+  if (state.depth.fetch_add(1, std::memory_order_relaxed) == 0) {
+    state.baseline.store(ESP.getHeapSize() - ESP.getFreeHeap(), std::memory_order_relaxed);
+    state.scopes.fetch_add(1, std::memory_order_relaxed);
+  }
+  sample();
+}
+
+void heapExit(const HeapTag tag) {
+  TagState& state = tags[static_cast<int>(tag)];
+  const uint32_t used = sample();
+  if (state.depth.fetch_sub(1, std::memory_order_relaxed) == 1) {
+    const uint32_t baseline = state.baseline.load(std::memory_order_relaxed);
+    state.net.fetch_add(static_cast<int32_t>(used - baseline), std::memory_order_relaxed);
+    // Walking the free list is too slow for every sample; a scope exit is where fragmentation changes most
+    atomicMin(minLargestBlock, ESP.getMaxAllocHeap());
+  }
+}
+
+void heapSample() { sample(); }
+
+HeapTagStats getHeapStats(const HeapTag tag) {
+  const TagState& state = tags[static_cast<int>(tag)];
+  HeapTagStats stats{};
+  stats.scopes = state.scopes.load(std::memory_order_relaxed);
+  stats.peakBytes = state.peak.load(std::memory_order_relaxed);
+  stats.netBytes = state.net.load(std::memory_order_relaxed);
+  if (state.depth.load(std::memory_order_relaxed) > 0) {
+    stats.currentBytes = growth(state, ESP.getHeapSize() - ESP.getFreeHeap());
+  }
+  return stats;
+}
+
+HeapSnapshot getHeapSnapshot() {
+  HeapSnapshot snapshot{};
+  snapshot.freeBytes = ESP.getFreeHeap();
+  snapshot.largestFreeBlock = ESP.getMaxAllocHeap();
+  snapshot.minFreeBytes = std::min(minFree.load(std::memory_order_relaxed), snapshot.freeBytes);
+  snapshot.minLargestFreeBlock = std::min(minLargestBlock.load(std::memory_order_relaxed), snapshot.largestFreeBlock);
+  if (snapshot.freeBytes > 0 && snapshot.largestFreeBlock < snapshot.freeBytes) {
+    snapshot.fragmentationPct = 100 - static_cast<uint8_t>(static_cast<uint64_t>(snapshot.largestFreeBlock) * 100 /
+                                                            snapshot.freeBytes);
+  }
+  return snapshot;
+}
+
+void logHeapReport(const char* reason) {
+  const HeapSnapshot snapshot = getHeapSnapshot();
+  LOG_INF("MEM", "Heap report (%s): %u free, %u largest block, %u%% fragmented; lowest %u free, %u largest block",
+          reason, snapshot.freeBytes, snapshot.largestFreeBlock, snapshot.fragmentationPct, snapshot.minFreeBytes,
+          snapshot.minLargestFreeBlock);
+  for (int i = 0; i < TAG_COUNT; i++) {
+    const auto tag = static_cast<HeapTag>(i);
+    const HeapTagStats stats = getHeapStats(tag);
+    if (stats.scopes == 0) {
+      continue;
+    }
+    LOG_INF("MEM", "  %-16s current %u, peak %u, net %d over %u scopes", heapTagName(tag), stats.currentBytes,
+            stats.peakBytes, stats.netBytes, stats.scopes);
+  }
+}
+
+void resetHeapTrace() {
+  const uint32_t used = ESP.getHeapSize() - ESP.getFreeHeap();
+  for (auto& state : tags) {
+    // Open scopes carry on, measured from where they are now
+    state.peak.store(state.depth.load(std::memory_order_relaxed) > 0 ? growth(state, used) : 0,
+                     std::memory_order_relaxed);
+    state.scopes.store(0, std::memory_order_relaxed);
+    state.net.store(0, std::memory_order_relaxed);
+  }
+  minFree.store(UINT32_MAX, std::memory_order_relaxed);
+  minLargestBlock.store(UINT32_MAX, std::memory_order_relaxed);
+}
+
+}  // namespace perf
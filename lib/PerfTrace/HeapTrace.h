@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+#include "PerfTrace.h"
+
+/*
+Opt-in accounting of which subsystem is holding heap, for tracking down low-memory failures (see /api/perf and the
+CMD:HEAP serial command). Define ENABLE_HEAP_TRACE in build_flags to turn it on; without it HEAP_SCOPE and HEAP_SAMPLE
+compile to nothing and only the free heap and largest free block are reported.
+
+There is no per-allocation hook on the device, so a tag is charged with how much the heap grew while one of its scopes
+was open: entering the outermost scope of a tag records the heap in use, and every sample point (scope entry and exit,
+HEAP_SAMPLE, and on the host every allocation) measures the growth since. Scopes are inclusive of nested scopes of
+other tags, and allocations made meanwhile by another task are charged too, so treat the numbers as who was active
+while the heap grew, not exact ownership.
+
+    bool CssParser::loadFromCache() {
+      HEAP_SCOPE(Css);
+      ...
+*/
+
+namespace perf {
+
+enum class HeapTag : uint8_t {
+  Parser,            // Chapter XHTML parsing and page layout
+  Css,               // Stylesheet parsing and the CSS rules cache
+  FontDecompressor,  // Decompressed glyph groups
+  ImageDecode,       // JPEG and PNG decoding, for covers and inline images
+  WebServer,         // The file transfer web server
+  Page,              // Pages loaded into the section page cache
+  COUNT
+};
+
+struct HeapTagStats {
+  uint32_t scopes;        // Outermost scopes entered since boot (or the last reset)
+  uint32_t currentBytes;  // Growth since the open scope began, 0 when none is open
+  uint32_t peakBytes;     // Largest growth seen at a sample point
+  int32_t netBytes;       // Sum of growth left behind by closed scopes: memory the tag still holds, if it frees its own
+};
+
+struct HeapSnapshot {
+  uint32_t freeBytes;
+  uint32_t largestFreeBlock;
+  uint32_t minFreeBytes;         // Lowest free heap seen at a sample point
+  uint32_t minLargestFreeBlock;  // Smallest largest free block seen at an outermost scope exit
+  uint8_t fragmentationPct;      // Share of the free heap outside the largest free block
+};
+
+constexpr bool heapTraceEnabled() {
+#ifdef ENABLE_HEAP_TRACE
+  return true;
+#else
+  return false;
+#endif
+}
+
+const char* heapTagName(HeapTag tag);
+void heapEnter(HeapTag tag);
+void heapExit(HeapTag tag);
+// Record the heap in use against every open scope; cheap enough to call from a hot loop
+void heapSample();
+HeapTagStats getHeapStats(HeapTag tag);
+HeapSnapshot getHeapSnapshot();
+// Write the snapshot and every tag that has been used to the log
+void logHeapReport(const char* reason);
+void resetHeapTrace();
+
+class HeapScope {
+  HeapTag tag;
+
+ public:
+  explicit HeapScope(const HeapTag tag) : tag(tag) { heapEnter(tag); }
+  ~HeapScope() { heapExit(tag); }
+  HeapScope(const HeapScope&) = delete;
+  HeapScope& operator=(const HeapScope&) = delete;
+};
+
+}  // namespace perf
+
+#ifdef ENABLE_HEAP_TRACE
+// Charge heap growth for the rest of the enclosing scope to the given perf::HeapTag
+#define HEAP_SCOPE(tag) const perf::HeapScope PERF_CONCAT(heapScope, __LINE__)(perf::HeapTag::tag)
+#define HEAP_SAMPLE() perf::heapSample()
+#else
+#define HEAP_SCOPE(tag) static_cast<void>(0)
+#define HEAP_SAMPLE() static_cast<void>(0)
+#endif
@@ -0,0 +1,67 @@
+#include "PerfTrace.h"
+
+#include <Arduino.h>
+
+#include <algorithm>
+
+namespace perf {
+
+namespace {
+
+constexpr int PHASE_COUNT = static_cast<int>(Phase::COUNT);
+
+struct Ring {
+  std::atomic<uint32_t> writes{0};
+  uint32_t samples[SAMPLES_PER_PHASE] = {};
+};
+
+Ring rings[PHASE_COUNT];
+
+constexpr const char* PHASE_NAMES[PHASE_COUNT] = {
+    "readerRender", "pageLoad", "pageDraw", "grayscale", "displayRefresh", "sectionBuild", "fontDecompress", "menuDraw",
+};
+
+}  // namespace
+
+const char* phaseName(const Phase phase) { return PHASE_NAMES[static_cast<int>(phase)]; }
+
+uint32_t nowUs() { return micros(); }
+
+void record(const Phase phase, const uint32_t durationUs) {
+  Ring& ring = rings[static_cast<int>(phase)];
+  const uint32_t slot = ring.writes.fetch_add(1, std::memory_order_relaxed) % SAMPLES_PER_PHASE;
+  ring.samples[slot] = durationUs;
+}
+
+PhaseStats getStats(const Phase phase) {
+  const Ring& ring = rings[static_cast<int>(phase)];
+  PhaseStats stats{};
+  stats.total = ring.writes.load(std::memory_order_relaxed);
+  stats.samples = std::min<uint32_t>(stats.total, SAMPLES_PER_PHASE);
+  if (stats.samples == 0) {
+    return stats;
+  }
+
+  // A copy, so a sample recorded meanwhile cannot reorder the sort
+  uint32_t sorted[SAMPLES_PER_PHASE];
+  std::copy(ring.samples, ring.samples + stats.samples, sorted);
+  std::sort(sorted, sorted + stats.samples);
+  uint64_t sum = 0;
+  for (int i = 0; i < stats.samples; i++) {
+    sum += sorted[i];
+  }
+  stats.minUs = sorted[0];
+  stats.maxUs = sorted[stats.samples - 1];
+  stats.meanUs = static_cast<uint32_t>(sum / stats.samples);
+  // Nearest rank
+  stats.p95Us = sorted[(stats.samples * 95 + 99) / 100 - 1];
+  return stats;
+}
+
+void reset() {
+  for (auto& ring : rings) {
+    ring.writes.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace perf
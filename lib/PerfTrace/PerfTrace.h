@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+Lightweight timing of the reader's hot phases, for pulling latency distributions off a device (see /api/perf).
+
+Each phase keeps its last SAMPLES_PER_PHASE durations in a fixed RAM ring; recording is two micros() calls and one
+store, with no locking, so it is safe from any task. Statistics are computed on demand from whatever the ring holds.
+
+    void Section::createSectionFile(...) {
+      PERF_SCOPE(SectionBuild);
+      ...
+*/
+
+namespace perf {
+
+enum class Phase : uint8_t {
+  ReaderRender,    // EpubReaderActivity::render, start to finish
+  PageLoad,        // Fetching the current page: page cache, SD read and Page::deserialize
+  PageDraw,        // Drawing the page's text and images into the BW framebuffer
+  Grayscale,       // Anti-aliasing: the LSB and MSB passes and the grayscale refresh
+  DisplayRefresh,  // GfxRenderer::displayBuffer
+  SectionBuild,    // Section::createSectionFile
+  FontDecompress,  // Inflating a font glyph group on a FontDecompressor cache miss
+  MenuDraw,        // Drawing the home or settings screen into the framebuffer, before the refresh
+  COUNT
+};
+
+constexpr int SAMPLES_PER_PHASE = 64;
+
+struct PhaseStats {
+  uint32_t total;    // Samples recorded since boot
+  uint16_t samples;  // Samples the statistics below cover (at most SAMPLES_PER_PHASE)
+  uint32_t minUs;
+  uint32_t meanUs;
+  uint32_t p95Us;
+  uint32_t maxUs;
+};
+
+const char* phaseName(Phase phase);
+uint32_t nowUs();
+void record(Phase phase, uint32_t durationUs);
+// Statistics over the samples currently in the phase's ring
+PhaseStats getStats(Phase phase);
+void reset();
+
+class ScopedTimer {
+  Phase phase;
+  uint32_t start;
+
+ public:
+  explicit ScopedTimer(const Phase phase) : phase(phase), start(nowUs()) {}
+  ~ScopedTimer() { record(phase, nowUs() - start); }
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+}  // namespace perf
+
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+// Time the rest of the enclosing scope as the given perf::Phase
+#define PERF_SCOPE(phase) const perf::ScopedTimer PERF_CONCAT(perfTimer, __LINE__)(perf::Phase::phase)
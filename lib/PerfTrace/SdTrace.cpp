@@ -0,0 +1,147 @@
+#include "SdTrace.h"
+
+#include <Arduino.h>
+#include <HalStorage.h>
+#include <Logging.h>
+
+#include <new>
+#include <string>
+#include <vector>
+
+namespace perf {
+
+namespace {
+
+// Records are buffered and written out a block at a time, so the trace adds one card write per block, not per call
+constexpr size_t BUFFER_RECORDS = 128;
+
+struct Trace {
+  FsFile file;
+  FsFile pathsFile;
+  SdTraceRecord buffer[BUFFER_RECORDS];
+  size_t buffered = 0;
+  uint32_t capacity = 0;
+  uint32_t total = 0;  // Records written to the file so far
+  std::vector<std::string> paths;
+  size_t pathsWritten = 0;
+};
+
+Trace* trace = nullptr;
+// Set while the trace touches the card itself, so its own calls are not recorded. Card access is already serialised
+// (see RenderLock), so a plain flag is enough.
+bool busy = false;
+
+void writeHeader() {
+  const SdTraceHeader header{SD_TRACE_MAGIC, SD_TRACE_VERSION, sizeof(SdTraceRecord), trace->capacity, trace->total};
+  trace->file.seek(0);
+  trace->file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+}
+
+void flush() {
+  busy = true;
+  size_t done = 0;
+  while (done < trace->buffered) {
+    // Wrap around the ring; a block can straddle the end
+    const uint32_t slot = trace->total % trace->capacity;
+    const size_t count = std::min<size_t>(trace->buffered - done, trace->capacity - slot);
+    trace->file.seek(sizeof(SdTraceHeader) + static_cast<uint64_t>(slot) * sizeof(SdTraceRecord));
+    trace->file.write(reinterpret_cast<const uint8_t*>(trace->buffer + done), count * sizeof(SdTraceRecord));
+    trace->total += count;
+    done += count;
+  }
+  trace->buffered = 0;
+  writeHeader();
+  trace->file.flush();
+
+  char line[16];
+  for (; trace->pathsWritten < trace->paths.size(); trace->pathsWritten++) {
+    const int len = snprintf(line, sizeof(line), "%u ", static_cast<unsigned>(trace->pathsWritten + 1));
+    trace->pathsFile.write(reinterpret_cast<const uint8_t*>(line), len);
+    const std::string& path = trace->paths[trace->pathsWritten];
+    trace->pathsFile.write(reinterpret_cast<const uint8_t*>(path.data()), path.size());
+    trace->pathsFile.write(static_cast<uint8_t>('\n'));
+  }
+  trace->pathsFile.flush();
+  busy = false;
+}
+
+}  // namespace
+
+bool sdTraceStart(const char* path, const uint32_t capacity) {
+  sdTraceStop();
+
+  trace = new (std::nothrow) Trace();
+  if (!trace) {
+    LOG_ERR("SDT", "Not enough memory to start a trace");
+    return false;
+  }
+  trace->capacity = std::max<uint32_t>(capacity, 1);
+
+  busy = true;
+  const std::string pathsPath = std::string(path) + ".paths";
+  const bool opened = Storage.openFileForWrite("SDT", path, trace->file) &&
+                      Storage.openFileForWrite("SDT", pathsPath, trace->pathsFile);
+  if (opened) {
+    writeHeader();
+  }
+  busy = false;
+  if (!opened) {
+    delete trace;
+    trace = nullptr;
+    return false;
+  }
+  LOG_INF("SDT", "Recording card access to %s", path);
+  return true;
+}
+
+void sdTraceStop() {
+  if (!trace) {
+    return;
+  }
+  flush();
+  busy = true;
+  trace->file.close();
+  trace->pathsFile.close();
+  busy = false;
+  LOG_INF("SDT", "Trace stopped after %u calls, %u paths", trace->total, static_cast<unsigned>(trace->paths.size()));
+  delete trace;
+  trace = nullptr;
+}
+
+bool sdTraceActive() { return trace && !busy; }
+
+uint16_t sdTracePathId(const char* path) {
+  if (!trace) {
+    return 0;
+  }
+  for (size_t i = 0; i < trace->paths.size(); i++) {
+    if (trace->paths[i] == path) {
+      return static_cast<uint16_t>(i + 1);
+    }
+  }
+  if (trace->paths.size() >= UINT16_MAX) {
+    return 0;
+  }
+  trace->paths.emplace_back(path);
+  return static_cast<uint16_t>(trace->paths.size());
+}
+
+void sdTraceRecord(const SdOp op, const uint16_t pathId, const uint32_t offset, const uint32_t length,
+                   const uint32_t startUs, const uint8_t flags) {
+  if (!sdTraceActive()) {
+    return;
+  }
+  SdTraceRecord& record = trace->buffer[trace->buffered++];
+  record.startUs = startUs;
+  record.durationUs = static_cast<uint32_t>(micros()) - startUs;
+  record.offset = offset;
+  record.length = length;
+  record.pathId = pathId;
+  record.op = static_cast<uint8_t>(op);
+  record.flags = flags;
+  if (trace->buffered == BUFFER_RECORDS) {
+    flush();
+  }
+}
+
+}  // namespace perf
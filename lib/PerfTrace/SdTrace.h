@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+Recording of every SD card access (opens, reads, writes, seeks and closes, with offset, length and duration) into a
+ring file on the card, for summarising and replaying off the device with test/run_sd_trace_replay.sh.
+
+Build with ENABLE_SD_TRACE: HalStorage then hands out files that report each call here, and CMD:SDTRACE_START /
+CMD:SDTRACE_STOP over serial start and stop a recording. Without the flag nothing is hooked and nothing is recorded.
+
+File layout: an SdTraceHeader, then `capacity` SdTraceRecords used as a ring (`total` records were recorded; when it
+exceeds `capacity` the oldest is at `total % capacity`). Paths are interned to ids; `<trace>.paths` lists them, one
+"<id> <path>" per line. Id 0 is a file that was not opened through HalStorage.
+*/
+
+namespace perf {
+
+enum class SdOp : uint8_t { Open, Close, Read, Write, Seek };
+
+enum SdTraceFlags : uint8_t {
+  SD_TRACE_FAILED = 1 << 0,      // The call returned an error
+  SD_TRACE_WRITE_MODE = 1 << 1,  // Open: the file was opened for writing
+  SD_TRACE_SHORT = 1 << 2,       // Read/write: fewer bytes than requested were transferred
+};
+
+struct SdTraceRecord {
+  uint32_t startUs;
+  uint32_t durationUs;
+  uint32_t offset;  // File position the call started at; for a seek, the position it moved to
+  uint32_t length;  // Bytes requested
+  uint16_t pathId;
+  uint8_t op;  // SdOp
+  uint8_t flags;
+};
+static_assert(sizeof(SdTraceRecord) == 20, "SdTraceRecord is written to the trace file as is");
+
+struct SdTraceHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint32_t capacity;
+  uint32_t total;
+};
+
+constexpr uint32_t SD_TRACE_MAGIC = 0x52544453;  // "SDTR"
+constexpr uint16_t SD_TRACE_VERSION = 1;
+
+// Start recording into `path`, replacing any earlier trace there; the ring keeps the last `capacity` records
+bool sdTraceStart(const char* path, uint32_t capacity = 65536);
+// Write out what is still buffered and close the trace
+void sdTraceStop();
+bool sdTraceActive();
+// Id for `path` in the current trace, 0 when not recording
+uint16_t sdTracePathId(const char* path);
+void sdTraceRecord(SdOp op, uint16_t pathId, uint32_t offset, uint32_t length, uint32_t startUs, uint8_t flags);
+
+}  // namespace perf
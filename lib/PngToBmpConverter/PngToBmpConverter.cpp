@@ -1,6 +1,7 @@
 #include "PngToBmpConverter.h"
 
 #include <HalStorage.h>
+#include <HeapTrace.h>
 #include <InflateReader.h>
 #include <Logging.h>
 
@@ -398,6 +399,7 @@ static void convertScanlineToGray(const PngDecodeContext& ctx, uint8_t* grayRow)
 
 bool PngToBmpConverter::pngFileToBmpStreamInternal(FsFile& pngFile, Print& bmpOut, int targetWidth, int targetHeight,
                                                    bool oneBit, bool crop) {
+  HEAP_SCOPE(ImageDecode);
   LOG_DBG("PNG", "Converting PNG to %s BMP (target: %dx%d)", oneBit ? "1-bit" : "2-bit", targetWidth, targetHeight);
 
   // Verify PNG signature
@@ -0,0 +1,149 @@
+#include "BufferedFs.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+BufferedFsWriter::BufferedFsWriter(FsFile& file)
+    : file(file),
+      buffer(static_cast<uint8_t*>(malloc(BUFFER_SIZE))),
+      capacity(buffer ? BUFFER_SIZE : 0),
+      ownsBuffer(true),
+      bufferStart(static_cast<uint32_t>(file.position())) {}
+
+BufferedFsWriter::BufferedFsWriter(FsFile& file, uint8_t* buffer, const size_t capacity)
+    : file(file),
+      buffer(buffer),
+      capacity(buffer ? capacity : 0),
+      ownsBuffer(false),
+      bufferStart(static_cast<uint32_t>(file.position())) {}
+
+BufferedFsWriter::~BufferedFsWriter() {
+  flush();
+  if (ownsBuffer) {
+    free(buffer);
+  }
+}
+
+size_t BufferedFsWriter::write(const void* data, const size_t len) {
+  if (len == 0) {
+    return 0;
+  }
+  if (used + len > capacity) {
+    flush();
+  }
+
+  // Too large to buffer (or no buffer at all): write through
+  if (len > capacity) {
+    const size_t written = file.write(static_cast<const uint8_t*>(data), len);
+    if (written != len) {
+      error = true;
+    }
+    bufferStart += written;
+    return len;
+  }
+
+  memcpy(buffer + used, data, len);
+  used += len;
+  return len;
+}
+
+bool BufferedFsWriter::flush() {
+  if (used > 0) {
+    const size_t written = file.write(buffer, used);
+    if (written != used) {
+      error = true;
+    }
+    bufferStart += written;
+    used = 0;
+  }
+  return !error;
+}
+
+bool BufferedFsWriter::seek(const uint32_t pos) {
+  flush();
+  if (!file.seek(pos)) {
+    error = true;
+    return false;
+  }
+  bufferStart = pos;
+  return true;
+}
+
+BufferedFsReader::BufferedFsReader(FsFile& file)
+    : file(file),
+      buffer(static_cast<uint8_t*>(malloc(BUFFER_SIZE))),
+      capacity(buffer ? BUFFER_SIZE : 0),
+      ownsBuffer(true),
+      bufferStart(static_cast<uint32_t>(file.position())) {}
+
+BufferedFsReader::BufferedFsReader(FsFile& file, uint8_t* buffer, const size_t capacity)
+    : file(file),
+      buffer(buffer),
+      capacity(buffer ? capacity : 0),
+      ownsBuffer(false),
+      bufferStart(static_cast<uint32_t>(file.position())) {}
+
+BufferedFsReader::~BufferedFsReader() {
+  if (ownsBuffer) {
+    free(buffer);
+  }
+}
+
+int BufferedFsReader::read(void* data, const size_t size) {
+  auto* out = static_cast<uint8_t*>(data);
+  size_t copied = 0;
+
+  while (copied < size) {
+    if (head < len) {
+      const size_t n = std::min(size - copied, len - head);
+      memcpy(out + copied, buffer + head, n);
+      head += n;
+      copied += n;
+      continue;
+    }
+
+    // Window exhausted, the file is positioned right after it
+    bufferStart += len;
+    head = 0;
+    len = 0;
+
+    const size_t remaining = size - copied;
+    if (remaining >= capacity) {
+      const int n = file.read(out + copied, remaining);
+      if (n < 0) {
+        return copied > 0 ? static_cast<int>(copied) : -1;
+      }
+      bufferStart += n;
+      copied += n;
+      break;
+    }
+
+    const int n = file.read(buffer, capacity);
+    if (n <= 0) {
+      if (n < 0 && copied == 0) {
+        return -1;
+      }
+      break;
+    }
+    len = n;
+  }
+
+  return static_cast<int>(copied);
+}
+
+bool BufferedFsReader::seek(const uint32_t pos) {
+  if (pos >= bufferStart && pos <= bufferStart + len) {
+    head = pos - bufferStart;
+    return true;
+  }
+
+  head = 0;
+  len = 0;
+  if (!file.seek(pos)) {
+    bufferStart = static_cast<uint32_t>(file.position());
+    return false;
+  }
+  bufferStart = pos;
+  return true;
+}
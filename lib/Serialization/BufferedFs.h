@@ -0,0 +1,75 @@
+#pragma once
+#include <HalStorage.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Write-behind buffer in front of an open FsFile. Small writes are collected and handed to SdFat in blocks of up
+// to BUFFER_SIZE bytes, so serializing a page costs a handful of card writes instead of one per field.
+//
+// Writes always report success; a failed flush is latched and surfaced by flush() and hasError(). seek() flushes
+// first, so the buffer never spans two file positions. The destructor flushes, but callers that care about the
+// result should call flush() before closing the file.
+//
+// If the buffer cannot be allocated the writer passes every write straight through to the file.
+class BufferedFsWriter {
+ public:
+  static constexpr size_t BUFFER_SIZE = 2048;
+
+  explicit BufferedFsWriter(FsFile& file);
+  // Use a caller-owned buffer (e.g. a small stack array for short-lived writers)
+  BufferedFsWriter(FsFile& file, uint8_t* buffer, size_t capacity);
+  ~BufferedFsWriter();
+
+  BufferedFsWriter(const BufferedFsWriter&) = delete;
+  BufferedFsWriter& operator=(const BufferedFsWriter&) = delete;
+
+  size_t write(const void* data, size_t len);
+  size_t write(uint8_t b) { return write(&b, 1); }
+  bool flush();
+  bool seek(uint32_t pos);
+  uint32_t position() const { return bufferStart + used; }
+  bool hasError() const { return error; }
+
+ private:
+  FsFile& file;
+  uint8_t* buffer;
+  size_t capacity;
+  bool ownsBuffer;
+  size_t used = 0;
+  uint32_t bufferStart;  // File offset of buffer[0]
+  bool error = false;
+};
+
+// Read-ahead buffer in front of an open FsFile. Reads are served from a window of up to BUFFER_SIZE bytes that is
+// refilled with a single card read; reads larger than the window bypass it. Seeking inside the current window is
+// free, anything else drops the window and seeks the file.
+//
+// The reader owns the file position while it is alive: do not read or seek the FsFile directly in the meantime.
+class BufferedFsReader {
+ public:
+  static constexpr size_t BUFFER_SIZE = 2048;
+
+  explicit BufferedFsReader(FsFile& file);
+  // Use a caller-owned buffer (e.g. a small stack array for short-lived readers)
+  BufferedFsReader(FsFile& file, uint8_t* buffer, size_t capacity);
+  ~BufferedFsReader();
+
+  BufferedFsReader(const BufferedFsReader&) = delete;
+  BufferedFsReader& operator=(const BufferedFsReader&) = delete;
+
+  // Same contract as FsFile::read: bytes read, 0 at end of file, -1 on error
+  int read(void* data, size_t len);
+  bool seek(uint32_t pos);
+  uint32_t position() const { return bufferStart + head; }
+  uint32_t available() const { return (len - head) + file.available(); }
+
+ private:
+  FsFile& file;
+  uint8_t* buffer;
+  size_t capacity;
+  bool ownsBuffer;
+  size_t head = 0;       // Next unread byte in buffer
+  size_t len = 0;        // Valid bytes in buffer
+  uint32_t bufferStart;  // File offset of buffer[0]; the file itself is positioned at bufferStart + len
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Bounds-checked cursor over a record that is already in RAM (e.g. a page read with a single card read).
+// read() follows the FsFile contract so the serialization helpers work on it unchanged; take() hands out the
+// bytes in place instead of copying them.
+class ByteReader {
+ public:
+  ByteReader(uint8_t* data, const size_t size) : data(data), size(size) {}
+
+  int read(void* out, const size_t len) {
+    const size_t n = len < size - pos ? len : size - pos;
+    memcpy(out, data + pos, n);
+    pos += n;
+    return static_cast<int>(n);
+  }
+
+  // Returns the next len bytes and skips past them, or nullptr (without moving) if fewer remain
+  uint8_t* take(const size_t len) {
+    if (len > size - pos) {
+      return nullptr;
+    }
+    uint8_t* p = data + pos;
+    pos += len;
+    return p;
+  }
+
+  bool seek(const size_t position) {
+    if (position > size) {
+      return false;
+    }
+    pos = position;
+    return true;
+  }
+
+  uint8_t* base() const { return data; }
+  size_t position() const { return pos; }
+  size_t available() const { return size - pos; }
+
+ private:
+  uint8_t* data;
+  size_t size;
+  size_t pos = 0;
+};
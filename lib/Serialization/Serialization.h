@@ -3,6 +3,9 @@
 
 #include <iostream>
 
+#include "BufferedFs.h"
+#include "ByteReader.h"
+
 namespace serialization {
 template <typename T>
 static void writePod(std::ostream& os, const T& value) {
@@ -14,6 +17,11 @@ static void writePod(FsFile& file, const T& value) {
   file.write(reinterpret_cast<const uint8_t*>(&value), sizeof(T));
 }
 
+template <typename T>
+static void writePod(BufferedFsWriter& writer, const T& value) {
+  writer.write(&value, sizeof(T));
+}
+
 template <typename T>
 static void readPod(std::istream& is, T& value) {
   is.read(reinterpret_cast<char*>(&value), sizeof(T));
@@ -24,6 +32,16 @@ static void readPod(FsFile& file, T& value) {
   file.read(reinterpret_cast<uint8_t*>(&value), sizeof(T));
 }
 
+template <typename T>
+static void readPod(BufferedFsReader& reader, T& value) {
+  reader.read(&value, sizeof(T));
+}
+
+template <typename T>
+static void readPod(ByteReader& reader, T& value) {
+  reader.read(&value, sizeof(T));
+}
+
 static void writeString(std::ostream& os, const std::string& s) {
   const uint32_t len = s.size();
   writePod(os, len);
@@ -36,6 +54,12 @@ static void writeString(FsFile& file, const std::string& s) {
   file.write(reinterpret_cast<const uint8_t*>(s.data()), len);
 }
 
+static void writeString(BufferedFsWriter& writer, const std::string& s) {
+  const uint32_t len = s.size();
+  writePod(writer, len);
+  writer.write(s.data(), len);
+}
+
 static void readString(std::istream& is, std::string& s) {
   uint32_t len;
   readPod(is, len);
@@ -49,4 +73,65 @@ static void readString(FsFile& file, std::string& s) {
   s.resize(len);
   file.read(&s[0], len);
 }
+
+static void readString(BufferedFsReader& reader, std::string& s) {
+  uint32_t len;
+  readPod(reader, len);
+  s.resize(len);
+  reader.read(&s[0], len);
+}
+
+static bool readString(ByteReader& reader, std::string& s) {
+  uint32_t len = 0;
+  readPod(reader, len);
+  const auto* bytes = reader.take(len);
+  if (!bytes) {
+    return false;
+  }
+  s.assign(reinterpret_cast<const char*>(bytes), len);
+  return true;
+}
+
+// LEB128: 7 bits per byte, high bit set on every byte but the last
+static void writeVarUint(BufferedFsWriter& writer, uint32_t value) {
+  uint8_t bytes[5];
+  size_t n = 0;
+  while (value >= 0x80) {
+    bytes[n++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  bytes[n++] = static_cast<uint8_t>(value);
+  writer.write(bytes, n);
+}
+
+template <typename Reader>
+static bool readVarUint(Reader& reader, uint32_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    uint8_t b;
+    if (reader.read(&b, 1) != 1) {
+      return false;
+    }
+    value |= static_cast<uint32_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Zigzag keeps small negative numbers small: 0, -1, 1, -2, ... map to 0, 1, 2, 3, ...
+static void writeVarInt(BufferedFsWriter& writer, const int32_t value) {
+  writeVarUint(writer, (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+}
+
+template <typename Reader>
+static bool readVarInt(Reader& reader, int32_t& value) {
+  uint32_t raw;
+  if (!readVarUint(reader, raw)) {
+    return false;
+  }
+  value = static_cast<int32_t>((raw >> 1) ^ (~(raw & 1) + 1));
+  return true;
+}
 }  // namespace serialization
@@ -5,6 +5,9 @@
 #include <Logging.h>
 
 #include <algorithm>
+#include <new>
+
+#include "ZipIndex.h"
 
 struct ZipInflateCtx {
   InflateReader reader;  // Must be first — callback casts uzlib_uncomp* to ZipInflateCtx*
@@ -91,6 +94,10 @@ bool ZipFile::loadAllFileStatSlims() {
 }
 
 bool ZipFile::loadFileStatSlim(const char* filename, FileStatSlim* fileStat) {
+  if (index && index->isLoaded()) {
+    return index->find(filename, fileStat);
+  }
+
   if (!fileStatSlimCache.empty()) {
     const auto it = fileStatSlimCache.find(filename);
     if (it != fileStatSlimCache.end()) {
@@ -181,6 +188,10 @@ bool ZipFile::loadFileStatSlim(const char* filename, FileStatSlim* fileStat) {
 }
 
 long ZipFile::getDataOffset(const FileStatSlim& fileStat) {
+  if (fileStat.dataOffset != 0) {
+    return fileStat.dataOffset;
+  }
+
   const bool wasOpen = isOpen();
   if (!wasOpen && !open()) {
     return -1;
@@ -628,3 +639,120 @@ bool ZipFile::readFileToStream(const char* filename, Print& out, const size_t ch
   LOG_ERR("ZIP", "Unsupported compression method");
   return false;
 }
+
+bool ZipFile::openEntry(const char* filename, EntryReader& reader, const size_t chunkSize) {
+  reader.close();
+
+  FileStatSlim fileStat = {};
+  if (!loadFileStatSlim(filename, &fileStat)) {
+    return false;
+  }
+
+  if (fileStat.method != ZIP_METHOD_STORED && fileStat.method != ZIP_METHOD_DEFLATED) {
+    LOG_ERR("ZIP", "Unsupported compression method");
+    return false;
+  }
+
+  const long fileOffset = getDataOffset(fileStat);
+  if (fileOffset < 0) {
+    return false;
+  }
+
+  if (!Storage.openFileForRead("ZIP", filePath, reader.file)) {
+    return false;
+  }
+  reader.file.seek(fileOffset);
+  reader.inflatedSize = fileStat.uncompressedSize;
+
+  if (fileStat.method == ZIP_METHOD_DEFLATED) {
+    reader.readBuf = static_cast<uint8_t*>(malloc(chunkSize));
+    reader.inflateCtx = new (std::nothrow) ZipInflateCtx();
+    if (!reader.readBuf || !reader.inflateCtx) {
+      LOG_ERR("ZIP", "Failed to allocate memory for entry reader");
+      reader.close();
+      return false;
+    }
+
+    auto* ctx = reader.inflateCtx;
+    ctx->file = &reader.file;
+    ctx->fileRemaining = fileStat.compressedSize;
+    ctx->readBuf = reader.readBuf;
+    ctx->readBufSize = chunkSize;
+
+    if (!ctx->reader.init(true)) {
+      LOG_ERR("ZIP", "Failed to init inflate reader");
+      reader.close();
+      return false;
+    }
+    ctx->reader.setReadCallback(zipReadCallback);
+  }
+
+  reader.finished = reader.inflatedSize == 0 && fileStat.method == ZIP_METHOD_STORED;
+  return true;
+}
+
+ZipFile::EntryReader::~EntryReader() { close(); }
+
+void ZipFile::EntryReader::close() {
+  delete inflateCtx;  // Frees the ring buffer
+  inflateCtx = nullptr;
+  free(readBuf);
+  readBuf = nullptr;
+  if (file) {
+    file.close();
+  }
+  inflatedSize = 0;
+  produced = 0;
+  finished = false;
+  failed = false;
+}
+
+int ZipFile::EntryReader::read(uint8_t* dest, const size_t maxLen) {
+  if (!file || failed) {
+    return -1;
+  }
+  if (finished || maxLen == 0) {
+    return 0;
+  }
+
+  if (!inflateCtx) {
+    // Stored entry: bytes on disk are the content
+    const size_t remaining = inflatedSize - produced;
+    const int dataRead = file.read(dest, remaining < maxLen ? remaining : maxLen);
+    if (dataRead <= 0) {
+      LOG_ERR("ZIP", "Could not read more bytes");
+      failed = true;
+      return -1;
+    }
+    produced += dataRead;
+    finished = produced == inflatedSize;
+    return dataRead;
+  }
+
+  size_t chunkProduced = 0;
+  const InflateStatus status = inflateCtx->reader.readAtMost(dest, maxLen, &chunkProduced);
+  produced += chunkProduced;
+
+  if (status == InflateStatus::Error) {
+    LOG_ERR("ZIP", "Decompression failed");
+    failed = true;
+    return -1;
+  }
+
+  if (produced > inflatedSize) {
+    LOG_ERR("ZIP", "Decompressed size exceeds expected (%zu > %zu)", produced, inflatedSize);
+    failed = true;
+    return -1;
+  }
+
+  if (status == InflateStatus::Done) {
+    if (produced != inflatedSize) {
+      LOG_ERR("ZIP", "Decompressed size mismatch (expected %zu, got %zu)", inflatedSize, produced);
+      failed = true;
+      return -1;
+    }
+    finished = true;
+  }
+
+  return static_cast<int>(chunkProduced);
+}
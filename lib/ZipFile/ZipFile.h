@@ -5,6 +5,9 @@
 #include <unordered_map>
 #include <vector>
 
+struct ZipInflateCtx;
+class ZipIndex;
+
 class ZipFile {
  public:
   struct FileStatSlim {
@@ -12,6 +15,7 @@ class ZipFile {
     uint32_t compressedSize;     // Compressed size
     uint32_t uncompressedSize;   // Uncompressed size
     uint32_t localHeaderOffset;  // Offset of local file header
+    uint32_t dataOffset;         // Start of entry data if already resolved (from ZipIndex), otherwise 0
   };
 
   struct ZipDetails {
@@ -37,8 +41,44 @@ class ZipFile {
     return hash;
   }
 
+  // Pull-style reader for a single entry: yields inflated bytes on demand so a parser can consume an entry
+  // without staging it on SD first. Owns its own file handle, and for deflated entries holds the 32KB inflate
+  // window until close() or destruction.
+  class EntryReader {
+   public:
+    EntryReader() = default;
+    ~EntryReader();
+
+    EntryReader(const EntryReader&) = delete;
+    EntryReader& operator=(const EntryReader&) = delete;
+
+    bool isOpen() const { return !!file; }
+    // Uncompressed size of the entry as recorded in the central directory
+    size_t size() const { return inflatedSize; }
+    // True once every byte of the entry has been returned
+    bool isDone() const { return finished; }
+    // Read up to maxLen inflated bytes into dest.
+    // Returns the number of bytes produced, 0 at the end of the entry, or -1 on error.
+    int read(uint8_t* dest, size_t maxLen);
+    void close();
+
+   private:
+    friend class ZipFile;
+
+    FsFile file;
+    ZipInflateCtx* inflateCtx = nullptr;  // Only set for deflated entries
+    uint8_t* readBuf = nullptr;
+    size_t inflatedSize = 0;
+    size_t produced = 0;
+    bool finished = false;
+    bool failed = false;
+  };
+
  private:
+  friend class ZipIndex;
+
   const std::string& filePath;
+  const ZipIndex* index;
   FsFile file;
   ZipDetails zipDetails = {0, 0, false};
   std::unordered_map<std::string, FileStatSlim> fileStatSlimCache;
@@ -52,7 +92,8 @@ class ZipFile {
   bool loadZipDetails();
 
  public:
-  explicit ZipFile(const std::string& filePath) : filePath(filePath) {}
+  // When a loaded index is given, entry lookups go through it instead of scanning the central directory
+  explicit ZipFile(const std::string& filePath, const ZipIndex* index = nullptr) : filePath(filePath), index(index) {}
   ~ZipFile() = default;
   // Zip file can be opened and closed by hand in order to allow for quick calculation of inflated file size
   // It is NOT recommended to pre-open it for any kind of inflation due to memory constraints
@@ -69,4 +110,7 @@ class ZipFile {
   // These functions will open and close the zip as needed
   uint8_t* readFileToMemory(const char* filename, size_t* size = nullptr, bool trailingNullByte = false);
   bool readFileToStream(const char* filename, Print& out, size_t chunkSize);
+  // Open an entry for incremental reading. chunkSize is the compressed read buffer size for deflated entries.
+  // The reader stays valid after this ZipFile is destroyed.
+  bool openEntry(const char* filename, EntryReader& reader, size_t chunkSize = 1024);
 };
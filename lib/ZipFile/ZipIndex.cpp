@@ -0,0 +1,363 @@
+#include "ZipIndex.h"
+
+#include <HalStorage.h>
+#include <Logging.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr uint32_t HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t);
+constexpr uint32_t CENTRAL_DIR_SIGNATURE = 0x02014b50;
+constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+constexpr size_t CENTRAL_DIR_HEADER_SIZE = 46;
+constexpr size_t LOCAL_HEADER_SIZE = 30;
+// Entries sorted in memory at once while building (24KB)
+constexpr uint32_t RUN_ENTRIES = 1024;
+// Entries buffered per run while merging
+constexpr uint32_t MERGE_BUFFER_ENTRIES = 16;
+
+uint16_t readLe16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+uint32_t readLe32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+
+bool entryLess(const ZipIndex::Entry& a, const ZipIndex::Entry& b) {
+  return a.hash < b.hash || (a.hash == b.hash && a.nameLen < b.nameLen);
+}
+
+struct RunCursor {
+  uint32_t next;  // Next entry to load from the runs file
+  uint32_t end;
+  uint32_t bufPos = 0;
+  uint32_t bufLen = 0;
+  ZipIndex::Entry buf[MERGE_BUFFER_ENTRIES];
+};
+}  // namespace
+
+bool ZipIndex::writeSortedRuns(ZipFile& zip, const std::string& runsPath, uint32_t* totalEntries) const {
+  // Every run but the last must hold exactly RUN_ENTRIES entries for mergeRuns to find them. The EOCD entry count can't
+  // size the buffer: it is 16 bits and archives understate it or leave it 0, and the directory is read to its end.
+  auto* run = static_cast<Entry*>(malloc(RUN_ENTRIES * sizeof(Entry)));
+  if (!run) {
+    LOG_ERR("ZIX", "Failed to allocate memory for sort run");
+    return false;
+  }
+
+  FsFile runsFile;
+  if (!Storage.openFileForWrite("ZIX", runsPath, runsFile)) {
+    free(run);
+    return false;
+  }
+
+  FsFile& file = zip.file;
+  uint32_t centralDirPos = zip.zipDetails.centralDirOffset;
+  uint8_t header[CENTRAL_DIR_HEADER_SIZE];
+  char itemName[256];
+  bool endOfCentralDir = false;
+  bool success = true;
+  *totalEntries = 0;
+
+  while (success && !endOfCentralDir) {
+    // Fill a run from the central directory; dataOffset temporarily holds the local header offset
+    uint32_t runSize = 0;
+    file.seek(centralDirPos);
+    while (runSize < RUN_ENTRIES) {
+      if (file.read(header, CENTRAL_DIR_HEADER_SIZE) != CENTRAL_DIR_HEADER_SIZE ||
+          readLe32(header) != CENTRAL_DIR_SIGNATURE) {
+        endOfCentralDir = true;
+        break;
+      }
+      const uint16_t nameLen = readLe16(header + 28);
+      const uint16_t extraLen = readLe16(header + 30);
+      const uint16_t commentLen = readLe16(header + 32);
+
+      if (nameLen < sizeof(itemName)) {
+        file.read(itemName, nameLen);
+        Entry& entry = run[runSize++];
+        entry.hash = ZipFile::fnvHash64(itemName, nameLen);
+        entry.nameLen = nameLen;
+        entry.method = readLe16(header + 10);
+        entry.compressedSize = readLe32(header + 20);
+        entry.uncompressedSize = readLe32(header + 24);
+        entry.dataOffset = readLe32(header + 42);
+        file.seekCur(extraLen + commentLen);
+      } else {
+        // Name too long to look up, skip it
+        file.seekCur(nameLen + extraLen + commentLen);
+      }
+    }
+    centralDirPos = file.position();
+
+    if (runSize == 0) {
+      break;
+    }
+
+    // Resolve data offsets in archive order so the local header reads only seek forward
+    std::sort(run, run + runSize, [](const Entry& a, const Entry& b) { return a.dataOffset < b.dataOffset; });
+    uint8_t localHeader[LOCAL_HEADER_SIZE];
+    for (uint32_t i = 0; i < runSize; i++) {
+      file.seek(run[i].dataOffset);
+      if (file.read(localHeader, LOCAL_HEADER_SIZE) != LOCAL_HEADER_SIZE ||
+          readLe32(localHeader) != LOCAL_HEADER_SIGNATURE) {
+        LOG_ERR("ZIX", "Invalid local header at %u", run[i].dataOffset);
+        success = false;
+        break;
+      }
+      run[i].dataOffset += LOCAL_HEADER_SIZE + readLe16(localHeader + 26) + readLe16(localHeader + 28);
+    }
+    if (!success) {
+      break;
+    }
+
+    std::sort(run, run + runSize, entryLess);
+    if (runsFile.write(reinterpret_cast<const uint8_t*>(run), runSize * sizeof(Entry)) != runSize * sizeof(Entry)) {
+      LOG_ERR("ZIX", "Failed to write sort run");
+      success = false;
+      break;
+    }
+    *totalEntries += runSize;
+  }
+
+  runsFile.close();
+  free(run);
+  return success;
+}
+
+bool ZipIndex::mergeRuns(const std::string& runsPath, const uint32_t totalEntries, const uint32_t zipFileSize) const {
+  FsFile runsFile;
+  if (!Storage.openFileForRead("ZIX", runsPath, runsFile)) {
+    return false;
+  }
+
+  const uint32_t runCount = (totalEntries + RUN_ENTRIES - 1) / RUN_ENTRIES;
+  std::vector<RunCursor> cursors(runCount);
+  for (uint32_t r = 0; r < runCount; r++) {
+    cursors[r].next = r * RUN_ENTRIES;
+    cursors[r].end = std::min(totalEntries, (r + 1) * RUN_ENTRIES);
+  }
+
+  FsFile out;
+  if (!Storage.openFileForWrite("ZIX", indexPath, out)) {
+    runsFile.close();
+    return false;
+  }
+
+  // Entry count and fence offset are placeholders until all entries are out
+  serialization::writePod(out, VERSION);
+  serialization::writePod(out, zipFileSize);
+  serialization::writePod(out, static_cast<uint32_t>(0));
+  serialization::writePod(out, static_cast<uint32_t>(0));
+
+  std::vector<uint64_t> blockFences;
+  blockFences.reserve((totalEntries + ENTRIES_PER_BLOCK - 1) / ENTRIES_PER_BLOCK);
+  Entry block[ENTRIES_PER_BLOCK];
+  uint32_t blockLen = 0;
+  uint32_t indexed = 0;
+  uint64_t previousHash = 0;
+  uint16_t previousLen = 0;
+  bool success = true;
+
+  const auto flushBlock = [&]() {
+    const size_t blockBytes = blockLen * sizeof(Entry);
+    blockLen = 0;
+    if (out.write(reinterpret_cast<const uint8_t*>(block), blockBytes) != blockBytes) {
+      LOG_ERR("ZIX", "Failed to write index block");
+      return false;
+    }
+    return true;
+  };
+
+  for (uint32_t merged = 0; merged < totalEntries && success; merged++) {
+    // Pick the smallest head among the runs, refilling run buffers as they drain
+    RunCursor* best = nullptr;
+    for (auto& cursor : cursors) {
+      if (cursor.bufPos == cursor.bufLen) {
+        if (cursor.next == cursor.end) continue;
+        const uint32_t toLoad = std::min(MERGE_BUFFER_ENTRIES, cursor.end - cursor.next);
+        runsFile.seek(cursor.next * sizeof(Entry));
+        if (runsFile.read(cursor.buf, toLoad * sizeof(Entry)) != static_cast<int>(toLoad * sizeof(Entry))) {
+          LOG_ERR("ZIX", "Failed to read sort run");
+          success = false;
+          break;
+        }
+        cursor.next += toLoad;
+        cursor.bufPos = 0;
+        cursor.bufLen = toLoad;
+      }
+      if (!best || entryLess(cursor.buf[cursor.bufPos], best->buf[best->bufPos])) {
+        best = &cursor;
+      }
+    }
+    if (!success || !best) {
+      success = false;
+      break;
+    }
+
+    const Entry& entry = best->buf[best->bufPos++];
+    if (indexed > 0 && entry.hash == previousHash) {
+      if (entry.nameLen == previousLen) {
+        // Same name stored twice; keep one, as a central directory scan would only ever find one
+        continue;
+      }
+      // Lookups only binary search on the hash; refuse to index an archive where two names collide
+      LOG_ERR("ZIX", "Hash collision between entries, not indexing");
+      success = false;
+      break;
+    }
+    previousHash = entry.hash;
+    previousLen = entry.nameLen;
+
+    if (blockLen == 0) {
+      blockFences.push_back(entry.hash);
+    }
+    block[blockLen++] = entry;
+    indexed++;
+    if (blockLen == ENTRIES_PER_BLOCK && !flushBlock()) {
+      success = false;
+    }
+  }
+  if (success && blockLen > 0 && !flushBlock()) {
+    success = false;
+  }
+  runsFile.close();
+
+  if (success) {
+    const uint32_t fenceOffset = out.position();
+    for (const uint64_t fence : blockFences) {
+      serialization::writePod(out, fence);
+    }
+    out.seek(HEADER_SIZE - sizeof(uint32_t) - sizeof(uint32_t));
+    serialization::writePod(out, indexed);
+    serialization::writePod(out, fenceOffset);
+  }
+  out.close();
+
+  if (!success) {
+    Storage.remove(indexPath.c_str());
+  }
+  return success;
+}
+
+bool ZipIndex::build(ZipFile& zip) const {
+  const bool wasOpen = zip.isOpen();
+  if (!wasOpen && !zip.open()) {
+    return false;
+  }
+
+  if (!zip.loadZipDetails()) {
+    if (!wasOpen) {
+      zip.close();
+    }
+    return false;
+  }
+
+  const uint32_t buildStart = millis();
+  const uint32_t zipFileSize = zip.file.size();
+  const std::string runsPath = indexPath + ".tmp";
+  uint32_t totalEntries = 0;
+  bool success = writeSortedRuns(zip, runsPath, &totalEntries);
+  if (!wasOpen) {
+    zip.close();
+  }
+
+  if (success) {
+    success = mergeRuns(runsPath, totalEntries, zipFileSize);
+  }
+  Storage.remove(runsPath.c_str());
+
+  if (!success) {
+    LOG_ERR("ZIX", "Failed to build zip index");
+    return false;
+  }
+  LOG_DBG("ZIX", "Indexed %u zip entries in %lu ms", totalEntries, millis() - buildStart);
+  return true;
+}
+
+bool ZipIndex::load(ZipFile& zip) {
+  close();
+
+  const bool wasOpen = zip.isOpen();
+  if (!wasOpen && !zip.open()) {
+    return false;
+  }
+  const uint32_t zipFileSize = zip.file.size();
+  if (!wasOpen) {
+    zip.close();
+  }
+
+  if (!Storage.exists(indexPath.c_str()) || !Storage.openFileForRead("ZIX", indexPath, file)) {
+    return false;
+  }
+
+  uint8_t version;
+  uint32_t fileZipSize;
+  uint32_t fenceOffset;
+  serialization::readPod(file, version);
+  serialization::readPod(file, fileZipSize);
+  serialization::readPod(file, entryCount);
+  serialization::readPod(file, fenceOffset);
+  if (version != VERSION || fileZipSize != zipFileSize) {
+    LOG_DBG("ZIX", "Zip index is stale (version %u, zip size %u vs %u)", version, fileZipSize, zipFileSize);
+    close();
+    return false;
+  }
+
+  const uint32_t blockCount = (entryCount + ENTRIES_PER_BLOCK - 1) / ENTRIES_PER_BLOCK;
+  fences.resize(blockCount);
+  file.seek(fenceOffset);
+  if (blockCount > 0 && file.read(fences.data(), blockCount * sizeof(uint64_t)) !=
+                            static_cast<int>(blockCount * sizeof(uint64_t))) {
+    LOG_ERR("ZIX", "Failed to read zip index fences");
+    close();
+    return false;
+  }
+
+  loaded = true;
+  return true;
+}
+
+void ZipIndex::close() {
+  if (file) {
+    file.close();
+  }
+  fences.clear();
+  fences.shrink_to_fit();
+  entryCount = 0;
+  loaded = false;
+}
+
+bool ZipIndex::find(const char* filename, ZipFile::FileStatSlim* fileStat) const {
+  if (!loaded || fences.empty()) {
+    return false;
+  }
+
+  const size_t nameLen = strlen(filename);
+  const uint64_t hash = ZipFile::fnvHash64(filename, nameLen);
+
+  const auto fenceIt = std::upper_bound(fences.begin(), fences.end(), hash);
+  if (fenceIt == fences.begin()) {
+    return false;
+  }
+  const uint32_t blockStart = static_cast<uint32_t>(fenceIt - fences.begin() - 1) * ENTRIES_PER_BLOCK;
+  const uint32_t blockLen = std::min<uint32_t>(ENTRIES_PER_BLOCK, entryCount - blockStart);
+
+  Entry block[ENTRIES_PER_BLOCK];
+  file.seek(HEADER_SIZE + blockStart * sizeof(Entry));
+  if (file.read(block, blockLen * sizeof(Entry)) != static_cast<int>(blockLen * sizeof(Entry))) {
+    LOG_ERR("ZIX", "Failed to read zip index block");
+    return false;
+  }
+
+  const Entry key = {hash, static_cast<uint16_t>(nameLen), 0, 0, 0, 0};
+  const Entry* it = std::lower_bound(block, block + blockLen, key, entryLess);
+  if (it == block + blockLen || it->hash != hash || it->nameLen != nameLen) {
+    return false;
+  }
+
+  fileStat->method = it->method;
+  fileStat->compressedSize = it->compressedSize;
+  fileStat->uncompressedSize = it->uncompressedSize;
+  fileStat->localHeaderOffset = 0;
+  fileStat->dataOffset = it->dataOffset;
+  return true;
+}
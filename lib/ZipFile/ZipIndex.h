@@ -0,0 +1,65 @@
+#pragma once
+#include <HalStorage.h>
+
+#include <string>
+#include <vector>
+
+#include "ZipFile.h"
+
+// Persistent index of a zip central directory, written once per book next to book.bin.
+//
+// Entries are sorted by the FNV-1a hash of their name and carry the resolved data offset, so a lookup never
+// scans the central directory or re-reads the local header. The first hash of every block of entries is kept
+// in RAM; a lookup is a binary search over those, a single block read and a binary search inside the block.
+//
+// File layout:
+//   uint8_t  version
+//   uint32_t zip file size (index is stale if the archive changes size)
+//   uint32_t entry count
+//   uint32_t offset of the block fence table
+//   Entry    entries[entry count]       (sorted by hash)
+//   uint64_t fences[block count]        (hash of the first entry in each block)
+class ZipIndex {
+ public:
+  struct Entry {
+    uint64_t hash;  // ZipFile::fnvHash64 of the entry name
+    uint16_t nameLen;
+    uint16_t method;
+    uint32_t compressedSize;
+    uint32_t uncompressedSize;
+    uint32_t dataOffset;
+  };
+  static_assert(sizeof(Entry) == 24, "ZipIndex::Entry must stay packed");
+
+  static constexpr uint8_t VERSION = 1;
+  static constexpr uint16_t ENTRIES_PER_BLOCK = 32;  // 768 bytes per lookup read
+
+  explicit ZipIndex(std::string indexPath) : indexPath(std::move(indexPath)) {}
+  ~ZipIndex() { close(); }
+
+  ZipIndex(const ZipIndex&) = delete;
+  ZipIndex& operator=(const ZipIndex&) = delete;
+
+  // Scan the central directory of zip and write the index file. Entries are sorted in bounded runs and merged
+  // on SD, so peak memory does not grow with the number of entries.
+  bool build(ZipFile& zip) const;
+  // Read the block fences and keep the index file open for lookups.
+  // Fails if the index is missing, from another version or was built for a different archive.
+  bool load(ZipFile& zip);
+  void close();
+  bool isLoaded() const { return loaded; }
+  uint32_t size() const { return entryCount; }
+  const std::string& getPath() const { return indexPath; }
+
+  bool find(const char* filename, ZipFile::FileStatSlim* fileStat) const;
+
+ private:
+  std::string indexPath;
+  mutable FsFile file;
+  std::vector<uint64_t> fences;
+  uint32_t entryCount = 0;
+  bool loaded = false;
+
+  bool writeSortedRuns(ZipFile& zip, const std::string& runsPath, uint32_t* totalEntries) const;
+  bool mergeRuns(const std::string& runsPath, uint32_t totalEntries, uint32_t zipFileSize) const;
+};
@@ -6,6 +6,19 @@
 
 HalStorage HalStorage::instance;
 
+#ifdef ENABLE_SD_TRACE
+namespace {
+void traceOpen(FsFile& file, const char* path, const bool writeMode, const uint32_t startUs) {
+  if (!perf::sdTraceActive()) {
+    return;
+  }
+  file.tracePathId = perf::sdTracePathId(path);
+  const uint8_t flags = (file ? 0 : perf::SD_TRACE_FAILED) | (writeMode ? perf::SD_TRACE_WRITE_MODE : 0);
+  perf::sdTraceRecord(perf::SdOp::Open, file.tracePathId, 0, 0, startUs, flags);
+}
+}  // namespace
+#endif
+
 HalStorage::HalStorage() {}
 
 bool HalStorage::begin() { return SDCard.begin(); }
@@ -28,7 +41,16 @@ bool HalStorage::writeFile(const char* path, const String& content) { return SDC
 
 bool HalStorage::ensureDirectoryExists(const char* path) { return SDCard.ensureDirectoryExists(path); }
 
-FsFile HalStorage::open(const char* path, const oflag_t oflag) { return SDCard.open(path, oflag); }
+FsFile HalStorage::open(const char* path, const oflag_t oflag) {
+#ifdef ENABLE_SD_TRACE
+  const uint32_t start = micros();
+  FsFile file = SDCard.open(path, oflag);
+  traceOpen(file, path, (oflag & (O_WRONLY | O_RDWR)) != 0, start);
+  return file;
+#else
+  return SDCard.open(path, oflag);
+#endif
+}
 
 bool HalStorage::mkdir(const char* path, const bool pFlag) { return SDCard.mkdir(path, pFlag); }
 
@@ -41,7 +63,14 @@ bool HalStorage::rename(const char* oldPath, const char* newPath) { return SDCar
 bool HalStorage::rmdir(const char* path) { return SDCard.rmdir(path); }
 
 bool HalStorage::openFileForRead(const char* moduleName, const char* path, FsFile& file) {
+#ifdef ENABLE_SD_TRACE
+  const uint32_t start = micros();
+  const bool ok = SDCard.openFileForRead(moduleName, path, file);
+  traceOpen(file, path, false, start);
+  return ok;
+#else
   return SDCard.openFileForRead(moduleName, path, file);
+#endif
 }
 
 bool HalStorage::openFileForRead(const char* moduleName, const std::string& path, FsFile& file) {
@@ -53,7 +82,14 @@ bool HalStorage::openFileForRead(const char* moduleName, const String& path, FsF
 }
 
 bool HalStorage::openFileForWrite(const char* moduleName, const char* path, FsFile& file) {
+#ifdef ENABLE_SD_TRACE
+  const uint32_t start = micros();
+  const bool ok = SDCard.openFileForWrite(moduleName, path, file);
+  traceOpen(file, path, true, start);
+  return ok;
+#else
   return SDCard.openFileForWrite(moduleName, path, file);
+#endif
 }
 
 bool HalStorage::openFileForWrite(const char* moduleName, const std::string& path, FsFile& file) {
@@ -5,6 +5,82 @@
 
 #include <vector>
 
+#ifdef ENABLE_SD_TRACE
+#include <SdTrace.h>
+
+// An FsFile that reports every call to the SD trace (see SdTrace.h). Only built with ENABLE_SD_TRACE, where FsFile
+// below names this class, the same way Logging.h redirects Serial. SDCardManager still hands out plain FsFiles, which
+// convert; those opened through HalStorage carry their path id.
+class HalFile : public FsFile {
+ public:
+  uint16_t tracePathId = 0;
+
+  HalFile() = default;
+  HalFile(const FsFile& file) : FsFile(file) {}  // NOLINT(google-explicit-constructor)
+
+  using FsFile::read;
+  using FsFile::write;
+
+  int read(void* buf, const size_t count) {
+    if (!perf::sdTraceActive()) return FsFile::read(buf, count);
+    const uint32_t start = micros();
+    const uint32_t offset = position();
+    const int n = FsFile::read(buf, count);
+    record(perf::SdOp::Read, offset, count, start, transferFlags(n, count));
+    return n;
+  }
+  int read() override {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+  }
+  size_t write(const uint8_t* buf, const size_t count) override {
+    if (!perf::sdTraceActive()) return FsFile::write(buf, count);
+    const uint32_t start = micros();
+    const uint32_t offset = position();
+    const size_t n = FsFile::write(buf, count);
+    record(perf::SdOp::Write, offset, count, start, transferFlags(static_cast<int>(n), count));
+    return n;
+  }
+  size_t write(const uint8_t b) override { return write(&b, 1); }
+  size_t write(const void* buf, const size_t count) { return write(static_cast<const uint8_t*>(buf), count); }
+
+  bool seek(const uint64_t pos) { return seekSet(pos); }
+  bool seekSet(const uint64_t pos) {
+    const uint32_t start = micros();
+    const bool ok = FsFile::seekSet(pos);
+    record(perf::SdOp::Seek, pos, 0, start, ok ? 0 : perf::SD_TRACE_FAILED);
+    return ok;
+  }
+  bool seekCur(const int64_t offset) {
+    const uint32_t start = micros();
+    const bool ok = FsFile::seekCur(offset);
+    record(perf::SdOp::Seek, position(), 0, start, ok ? 0 : perf::SD_TRACE_FAILED);
+    return ok;
+  }
+  bool close() {
+    const bool wasOpen = isOpen();
+    const uint32_t start = micros();
+    const bool ok = FsFile::close();
+    if (wasOpen) record(perf::SdOp::Close, 0, 0, start, ok ? 0 : perf::SD_TRACE_FAILED);
+    return ok;
+  }
+
+ private:
+  static uint8_t transferFlags(const int transferred, const size_t requested) {
+    if (transferred < 0) return perf::SD_TRACE_FAILED;
+    return static_cast<size_t>(transferred) < requested ? perf::SD_TRACE_SHORT : 0;
+  }
+  void record(const perf::SdOp op, const uint64_t offset, const size_t length, const uint32_t start,
+              const uint8_t flags) const {
+    if (perf::sdTraceActive()) {
+      perf::sdTraceRecord(op, tracePathId, static_cast<uint32_t>(offset), static_cast<uint32_t>(length), start, flags);
+    }
+  }
+};
+
+#define FsFile HalFile
+#endif
+
 class HalStorage {
  public:
   HalStorage();
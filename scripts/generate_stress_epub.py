@@ -0,0 +1,421 @@
+#!/usr/bin/env python3
+"""
+Generate large synthetic EPUBs for stress and scaling tests.
+
+Each preset pushes one dimension the reader has to scale along:
+- spine:          thousands of small spine items
+- big-chapter:    a single 5 MB chapter
+- images:         2,000+ inline JPEG and PNG images
+- deep-toc:       a deeply nested table of contents (nav and NCX)
+- css:            large stylesheets with hundreds of classes, used throughout the text
+- long-paragraph: very long paragraphs with no breaks, and some very long words
+- footnotes:      text with a footnote reference every few sentences
+- stored:         a mid-sized book whose entries are all STORED instead of DEFLATEd
+- novel:          a novel-length book whose words follow Zipf's law, as prose does, with some bold and italic text
+
+Any preset parameter can be overridden on the command line. Output depends only on the seed and the parameters (and
+zlib, for the DEFLATEd entries), so the host benchmark and the device read the same bytes and scaling runs stay
+comparable over time:
+
+    python3 scripts/generate_stress_epub.py --preset all
+    ./test/run_layout_bench.sh --no-render build/stress_epubs/stress-spine.epub
+
+Images are generated in pure Python (DC-only baseline JPEGs and 8-bit grayscale PNGs), so Pillow is not needed.
+"""
+
+import argparse
+import itertools
+import random
+import struct
+import zipfile
+import zlib
+from pathlib import Path
+
+OUTPUT_DIR = Path(__file__).parent.parent / "build" / "stress_epubs"
+
+DEFAULTS = {
+    "chapters": 20,
+    "chapter_kb": 32,  # Approximate text per chapter
+    "paragraph_kb": 1,  # Approximate paragraph length
+    "images": 0,  # Total, spread over the chapters
+    "image_width": 160,
+    "image_height": 120,
+    "toc_depth": 1,
+    "toc_fanout": 0,  # 0: one flat entry per chapter; otherwise a full tree of this fanout and toc_depth
+    "css_classes": 20,
+    "css_files": 1,
+    "footnotes_per_kb": 0,
+    "long_words": 0,  # Unbreakable 300-character words per paragraph
+    "vocabulary": 0,  # 0: every word made up on the spot; otherwise drawn from this many words by Zipf's law
+    "compression": "deflate",  # deflate, stored or mixed
+}
+
+PRESETS = {
+    "spine": {"chapters": 3000, "chapter_kb": 2},
+    "big-chapter": {"chapters": 1, "chapter_kb": 5120, "paragraph_kb": 2},
+    "images": {"chapters": 100, "chapter_kb": 4, "images": 2400},
+    "deep-toc": {"chapters": 128, "chapter_kb": 4, "toc_depth": 8, "toc_fanout": 2},
+    "css": {"chapters": 50, "chapter_kb": 16, "css_classes": 1200, "css_files": 3},
+    "long-paragraph": {"chapters": 10, "chapter_kb": 256, "paragraph_kb": 128, "long_words": 2},
+    "footnotes": {"chapters": 40, "chapter_kb": 24, "footnotes_per_kb": 6},
+    "stored": {"chapters": 200, "chapter_kb": 16, "images": 100, "compression": "stored"},
+    "novel": {"chapters": 30, "chapter_kb": 48, "vocabulary": 6000},
+}
+
+SYLLABLES = ["ka", "lo", "mi", "ne", "ra", "tu", "shi", "an", "el", "or", "qua", "ber", "ston", "ing", "th", "ve",
+             "de", "pre", "con", "ly", "ment", "ous", "ab", "ex", "im", "sa", "po", "gri", "fal", "wen"]
+CSS_PROPERTIES = [
+    "font-style: italic", "font-weight: bold", "text-align: center", "text-align: justify", "text-align: right",
+    "text-indent: 1.5em", "text-indent: 0", "margin-top: 1em", "margin-bottom: 0.5em", "margin-left: 2em",
+    "padding-left: 1em", "text-decoration: underline", "font-size: 0.9em", "line-height: 1.4", "font-variant: normal",
+]
+
+
+# Text
+
+def make_word(rng):
+    return "".join(rng.choice(SYLLABLES) for _ in range(rng.choice((1, 1, 2, 2, 2, 3, 3, 4))))
+
+
+class Vocabulary:
+    """A fixed word list drawn from by Zipf's law, so the common words recur as often as they do in prose."""
+
+    def __init__(self, rng, size):
+        self.words = [make_word(rng) for _ in range(size)]
+        self.weights = list(itertools.accumulate(1 / rank for rank in range(1, size + 1)))
+
+    def word(self, rng):
+        return rng.choices(self.words, cum_weights=self.weights)[0]
+
+
+def make_sentence(rng, vocabulary=None):
+    words = [vocabulary.word(rng) if vocabulary else make_word(rng) for _ in range(rng.randint(6, 18))]
+    words[0] = words[0].capitalize()
+    if len(words) > 8 and rng.random() < 0.4:
+        words[rng.randint(2, len(words) - 3)] += ","
+    return " ".join(words) + rng.choice(".....?!")
+
+
+class Footnotes:
+    """Numbers footnote references across a chapter and collects their notes."""
+
+    def __init__(self, rng, per_kb):
+        self.rng = rng
+        self.per_kb = per_kb
+        self.notes = []
+
+    def maybe_ref(self, sentence_bytes):
+        if self.per_kb == 0 or self.rng.random() >= self.per_kb * sentence_bytes / 1024:
+            return ""
+        number = len(self.notes) + 1
+        self.notes.append(make_sentence(self.rng))
+        return f'<a epub:type="noteref" href="#fn{number}" id="ref{number}">{number}</a>'
+
+    def asides(self):
+        return "\n".join(f'<aside epub:type="footnote" id="fn{i + 1}"><p><a href="#ref{i + 1}">{i + 1}</a> {note}</p>'
+                         f"</aside>" for i, note in enumerate(self.notes))
+
+
+def make_paragraph(rng, target_bytes, params, footnotes, classes, vocabulary):
+    parts = []
+    size = 0
+    while size < target_bytes:
+        sentence = make_sentence(rng, vocabulary)
+        if classes and rng.random() < 0.15:
+            words = sentence.split(" ")
+            i = rng.randrange(len(words))
+            words[i] = f'<span class="{rng.choice(classes)}">{words[i]}</span>'
+            sentence = " ".join(words)
+        sentence += footnotes.maybe_ref(len(sentence))
+        parts.append(sentence)
+        size += len(sentence) + 1
+    for _ in range(params["long_words"]):
+        # One unbreakable run of letters, longer than any line
+        parts.insert(rng.randrange(len(parts) + 1), "".join(rng.choice(SYLLABLES) for _ in range(120))[:300])
+    attr = f' class="{rng.choice(classes)}"' if classes and rng.random() < 0.5 else ""
+    return f"<p{attr}>{' '.join(parts)}</p>"
+
+
+# Images
+
+def png_image(rng, width, height):
+    """An 8-bit grayscale PNG: a few random bands and a diagonal stripe."""
+    bands = [rng.randrange(256) for _ in range(4)]
+    rows = bytearray()
+    for y in range(height):
+        rows.append(0)  # Filter: none
+        band = bands[y * len(bands) // height]
+        rows.extend(0 if (x + y) % 32 < 4 else band for x in range(width))
+
+    def chunk(kind, data):
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data) & 0xFFFFFFFF)
+
+    header = struct.pack(">IIBBBBB", width, height, 8, 0, 0, 0, 0)
+    return (b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", header) + chunk(b"IDAT", zlib.compress(bytes(rows), 9)) +
+            chunk(b"IEND", b""))
+
+
+# Standard luminance DC table (JPEG spec, Annex K.3): code lengths per category 0-11
+DC_BITS = [0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0]
+DC_CODES = {0: "00", 1: "010", 2: "011", 3: "100", 4: "101", 5: "110", 6: "1110", 7: "11110", 8: "111110",
+            9: "1111110", 10: "11111110", 11: "111111110"}
+# AC table with end-of-block as its only symbol: every block is flat, so only DC coefficients are coded
+AC_BITS = [1] + [0] * 15
+AC_EOB = "0"
+
+
+def jpeg_image(rng, width, height):
+    """A baseline grayscale JPEG made of flat 8x8 blocks, which picojpeg decodes like any other baseline JPEG."""
+    width = (width + 7) // 8 * 8
+    height = (height + 7) // 8 * 8
+    levels = [rng.randrange(256) for _ in range(6)]
+
+    bits = []
+    previous = 0
+    for by in range(height // 8):
+        for bx in range(width // 8):
+            # With every quantiser at 8, a flat block of value v has the quantised DC v - 128
+            dc = levels[(bx // 4 + by // 3) % len(levels)] - 128
+            diff = dc - previous
+            previous = dc
+            category = abs(diff).bit_length()
+            bits.append(DC_CODES[category])
+            if category:
+                bits.append(format(diff if diff >= 0 else diff + (1 << category) - 1, f"0{category}b"))
+            bits.append(AC_EOB)
+    stream = "".join(bits)
+    stream += "1" * (-len(stream) % 8)
+    data = bytearray()
+    for i in range(0, len(stream), 8):
+        byte = int(stream[i:i + 8], 2)
+        data.append(byte)
+        if byte == 0xFF:
+            data.append(0)  # Byte stuffing
+
+    def segment(marker, payload):
+        return struct.pack(">BBH", 0xFF, marker, len(payload) + 2) + payload
+
+    return (b"\xff\xd8" +
+            segment(0xDB, bytes([0]) + bytes([8] * 64)) +
+            segment(0xC0, struct.pack(">BHHB", 8, height, width, 1) + bytes([1, 0x11, 0])) +
+            segment(0xC4, bytes([0x00] + DC_BITS + list(range(12)))) +
+            segment(0xC4, bytes([0x10] + AC_BITS + [0x00])) +
+            segment(0xDA, bytes([1, 1, 0x00, 0, 63, 0])) +
+            bytes(data) + b"\xff\xd9")
+
+
+# Table of contents
+
+def toc_tree(params):
+    """(level, chapter index, title) entries in document order."""
+    chapters = params["chapters"]
+    fanout = params["toc_fanout"]
+    if fanout == 0:
+        return [(1, i, f"Chapter {i + 1}") for i in range(chapters)]
+
+    entries = []
+    leaves = [0]
+
+    def visit(level, label):
+        if level == params["toc_depth"]:
+            entries.append((level, leaves[0] % chapters, f"Section {label}"))
+            leaves[0] += 1
+            return
+        index = len(entries)
+        entries.append((level, 0, f"Part {label}"))
+        first_leaf = leaves[0]
+        for child in range(fanout):
+            visit(level + 1, f"{label}.{child + 1}")
+        entries[index] = (level, first_leaf % chapters, entries[index][2])
+
+    for root in range(fanout):
+        visit(1, str(root + 1))
+    return entries
+
+
+def nav_xhtml(entries):
+    lines = []
+    level = 0
+    for entry_level, chapter, title in entries:
+        if entry_level > level:
+            lines.append("<ol>" * (entry_level - level))
+        else:
+            lines.append("</li>" + "</ol></li>" * (level - entry_level))
+        lines.append(f'<li><a href="chapter{chapter + 1}.xhtml">{title}</a>')
+        level = entry_level
+    lines.append("</li>" + "</ol></li>" * (level - 1) + "</ol>")
+    return ('<?xml version="1.0" encoding="UTF-8"?>\n<!DOCTYPE html>\n'
+            '<html xmlns="http://www.w3.org/1999/xhtml" xmlns:epub="http://www.idpf.org/2007/ops">\n'
+            '<head><title>Contents</title></head>\n<body>\n<nav epub:type="toc">\n<h1>Contents</h1>\n' +
+            "\n".join(lines) + "\n</nav>\n</body>\n</html>\n")
+
+
+def toc_ncx(entries, uid):
+    lines = []
+    open_points = 0
+    level = 0
+    for order, (entry_level, chapter, title) in enumerate(entries):
+        close = level - entry_level + 1 if level else 0
+        lines.append("</navPoint>" * close)
+        open_points -= close
+        lines.append(f'<navPoint id="np{order + 1}" playOrder="{order + 1}"><navLabel><text>{title}</text>'
+                     f'</navLabel><content src="chapter{chapter + 1}.xhtml"/>')
+        open_points += 1
+        level = entry_level
+    lines.append("</navPoint>" * open_points)
+    return ('<?xml version="1.0" encoding="UTF-8"?>\n<ncx xmlns="http://www.daisy.org/z3986/2005/ncx/" version="2005-1">\n'
+            f'<head><meta name="dtb:uid" content="{uid}"/></head>\n<docTitle><text>{uid}</text></docTitle>\n<navMap>\n' +
+            "\n".join(line for line in lines if line) + "\n</navMap>\n</ncx>\n")
+
+
+# Book
+
+def make_css(rng, params):
+    """Stylesheets and the class names they define."""
+    classes = [f"c{i}-{make_word(rng)}" for i in range(params["css_classes"])]
+    files = [[] for _ in range(params["css_files"])]
+    files[0].append("p { margin: 0; text-indent: 1em; }\nh1 { text-align: center; }\n"
+                    "aside { font-size: 0.8em; }\n")
+    for i, name in enumerate(classes):
+        props = "; ".join(rng.sample(CSS_PROPERTIES, rng.randint(1, 4)))
+        selector = f".{name}" if rng.random() < 0.7 else f"{rng.choice(('p', 'span', 'div'))}.{name}"
+        files[i % len(files)].append(f"{selector} {{ {props}; }}\n")
+    return ["".join(rules) for rules in files], classes
+
+
+def make_chapter(rng, index, params, classes, images, vocabulary):
+    footnotes = Footnotes(rng, params["footnotes_per_kb"])
+    target = params["chapter_kb"] * 1024
+    paragraph = params["paragraph_kb"] * 1024
+    body = [f"<h1>Chapter {index + 1}</h1>"]
+    size = 0
+    # Spread this chapter's images evenly through its text
+    image_every = max(1, target // (len(images) + 1)) if images else 0
+    next_image = image_every
+    pending = list(images)
+    while size < target:
+        body.append(make_paragraph(rng, min(paragraph, target - size), params, footnotes, classes, vocabulary))
+        size += len(body[-1])
+        while pending and size >= next_image:
+            name = pending.pop(0)
+            body.append(f'<p><img src="images/{name}" alt="{name}"/></p>')
+            next_image += image_every
+    body.extend(f'<p><img src="images/{name}" alt="{name}"/></p>' for name in pending)
+    if footnotes.notes:
+        body.append(footnotes.asides())
+    links = "".join(f'<link rel="stylesheet" type="text/css" href="styles/style{i + 1}.css"/>'
+                    for i in range(params["css_files"]))
+    return ('<?xml version="1.0" encoding="UTF-8"?>\n<!DOCTYPE html>\n'
+            '<html xmlns="http://www.w3.org/1999/xhtml" xmlns:epub="http://www.idpf.org/2007/ops">\n'
+            f"<head><title>Chapter {index + 1}</title>{links}</head>\n<body>\n" + "\n".join(body) + "\n</body>\n</html>\n")
+
+
+class EpubWriter:
+    """Writes entries with fixed timestamps and attributes, so equal input gives byte-identical output."""
+
+    def __init__(self, path, compression, rng):
+        self.zip = zipfile.ZipFile(path, "w")
+        self.compression = compression
+        self.rng = rng
+        self.entries = 0
+
+    def add(self, name, data, compressible=True):
+        if isinstance(data, str):
+            data = data.encode("utf-8")
+        if self.compression == "stored" or not compressible:
+            method = zipfile.ZIP_STORED
+        elif self.compression == "mixed":
+            method = zipfile.ZIP_DEFLATED if self.rng.random() < 0.5 else zipfile.ZIP_STORED
+        else:
+            method = zipfile.ZIP_DEFLATED
+        info = zipfile.ZipInfo(name, date_time=(1980, 1, 1, 0, 0, 0))
+        info.compress_type = method
+        info.create_system = 3
+        info.external_attr = 0o644 << 16
+        self.zip.writestr(info, data)
+        self.entries += 1
+
+    def close(self):
+        self.zip.close()
+
+
+def build_book(path, name, params, seed):
+    rng = random.Random(f"{name}:{seed}")
+    uid = f"crosspoint-stress-{name}-{seed}"
+    epub = EpubWriter(path, params["compression"], rng)
+    epub.add("mimetype", "application/epub+zip", compressible=False)
+    epub.add("META-INF/container.xml",
+             '<?xml version="1.0" encoding="UTF-8"?>\n'
+             '<container version="1.0" xmlns="urn:oasis:names:tc:opendocument:xmlns:container">\n'
+             '<rootfiles><rootfile full-path="OEBPS/content.opf" media-type="application/oebps-package+xml"/>'
+             "</rootfiles>\n</container>\n")
+
+    manifest = ['<item id="nav" href="nav.xhtml" media-type="application/xhtml+xml" properties="nav"/>',
+                '<item id="ncx" href="toc.ncx" media-type="application/x-dtbncx+xml"/>']
+    stylesheets, classes = make_css(rng, params)
+    for i, css in enumerate(stylesheets):
+        epub.add(f"OEBPS/styles/style{i + 1}.css", css)
+        manifest.append(f'<item id="css{i + 1}" href="styles/style{i + 1}.css" media-type="text/css"/>')
+    classes = classes if params["css_classes"] else []
+    vocabulary = Vocabulary(rng, params["vocabulary"]) if params["vocabulary"] else None
+
+    chapters = params["chapters"]
+    chapter_images = [[] for _ in range(chapters)]
+    for i in range(params["images"]):
+        is_png = i % 2 == 1
+        image = f"img{i + 1}.{'png' if is_png else 'jpg'}"
+        data = (png_image if is_png else jpeg_image)(rng, params["image_width"], params["image_height"])
+        # Images are already compressed; like most real books, store them
+        epub.add(f"OEBPS/images/{image}", data, compressible=False)
+        manifest.append(f'<item id="img{i + 1}" href="images/{image}" '
+                        f'media-type="{"image/png" if is_png else "image/jpeg"}"/>')
+        chapter_images[i * chapters // params["images"]].append(image)
+
+    spine = []
+    for i in range(chapters):
+        epub.add(f"OEBPS/chapter{i + 1}.xhtml", make_chapter(rng, i, params, classes, chapter_images[i], vocabulary))
+        manifest.append(f'<item id="ch{i + 1}" href="chapter{i + 1}.xhtml" media-type="application/xhtml+xml"/>')
+        spine.append(f'<itemref idref="ch{i + 1}"/>')
+
+    entries = toc_tree(params)
+    epub.add("OEBPS/nav.xhtml", nav_xhtml(entries))
+    epub.add("OEBPS/toc.ncx", toc_ncx(entries, uid))
+    epub.add("OEBPS/content.opf",
+             '<?xml version="1.0" encoding="UTF-8"?>\n'
+             '<package xmlns="http://www.idpf.org/2007/opf" version="3.0" unique-identifier="uid">\n'
+             '<metadata xmlns:dc="http://purl.org/dc/elements/1.1/">\n'
+             f'<dc:identifier id="uid">{uid}</dc:identifier>\n<dc:title>Stress test: {name} (seed {seed})</dc:title>\n'
+             "<dc:creator>CrossPoint</dc:creator>\n<dc:language>en</dc:language>\n</metadata>\n"
+             "<manifest>\n" + "\n".join(manifest) + '\n</manifest>\n<spine toc="ncx">\n' + "\n".join(spine) +
+             "\n</spine>\n</package>\n")
+    epub.close()
+    return epub.entries, len(entries)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--preset", default="all", choices=["all", "custom"] + list(PRESETS),
+                        help="book to generate; 'custom' starts from the defaults (default: all)")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--out-dir", type=Path, default=OUTPUT_DIR)
+    for key, value in DEFAULTS.items():
+        option = "--" + key.replace("_", "-")
+        if key == "compression":
+            parser.add_argument(option, choices=["deflate", "stored", "mixed"])
+        else:
+            parser.add_argument(option, type=type(value))
+    args = parser.parse_args()
+
+    names = list(PRESETS) if args.preset == "all" else [args.preset]
+    overrides = {key: getattr(args, key) for key in DEFAULTS if getattr(args, key) is not None}
+    args.out_dir.mkdir(parents=True, exist_ok=True)
+    for name in names:
+        params = {**DEFAULTS, **PRESETS.get(name, {}), **overrides}
+        path = args.out_dir / f"stress-{name}.epub"
+        entries, toc_entries = build_book(path, name, params, args.seed)
+        print(f"{path}: {path.stat().st_size / 1024:.0f} KB, {entries} entries, {params['chapters']} chapters, "
+              f"{params['images']} images, {toc_entries} TOC entries")
+
+
+if __name__ == "__main__":
+    main()
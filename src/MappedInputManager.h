@@ -25,6 +25,8 @@ class MappedInputManager {
   Labels mapLabels(const char* back, const char* confirm, const char* previous, const char* next) const;
   // Returns the raw front button index that was pressed this frame (or -1 if none).
   int getPressedFrontButton() const;
+  // The device is on USB power (and so charging)
+  bool isUsbConnected() const { return gpio.isUsbConnected(); }
 
  private:
   HalGPIO& gpio;
@@ -5,6 +5,7 @@
 #include <GfxRenderer.h>
 #include <HalStorage.h>
 #include <I18n.h>
+#include <PerfTrace.h>
 #include <Utf8.h>
 #include <Xtc.h>
 
@@ -216,6 +217,7 @@ void HomeActivity::render(RenderLock&&) {
   const auto pageWidth = renderer.getScreenWidth();
   const auto pageHeight = renderer.getScreenHeight();
 
+  const uint32_t drawStart = perf::nowUs();
   renderer.clearScreen();
   bool bufferRestored = coverBufferStored && restoreCoverBuffer();
 
@@ -247,6 +249,7 @@ void HomeActivity::render(RenderLock&&) {
 
   const auto labels = mappedInput.mapLabels("", tr(STR_SELECT), tr(STR_DIR_UP), tr(STR_DIR_DOWN));
   GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
+  perf::record(perf::Phase::MenuDraw, perf::nowUs() - drawStart);
 
   renderer.displayBuffer();
 
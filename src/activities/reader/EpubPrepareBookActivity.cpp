@@ -0,0 +1,109 @@
+#include "EpubPrepareBookActivity.h"
+
+#include <GfxRenderer.h>
+#include <I18n.h>
+#include <Logging.h>
+
+#include "MappedInputManager.h"
+#include "SectionPreIndexer.h"
+#include "components/UITheme.h"
+#include "fontIds.h"
+
+void EpubPrepareBookActivity::onEnter() {
+  Activity::onEnter();
+  startTime = millis();
+  LOG_DBG("EPB", "Preparing book: %u of %u spine items to index", pageMap.missingCount(), pageMap.spineCount());
+  requestUpdate();
+}
+
+void EpubPrepareBookActivity::onExit() {
+  // The render lock is held here, so the build is only told to stop
+  SectionPreIndexer::getInstance().requestCancel();
+  Activity::onExit();
+}
+
+void EpubPrepareBookActivity::loop() {
+  auto& preIndexer = SectionPreIndexer::getInstance();
+  if (mappedInput.wasReleased(MappedInputManager::Button::Back)) {
+    preIndexer.cancel();
+    LOG_DBG("EPB", "Preparing book stopped, %u spine items left", pageMap.missingCount());
+    ActivityResult result;
+    result.isCancelled = true;
+    setResult(std::move(result));
+    finish();
+    return;
+  }
+
+  // One chapter at a time; a build already running (e.g. the reader's own) is waited for and its count kept
+  int builtSpineIndex;
+  uint16_t builtPageCount;
+  if (preIndexer.takeResult(builtSpineIndex, builtPageCount)) {
+    RenderLock lock(*this);
+    if (pageMap.setPageCount(builtSpineIndex, builtPageCount)) {
+      pageMap.save();
+    }
+  }
+  if (preIndexer.isRunning()) {
+    return;
+  }
+  if (buildingSpineIndex >= 0) {
+    if (pageMap.pageCount(buildingSpineIndex) == BookPageMap::UNKNOWN) {
+      LOG_ERR("EPB", "Section %d did not build, skipping it", buildingSpineIndex);
+      failedSections++;
+    }
+    buildingSpineIndex = -1;
+    requestUpdate();
+  }
+
+  const int spineIndex = pageMap.nextMissing(nextSpineIndex);
+  if (spineIndex < 0) {
+    finishPreparing();
+    return;
+  }
+  const auto& layout = pageMap.getLayout();
+  if (!preIndexer.start(epub, spineIndex, renderer, layout.fontId, layout.lineCompression,
+                        layout.extraParagraphSpacing, layout.paragraphAlignment, layout.viewportWidth,
+                        layout.viewportHeight, layout.hyphenationEnabled, layout.embeddedStyle)) {
+    // Only refused for lack of heap, which waiting here will not fix
+    LOG_ERR("EPB", "Could not start indexing section %d", spineIndex);
+    finishPreparing();
+    return;
+  }
+  buildingSpineIndex = spineIndex;
+  nextSpineIndex = spineIndex + 1;
+}
+
+void EpubPrepareBookActivity::finishPreparing() {
+  if (pageMap.isComplete()) {
+    LOG_DBG("EPB", "Prepared book in %lums: %u pages in %u spine items", millis() - startTime,
+            pageMap.totalPages(), pageMap.spineCount());
+  } else {
+    LOG_DBG("EPB", "Preparing book ended after %lums, %u spine items left (%d failed)", millis() - startTime,
+            pageMap.missingCount(), failedSections);
+  }
+  finish();
+}
+
+void EpubPrepareBookActivity::render(RenderLock&&) {
+  const auto pageWidth = renderer.getScreenWidth();
+  const auto pageHeight = renderer.getScreenHeight();
+  const int total = pageMap.spineCount();
+  const int done = total - pageMap.missingCount();
+
+  renderer.clearScreen();
+  renderer.drawCenteredText(UI_12_FONT_ID, 15, tr(STR_PREPARE_BOOK), true, EpdFontFamily::BOLD);
+  renderer.drawCenteredText(UI_10_FONT_ID, pageHeight / 2 - 40, tr(STR_PREPARING_BOOK));
+  const std::string countText = std::to_string(done) + " / " + std::to_string(total);
+  renderer.drawCenteredText(UI_10_FONT_ID, pageHeight / 2 - 10, countText.c_str());
+  if (total > 0) {
+    const int barWidth = pageWidth - 100;
+    constexpr int barHeight = 20;
+    constexpr int barX = 50;
+    const int barY = pageHeight / 2 + 20;
+    GUI.drawProgressBar(renderer, Rect{barX, barY, barWidth, barHeight}, done, total);
+  }
+
+  const auto labels = mappedInput.mapLabels(tr(STR_BACK), "", "", "");
+  GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
+  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+}
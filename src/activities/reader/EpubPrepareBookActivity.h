@@ -0,0 +1,34 @@
+#pragma once
+#include <Epub.h>
+#include <Epub/BookPageMap.h>
+
+#include <memory>
+
+#include "activities/Activity.h"
+
+// Lays out every chapter the book's page map is still missing, one after the other on the background indexer,
+// with a progress screen. Chapters already on the card are only loaded, and the map is saved after every chapter,
+// so running it again after an interruption picks up where the last run stopped. Back cancels the current build.
+class EpubPrepareBookActivity final : public Activity {
+ public:
+  explicit EpubPrepareBookActivity(GfxRenderer& renderer, MappedInputManager& mappedInput,
+                                   const std::shared_ptr<Epub>& epub, BookPageMap& pageMap)
+      : Activity("EpubPrepareBook", renderer, mappedInput), epub(epub), pageMap(pageMap) {}
+
+  void onEnter() override;
+  void onExit() override;
+  void loop() override;
+  void render(RenderLock&&) override;
+  bool preventAutoSleep() override { return true; }
+
+ private:
+  std::shared_ptr<Epub> epub;
+  BookPageMap& pageMap;  // Owned by the reader, which outlives this activity
+
+  int nextSpineIndex = 0;   // Where the search for the next missing chapter resumes
+  int buildingSpineIndex = -1;
+  int failedSections = 0;
+  unsigned long startTime = 0;
+
+  void finishPreparing();
+};
@@ -7,9 +7,11 @@
 #include <HalStorage.h>
 #include <I18n.h>
 #include <Logging.h>
+#include <PerfTrace.h>
 
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
+#include "EpubPrepareBookActivity.h"
 #include "EpubReaderChapterSelectionActivity.h"
 #include "EpubReaderFootnotesActivity.h"
 #include "EpubReaderPercentSelectionActivity.h"
@@ -18,6 +20,7 @@
 #include "MappedInputManager.h"
 #include "QrDisplayActivity.h"
 #include "RecentBooksStore.h"
+#include "SectionPreIndexer.h"
 #include "components/UITheme.h"
 #include "fontIds.h"
 #include "util/ScreenshotUtil.h"
@@ -28,6 +31,14 @@ constexpr unsigned long skipChapterMs = 700;
 constexpr unsigned long goHomeMs = 1000;
 // pages per minute, first item is 1 to prevent division by zero if accessed
 const std::vector<int> PAGE_TURN_LABELS = {1, 1, 3, 6, 12};
+// The next chapter is indexed in the background once the reader is this close to the end of the current one
+constexpr int PREINDEX_LAST_PAGES = 3;
+// Adjacent pages are only prefetched with this much heap to spare (a cached page is typically a few KB)
+constexpr uint32_t PREFETCH_MIN_FREE_HEAP = 48 * 1024;
+// Decompressed glyph groups are kept from page to page unless the free heap drops below this
+constexpr uint32_t FONT_CACHE_MIN_FREE_HEAP = 32 * 1024;
+// On USB power, the rest of the book is paginated once no page has been turned for this long
+constexpr unsigned long POWER_PREPARE_IDLE_MS = 10 * 1000;
 
 int clampPercent(int percent) {
   if (percent < 0) {
@@ -117,10 +128,15 @@ void EpubReaderActivity::onExit() {
 
   APP_STATE.readerActivityLoadCount = 0;
   APP_STATE.saveToFile();
+  // The render lock is held here, so the build is only told to stop; it cleans up once the lock is free
+  SectionPreIndexer::getInstance().requestCancel();
   section.reset();
   epub.reset();
+  renderer.clearFontCache();
 }
 
+bool EpubReaderActivity::preventAutoSleep() { return SectionPreIndexer::getInstance().isRunning(); }
+
 void EpubReaderActivity::loop() {
   if (!epub) {
     // Should never happen
@@ -128,6 +144,19 @@ void EpubReaderActivity::loop() {
     return;
   }
 
+  // Input, or an automatic turn coming due, takes the card and CPU back from a background build of the next chapter.
+  // A progressive build of the current one keeps going, since the reader is waiting on its pages.
+  auto& preIndexer = SectionPreIndexer::getInstance();
+  if (preIndexer.isRunning() && !preIndexer.isProgressive() &&
+      (mappedInput.wasAnyPressed() || mappedInput.wasAnyReleased() ||
+       (automaticPageTurnActive && millis() - lastPageTurnTime >= pageTurnDuration))) {
+    preIndexer.cancel();
+    preIndexedSpineIndex = -1;
+    // Not a build failure; the chapter is tried again
+    powerPrepareSpineIndex = -1;
+  }
+  updatePowerPrepare();
+
   if (automaticPageTurnActive) {
     if (mappedInput.wasReleased(MappedInputManager::Button::Confirm) ||
         mappedInput.wasReleased(MappedInputManager::Button::Back)) {
@@ -158,11 +187,7 @@ void EpubReaderActivity::loop() {
   if (mappedInput.wasReleased(MappedInputManager::Button::Confirm)) {
     const int currentPage = section ? section->currentPage + 1 : 0;
     const int totalPages = section ? section->pageCount : 0;
-    float bookProgress = 0.0f;
-    if (epub->getBookSize() > 0 && section && section->pageCount > 0) {
-      const float chapterProgress = static_cast<float>(section->currentPage) / static_cast<float>(section->pageCount);
-      bookProgress = epub->calculateProgress(currentSpineIndex, chapterProgress) * 100.0f;
-    }
+    const float bookProgress = section ? getBookProgress(section->currentPage) : 0.0f;
     const int bookProgressPercent = clampPercent(static_cast<int>(bookProgress + 0.5f));
     startActivityForResult(std::make_unique<EpubReaderMenuActivity>(
                                renderer, mappedInput, epub->getTitle(), currentPage, totalPages, bookProgressPercent,
@@ -263,6 +288,20 @@ void EpubReaderActivity::jumpToPercent(int percent) {
   // Normalize input to 0-100 to avoid invalid jumps.
   percent = clampPercent(percent);
 
+  // With the whole book paginated, the percent maps straight to a page
+  {
+    RenderLock lock(*this);
+    int spineIndex, page;
+    if (pageMap.locate(static_cast<uint32_t>(static_cast<uint64_t>(pageMap.totalPages()) * percent / 100),
+                       spineIndex, page)) {
+      currentSpineIndex = spineIndex;
+      nextPageNumber = page;
+      pendingPercentJump = false;
+      section.reset();
+      return;
+    }
+  }
+
   // Convert percent into a byte-like absolute position across the spine sizes.
   // Use an overflow-safe computation: (bookSize / 100) * percent + (bookSize % 100) * percent / 100
   size_t targetSize =
@@ -340,11 +379,7 @@ void EpubReaderActivity::onReaderMenuConfirm(EpubReaderMenuActivity::MenuAction
       break;
     }
     case EpubReaderMenuActivity::MenuAction::GO_TO_PERCENT: {
-      float bookProgress = 0.0f;
-      if (epub && epub->getBookSize() > 0 && section && section->pageCount > 0) {
-        const float chapterProgress = static_cast<float>(section->currentPage) / static_cast<float>(section->pageCount);
-        bookProgress = epub->calculateProgress(currentSpineIndex, chapterProgress) * 100.0f;
-      }
+      const float bookProgress = section ? getBookProgress(section->currentPage) : 0.0f;
       const int initialPercent = clampPercent(static_cast<int>(bookProgress + 0.5f));
       startActivityForResult(
           std::make_unique<EpubReaderPercentSelectionActivity>(renderer, mappedInput, initialPercent),
@@ -357,7 +392,12 @@ void EpubReaderActivity::onReaderMenuConfirm(EpubReaderMenuActivity::MenuAction
     }
     case EpubReaderMenuActivity::MenuAction::DISPLAY_QR: {
       if (section && section->currentPage >= 0 && section->currentPage < section->pageCount) {
-        auto p = section->loadPageFromSectionFile();
+        std::unique_ptr<Page> p;
+        {
+          // The section file may be in use by a background build
+          RenderLock lock(*this);
+          p = section->loadPageFromSectionFile();
+        }
         if (p) {
           std::string fullText;
           for (const auto& el : p->elements) {
@@ -387,7 +427,15 @@ void EpubReaderActivity::onReaderMenuConfirm(EpubReaderMenuActivity::MenuAction
       onGoHome();
       return;
     }
+    case EpubReaderMenuActivity::MenuAction::PREPARE_BOOK: {
+      // A build that is already running is waited for by the activity rather than thrown away
+      startActivityForResult(std::make_unique<EpubPrepareBookActivity>(renderer, mappedInput, epub, pageMap),
+                             [this](const ActivityResult&) { requestUpdate(); });
+      break;
+    }
     case EpubReaderMenuActivity::MenuAction::DELETE_CACHE: {
+      // A background build keeps its section file open, so it has to be gone before the cache is
+      SectionPreIndexer::getInstance().cancel();
       {
         RenderLock lock(*this);
         if (epub && section) {
@@ -417,7 +465,7 @@ void EpubReaderActivity::onReaderMenuConfirm(EpubReaderMenuActivity::MenuAction
         const int totalPages = section ? section->pageCount : 0;
         startActivityForResult(
             std::make_unique<KOReaderSyncActivity>(renderer, mappedInput, epub, epub->getPath(), currentSpineIndex,
-                                                   currentPage, totalPages),
+                                                   currentPage, totalPages, &pageMap),
             [this](const ActivityResult& result) {
               if (!result.isCancelled) {
                 const auto& sync = std::get<SyncResult>(result.data);
@@ -446,7 +494,8 @@ void EpubReaderActivity::applyOrientation(const uint8_t orientation) {
     RenderLock lock(*this);
     if (section) {
       cachedSpineIndex = currentSpineIndex;
-      cachedChapterTotalPageCount = section->pageCount;
+      // A section still being indexed has no final page count to scale from, so keep the absolute page
+      cachedChapterTotalPageCount = section->isIndexing() ? 0 : section->pageCount;
       nextPageNumber = section->currentPage;
     }
 
@@ -480,7 +529,8 @@ void EpubReaderActivity::toggleAutoPageTurn(const uint8_t selectedPageTurnOption
     RenderLock lock(*this);
     if (section) {
       cachedSpineIndex = currentSpineIndex;
-      cachedChapterTotalPageCount = section->pageCount;
+      // A section still being indexed has no final page count to scale from, so keep the absolute page
+      cachedChapterTotalPageCount = section->isIndexing() ? 0 : section->pageCount;
       nextPageNumber = section->currentPage;
     }
     section.reset();
@@ -489,7 +539,11 @@ void EpubReaderActivity::toggleAutoPageTurn(const uint8_t selectedPageTurnOption
 
 void EpubReaderActivity::pageTurn(bool isForwardTurn) {
   if (isForwardTurn) {
-    if (section->currentPage < section->pageCount - 1) {
+    if (section->isIndexing()) {
+      // The next page may not be laid out yet, render() waits for it. Where the chapter ends is only known once
+      // it is fully indexed.
+      section->currentPage = std::min(section->currentPage + 1, static_cast<int>(section->pageCount));
+    } else if (section->currentPage < section->pageCount - 1) {
       section->currentPage++;
     } else {
       // We don't want to delete the section mid-render, so grab the semaphore
@@ -514,11 +568,14 @@ void EpubReaderActivity::pageTurn(bool isForwardTurn) {
     }
   }
   lastPageTurnTime = millis();
+  lastTurnForward = isForwardTurn;
+  turnStartTime = lastPageTurnTime;
   requestUpdate();
 }
 
 // TODO: Failure handling
 void EpubReaderActivity::render(RenderLock&& lock) {
+  PERF_SCOPE(ReaderRender);
   if (!epub) {
     return;
   }
@@ -561,24 +618,49 @@ void EpubReaderActivity::render(RenderLock&& lock) {
     orientedMarginBottom += std::max(SETTINGS.screenMargin, statusBarHeight);
   }
 
+  const uint16_t viewportWidth = renderer.getScreenWidth() - orientedMarginLeft - orientedMarginRight;
+  const uint16_t viewportHeight = renderer.getScreenHeight() - orientedMarginTop - orientedMarginBottom;
+  pageMap.open(epub->getCachePath(), epub->getSpineItemsCount(),
+               {SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(), SETTINGS.extraParagraphSpacing,
+                SETTINGS.paragraphAlignment, viewportWidth, viewportHeight, SETTINGS.hyphenationEnabled,
+                SETTINGS.embeddedStyle});
+
   if (!section) {
+    auto& indexer = SectionPreIndexer::getInstance();
+    if (indexer.isRunning()) {
+      // A build left over from an earlier section may still have a section file open, possibly the one about to be
+      // loaded. It requests another render once it has stopped.
+      indexer.requestCancelAndRender();
+      GUI.drawPopup(renderer, tr(STR_INDEXING));
+      return;
+    }
+
     const auto filepath = epub->getSpineItem(currentSpineIndex).href;
     LOG_DBG("ERS", "Loading file: %s, index: %d", filepath.c_str(), currentSpineIndex);
-    section = std::unique_ptr<Section>(new Section(epub, currentSpineIndex, renderer));
-
-    const uint16_t viewportWidth = renderer.getScreenWidth() - orientedMarginLeft - orientedMarginRight;
-    const uint16_t viewportHeight = renderer.getScreenHeight() - orientedMarginTop - orientedMarginBottom;
+    section = std::make_shared<Section>(epub, currentSpineIndex, renderer);
+    preIndexedSpineIndex = -1;
 
     if (!section->loadSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
                                   SETTINGS.extraParagraphSpacing, SETTINGS.paragraphAlignment, viewportWidth,
                                   viewportHeight, SETTINGS.hyphenationEnabled, SETTINGS.embeddedStyle)) {
       LOG_DBG("ERS", "Cache not found, building...");
 
+      // Opening at a known page, the chapter can be shown as soon as that page is laid out. The last page, a percent
+      // jump or a position carried over from another layout need the final page count, so they wait for it.
+      const bool knownStartPage = nextPageNumber != UINT16_MAX && !pendingPercentJump &&
+                                  !(cachedChapterTotalPageCount > 0 && currentSpineIndex == cachedSpineIndex);
       const auto popupFn = [this]() { GUI.drawPopup(renderer, tr(STR_INDEXING)); };
 
-      if (!section->createSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
-                                      SETTINGS.extraParagraphSpacing, SETTINGS.paragraphAlignment, viewportWidth,
-                                      viewportHeight, SETTINGS.hyphenationEnabled, SETTINGS.embeddedStyle, popupFn)) {
+      if (knownStartPage &&
+          indexer.startProgressive(section, currentSpineIndex, renderer, SETTINGS.getReaderFontId(),
+                                   SETTINGS.getReaderLineCompression(), SETTINGS.extraParagraphSpacing,
+                                   SETTINGS.paragraphAlignment, viewportWidth, viewportHeight,
+                                   SETTINGS.hyphenationEnabled, SETTINGS.embeddedStyle)) {
+        progressiveBuildStart = millis();
+      } else if (!section->createSectionFile(SETTINGS.getReaderFontId(), SETTINGS.getReaderLineCompression(),
+                                             SETTINGS.extraParagraphSpacing, SETTINGS.paragraphAlignment,
+                                             viewportWidth, viewportHeight, SETTINGS.hyphenationEnabled,
+                                             SETTINGS.embeddedStyle, popupFn)) {
         LOG_ERR("ERS", "Failed to persist page data to SD");
         section.reset();
         return;
@@ -615,6 +697,16 @@ void EpubReaderActivity::render(RenderLock&& lock) {
     }
   }
 
+  if (section->isIndexing() && section->currentPage >= section->pageCount) {
+    // The build requests a render once this page is committed
+    GUI.drawPopup(renderer, tr(STR_INDEXING));
+    return;
+  }
+  // A failed build also ends up with no pages, so empty chapters are left to the background builds to record
+  if (!section->isIndexing() && section->pageCount > 0) {
+    recordPageCount(currentSpineIndex, section->pageCount);
+  }
+
   renderer.clearScreen();
 
   if (section->pageCount == 0) {
@@ -636,7 +728,10 @@ void EpubReaderActivity::render(RenderLock&& lock) {
   }
 
   {
-    auto p = section->loadPageFromSectionFile();
+    bool cacheHit = false;
+    const uint32_t loadStart = perf::nowUs();
+    const Page* p = section->getCurrentPage(cacheHit);
+    perf::record(perf::Phase::PageLoad, perf::nowUs() - loadStart);
     if (!p) {
       LOG_ERR("ERS", "Failed to load page from SD - clearing section cache");
       section->clearCache();
@@ -646,16 +741,46 @@ void EpubReaderActivity::render(RenderLock&& lock) {
       automaticPageTurnActive = false;
       return;
     }
+    pageCacheLookups++;
+    pageCacheHits += cacheHit ? 1 : 0;
 
-    // Collect footnotes from the loaded page
-    currentPageFootnotes = std::move(p->footnotes);
+    // Collect footnotes from the loaded page (copied, the page stays cached)
+    currentPageFootnotes = p->footnotes;
+
+    const auto start = millis();
+    renderContents(*p, orientedMarginTop, orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
+    LOG_DBG("ERS", "Rendered page in %dms (heap %u free, %u largest block)", millis() - start, ESP.getFreeHeap(),
+            ESP.getMaxAllocHeap());
+    if (progressiveBuildStart != 0) {
+      LOG_DBG("ERS", "First page shown %lums into indexing", millis() - progressiveBuildStart);
+      progressiveBuildStart = 0;
+    }
+    if (ESP.getFreeHeap() < FONT_CACHE_MIN_FREE_HEAP) {
+      renderer.clearFontCache();
+    }
+  }
+  // The page count is only saved once final, so a resume does not scale the position by a partial count
+  saveProgress(currentSpineIndex, section->currentPage, section->isIndexing() ? 0 : section->pageCount);
 
+  // Load the neighbouring pages while the reader looks at this one, unless that would squeeze the heap
+  if (ESP.getFreeHeap() >= PREFETCH_MIN_FREE_HEAP) {
     const auto start = millis();
-    renderContents(std::move(p), orientedMarginTop, orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
-    LOG_DBG("ERS", "Rendered page in %dms", millis() - start);
-    renderer.clearFontCache();
+    section->prefetchAdjacentPages(lastTurnForward);
+    LOG_DBG("ERS", "Prefetched adjacent pages in %dms", millis() - start);
+  }
+
+  // Near the end of the chapter, lay out the next one while this page is being read. The build waits for the
+  // render lock, so it starts once this render is done.
+  const int nextSpineIndex = currentSpineIndex + 1;
+  if (section->currentPage + PREINDEX_LAST_PAGES >= section->pageCount &&
+      nextSpineIndex < epub->getSpineItemsCount() && preIndexedSpineIndex != nextSpineIndex) {
+    if (SectionPreIndexer::getInstance().start(epub, nextSpineIndex, renderer, SETTINGS.getReaderFontId(),
+                                               SETTINGS.getReaderLineCompression(), SETTINGS.extraParagraphSpacing,
+                                               SETTINGS.paragraphAlignment, viewportWidth, viewportHeight,
+                                               SETTINGS.hyphenationEnabled, SETTINGS.embeddedStyle)) {
+      preIndexedSpineIndex = nextSpineIndex;
+    }
   }
-  saveProgress(currentSpineIndex, section->currentPage, section->pageCount);
 
   if (pendingScreenshot) {
     pendingScreenshot = false;
@@ -663,6 +788,68 @@ void EpubReaderActivity::render(RenderLock&& lock) {
   }
 }
 
+float EpubReaderActivity::getBookProgress(const float chapterPage) const {
+  if (pageMap.isComplete() && pageMap.totalPages() > 0) {
+    return (pageMap.bookPage(currentSpineIndex, 0) + chapterPage) * 100.0f / pageMap.totalPages();
+  }
+  if (epub->getBookSize() == 0 || section->pageCount == 0) {
+    return 0.0f;
+  }
+  return epub->calculateProgress(currentSpineIndex, chapterPage / section->pageCount) * 100.0f;
+}
+
+void EpubReaderActivity::recordPageCount(const int spineIndex, const uint16_t pageCount) {
+  if (pageMap.setPageCount(spineIndex, pageCount)) {
+    pageMap.save();
+    if (pageMap.isComplete()) {
+      LOG_DBG("ERS", "Book paginated: %u pages in %u spine items", pageMap.totalPages(), pageMap.spineCount());
+    }
+  }
+}
+
+void EpubReaderActivity::updatePowerPrepare() {
+  auto& preIndexer = SectionPreIndexer::getInstance();
+  int builtSpineIndex;
+  uint16_t builtPageCount;
+  if (preIndexer.takeResult(builtSpineIndex, builtPageCount)) {
+    RenderLock lock(*this);
+    recordPageCount(builtSpineIndex, builtPageCount);
+  }
+  if (preIndexer.isRunning()) {
+    return;
+  }
+  // The render task reopens the page map and replaces the section; while it holds them, try again next loop
+  if (RenderLock::peek()) {
+    return;
+  }
+  RenderLock lock(*this);
+  if (powerPrepareSpineIndex >= 0) {
+    // Done without a page count, so the chapter does not build; move past it
+    if (pageMap.pageCount(powerPrepareSpineIndex) == BookPageMap::UNKNOWN) {
+      powerPrepareFrom = powerPrepareSpineIndex + 1;
+    }
+    powerPrepareSpineIndex = -1;
+  }
+
+  // Charging and left alone for a while: lay out the next chapter the page map is missing
+  if (!mappedInput.isUsbConnected() || !pageMap.isOpen() || pageMap.isComplete() || !section ||
+      section->isIndexing() || millis() - lastPageTurnTime < POWER_PREPARE_IDLE_MS) {
+    return;
+  }
+  const int spineIndex = pageMap.nextMissing(powerPrepareFrom);
+  if (spineIndex < 0) {
+    return;
+  }
+  const auto& layout = pageMap.getLayout();
+  if (preIndexer.start(epub, spineIndex, renderer, layout.fontId, layout.lineCompression,
+                      layout.extraParagraphSpacing, layout.paragraphAlignment, layout.viewportWidth,
+                      layout.viewportHeight, layout.hyphenationEnabled, layout.embeddedStyle)) {
+    LOG_DBG("ERS", "On USB power, indexing section %d for the page map (%u left)", spineIndex,
+            pageMap.missingCount());
+    powerPrepareSpineIndex = spineIndex;
+  }
+}
+
 void EpubReaderActivity::saveProgress(int spineIndex, int currentPage, int pageCount) {
   FsFile f;
   if (Storage.openFileForWrite("ERS", epub->getCachePath() + "/progress.bin", f)) {
@@ -680,14 +867,35 @@ void EpubReaderActivity::saveProgress(int spineIndex, int currentPage, int pageC
     LOG_ERR("ERS", "Could not save progress!");
   }
 }
-void EpubReaderActivity::renderContents(std::unique_ptr<Page> page, const int orientedMarginTop,
-                                        const int orientedMarginRight, const int orientedMarginBottom,
-                                        const int orientedMarginLeft) {
+void EpubReaderActivity::renderContents(const Page& page, const int orientedMarginTop, const int orientedMarginRight,
+                                        const int orientedMarginBottom, const int orientedMarginLeft) {
   // Force special handling for pages with images when anti-aliasing is on
-  bool imagePageWithAA = page->hasImages() && SETTINGS.textAntiAliasing;
+  bool imagePageWithAA = page.hasImages() && SETTINGS.textAntiAliasing;
+  // Anti-aliased text pages are drawn once, capturing the grayscale planes along with the BW frame. The status bar
+  // goes first, as the capture stores the frame.
+  const bool singlePassAA = SETTINGS.textAntiAliasing && !imagePageWithAA;
+  const unsigned long turnStart = turnStartTime;
 
-  page->render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
-  renderStatusBar();
+  if (singlePassAA) {
+    renderStatusBar();
+  }
+  bool grayscaleCaptured = false;
+  {
+    PERF_SCOPE(PageDraw);
+    grayscaleCaptured = singlePassAA && renderer.beginGrayscaleCapture();
+    page.render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
+    if (grayscaleCaptured) {
+      grayscaleCaptured = renderer.endGrayscaleCapture();
+    }
+  }
+  if (!singlePassAA) {
+    renderStatusBar();
+  }
+  if (turnStartTime != 0) {
+    LOG_DBG("ERS", "Page turn to frame in %lums (page cache %u/%u hits)", millis() - turnStartTime, pageCacheHits,
+            pageCacheLookups);
+    turnStartTime = 0;
+  }
   if (imagePageWithAA) {
     // Double FAST_REFRESH with selective image blanking (pablohc's technique):
     // HALF_REFRESH sets particles too firmly for the grayscale LUT to adjust.
@@ -695,12 +903,12 @@ void EpubReaderActivity::renderContents(std::unique_ptr<Page> page, const int or
     // Step 1: Display page with image area blanked (text appears, image area white)
     // Step 2: Re-render with images and display again (images appear clean)
     int16_t imgX, imgY, imgW, imgH;
-    if (page->getImageBoundingBox(imgX, imgY, imgW, imgH)) {
+    if (page.getImageBoundingBox(imgX, imgY, imgW, imgH)) {
       renderer.fillRect(imgX + orientedMarginLeft, imgY + orientedMarginTop, imgW, imgH, false);
       renderer.displayBuffer(HalDisplay::FAST_REFRESH);
 
       // Re-render page content to restore images into the blanked area
-      page->render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
+      page.render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
       renderStatusBar();
       renderer.displayBuffer(HalDisplay::FAST_REFRESH);
     } else {
@@ -715,26 +923,41 @@ void EpubReaderActivity::renderContents(std::unique_ptr<Page> page, const int or
     pagesUntilFullRefresh--;
   }
 
+  if (grayscaleCaptured) {
+    {
+      PERF_SCOPE(Grayscale);
+      renderer.displayCapturedGrayscale();
+    }
+    if (turnStart != 0) {
+      LOG_DBG("ERS", "Page turn to grayscale in %lums", millis() - turnStart);
+    }
+    return;
+  }
+
   // Save bw buffer to reset buffer state after grayscale data sync
   renderer.storeBwBuffer();
 
   // grayscale rendering
   // TODO: Only do this if font supports it
   if (SETTINGS.textAntiAliasing) {
+    PERF_SCOPE(Grayscale);
     renderer.clearScreen(0x00);
     renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
-    page->render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
+    page.render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
     renderer.copyGrayscaleLsbBuffers();
 
     // Render and copy to MSB buffer
     renderer.clearScreen(0x00);
     renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
-    page->render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
+    page.render(renderer, SETTINGS.getReaderFontId(), orientedMarginLeft, orientedMarginTop);
     renderer.copyGrayscaleMsbBuffers();
 
     // display grayscale part
     renderer.displayGrayBuffer();
     renderer.setRenderMode(GfxRenderer::BW);
+    if (turnStart != 0) {
+      LOG_DBG("ERS", "Page turn to grayscale in %lums", millis() - turnStart);
+    }
   }
 
   // restore the bw data
@@ -745,8 +968,8 @@ void EpubReaderActivity::renderStatusBar() const {
   // Calculate progress in book
   const int currentPage = section->currentPage + 1;
   const float pageCount = section->pageCount;
-  const float sectionChapterProg = (pageCount > 0) ? (static_cast<float>(currentPage) / pageCount) : 0;
-  const float bookProgress = epub->calculateProgress(currentSpineIndex, sectionChapterProg) * 100;
+  const float bookProgress = getBookProgress(currentPage);
+  const bool bookPaginated = pageMap.isComplete();
 
   std::string title;
 
@@ -775,7 +998,9 @@ void EpubReaderActivity::renderStatusBar() const {
     title = epub->getTitle();
   }
 
-  GUI.drawStatusBar(renderer, bookProgress, currentPage, pageCount, title, 0, textYOffset);
+  GUI.drawStatusBar(renderer, bookProgress, currentPage, pageCount, title, 0, textYOffset,
+                    bookPaginated ? pageMap.bookPage(currentSpineIndex, currentPage) : 0,
+                    bookPaginated ? pageMap.totalPages() : 0);
 }
 
 void EpubReaderActivity::navigateToHref(const std::string& hrefStr, const bool savePosition) {
@@ -1,5 +1,6 @@
 #pragma once
 #include <Epub.h>
+#include <Epub/BookPageMap.h>
 #include <Epub/FootnoteEntry.h>
 #include <Epub/Section.h>
 
@@ -8,7 +9,8 @@
 
 class EpubReaderActivity final : public Activity {
   std::shared_ptr<Epub> epub;
-  std::unique_ptr<Section> section = nullptr;
+  // Shared with SectionPreIndexer while the section is indexed progressively
+  std::shared_ptr<Section> section = nullptr;
   int currentSpineIndex = 0;
   int nextPageNumber = 0;
   int pagesUntilFullRefresh = 0;
@@ -24,6 +26,22 @@ class EpubReaderActivity final : public Activity {
   bool pendingScreenshot = false;
   bool skipNextButtonCheck = false;  // Skip button processing for one frame after subactivity exit
   bool automaticPageTurnActive = false;
+  // Page cache instrumentation: prefetch follows the last turn direction, and the time from a turn to its frame
+  // being ready is logged with the running hit rate
+  bool lastTurnForward = true;
+  unsigned long turnStartTime = 0UL;
+  uint32_t pageCacheHits = 0;
+  uint32_t pageCacheLookups = 0;
+  // Spine item handed to the background pre-indexer for the current section, -1 if none yet
+  int preIndexedSpineIndex = -1;
+  // Start of a progressive build of the current section, until its first page has been shown
+  unsigned long progressiveBuildStart = 0UL;
+  // Page count of every chapter for the current layout, for whole-book page numbers. Opened by render().
+  BookPageMap pageMap;
+  // On USB power the rest of the book is indexed in the background: the spine item being built (-1 if none) and
+  // where the search for the next one resumes, so a chapter that fails to build is not retried over and over
+  int powerPrepareSpineIndex = -1;
+  int powerPrepareFrom = 0;
 
   // Footnote support
   std::vector<FootnoteEntry> currentPageFootnotes;
@@ -35,10 +53,15 @@ class EpubReaderActivity final : public Activity {
   SavedPosition savedPositions[MAX_FOOTNOTE_DEPTH] = {};
   int footnoteDepth = 0;
 
-  void renderContents(std::unique_ptr<Page> page, int orientedMarginTop, int orientedMarginRight,
+  void renderContents(const Page& page, int orientedMarginTop, int orientedMarginRight,
                       int orientedMarginBottom, int orientedMarginLeft);
   void renderStatusBar() const;
   void saveProgress(int spineIndex, int currentPage, int pageCount);
+  // Book progress (0-100) at chapterPage of the current section: exact once the whole book is paginated,
+  // estimated from spine item sizes before that
+  float getBookProgress(float chapterPage) const;
+  void recordPageCount(int spineIndex, uint16_t pageCount);
+  void updatePowerPrepare();
   // Jump to a percentage of the book (0-100), mapping it to spine and page.
   void jumpToPercent(int percent);
   void onReaderMenuConfirm(EpubReaderMenuActivity::MenuAction action);
@@ -58,4 +81,5 @@ class EpubReaderActivity final : public Activity {
   void loop() override;
   void render(RenderLock&& lock) override;
   bool isReaderActivity() const override { return true; }
+  bool preventAutoSleep() override;
 };
@@ -21,6 +21,7 @@ class EpubReaderMenuActivity final : public Activity {
     DISPLAY_QR,
     GO_HOME,
     SYNC,
+    PREPARE_BOOK,
     DELETE_CACHE
   };
 
@@ -22,13 +22,14 @@ class KOReaderSyncActivity final : public Activity {
  public:
   explicit KOReaderSyncActivity(GfxRenderer& renderer, MappedInputManager& mappedInput,
                                 const std::shared_ptr<Epub>& epub, const std::string& epubPath, int currentSpineIndex,
-                                int currentPage, int totalPagesInSpine)
+                                int currentPage, int totalPagesInSpine, const BookPageMap* pageMap = nullptr)
       : Activity("KOReaderSync", renderer, mappedInput),
         epub(epub),
         epubPath(epubPath),
         currentSpineIndex(currentSpineIndex),
         currentPage(currentPage),
         totalPagesInSpine(totalPagesInSpine),
+        pageMap(pageMap),
         remoteProgress{},
         remotePosition{},
         localProgress{} {}
@@ -57,6 +58,7 @@ class KOReaderSyncActivity final : public Activity {
   int currentSpineIndex;
   int currentPage;
   int totalPagesInSpine;
+  const BookPageMap* pageMap;  // Owned by the reader, which outlives this activity
 
   State state = WIFI_SELECTION;
   std::string statusMessage;
@@ -0,0 +1,164 @@
+#include "SectionPreIndexer.h"
+
+#include <Arduino.h>
+#include <Epub/Section.h>
+#include <Logging.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <optional>
+
+#include "activities/ActivityManager.h"
+#include "activities/RenderLock.h"
+
+namespace {
+// A chapter build peaks at the inflate window, expat and a paragraph of layout, plus the task stack
+constexpr uint32_t MIN_FREE_HEAP = 80 * 1024;
+constexpr uint32_t TASK_STACK_SIZE = 8192;  // Same as the render task, which runs foreground builds
+// Below the main loop and render tasks (1), so the build only runs while both are idle
+constexpr UBaseType_t TASK_PRIORITY = 0;
+}  // namespace
+
+SectionPreIndexer SectionPreIndexer::instance;
+
+bool SectionPreIndexer::start(const std::shared_ptr<Epub>& epub, const int spineIndex, GfxRenderer& renderer,
+                              const int fontId, const float lineCompression, const bool extraParagraphSpacing,
+                              const uint8_t paragraphAlignment, const uint16_t viewportWidth,
+                              const uint16_t viewportHeight, const bool hyphenationEnabled, const bool embeddedStyle) {
+  if (running) {
+    return false;
+  }
+  this->epub = epub;
+  progressive = false;
+  return launch(spineIndex, renderer, fontId, lineCompression, extraParagraphSpacing, paragraphAlignment,
+                viewportWidth, viewportHeight, hyphenationEnabled, embeddedStyle);
+}
+
+bool SectionPreIndexer::startProgressive(const std::shared_ptr<Section>& section, const int spineIndex,
+                                         GfxRenderer& renderer, const int fontId, const float lineCompression,
+                                         const bool extraParagraphSpacing, const uint8_t paragraphAlignment,
+                                         const uint16_t viewportWidth, const uint16_t viewportHeight,
+                                         const bool hyphenationEnabled, const bool embeddedStyle) {
+  if (running) {
+    return false;
+  }
+  this->section = section;
+  progressive = true;
+  return launch(spineIndex, renderer, fontId, lineCompression, extraParagraphSpacing, paragraphAlignment,
+                viewportWidth, viewportHeight, hyphenationEnabled, embeddedStyle);
+}
+
+bool SectionPreIndexer::launch(const int spineIndex, GfxRenderer& renderer, const int fontId,
+                               const float lineCompression, const bool extraParagraphSpacing,
+                               const uint8_t paragraphAlignment, const uint16_t viewportWidth,
+                               const uint16_t viewportHeight, const bool hyphenationEnabled, const bool embeddedStyle) {
+  if (ESP.getFreeHeap() < MIN_FREE_HEAP) {
+    LOG_DBG("PRE", "Not indexing section %d in the background, %u bytes free", spineIndex, ESP.getFreeHeap());
+    epub.reset();
+    section.reset();
+    return false;
+  }
+
+  this->renderer = &renderer;
+  this->spineIndex = spineIndex;
+  resultSpineIndex = spineIndex;
+  this->fontId = fontId;
+  this->lineCompression = lineCompression;
+  this->extraParagraphSpacing = extraParagraphSpacing;
+  this->paragraphAlignment = paragraphAlignment;
+  this->viewportWidth = viewportWidth;
+  this->viewportHeight = viewportHeight;
+  this->hyphenationEnabled = hyphenationEnabled;
+  this->embeddedStyle = embeddedStyle;
+  cancelRequested = false;
+  renderWhenDone = false;
+  resultReady = false;
+  running = true;
+
+  if (xTaskCreate(&taskTrampoline, "SectionPreIndex", TASK_STACK_SIZE, this, TASK_PRIORITY, nullptr) != pdPASS) {
+    LOG_ERR("PRE", "Failed to create pre-index task");
+    epub.reset();
+    section.reset();
+    running = false;
+    return false;
+  }
+  return true;
+}
+
+bool SectionPreIndexer::takeResult(int& spineIndex, uint16_t& pageCount) {
+  if (running || !resultReady) {
+    return false;
+  }
+  resultReady = false;
+  spineIndex = resultSpineIndex;
+  pageCount = resultPageCount;
+  return true;
+}
+
+void SectionPreIndexer::cancel() {
+  cancelRequested = true;
+  while (running) {
+    delay(5);
+  }
+}
+
+void SectionPreIndexer::taskTrampoline(void* param) {
+  static_cast<SectionPreIndexer*>(param)->build();
+  vTaskDelete(nullptr);
+}
+
+void SectionPreIndexer::build() {
+  const auto start = millis();
+  std::optional<RenderLock> lock(std::in_place);
+  bool built = false;
+  if (!cancelRequested) {
+    auto target = section ? section : std::make_shared<Section>(epub, spineIndex, *renderer);
+    if (!section && target->loadSectionFile(fontId, lineCompression, extraParagraphSpacing, paragraphAlignment,
+                                            viewportWidth, viewportHeight, hyphenationEnabled, embeddedStyle)) {
+      LOG_DBG("PRE", "Section %d is already indexed", spineIndex);
+      resultPageCount = target->pageCount;
+      resultReady = true;
+    } else {
+      uint16_t committed = 0;
+      // Hand the lock back between chunks; a waiting render or loop task outranks this one and runs straight away
+      const auto checkpoint = [this, &lock, &committed] {
+        // The reader is waiting on the page just committed
+        if (section && committed <= section->currentPage && section->currentPage < section->pageCount) {
+          activityManager.requestUpdate(true);
+        }
+        committed = section ? section->pageCount : 0;
+        lock.reset();
+        taskYIELD();
+        lock.emplace();
+        return !cancelRequested;
+      };
+      built = target->createSectionFile(fontId, lineCompression, extraParagraphSpacing, paragraphAlignment,
+                                        viewportWidth, viewportHeight, hyphenationEnabled, embeddedStyle, nullptr,
+                                        checkpoint);
+      if (built) {
+        resultPageCount = target->pageCount;
+        resultReady = true;
+      }
+      if (section && built && !cancelRequested) {
+        // A turn past the last committed page may have gone past the end of the chapter
+        if (section->currentPage >= section->pageCount && section->pageCount > 0) {
+          section->currentPage = section->pageCount - 1;
+        }
+        activityManager.requestUpdate(true);
+      }
+    }
+  }
+  section.reset();
+  epub.reset();
+  lock.reset();
+
+  if (built) {
+    LOG_DBG("PRE", "Indexed section %d in the background in %lums", spineIndex, millis() - start);
+  } else if (cancelRequested) {
+    LOG_DBG("PRE", "Background indexing of section %d cancelled", spineIndex);
+  }
+  running = false;
+  if (renderWhenDone) {
+    activityManager.requestUpdate(true);
+  }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <Epub.h>
+
+#include <atomic>
+#include <memory>
+
+class GfxRenderer;
+class Section;
+
+// Lays out a spine item into its section file on a low-priority task, so the next chapter can be indexed while the
+// reader is still on the last pages of the current one. A progressive build does the same for the section being
+// read, which shows its pages as they are committed instead of waiting for the whole chapter.
+//
+// The build only touches the SD card, the EPUB and the renderer's font metrics while it holds RenderLock. It takes
+// the lock per parser chunk and gives it back in between, so a page render waits for at most one chunk. A stopped
+// build removes its partial section file, the same as a failed foreground build.
+class SectionPreIndexer {
+  static SectionPreIndexer instance;
+
+  std::atomic<bool> running{false};
+  std::atomic<bool> cancelRequested{false};
+  std::atomic<bool> progressive{false};
+  std::atomic<bool> renderWhenDone{false};
+  // Page count of the last section that finished building (or was found already built)
+  std::atomic<bool> resultReady{false};
+  int resultSpineIndex = 0;
+  uint16_t resultPageCount = 0;
+
+  // Build parameters, only touched by the task while it runs
+  std::shared_ptr<Epub> epub;
+  std::shared_ptr<Section> section;  // Progressive builds only
+  GfxRenderer* renderer = nullptr;
+  int spineIndex = 0;
+  int fontId = 0;
+  float lineCompression = 0;
+  bool extraParagraphSpacing = false;
+  uint8_t paragraphAlignment = 0;
+  uint16_t viewportWidth = 0;
+  uint16_t viewportHeight = 0;
+  bool hyphenationEnabled = false;
+  bool embeddedStyle = false;
+
+  bool launch(int spineIndex, GfxRenderer& renderer, int fontId, float lineCompression, bool extraParagraphSpacing,
+              uint8_t paragraphAlignment, uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled,
+              bool embeddedStyle);
+  static void taskTrampoline(void* param);
+  void build();
+
+ public:
+  static SectionPreIndexer& getInstance() { return instance; }
+
+  // Start indexing spineIndex unless a build is still running or the heap is short. A section file that already
+  // matches the layout parameters is kept. Safe to call with RenderLock held; the build starts once it is released.
+  bool start(const std::shared_ptr<Epub>& epub, int spineIndex, GfxRenderer& renderer, int fontId,
+             float lineCompression, bool extraParagraphSpacing, uint8_t paragraphAlignment, uint16_t viewportWidth,
+             uint16_t viewportHeight, bool hyphenationEnabled, bool embeddedStyle);
+  // Finish laying out section, whose file could not be loaded, in the background. Its pages become readable as they
+  // are committed; the task requests a render once the page the reader is on is ready, and again when the build
+  // ends so the page count can be redrawn. Same preconditions as start().
+  bool startProgressive(const std::shared_ptr<Section>& section, int spineIndex, GfxRenderer& renderer, int fontId,
+                        float lineCompression, bool extraParagraphSpacing, uint8_t paragraphAlignment,
+                        uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled, bool embeddedStyle);
+  // Stop the build at its next chunk without waiting, for callers that hold RenderLock
+  void requestCancel() { cancelRequested = true; }
+  // requestCancel(), then request a render once the build has let go of its section file
+  void requestCancelAndRender() {
+    renderWhenDone = true;
+    cancelRequested = true;
+  }
+  // Stop the build and wait until it has cleaned up. Must not be called with RenderLock held.
+  void cancel();
+  bool isRunning() const { return running; }
+  bool isProgressive() const { return running && progressive; }
+  // Hand over the page count of the last completed build, once. For recording it in the book's page map.
+  bool takeResult(int& spineIndex, uint16_t& pageCount);
+};
@@ -20,6 +20,8 @@ constexpr size_t CHUNK_SIZE = 8 * 1024;  // 8KB chunk for reading
 // Cache file magic and version
 constexpr uint32_t CACHE_MAGIC = 0x54585449;  // "TXTI"
 constexpr uint8_t CACHE_VERSION = 2;          // Increment when cache format changes
+// Decompressed glyph groups are kept from page to page unless the free heap drops below this
+constexpr uint32_t FONT_CACHE_MIN_FREE_HEAP = 32 * 1024;
 }  // namespace
 
 void TxtReaderActivity::onEnter() {
@@ -71,6 +73,7 @@ void TxtReaderActivity::onExit() {
   APP_STATE.readerActivityLoadCount = 0;
   APP_STATE.saveToFile();
   txt.reset();
+  renderer.clearFontCache();
 }
 
 void TxtReaderActivity::loop() {
@@ -349,7 +352,9 @@ void TxtReaderActivity::render(RenderLock&&) {
 
   renderer.clearScreen();
   renderPage();
-  renderer.clearFontCache();
+  if (ESP.getFreeHeap() < FONT_CACHE_MIN_FREE_HEAP) {
+    renderer.clearFontCache();
+  }
 
   // Save progress
   saveProgress();
@@ -394,9 +399,14 @@ void TxtReaderActivity::renderPage() {
     }
   };
 
-  // First pass: BW rendering
-  renderLines();
+  // With anti-aliasing, a single pass also captures the grayscale planes; the status bar goes first, as the capture
+  // stores the frame
   renderStatusBar();
+  bool grayscaleCaptured = SETTINGS.textAntiAliasing && renderer.beginGrayscaleCapture();
+  renderLines();
+  if (grayscaleCaptured) {
+    grayscaleCaptured = renderer.endGrayscaleCapture();
+  }
 
   if (pagesUntilFullRefresh <= 1) {
     renderer.displayBuffer(HalDisplay::HALF_REFRESH);
@@ -406,26 +416,9 @@ void TxtReaderActivity::renderPage() {
     pagesUntilFullRefresh--;
   }
 
-  // Grayscale rendering pass (for anti-aliased fonts)
-  if (SETTINGS.textAntiAliasing) {
-    // Save BW buffer for restoration after grayscale pass
-    renderer.storeBwBuffer();
-
-    renderer.clearScreen(0x00);
-    renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
-    renderLines();
-    renderer.copyGrayscaleLsbBuffers();
-
-    renderer.clearScreen(0x00);
-    renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
-    renderLines();
-    renderer.copyGrayscaleMsbBuffers();
-
-    renderer.displayGrayBuffer();
-    renderer.setRenderMode(GfxRenderer::BW);
-
-    // Restore BW buffer
-    renderer.restoreBwBuffer();
+  // Short of memory, the page goes without its grayscale layer
+  if (grayscaleCaptured) {
+    renderer.displayCapturedGrayscale();
   }
 }
 
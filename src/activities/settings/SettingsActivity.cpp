@@ -2,6 +2,7 @@
 
 #include <GfxRenderer.h>
 #include <Logging.h>
+#include <PerfTrace.h>
 
 #include "ButtonRemapActivity.h"
 #include "CalibreSettingsActivity.h"
@@ -200,6 +201,7 @@ void SettingsActivity::toggleCurrentSetting() {
 }
 
 void SettingsActivity::render(RenderLock&&) {
+  const uint32_t drawStart = perf::nowUs();
   renderer.clearScreen();
 
   const auto pageWidth = renderer.getScreenWidth();
@@ -245,6 +247,7 @@ void SettingsActivity::render(RenderLock&&) {
   // Draw help text
   const auto labels = mappedInput.mapLabels(tr(STR_BACK), tr(STR_TOGGLE), tr(STR_DIR_UP), tr(STR_DIR_DOWN));
   GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
+  perf::record(perf::Phase::MenuDraw, perf::nowUs() - drawStart);
 
   // Always use standard refresh for settings screen
   renderer.displayBuffer();
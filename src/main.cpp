@@ -6,10 +6,13 @@
 #include <HalGPIO.h>
 #include <HalPowerManager.h>
 #include <HalStorage.h>
+#include <HeapTrace.h>
 #include <I18n.h>
 #include <Logging.h>
 #include <SPI.h>
+#include <SdTrace.h>
 #include <builtinFonts/all.h>
+#include <esp_heap_caps.h>
 
 #include <cstring>
 
@@ -192,6 +195,14 @@ void enterDeepSleep() {
   powerManager.startDeepSleep(gpio);
 }
 
+#ifdef ENABLE_HEAP_TRACE
+// Runs in the failing allocation's context, so only log: the report shows which subsystems were growing the heap
+void onAllocFailed(const size_t size, const uint32_t caps, const char* functionName) {
+  LOG_ERR("MEM", "%s failed to allocate %u bytes (caps 0x%x)", functionName, size, caps);
+  perf::logHeapReport("allocation failed");
+}
+#endif
+
 void setupDisplayAndFonts() {
   display.begin();
   renderer.begin();
@@ -240,6 +251,10 @@ void setup() {
     }
   }
 
+#ifdef ENABLE_HEAP_TRACE
+  heap_caps_register_failed_alloc_callback(onAllocFailed);
+#endif
+
   // SD Card Initialization
   // We need 6 open files concurrently when parsing a new chapter
   if (!Storage.begin()) {
@@ -328,6 +343,17 @@ void loop() {
         uint8_t* buf = display.getFrameBuffer();
         logSerial.write(buf, HalDisplay::BUFFER_SIZE);
         logSerial.printf("SCREENSHOT_END\n");
+      } else if (cmd == "HEAP") {
+        perf::logHeapReport("requested");
+#ifdef ENABLE_SD_TRACE
+      } else if (cmd == "SDTRACE_START") {
+        // The render lock keeps the trace file's own card access clear of a render or background build
+        RenderLock lock;
+        perf::sdTraceStart("/.crosspoint/sdtrace.bin");
+      } else if (cmd == "SDTRACE_STOP") {
+        RenderLock lock;
+        perf::sdTraceStop();
+#endif
       }
     }
   }
@@ -4,7 +4,9 @@
 #include <Epub.h>
 #include <FsHelpers.h>
 #include <HalStorage.h>
+#include <HeapTrace.h>
 #include <Logging.h>
+#include <PerfTrace.h>
 #include <WiFi.h>
 #include <esp_task_wdt.h>
 
@@ -90,6 +92,7 @@ CrossPointWebServer::CrossPointWebServer() {}
 CrossPointWebServer::~CrossPointWebServer() { stop(); }
 
 void CrossPointWebServer::begin() {
+  HEAP_SCOPE(WebServer);
   if (running) {
     LOG_DBG("WEB", "Web server already running");
     return;
@@ -134,6 +137,7 @@ void CrossPointWebServer::begin() {
   server->on("/files", HTTP_GET, [this] { handleFileList(); });
 
   server->on("/api/status", HTTP_GET, [this] { handleStatus(); });
+  server->on("/api/perf", HTTP_GET, [this] { handlePerf(); });
   server->on("/api/files", HTTP_GET, [this] { handleFileListData(); });
   server->on("/download", HTTP_GET, [this] { handleDownload(); });
 
@@ -190,6 +194,7 @@ void CrossPointWebServer::begin() {
 }
 
 void CrossPointWebServer::stop() {
+  HEAP_SCOPE(WebServer);
   if (!running || !server) {
     LOG_DBG("WEB", "stop() called but already stopped (running=%d, server=%p)", running, server.get());
     return;
@@ -239,6 +244,7 @@ void CrossPointWebServer::stop() {
 }
 
 void CrossPointWebServer::handleClient() {
+  HEAP_SCOPE(WebServer);
   static unsigned long lastDebugPrint = 0;
 
   // Check running flag FIRST before accessing server
@@ -333,6 +339,53 @@ void CrossPointWebServer::handleStatus() const {
   server->send(200, "application/json", json);
 }
 
+void CrossPointWebServer::handlePerf() const {
+  JsonDocument doc;
+  doc["uptime"] = millis() / 1000;
+  doc["window"] = perf::SAMPLES_PER_PHASE;
+  JsonObject phases = doc["phases"].to<JsonObject>();
+  for (int i = 0; i < static_cast<int>(perf::Phase::COUNT); i++) {
+    const auto phase = static_cast<perf::Phase>(i);
+    const perf::PhaseStats stats = perf::getStats(phase);
+    JsonObject entry = phases[perf::phaseName(phase)].to<JsonObject>();
+    entry["count"] = stats.total;
+    entry["samples"] = stats.samples;
+    entry["minUs"] = stats.minUs;
+    entry["meanUs"] = stats.meanUs;
+    entry["p95Us"] = stats.p95Us;
+    entry["maxUs"] = stats.maxUs;
+  }
+
+  const perf::HeapSnapshot snapshot = perf::getHeapSnapshot();
+  JsonObject heap = doc["heap"].to<JsonObject>();
+  heap["tracing"] = perf::heapTraceEnabled();
+  heap["free"] = snapshot.freeBytes;
+  heap["largestFreeBlock"] = snapshot.largestFreeBlock;
+  heap["minFree"] = snapshot.minFreeBytes;
+  heap["minLargestFreeBlock"] = snapshot.minLargestFreeBlock;
+  heap["fragmentationPct"] = snapshot.fragmentationPct;
+  JsonObject tags = heap["tags"].to<JsonObject>();
+  for (int i = 0; i < static_cast<int>(perf::HeapTag::COUNT); i++) {
+    const auto tag = static_cast<perf::HeapTag>(i);
+    const perf::HeapTagStats stats = perf::getHeapStats(tag);
+    JsonObject entry = tags[perf::heapTagName(tag)].to<JsonObject>();
+    entry["scopes"] = stats.scopes;
+    entry["currentBytes"] = stats.currentBytes;
+    entry["peakBytes"] = stats.peakBytes;
+    entry["netBytes"] = stats.netBytes;
+  }
+
+  // Start a fresh window, e.g. before reproducing a slow page turn
+  if (server->hasArg("reset")) {
+    perf::reset();
+    perf::resetHeapTrace();
+  }
+
+  String json;
+  serializeJson(doc, json);
+  server->send(200, "application/json", json);
+}
+
 void CrossPointWebServer::scanFiles(const char* path, const std::function<void(FileInfo)>& callback) const {
   FsFile root = Storage.open(path);
   if (!root) {
@@ -0,0 +1,55 @@
+#pragma once
+
+// Host stand-ins for the Arduino core functions used by the libraries under test.
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// delay() does not sleep: the waits the firmware makes for the SD card are counted and added to millis()/micros()
+// instead, so host runs stay fast and benchmarks can report the waits apart from the work
+struct HostDelayStats {
+  uint64_t calls = 0;
+  uint64_t totalMs = 0;
+
+  void reset() { *this = HostDelayStats{}; }
+};
+
+inline HostDelayStats& hostDelayStats() {
+  static HostDelayStats stats;
+  return stats;
+}
+
+inline unsigned long micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  return static_cast<unsigned long>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() +
+      hostDelayStats().totalMs * 1000);
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+
+inline void delay(const unsigned long ms) {
+  hostDelayStats().calls++;
+  hostDelayStats().totalMs += ms;
+}
+
+// Bytes in use as counted by a harness that wraps malloc (see run_layout_bench.sh); stays 0 otherwise
+inline size_t& hostHeapInUse() {
+  static size_t inUse = 0;
+  return inUse;
+}
+
+// The free heap stays comfortably large so the firmware's low-memory fallbacks never kick in on the host. The heap
+// size grows by what is in use instead, so size minus free, which is how the firmware measures heap use, is real.
+struct HostEspClass {
+  uint32_t getFreeHeap() const { return 256 * 1024; }
+  uint32_t getMaxAllocHeap() const { return 128 * 1024; }
+  uint32_t getHeapSize() const { return getFreeHeap() + static_cast<uint32_t>(hostHeapInUse()); }
+};
+inline HostEspClass ESP;
@@ -0,0 +1,78 @@
+#pragma once
+
+// In-memory stand-in for HalDisplay: the renderer draws into a plain 1-bit framebuffer of the panel's size, and
+// the refresh calls only count how often the panel would have been updated.
+
+#include <cstdint>
+#include <cstring>
+
+#include "Arduino.h"
+
+struct HostDisplayStats {
+  uint64_t refreshes = 0;
+  uint64_t grayscaleRefreshes = 0;
+
+  void reset() { *this = HostDisplayStats{}; }
+};
+
+inline HostDisplayStats& hostDisplayStats() {
+  static HostDisplayStats stats;
+  return stats;
+}
+
+class HalDisplay {
+ public:
+  enum RefreshMode { FULL_REFRESH, HALF_REFRESH, FAST_REFRESH };
+
+  static constexpr uint16_t DISPLAY_WIDTH = 800;
+  static constexpr uint16_t DISPLAY_HEIGHT = 480;
+  static constexpr uint16_t DISPLAY_WIDTH_BYTES = DISPLAY_WIDTH / 8;
+  static constexpr uint32_t BUFFER_SIZE = DISPLAY_WIDTH_BYTES * DISPLAY_HEIGHT;
+
+  void begin() {}
+
+  void clearScreen(const uint8_t color = 0xFF) const { memset(frameBuffer, color, BUFFER_SIZE); }
+  // Byte-aligned copy of a packed 1-bit image, like the panel driver
+  void drawImage(const uint8_t* imageData, const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h,
+                 bool = false) const {
+    const int rowBytes = (w + 7) / 8;
+    for (int row = 0; row < h && y + row < DISPLAY_HEIGHT; row++) {
+      for (int col = 0; col < rowBytes && x / 8 + col < DISPLAY_WIDTH_BYTES; col++) {
+        frameBuffer[(y + row) * DISPLAY_WIDTH_BYTES + x / 8 + col] = imageData[row * rowBytes + col];
+      }
+    }
+  }
+  // Only black pixels are copied
+  void drawImageTransparent(const uint8_t* imageData, const uint16_t x, const uint16_t y, const uint16_t w,
+                            const uint16_t h, bool = false) const {
+    const int rowBytes = (w + 7) / 8;
+    for (int row = 0; row < h && y + row < DISPLAY_HEIGHT; row++) {
+      for (int col = 0; col < rowBytes && x / 8 + col < DISPLAY_WIDTH_BYTES; col++) {
+        frameBuffer[(y + row) * DISPLAY_WIDTH_BYTES + x / 8 + col] &= imageData[row * rowBytes + col];
+      }
+    }
+  }
+
+  void displayBuffer(RefreshMode = FAST_REFRESH, bool = false) { hostDisplayStats().refreshes++; }
+  void refreshDisplay(RefreshMode = FAST_REFRESH, bool = false) { hostDisplayStats().refreshes++; }
+  void deepSleep() {}
+
+  uint8_t* getFrameBuffer() const { return frameBuffer; }
+
+  // The grayscale planes are kept, as the panel's RAM would, so tests can check them
+  void copyGrayscaleBuffers(const uint8_t* lsbBuffer, const uint8_t* msbBuffer) {
+    copyGrayscaleLsbBuffers(lsbBuffer);
+    copyGrayscaleMsbBuffers(msbBuffer);
+  }
+  void copyGrayscaleLsbBuffers(const uint8_t* lsbBuffer) { memcpy(grayscaleLsb, lsbBuffer, BUFFER_SIZE); }
+  void copyGrayscaleMsbBuffers(const uint8_t* msbBuffer) { memcpy(grayscaleMsb, msbBuffer, BUFFER_SIZE); }
+  const uint8_t* getGrayscaleLsb() const { return grayscaleLsb; }
+  const uint8_t* getGrayscaleMsb() const { return grayscaleMsb; }
+  void cleanupGrayscaleBuffers(const uint8_t*) {}
+  void displayGrayBuffer(bool = false) { hostDisplayStats().grayscaleRefreshes++; }
+
+ private:
+  mutable uint8_t frameBuffer[BUFFER_SIZE] = {};
+  uint8_t grayscaleLsb[BUFFER_SIZE] = {};
+  uint8_t grayscaleMsb[BUFFER_SIZE] = {};
+};
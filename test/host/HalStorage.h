@@ -0,0 +1,184 @@
+#pragma once
+
+// POSIX-backed stand-in for HalStorage/FsFile so SD-bound libraries can be built and measured on the host.
+// Every call that would reach the card is counted in HostIoStats, and with ENABLE_SD_TRACE recorded like the
+// device's HalFile does (see SdTrace.h).
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+#include "../../lib/PerfTrace/SdTrace.h"
+#include "Arduino.h"
+#include "Print.h"
+
+struct HostIoStats {
+  uint64_t opens = 0;
+  uint64_t reads = 0;
+  uint64_t bytesRead = 0;
+  uint64_t writes = 0;
+  uint64_t bytesWritten = 0;
+  uint64_t seeks = 0;
+
+  void reset() { *this = HostIoStats{}; }
+};
+
+inline HostIoStats& hostIoStats() {
+  static HostIoStats stats;
+  return stats;
+}
+
+class FsFile : public Print {
+ public:
+  FsFile() = default;
+  ~FsFile() override { close(); }
+  FsFile(const FsFile&) = delete;
+  FsFile& operator=(const FsFile&) = delete;
+  FsFile(FsFile&& other) noexcept : fp(std::exchange(other.fp, nullptr)), tracePathId(other.tracePathId) {}
+  FsFile& operator=(FsFile&& other) noexcept {
+    if (this != &other) {
+      close();
+      fp = std::exchange(other.fp, nullptr);
+      tracePathId = other.tracePathId;
+    }
+    return *this;
+  }
+
+  bool openPath(const char* path, const char* mode) {
+    close();
+#ifdef ENABLE_SD_TRACE
+    const uint32_t start = micros();
+#endif
+    fp = fopen(path, mode);
+    hostIoStats().opens++;
+#ifdef ENABLE_SD_TRACE
+    tracePathId = perf::sdTracePathId(path);
+    record(perf::SdOp::Open, 0, 0, start,
+           (fp ? 0 : perf::SD_TRACE_FAILED) | (mode[0] == 'r' && !strchr(mode, '+') ? 0 : perf::SD_TRACE_WRITE_MODE));
+#endif
+    return fp != nullptr;
+  }
+
+  explicit operator bool() const { return fp != nullptr; }
+  bool isOpen() const { return fp != nullptr; }
+
+  int read(void* buf, const size_t len) {
+    if (!fp) return -1;
+    const uint32_t start = micros();
+    const uint64_t offset = position();
+    hostIoStats().reads++;
+    const size_t n = fread(buf, 1, len, fp);
+    hostIoStats().bytesRead += n;
+    record(perf::SdOp::Read, offset, len, start, n < len ? perf::SD_TRACE_SHORT : 0);
+    return static_cast<int>(n);
+  }
+  int read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+
+  size_t write(const uint8_t* buf, const size_t len) override {
+    if (!fp) return 0;
+    const uint32_t start = micros();
+    const uint64_t offset = position();
+    hostIoStats().writes++;
+    const size_t n = fwrite(buf, 1, len, fp);
+    hostIoStats().bytesWritten += n;
+    record(perf::SdOp::Write, offset, len, start, n < len ? perf::SD_TRACE_SHORT : 0);
+    return n;
+  }
+  size_t write(const uint8_t c) override { return write(&c, 1); }
+  size_t write(const void* buf, const size_t len) { return write(static_cast<const uint8_t*>(buf), len); }
+
+  bool seek(const uint64_t pos) { return seekSet(pos); }
+  bool seekSet(const uint64_t pos) {
+    if (!fp) return false;
+    const uint32_t start = micros();
+    hostIoStats().seeks++;
+    const bool ok = fseek(fp, static_cast<long>(pos), SEEK_SET) == 0;
+    record(perf::SdOp::Seek, pos, 0, start, ok ? 0 : perf::SD_TRACE_FAILED);
+    return ok;
+  }
+  bool seekCur(const int64_t offset) {
+    if (!fp) return false;
+    const uint32_t start = micros();
+    hostIoStats().seeks++;
+    const bool ok = fseek(fp, static_cast<long>(offset), SEEK_CUR) == 0;
+    record(perf::SdOp::Seek, position(), 0, start, ok ? 0 : perf::SD_TRACE_FAILED);
+    return ok;
+  }
+  uint64_t position() const { return fp ? static_cast<uint64_t>(ftell(fp)) : 0; }
+  uint64_t size() const {
+    if (!fp) return 0;
+    struct stat st = {};
+    fflush(fp);
+    return fstat(fileno(fp), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+  }
+  uint64_t fileSize() const { return size(); }
+  int available() const { return fp ? static_cast<int>(size() - position()) : 0; }
+  void flush() {
+    if (fp) fflush(fp);
+  }
+  bool close() {
+    if (fp) {
+      const uint32_t start = micros();
+      fclose(fp);
+      record(perf::SdOp::Close, 0, 0, start, 0);
+    }
+    fp = nullptr;
+    return true;
+  }
+
+ private:
+  FILE* fp = nullptr;
+  uint16_t tracePathId = 0;
+
+#ifdef ENABLE_SD_TRACE
+  void record(const perf::SdOp op, const uint64_t offset, const size_t length, const uint32_t start,
+              const uint8_t flags) const {
+    perf::sdTraceRecord(op, tracePathId, static_cast<uint32_t>(offset), static_cast<uint32_t>(length), start, flags);
+  }
+#else
+  template <typename... Args>
+  void record(Args&&...) const {}
+#endif
+};
+
+class HalStorage {
+ public:
+  bool openFileForRead(const char*, const char* path, FsFile& file) { return file.openPath(path, "rb"); }
+  bool openFileForRead(const char* moduleName, const std::string& path, FsFile& file) {
+    return openFileForRead(moduleName, path.c_str(), file);
+  }
+  bool openFileForWrite(const char*, const char* path, FsFile& file) { return file.openPath(path, "wb+"); }
+  bool openFileForWrite(const char* moduleName, const std::string& path, FsFile& file) {
+    return openFileForWrite(moduleName, path.c_str(), file);
+  }
+  bool exists(const char* path) {
+    struct stat st = {};
+    return ::stat(path, &st) == 0;
+  }
+  bool remove(const char* path) { return ::remove(path) == 0; }
+  bool mkdir(const char* path, bool = true) {
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+    return exists(path);
+  }
+  bool rmdir(const char* path) { return ::rmdir(path) == 0; }
+  bool removeDir(const char* path) {
+    std::error_code ec;
+    return std::filesystem::remove_all(path, ec) != static_cast<std::uintmax_t>(-1);
+  }
+
+  static HalStorage& getInstance() {
+    static HalStorage instance;
+    return instance;
+  }
+};
+
+#define Storage HalStorage::getInstance()
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdio>
+
+// Host logging: errors go to stderr, everything else is compiled out unless HOST_LOG_DEBUG is defined.
+// HOST_LOG_QUIET drops errors too, for harnesses that hit logged edge cases on purpose and time them.
+// Dropped calls still type-check their arguments against the format, and count as uses of them.
+#define HOST_LOG_DROP(format, ...)                 \
+  do {                                             \
+    if (0) fprintf(stderr, format, ##__VA_ARGS__); \
+  } while (0)
+
+#ifdef HOST_LOG_QUIET
+#define LOG_ERR(origin, format, ...) HOST_LOG_DROP("[%s] " format, origin, ##__VA_ARGS__)
+#else
+#define LOG_ERR(origin, format, ...) fprintf(stderr, "[ERR] [%s] " format "\n", origin, ##__VA_ARGS__)
+#endif
+#ifdef HOST_LOG_DEBUG
+#define LOG_INF(origin, format, ...) fprintf(stderr, "[INF] [%s] " format "\n", origin, ##__VA_ARGS__)
+#define LOG_DBG(origin, format, ...) fprintf(stderr, "[DBG] [%s] " format "\n", origin, ##__VA_ARGS__)
+#else
+#define LOG_INF(origin, format, ...) HOST_LOG_DROP("[%s] " format, origin, ##__VA_ARGS__)
+#define LOG_DBG(origin, format, ...) HOST_LOG_DROP("[%s] " format, origin, ##__VA_ARGS__)
+#endif
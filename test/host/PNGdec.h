@@ -0,0 +1,52 @@
+#pragma once
+
+// Host stand-in for the PNGdec library, which is fetched by PlatformIO and not available to host builds. Every
+// open fails, so PNG images are skipped like unsupported ones; JPEG images still go through picojpeg.
+
+#include <cstdint>
+
+#ifndef PNG_MAX_BUFFERED_PIXELS
+#define PNG_MAX_BUFFERED_PIXELS 16416
+#endif
+
+enum { PNG_SUCCESS = 0, PNG_UNSUPPORTED_FEATURE = 5 };
+enum {
+  PNG_PIXEL_GRAYSCALE = 0,
+  PNG_PIXEL_TRUECOLOR = 2,
+  PNG_PIXEL_INDEXED = 3,
+  PNG_PIXEL_GRAY_ALPHA = 4,
+  PNG_PIXEL_TRUECOLOR_ALPHA = 6
+};
+
+struct PNGFILE {
+  void* fHandle = nullptr;
+};
+
+struct PNGDRAW {
+  int y = 0;
+  int iPixelType = 0;
+  int iHasAlpha = 0;
+  uint8_t* pPixels = nullptr;
+  uint8_t* pPalette = nullptr;
+  void* pUser = nullptr;
+};
+
+using PNG_OPEN_CALLBACK = void* (*)(const char*, int32_t*);
+using PNG_CLOSE_CALLBACK = void (*)(void*);
+using PNG_READ_CALLBACK = int32_t (*)(PNGFILE*, uint8_t*, int32_t);
+using PNG_SEEK_CALLBACK = int32_t (*)(PNGFILE*, int32_t);
+using PNG_DRAW_CALLBACK = int (*)(PNGDRAW*);
+
+class PNG {
+ public:
+  int open(const char*, PNG_OPEN_CALLBACK, PNG_CLOSE_CALLBACK, PNG_READ_CALLBACK, PNG_SEEK_CALLBACK,
+           PNG_DRAW_CALLBACK) {
+    return PNG_UNSUPPORTED_FEATURE;
+  }
+  int decode(void*, int) { return PNG_UNSUPPORTED_FEATURE; }
+  void close() {}
+  int getWidth() const { return 0; }
+  int getHeight() const { return 0; }
+  int getBpp() const { return 0; }
+  int getPixelType() const { return 0; }
+};
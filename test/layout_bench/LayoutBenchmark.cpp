@@ -0,0 +1,539 @@
+// Runs the EPUB layout pipeline on the host: every book is opened (zip index, OPF/TOC, book.bin, CSS), every spine
+// item is laid out into its section file and every page is rendered into an in-memory framebuffer, with the reader's
+// default settings (Bookerly 14, justified, extra paragraph spacing, embedded style, anti-aliased text).
+//
+// Reported per phase: wall time, bytes read and written through HalStorage, the peak heap in use during the phase
+// above what was live when it started, and the number of heap allocations. The section builds run progressive, like
+// the background indexer, so the time until each section's first page was readable is reported as well. The cache is
+// wiped before each book, so every run starts cold. delay() calls (the firmware's waits for the SD card) are counted,
+// not slept.
+//
+// Host numbers are not device numbers (64-bit pointers, no SD latency, a much faster CPU), but they move in the same
+// direction and are repeatable, which is what a change to the layout or cache code needs.
+//
+// The run is built with heap tracing on, so the peak heap growth of each HeapTrace tag is reported too. With
+// --heap-budgets, any tag whose peak exceeds its budget fails the run, so a memory regression shows up here first.
+//
+// --sd-trace records every file call of the run, for test/run_sd_trace_replay.sh. --three-pass renders anti-aliased
+// text the way the reader did before single-pass capture, and --flush-font-cache empties the font cache after every
+// page the way the reader did before it kept decompressed glyph groups from page to page, both for comparison.
+//
+// Usage: LayoutBenchmark [--hyphenation] [--no-render] [--three-pass] [--flush-font-cache] [--heap-budgets=<file>]
+//                        [--sd-trace=<file>] <work dir> <epub>...
+
+#include <Epub.h>
+#include <Epub/Page.h>
+#include <Epub/ParsedText.h>
+#include <Epub/Section.h>
+#include <Epub/WordWidthCache.h>
+#include <FontDecompressor.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <HeapTrace.h>
+#include <SdTrace.h>
+#include <Utf8.h>
+#include <builtinFonts/all.h>
+#include <malloc.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../../src/fontIds.h"
+
+// Heap in use by the benchmark and the libraries it links (see the --wrap flags in the run script), kept in the host
+// Arduino stub so HeapTrace sees it through ESP.getHeapSize()
+size_t heapPeak = 0;
+uint64_t heapAllocations = 0;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+static void trackAlloc(void* p) {
+  if (!p) return;
+  heapAllocations++;
+  hostHeapInUse() += malloc_usable_size(p);
+  heapPeak = std::max(heapPeak, hostHeapInUse());
+  // Every allocation is a sample point, so the host sees each tag's true peak
+  perf::heapSample();
+}
+void* __wrap_malloc(const size_t size) {
+  void* p = __real_malloc(size);
+  trackAlloc(p);
+  return p;
+}
+void* __wrap_calloc(const size_t count, const size_t size) {
+  void* p = __real_calloc(count, size);
+  trackAlloc(p);
+  return p;
+}
+void* __wrap_realloc(void* ptr, const size_t size) {
+  const size_t before = ptr ? malloc_usable_size(ptr) : 0;
+  void* p = __real_realloc(ptr, size);
+  if (p || size == 0) hostHeapInUse() -= before;
+  trackAlloc(p);
+  return p;
+}
+void __wrap_free(void* ptr) {
+  if (ptr) hostHeapInUse() -= malloc_usable_size(ptr);
+  __real_free(ptr);
+}
+}
+
+void* operator new(const size_t size) {
+  void* p = malloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](const size_t size) { return operator new(size); }
+void* operator new(const size_t size, const std::nothrow_t&) noexcept { return malloc(size); }
+void* operator new[](const size_t size, const std::nothrow_t&) noexcept { return malloc(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+namespace {
+
+// Reader defaults, see CrossPointSettings
+constexpr int FONT_ID = BOOKERLY_14_FONT_ID;
+constexpr float LINE_COMPRESSION = 1.0f;
+constexpr bool EXTRA_PARAGRAPH_SPACING = true;
+constexpr uint8_t PARAGRAPH_ALIGNMENT = 0;  // Justified
+constexpr bool EMBEDDED_STYLE = true;
+constexpr int SCREEN_MARGIN = 5;
+constexpr int STATUS_BAR_HEIGHT = 19;
+
+EpdFont bookerly14RegularFont(&bookerly_14_regular);
+EpdFont bookerly14BoldFont(&bookerly_14_bold);
+EpdFont bookerly14ItalicFont(&bookerly_14_italic);
+EpdFont bookerly14BoldItalicFont(&bookerly_14_bolditalic);
+EpdFontFamily bookerly14FontFamily(&bookerly14RegularFont, &bookerly14BoldFont, &bookerly14ItalicFont,
+                                   &bookerly14BoldItalicFont);
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(const Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Time, card traffic and peak heap of one phase
+struct Phase {
+  Clock::time_point start;
+  HostIoStats io;
+  size_t heapBase = 0;
+  uint64_t allocationBase = 0;
+
+  double ms = 0;
+  uint64_t bytesRead = 0;
+  uint64_t bytesWritten = 0;
+  size_t peakHeap = 0;
+  uint64_t allocations = 0;
+
+  void begin() {
+    io = hostIoStats();
+    heapBase = hostHeapInUse();
+    allocationBase = heapAllocations;
+    heapPeak = hostHeapInUse();
+    start = Clock::now();
+  }
+  void end() {
+    ms += msSince(start);
+    bytesRead += hostIoStats().bytesRead - io.bytesRead;
+    bytesWritten += hostIoStats().bytesWritten - io.bytesWritten;
+    peakHeap = std::max(peakHeap, heapPeak - heapBase);
+    allocations += heapAllocations - allocationBase;
+  }
+  void add(const Phase& other) {
+    ms += other.ms;
+    bytesRead += other.bytesRead;
+    bytesWritten += other.bytesWritten;
+    peakHeap = std::max(peakHeap, other.peakHeap);
+    allocations += other.allocations;
+  }
+};
+
+struct BookResult {
+  Phase open;
+  Phase layout;
+  Phase render;
+  int sections = 0;
+  int failedSections = 0;
+  uint64_t pages = 0;
+  std::vector<double> firstPageMs;  // Per section that produced pages
+  uint64_t glyphLookups = 0;        // Codepoints measured by measureWords()
+  double glyphMs = 0;
+  uint64_t widthHits = 0;  // Word width cache lookups during layout
+  uint64_t widthMisses = 0;
+  ParsedText::LineStats lines;
+  uint64_t widthWords = 0;  // Words measured by measureWords() with and without a word width cache
+  double widthMs = 0;
+  double cachedWidthMs = 0;
+};
+
+struct Viewport {
+  int top, right, bottom, left;
+  uint16_t width, height;
+};
+
+Viewport readerViewport(const GfxRenderer& renderer) {
+  Viewport v{};
+  renderer.getOrientedViewableTRBL(&v.top, &v.right, &v.bottom, &v.left);
+  v.top += SCREEN_MARGIN;
+  v.left += SCREEN_MARGIN;
+  v.right += SCREEN_MARGIN;
+  v.bottom += std::max(SCREEN_MARGIN, STATUS_BAR_HEIGHT);
+  v.width = renderer.getScreenWidth() - v.left - v.right;
+  v.height = renderer.getScreenHeight() - v.top - v.bottom;
+  return v;
+}
+
+// Same passes as EpubReaderActivity::renderContents with anti-aliasing on: text pages in one pass that captures the
+// grayscale planes too, pages with images (or every page, with --three-pass) in a BW pass and one per grayscale plane
+void renderPage(GfxRenderer& renderer, const Page& page, const Viewport& v, const bool threePass) {
+  renderer.clearScreen();
+  const bool capture = !threePass && !page.hasImages() && renderer.beginGrayscaleCapture();
+  page.render(renderer, FONT_ID, v.left, v.top);
+  if (capture && renderer.endGrayscaleCapture()) {
+    renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+    renderer.displayCapturedGrayscale();
+    return;
+  }
+  renderer.displayBuffer(HalDisplay::FAST_REFRESH);
+  renderer.storeBwBuffer();
+  renderer.clearScreen(0x00);
+  renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
+  page.render(renderer, FONT_ID, v.left, v.top);
+  renderer.copyGrayscaleLsbBuffers();
+  renderer.clearScreen(0x00);
+  renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
+  page.render(renderer, FONT_ID, v.left, v.top);
+  renderer.copyGrayscaleMsbBuffers();
+  renderer.displayGrayBuffer();
+  renderer.setRenderMode(GfxRenderer::BW);
+  renderer.restoreBwBuffer();
+}
+
+// Measures every word of the rendered pages in all four styles, as layout measures words, and counts the codepoints
+// (each a glyph, kerning and ligature lookup). Kept out of the render phase's time.
+void measureWords(const GfxRenderer& renderer, const std::vector<std::string>& words, BookResult& result) {
+  constexpr EpdFontFamily::Style STYLES[] = {EpdFontFamily::REGULAR, EpdFontFamily::BOLD, EpdFontFamily::ITALIC,
+                                             EpdFontFamily::BOLD_ITALIC};
+  uint64_t codepoints = 0;
+  for (const auto& word : words) {
+    auto* text = reinterpret_cast<const uint8_t*>(word.c_str());
+    while (utf8NextCodepoint(&text)) codepoints++;
+  }
+  const auto start = Clock::now();
+  volatile int width = 0;
+  for (const auto style : STYLES) {
+    for (const auto& word : words) {
+      width = width + renderer.getTextAdvanceX(FONT_ID, word.c_str(), style);
+    }
+  }
+  result.glyphMs += msSince(start);
+  result.glyphLookups += codepoints * 4;
+
+  // The regular style once more, then through a fresh word width cache the way a section build measures them
+  const auto uncachedStart = Clock::now();
+  for (const auto& word : words) {
+    width = width + renderer.getTextAdvanceX(FONT_ID, word.c_str(), EpdFontFamily::REGULAR);
+  }
+  result.widthMs += msSince(uncachedStart);
+  const auto cachedStart = Clock::now();
+  {
+    WordWidthCache cache;
+    for (const auto& word : words) {
+      width = width + cache.getOrMeasure(FONT_ID, EpdFontFamily::REGULAR, word.data(), word.size(), [&] {
+        return renderer.getTextAdvanceX(FONT_ID, word.c_str(), EpdFontFamily::REGULAR);
+      });
+    }
+  }
+  result.cachedWidthMs += msSince(cachedStart);
+  result.widthWords += words.size();
+}
+
+void addLineStats(ParsedText::LineStats& total, const ParsedText::LineStats& add) {
+  total.lines += add.lines;
+  total.splitWords += add.splitWords;
+  total.badness += add.badness;
+  total.breakUs += add.breakUs;
+}
+
+bool runBook(const std::string& path, const std::string& cacheDir, GfxRenderer& renderer, const bool hyphenation,
+             const bool render, const bool threePass, const bool flushFontCache, BookResult& result) {
+  const Viewport v = readerViewport(renderer);
+
+  result.open.begin();
+  auto epub = std::make_shared<Epub>(path, cacheDir);
+  Storage.removeDir(epub->getCachePath().c_str());
+  const bool loaded = epub->load(true, !EMBEDDED_STYLE);
+  result.open.end();
+  if (!loaded) {
+    fprintf(stderr, "Failed to open %s\n", path.c_str());
+    return false;
+  }
+
+  result.sections = epub->getSpineItemsCount();
+  for (int i = 0; i < result.sections; i++) {
+    Section section(epub, i, renderer);
+    const auto buildStart = Clock::now();
+    double firstPageMs = -1;
+    // Progressive build, so the first page is committed (and readable) as early as the indexer would have it
+    const auto checkpoint = [&section, &firstPageMs, buildStart] {
+      if (firstPageMs < 0 && section.pageCount > 0) {
+        firstPageMs = msSince(buildStart);
+      }
+      return true;
+    };
+    WordWidthCache::resetTotals();
+    ParsedText::resetLineTotals();
+    result.layout.begin();
+    const bool built = section.createSectionFile(FONT_ID, LINE_COMPRESSION, EXTRA_PARAGRAPH_SPACING,
+                                                 PARAGRAPH_ALIGNMENT, v.width, v.height, hyphenation, EMBEDDED_STYLE,
+                                                 nullptr, checkpoint);
+    result.layout.end();
+    result.widthHits += WordWidthCache::getTotals().hits;
+    result.widthMisses += WordWidthCache::getTotals().misses;
+    addLineStats(result.lines, ParsedText::getLineTotals());
+    if (!built) {
+      result.failedSections++;
+      continue;
+    }
+    if (section.pageCount > 0) {
+      // A chapter that fits in one parser chunk only commits when the build ends
+      result.firstPageMs.push_back(firstPageMs < 0 ? msSince(buildStart) : firstPageMs);
+    }
+    result.pages += section.pageCount;
+    section.close();
+
+    if (!render) {
+      continue;
+    }
+    // Read back from a fresh Section, turning forward through the page cache like the reader
+    Section reader(epub, i, renderer);
+    std::vector<std::string> words;
+    result.render.begin();
+    if (reader.loadSectionFile(FONT_ID, LINE_COMPRESSION, EXTRA_PARAGRAPH_SPACING, PARAGRAPH_ALIGNMENT, v.width,
+                               v.height, hyphenation, EMBEDDED_STYLE)) {
+      for (int p = 0; p < reader.pageCount; p++) {
+        reader.currentPage = p;
+        bool hit = false;
+        const Page* page = reader.getCurrentPage(hit);
+        if (page) {
+          renderPage(renderer, *page, v, threePass);
+          for (const auto& element : page->elements) {
+            if (element->getTag() != TAG_PageLine) continue;
+            for (const auto word : static_cast<const PageLine&>(*element).getBlock()->getWords()) {
+              words.emplace_back(word);
+            }
+          }
+        }
+        if (flushFontCache) {
+          renderer.clearFontCache();
+        }
+        reader.prefetchAdjacentPages(true);
+      }
+    }
+    reader.close();
+    result.render.end();
+    measureWords(renderer, words, result);
+  }
+  return true;
+}
+
+void printPhase(const char* name, const Phase& phase) {
+  printf("  %-8s %10.1f ms %12llu B read %12llu B written %10zu B peak heap %10llu allocations\n", name, phase.ms,
+         static_cast<unsigned long long>(phase.bytesRead), static_cast<unsigned long long>(phase.bytesWritten),
+         phase.peakHeap, static_cast<unsigned long long>(phase.allocations));
+}
+
+void printFirstPage(std::vector<double> times) {
+  if (times.empty()) return;
+  std::sort(times.begin(), times.end());
+  double sum = 0;
+  for (const double t : times) sum += t;
+  printf("  first page: median %.1f ms, mean %.1f ms, max %.1f ms over %zu sections\n", times[times.size() / 2],
+         sum / times.size(), times.back(), times.size());
+}
+
+// Prints the heap tags the run used; with a budgets file ("<tag> <bytes>" per line), fails any tag over its budget
+bool reportHeapTags(const char* budgetsPath) {
+  constexpr int TAG_COUNT = static_cast<int>(perf::HeapTag::COUNT);
+  uint32_t budgets[TAG_COUNT] = {};
+  if (budgetsPath) {
+    FILE* f = fopen(budgetsPath, "r");
+    if (!f) {
+      fprintf(stderr, "Cannot open %s\n", budgetsPath);
+      return false;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+      char name[64];
+      unsigned budget = 0;
+      if (line[0] == '#' || sscanf(line, "%63s %u", name, &budget) != 2) continue;
+      int i = 0;
+      while (i < TAG_COUNT && strcmp(name, perf::heapTagName(static_cast<perf::HeapTag>(i))) != 0) i++;
+      if (i == TAG_COUNT) {
+        fprintf(stderr, "Unknown heap tag %s in %s\n", name, budgetsPath);
+        fclose(f);
+        return false;
+      }
+      budgets[i] = budget;
+    }
+    fclose(f);
+  }
+
+  bool ok = true;
+  printf("  heap tags:\n");
+  for (int i = 0; i < TAG_COUNT; i++) {
+    const auto tag = static_cast<perf::HeapTag>(i);
+    const perf::HeapTagStats stats = perf::getHeapStats(tag);
+    if (stats.scopes == 0 && budgets[i] == 0) continue;
+    const bool over = budgets[i] > 0 && stats.peakBytes > budgets[i];
+    ok = ok && !over;
+    printf("    %-16s peak %8u B, net %8d B over %6u scopes", perf::heapTagName(tag), stats.peakBytes, stats.netBytes,
+           stats.scopes);
+    if (budgets[i] > 0) printf(", budget %8u B%s", budgets[i], over ? "  OVER BUDGET" : "");
+    printf("\n");
+  }
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool hyphenation = false;
+  bool render = true;
+  bool threePass = false;
+  bool flushFontCache = false;
+  const char* heapBudgets = nullptr;
+  const char* sdTrace = nullptr;
+  int arg = 1;
+  for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++) {
+    if (strcmp(argv[arg], "--hyphenation") == 0) {
+      hyphenation = true;
+    } else if (strcmp(argv[arg], "--no-render") == 0) {
+      render = false;
+    } else if (strcmp(argv[arg], "--three-pass") == 0) {
+      threePass = true;
+    } else if (strcmp(argv[arg], "--flush-font-cache") == 0) {
+      flushFontCache = true;
+    } else if (strncmp(argv[arg], "--heap-budgets=", 15) == 0) {
+      heapBudgets = argv[arg] + 15;
+    } else if (strncmp(argv[arg], "--sd-trace=", 11) == 0) {
+      sdTrace = argv[arg] + 11;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", argv[arg]);
+      return 1;
+    }
+  }
+  if (argc - arg < 2) {
+    fprintf(stderr,
+            "Usage: %s [--hyphenation] [--no-render] [--three-pass] [--flush-font-cache] [--heap-budgets=<file>] "
+            "[--sd-trace=<file>] <work dir> <epub>...\n",
+            argv[0]);
+    return 1;
+  }
+  const std::string cacheDir = std::string(argv[arg++]) + "/cache";
+  Storage.mkdir(cacheDir.c_str());
+
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  renderer.begin();
+  FontDecompressor fontDecompressor;
+  if (!fontDecompressor.init()) {
+    fprintf(stderr, "Failed to initialize the font decompressor\n");
+    return 1;
+  }
+  renderer.setFontDecompressor(&fontDecompressor);
+  renderer.insertFont(FONT_ID, bookerly14FontFamily);
+
+  if (sdTrace && !perf::sdTraceStart(sdTrace)) {
+    fprintf(stderr, "Cannot write the SD trace to %s\n", sdTrace);
+    return 1;
+  }
+
+  BookResult total;
+  std::vector<double> firstPageMs;
+  int books = 0;
+  for (; arg < argc; arg++) {
+    const std::string path = argv[arg];
+    BookResult result;
+    if (!runBook(path, cacheDir, renderer, hyphenation, render, threePass, flushFontCache, result)) {
+      continue;
+    }
+    books++;
+    printf("%s: %d sections (%d failed), %llu pages\n", path.substr(path.find_last_of('/') + 1).c_str(),
+           result.sections, result.failedSections, static_cast<unsigned long long>(result.pages));
+    printPhase("open", result.open);
+    printPhase("layout", result.layout);
+    if (render) printPhase("render", result.render);
+    printFirstPage(result.firstPageMs);
+
+    total.open.add(result.open);
+    total.layout.add(result.layout);
+    total.render.add(result.render);
+    total.sections += result.sections;
+    total.failedSections += result.failedSections;
+    total.pages += result.pages;
+    total.glyphLookups += result.glyphLookups;
+    total.glyphMs += result.glyphMs;
+    total.widthHits += result.widthHits;
+    total.widthMisses += result.widthMisses;
+    addLineStats(total.lines, result.lines);
+    total.widthWords += result.widthWords;
+    total.widthMs += result.widthMs;
+    total.cachedWidthMs += result.cachedWidthMs;
+    firstPageMs.insert(firstPageMs.end(), result.firstPageMs.begin(), result.firstPageMs.end());
+  }
+
+  printf("\nTotal: %d books, %d sections (%d failed), %llu pages\n", books, total.sections, total.failedSections,
+         static_cast<unsigned long long>(total.pages));
+  printPhase("open", total.open);
+  printPhase("layout", total.layout);
+  if (render) printPhase("render", total.render);
+  printFirstPage(firstPageMs);
+  const uint64_t widthLookups = total.widthHits + total.widthMisses;
+  printf("  word widths: %.2f%% of %llu lookups hit during layout, %.2f ms layout per section\n",
+         widthLookups > 0 ? 100.0 * total.widthHits / widthLookups : 0.0,
+         static_cast<unsigned long long>(widthLookups), total.sections > 0 ? total.layout.ms / total.sections : 0.0);
+  printf("  line breaks: %u lines, %u split words, badness %.1f per line, %.1f ms choosing them\n",
+         total.lines.lines, total.lines.splitWords,
+         total.lines.lines > 0 ? static_cast<double>(total.lines.badness) / total.lines.lines : 0.0,
+         total.lines.breakUs / 1000.0);
+  if (render && total.pages > 0) {
+    printf("  per page: layout %.3f ms, render %.3f ms\n", total.layout.ms / total.pages,
+           total.render.ms / total.pages);
+    // Only rendering draws glyphs, so the whole run's lookups are the pages'
+    const FontDecompressor::Stats& fonts = fontDecompressor.getStats();
+    const uint32_t lookups = fonts.hits + fonts.misses;
+    printf("  glyph lookups: %.2f M/s over %llu, measuring every rendered word in all four styles\n",
+           total.glyphMs > 0 ? total.glyphLookups / total.glyphMs / 1000.0 : 0.0,
+           static_cast<unsigned long long>(total.glyphLookups));
+    printf("  word measuring: %.1f ns per rendered word, %.1f ns through a word width cache\n",
+           total.widthWords > 0 ? total.widthMs * 1e6 / total.widthWords : 0.0,
+           total.widthWords > 0 ? total.cachedWidthMs * 1e6 / total.widthWords : 0.0);
+    printf("  font cache: %.2f%% of %u glyph lookups hit, %.2f groups and %.3f ms inflated per page\n",
+           lookups > 0 ? 100.0 * fonts.hits / lookups : 0.0, lookups, static_cast<double>(fonts.misses) / total.pages,
+           fonts.inflateUs / 1000.0 / total.pages);
+  }
+  printf("  delay(): %llu calls, %llu ms of device waits, not included above\n",
+         static_cast<unsigned long long>(hostDelayStats().calls),
+         static_cast<unsigned long long>(hostDelayStats().totalMs));
+  printf("  display: %llu refreshes, %llu grayscale\n", static_cast<unsigned long long>(hostDisplayStats().refreshes),
+         static_cast<unsigned long long>(hostDisplayStats().grayscaleRefreshes));
+  perf::sdTraceStop();
+  const bool heapOk = reportHeapTags(heapBudgets);
+  fontDecompressor.deinit();
+  return books > 0 && heapOk ? 0 : 1;
+}
@@ -0,0 +1,675 @@
+// Draws a fixed set of text, bitmap and shape scenes with GfxRenderer into the host framebuffer, in every orientation
+// and render mode, and compares a hash of each resulting framebuffer with the one recorded in golden.txt. A change to a
+// drawing path either keeps every hash or shows exactly which scene, orientation and mode it altered; --dump writes
+// the framebuffers as PBM images to look at the difference. The scenes with only dark content on white are also drawn
+// in a single BW_AND_GRAYSCALE pass, which has to give the same three hashes.
+//
+// --bench draws the same scenes repeatedly instead and reports frames, glyphs and pixels per second for each, so a
+// blitter rewrite can be checked bit-exact and timed with the same scenes. Pixels are the area the scene's shapes and
+// bitmaps cover, glyphs the non-space code points of its text. It then reports glyphs per second for each orientation
+// and render mode, since each orientation takes its own path through the glyph blitter.
+//
+// Usage: RendererGoldenTest [--update | --bench] [--dump] <work dir> <golden file>
+
+#include <Bitmap.h>
+#include <FontDecompressor.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <Utf8.h>
+#include <builtinFonts/bookerly_14_bold.h>
+#include <builtinFonts/bookerly_14_bolditalic.h>
+#include <builtinFonts/bookerly_14_italic.h>
+#include <builtinFonts/bookerly_14_regular.h>
+#include <builtinFonts/notosans_8_regular.h>
+#include <builtinFonts/ubuntu_10_bold.h>
+#include <builtinFonts/ubuntu_10_regular.h>
+#include <builtinFonts/ubuntu_12_bold.h>
+#include <builtinFonts/ubuntu_12_regular.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../src/fontIds.h"
+
+namespace {
+
+EpdFont bookerly14RegularFont(&bookerly_14_regular);
+EpdFont bookerly14BoldFont(&bookerly_14_bold);
+EpdFont bookerly14ItalicFont(&bookerly_14_italic);
+EpdFont bookerly14BoldItalicFont(&bookerly_14_bolditalic);
+EpdFontFamily bookerly14FontFamily(&bookerly14RegularFont, &bookerly14BoldFont, &bookerly14ItalicFont,
+                                   &bookerly14BoldItalicFont);
+EpdFont smallFont(&notosans_8_regular);
+EpdFontFamily smallFontFamily(&smallFont);
+EpdFont ui10RegularFont(&ubuntu_10_regular);
+EpdFont ui10BoldFont(&ubuntu_10_bold);
+EpdFontFamily ui10FontFamily(&ui10RegularFont, &ui10BoldFont);
+EpdFont ui12RegularFont(&ubuntu_12_regular);
+EpdFont ui12BoldFont(&ubuntu_12_bold);
+EpdFontFamily ui12FontFamily(&ui12RegularFont, &ui12BoldFont);
+
+constexpr const char* ORIENTATION_NAMES[] = {"portrait", "landscape_cw", "portrait_inverted", "landscape_ccw"};
+constexpr const char* MODE_NAMES[] = {"bw", "lsb", "msb"};
+
+// Short enough to fit the portrait width
+constexpr const char* PARAGRAPH[] = {
+    "It was the best of times, it was the worst",
+    "of times, it was the age of wisdom, it was",
+    "the age of foolishness, it was the epoch of",
+    "belief, it was the epoch of incredulity, it",
+    "was the season of Light, it was the season",
+};
+
+// What a scene drew, for the throughput figures
+struct SceneCounts {
+  uint64_t glyphs = 0;
+  uint64_t pixels = 0;
+};
+
+struct Scene {
+  const char* name;
+  void (*draw)(GfxRenderer&, const std::string& workDir, SceneCounts&);
+  // Only dark content on white, like a reader page: the single-pass render matches the three passes exactly. White
+  // drawn in the grayscale passes marks gray, which a single pass does not reproduce.
+  bool darkOnWhite;
+};
+
+void text(GfxRenderer& r, SceneCounts& counts, const int fontId, const int x, const int y, const char* str,
+          const bool black = true, const EpdFontFamily::Style style = EpdFontFamily::REGULAR) {
+  r.drawText(fontId, x, y, str, black, style);
+  const auto* p = reinterpret_cast<const unsigned char*>(str);
+  uint32_t cp;
+  while ((cp = utf8NextCodepoint(&p))) {
+    if (cp != ' ') counts.glyphs++;
+  }
+}
+
+void area(SceneCounts& counts, const int width, const int height) {
+  counts.pixels += static_cast<uint64_t>(width) * height;
+}
+
+void drawParagraph(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  const int lineHeight = r.getLineHeight(BOOKERLY_14_FONT_ID);
+  int y = 20;
+  for (int pass = 0; pass < 3; pass++) {
+    for (const char* line : PARAGRAPH) {
+      text(r, counts, BOOKERLY_14_FONT_ID, 12, y, line);
+      y += lineHeight;
+    }
+  }
+}
+
+void drawStyles(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  constexpr EpdFontFamily::Style STYLES[] = {EpdFontFamily::REGULAR, EpdFontFamily::BOLD, EpdFontFamily::ITALIC,
+                                             EpdFontFamily::BOLD_ITALIC};
+  const int lineHeight = r.getLineHeight(BOOKERLY_14_FONT_ID);
+  int y = 20;
+  for (const auto style : STYLES) {
+    text(r, counts, BOOKERLY_14_FONT_ID, 12, y, "Sphinx of black quartz, judge my vow!", true, style);
+    y += lineHeight;
+  }
+  // White text on black, partly off the right edge
+  r.fillRect(0, y, r.getScreenWidth(), lineHeight * 2, true);
+  area(counts, r.getScreenWidth(), lineHeight * 2);
+  text(r, counts, BOOKERLY_14_FONT_ID, 12, y, "Inverted text runs off the edge of the screen here and on", false);
+  text(r, counts, BOOKERLY_14_FONT_ID, -20, y + lineHeight, "and starts before it", false, EpdFontFamily::BOLD);
+}
+
+void drawKerningLigatures(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  const int lineHeight = r.getLineHeight(BOOKERLY_14_FONT_ID);
+  text(r, counts, BOOKERLY_14_FONT_ID, 12, 20, "AVA To Ta Yo We LT P. F, y.");
+  text(r, counts, BOOKERLY_14_FONT_ID, 12, 20 + lineHeight, "office fluffy affirm efficient shuffle");
+  text(r, counts, BOOKERLY_14_FONT_ID, 12, 20 + lineHeight * 2, "office fluffy affirm", true, EpdFontFamily::ITALIC);
+}
+
+void drawUnicode(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  const int lineHeight = r.getLineHeight(BOOKERLY_14_FONT_ID);
+  text(r, counts, BOOKERLY_14_FONT_ID, 12, 20, "“Quoted” — naïve café, Ångström");
+  text(r, counts, BOOKERLY_14_FONT_ID, 12, 20 + lineHeight, "ß æ œ ø … «» €");
+  // Code points the font does not have
+  text(r, counts, BOOKERLY_14_FONT_ID, 12, 20 + lineHeight * 2, "中文 \U0001F600 missing");
+}
+
+void drawClippedText(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  // Glyphs cut by each edge of the screen, upright and rotated, anti-aliased and 1-bit
+  const int width = r.getScreenWidth();
+  const int height = r.getScreenHeight();
+  text(r, counts, BOOKERLY_14_FONT_ID, -9, -12, "Cut by the top and left edges");
+  text(r, counts, BOOKERLY_14_FONT_ID, width - 120, height - 8, "Bottom right corner");
+  text(r, counts, UI_10_FONT_ID, -5, height / 2, "Left edge, 1-bit");
+  r.drawTextRotated90CW(BOOKERLY_14_FONT_ID, -10, 250, "Rotated off the top and left");
+  r.drawTextRotated90CW(UI_10_FONT_ID, width - 12, height + 6, "Rotated bottom");
+  counts.glyphs += 24 + 12;
+}
+
+void drawUi(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  text(r, counts, UI_12_FONT_ID, 10, 10, "Settings", true, EpdFontFamily::BOLD);
+  text(r, counts, UI_10_FONT_ID, 10, 40, "Reader font: Bookerly 14");
+  text(r, counts, UI_10_FONT_ID, 10, 60, "Selected row", false);
+  text(r, counts, SMALL_FONT_ID, 10, 90, "12/345  67%");
+  r.drawCenteredText(UI_12_FONT_ID, 120, "Centered title");
+  counts.glyphs += 13;
+  r.drawTextRotated90CW(UI_10_FONT_ID, 20, 300, "Rotated label");
+  counts.glyphs += 12;
+}
+
+// The calls LyraTheme makes for a battery icon, a header and the button hints, shared by the two menu scenes
+void drawMenuChrome(GfxRenderer& r, SceneCounts& counts, const int headerHeight, const char* title) {
+  const int width = r.getScreenWidth();
+  const int height = r.getScreenHeight();
+  r.fillRect(0, 5, width, headerHeight, false);
+  const int batteryX = width - 12 - 16;
+  r.drawLine(batteryX + 1, 10, batteryX + 13, 10);
+  r.drawLine(batteryX + 1, 21, batteryX + 13, 21);
+  r.drawLine(batteryX, 11, batteryX, 20);
+  r.drawLine(batteryX + 14, 11, batteryX + 14, 20);
+  r.drawPixel(batteryX + 15, 13);
+  r.drawPixel(batteryX + 15, 18);
+  r.drawLine(batteryX + 16, 14, batteryX + 16, 17);
+  for (int bar = 0; bar < 3; bar++) {
+    r.fillRect(batteryX + 2 + bar * 4, 12, 3, 8);
+  }
+  text(r, counts, SMALL_FONT_ID, batteryX - 30, 8, "87%");
+  area(counts, width, headerHeight);
+  if (title) {
+    text(r, counts, UI_12_FONT_ID, 20, 25, title, true, EpdFontFamily::BOLD);
+    r.drawLine(0, 5 + headerHeight - 3, width - 1, 5 + headerHeight - 3, 3, true);
+    area(counts, width, 3);
+  }
+
+  constexpr const char* LABELS[] = {"Back", "Select", "Up", "Down"};
+  for (int i = 0; i < 4; i++) {
+    const int x = 58 + i * (width - 138) / 3;
+    r.fillRoundedRect(x, height - 40, 80, 40, 6, Color::White);
+    r.drawRoundedRect(x, height - 40, 80, 40, 1, 6, true, true, false, false, true);
+    text(r, counts, SMALL_FONT_ID, x + 20, height - 33, LABELS[i]);
+    area(counts, 80, 40);
+  }
+}
+
+// HomeActivity with the Lyra theme: the selected recent book's tile and the menu buttons below it
+void drawHomeMenu(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  const int width = r.getScreenWidth();
+  const int tileWidth = width - 40;
+  const int coverHeight = std::min(226, r.getScreenHeight() / 3);
+  drawMenuChrome(r, counts, 56, nullptr);
+  r.fillRoundedRect(20, 61, tileWidth, 8, 6, true, true, false, false, Color::LightGray);
+  r.fillRectDither(20, 69, 8, coverHeight, Color::LightGray);
+  r.fillRectDither(178, 69, tileWidth - 158, coverHeight, Color::LightGray);
+  r.fillRoundedRect(20, 69 + coverHeight, tileWidth, 8, 6, false, false, true, true, Color::LightGray);
+  r.drawRect(28, 69, 150, coverHeight);
+  area(counts, tileWidth, coverHeight + 16);
+  text(r, counts, UI_12_FONT_ID, 194, 90, "A Tale of Two Cities", true, EpdFontFamily::BOLD);
+  text(r, counts, UI_10_FONT_ID, 194, 120, "Charles Dickens");
+
+  constexpr const char* ITEMS[] = {"Browse files", "Recent books", "File transfer", "Settings"};
+  const int menuY = 77 + coverHeight + 16;
+  const int rowPitch = std::min(72, (r.getScreenHeight() - 40 - menuY) / 4);
+  for (int i = 0; i < 4; i++) {
+    const int y = menuY + i * rowPitch;
+    if (i == 1) {
+      r.fillRoundedRect(20, y, tileWidth, rowPitch - 8, 6, Color::LightGray);
+      area(counts, tileWidth, rowPitch - 8);
+    }
+    text(r, counts, UI_12_FONT_ID, 78, y + (rowPitch - 8 - r.getLineHeight(UI_12_FONT_ID)) / 2, ITEMS[i]);
+  }
+}
+
+// SettingsActivity with the Lyra theme: header, category tabs and a page of the settings list
+void drawSettingsMenu(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  const int width = r.getScreenWidth();
+  drawMenuChrome(r, counts, 84, "Settings");
+
+  constexpr const char* TABS[] = {"Display", "Reader", "Controls", "System"};
+  int tabX = 20;
+  for (int i = 0; i < 4; i++) {
+    const int textWidth = r.getTextWidth(UI_10_FONT_ID, TABS[i]);
+    if (i == 1) {
+      r.fillRectDither(tabX, 89, textWidth + 16, 37, Color::LightGray);
+      r.drawLine(tabX, 126, tabX + textWidth + 16, 126, 2, true);
+      area(counts, textWidth + 16, 39);
+    }
+    text(r, counts, UI_10_FONT_ID, tabX + 8, 95, TABS[i]);
+    tabX += textWidth + 8 + 16;
+  }
+  r.drawLine(0, 128, width - 1, 128, true);
+
+  constexpr const char* NAMES[] = {"Font family", "Font size", "Line spacing", "Paragraph alignment",
+                                   "Hyphenation", "Text anti-aliasing", "Screen margin", "Extra paragraph spacing"};
+  constexpr const char* VALUES[] = {"Bookerly", "Medium", "Normal", "Justify", "On", "On", "5", "Off"};
+  const int listY = 145;
+  const int rows = std::min(8, (r.getScreenHeight() - 56 - listY) / 40);
+  const int contentWidth = width - 9;
+  r.drawLine(width - 5, listY, width - 5, listY + rows * 40, true);
+  r.fillRect(width - 9, listY, 4, rows * 40 / 2, true);
+  r.fillRoundedRect(20, listY + 2 * 40, contentWidth - 40, 40, 6, Color::LightGray);
+  area(counts, contentWidth - 40, 40);
+  for (int i = 0; i < rows; i++) {
+    const int y = listY + i * 40;
+    const int valueWidth = r.getTextWidth(UI_10_FONT_ID, VALUES[i]) + 8;
+    text(r, counts, UI_10_FONT_ID, 28, y + 7, NAMES[i]);
+    if (i == 2) {
+      r.fillRoundedRect(contentWidth - 28 - valueWidth, y, valueWidth + 8, 40, 6, Color::Black);
+      area(counts, valueWidth + 8, 40);
+    }
+    text(r, counts, UI_10_FONT_ID, contentWidth - 20 - valueWidth, y + 6, VALUES[i], i != 2);
+  }
+}
+
+void drawShapes(GfxRenderer& r, const std::string&, SceneCounts& counts) {
+  r.fillRect(10, 10, 120, 60, true);
+  area(counts, 120, 60);
+  r.drawRect(140, 10, 120, 60, true);
+  r.drawRect(270, 10, 120, 60, 4, true);
+  area(counts, 240, 60);
+  r.drawLine(10, 90, 400, 130, true);
+  r.drawLine(10, 140, 10, 260, true);
+  r.drawLine(20, 140, 400, 260, 3, true);
+  area(counts, 390 + 120 + 380 * 3, 1);
+  r.drawRoundedRect(10, 280, 200, 80, 2, 12, true);
+  r.fillRoundedRect(220, 280, 200, 80, 16, Color::Black);
+  r.fillRoundedRect(230, 290, 180, 60, 10, true, false, false, true, Color::LightGray);
+  area(counts, 400, 80);
+  constexpr Color COLORS[] = {Color::White, Color::LightGray, Color::DarkGray, Color::Black};
+  for (int i = 0; i < 4; i++) {
+    r.fillRectDither(10 + i * 100, 380, 90, 90, COLORS[i]);
+  }
+  area(counts, 360, 90);
+  const int xs[] = {50, 200, 150, 20};
+  const int ys[] = {500, 520, 640, 600};
+  r.fillPolygon(xs, ys, 4, true);
+  area(counts, 180, 140);
+  r.drawArc(40, 300, 560, 1, 1, 3, true);
+  r.drawArc(40, 300, 560, -1, -1, 3, true);
+  area(counts, 80, 80);
+  // Clipped at the screen edges
+  r.fillRect(-20, r.getScreenHeight() - 30, 60, 60, true);
+  r.fillRect(r.getScreenWidth() - 30, -20, 60, 60, true);
+  area(counts, 60, 60);
+}
+
+void drawBitmapFile(GfxRenderer& r, const std::string& path, const int x, const int y, const int maxWidth,
+                    const int maxHeight, SceneCounts& counts, const bool dithering = false, const float crop = 0) {
+  FsFile file;
+  if (!Storage.openFileForRead("GLD", path, file)) {
+    fprintf(stderr, "Missing %s\n", path.c_str());
+    return;
+  }
+  Bitmap bitmap(file, dithering);
+  if (bitmap.parseHeaders() != BmpReaderError::Ok) {
+    fprintf(stderr, "Bad bitmap %s\n", path.c_str());
+    return;
+  }
+  r.drawBitmap(bitmap, x, y, maxWidth, maxHeight, crop, crop);
+  area(counts, std::min(maxWidth, bitmap.getWidth()), std::min(maxHeight, bitmap.getHeight()));
+}
+
+void drawBitmaps(GfxRenderer& r, const std::string& workDir, SceneCounts& counts) {
+  drawBitmapFile(r, workDir + "/gradient_1.bmp", 10, 10, 200, 200, counts);
+  drawBitmapFile(r, workDir + "/gradient_2.bmp", 230, 10, 200, 200, counts);
+  drawBitmapFile(r, workDir + "/gradient_8.bmp", 10, 230, 200, 200, counts);
+  drawBitmapFile(r, workDir + "/gradient_24.bmp", 230, 230, 200, 200, counts, false, 0.2f);
+}
+
+// The home screen's cover thumbnails, which are cached at their display size, next to covers halved to fit and cropped
+// by an odd number of pixels
+void drawHomeCovers(GfxRenderer& r, const std::string& workDir, SceneCounts& counts) {
+  drawBitmapFile(r, workDir + "/cover_24.bmp", 28, 69, 150, 226, counts);
+  drawBitmapFile(r, workDir + "/cover_24.bmp", 190, 69, 150, 226, counts, true);
+  drawBitmapFile(r, workDir + "/photo_8.bmp", 10, 310, 300, 200, counts);
+  drawBitmapFile(r, workDir + "/photo_1.bmp", 10, 520, 300, 200, counts);
+  drawBitmapFile(r, workDir + "/gradient_8.bmp", 320, 310, 200, 200, counts, false, 0.05f);
+}
+
+// A full-screen sleep image: 1:1 in portrait, scaled down to the height in landscape
+void drawSleepScreen(GfxRenderer& r, const std::string& workDir, SceneCounts& counts) {
+  drawBitmapFile(r, workDir + "/sleep_8.bmp", 0, 0, r.getScreenWidth(), r.getScreenHeight(), counts);
+}
+
+void drawScaledBitmaps(GfxRenderer& r, const std::string& workDir, SceneCounts& counts) {
+  // Downscaled to fit, as covers and chapter images are
+  drawBitmapFile(r, workDir + "/photo_8.bmp", 0, 0, 480, 400, counts);
+  drawBitmapFile(r, workDir + "/photo_8.bmp", 0, 400, 240, 200, counts, true);
+  drawBitmapFile(r, workDir + "/photo_1.bmp", 240, 400, 240, 200, counts);
+}
+
+constexpr Scene SCENES[] = {
+    {"paragraph", drawParagraph, true},
+    {"styles", drawStyles, false},
+    {"kerning_ligatures", drawKerningLigatures, true},
+    {"unicode", drawUnicode, true},
+    {"clipped_text", drawClippedText, true},
+    {"ui", drawUi, false},
+    {"home_menu", drawHomeMenu, false},
+    {"settings_menu", drawSettingsMenu, false},
+    {"shapes", drawShapes, false},
+    {"bitmaps", drawBitmaps, true},
+    {"scaled_bitmaps", drawScaledBitmaps, true},
+    {"home_covers", drawHomeCovers, true},
+    {"sleep_screen", drawSleepScreen, true},
+};
+
+// Writes an uncompressed BMP whose grey level is f(x, y) in 0..255
+template <typename F>
+bool writeBmp(const std::string& path, const int width, const int height, const int bpp, const bool topDown, F f) {
+  const int rowBytes = (width * bpp + 31) / 32 * 4;
+  const int paletteSize = bpp <= 8 ? (1 << bpp) : 0;
+  const uint32_t dataOffset = 54 + paletteSize * 4;
+  std::vector<uint8_t> out(dataOffset + rowBytes * height, 0);
+  const auto put16 = [&out](const size_t at, const uint16_t v) {
+    out[at] = v & 0xFF;
+    out[at + 1] = v >> 8;
+  };
+  const auto put32 = [&put16](const size_t at, const uint32_t v) {
+    put16(at, v & 0xFFFF);
+    put16(at + 2, v >> 16);
+  };
+  out[0] = 'B';
+  out[1] = 'M';
+  put32(2, out.size());
+  put32(10, dataOffset);
+  put32(14, 40);
+  put32(18, width);
+  put32(22, topDown ? -height : height);
+  put16(26, 1);
+  put16(28, bpp);
+  for (int i = 0; i < paletteSize; i++) {
+    const uint8_t grey = i * 255 / (paletteSize - 1);
+    out[54 + i * 4] = out[55 + i * 4] = out[56 + i * 4] = grey;
+  }
+  for (int row = 0; row < height; row++) {
+    const int y = topDown ? row : height - 1 - row;
+    uint8_t* dst = &out[dataOffset + row * rowBytes];
+    for (int x = 0; x < width; x++) {
+      const uint8_t grey = f(x, y);
+      if (bpp == 24) {
+        dst[x * 3] = dst[x * 3 + 1] = dst[x * 3 + 2] = grey;
+      } else {
+        const int index = grey * paletteSize / 256;
+        const int bit = x * bpp;
+        dst[bit / 8] |= index << (8 - bpp - bit % 8);
+      }
+    }
+  }
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(out.data()), out.size());
+  return file.good();
+}
+
+bool writeBitmaps(const std::string& workDir) {
+  const auto gradient = [](const int x, const int y) { return static_cast<uint8_t>((x + y) * 255 / 398); };
+  // Smooth shading with detail, like a photo
+  const auto photo = [](const int x, const int y) {
+    const int dx = x - 300, dy = y - 200;
+    const int ring = ((dx * dx + dy * dy) / 400) % 64;
+    return static_cast<uint8_t>(std::min(255, x * 160 / 600 + ring * 2));
+  };
+  return writeBmp(workDir + "/gradient_1.bmp", 200, 200, 1, false, gradient) &&
+         writeBmp(workDir + "/gradient_2.bmp", 200, 200, 2, true, gradient) &&
+         writeBmp(workDir + "/gradient_8.bmp", 200, 200, 8, false, gradient) &&
+         writeBmp(workDir + "/gradient_24.bmp", 200, 200, 24, false, gradient) &&
+         writeBmp(workDir + "/photo_8.bmp", 600, 400, 8, false, photo) &&
+         writeBmp(workDir + "/photo_1.bmp", 600, 400, 1, false, photo) &&
+         writeBmp(workDir + "/cover_24.bmp", 150, 226, 24, true, photo) &&
+         writeBmp(workDir + "/sleep_8.bmp", 480, 800, 8, false, photo);
+}
+
+uint64_t fnv1a(const uint8_t* data, const size_t size) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ data[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Panel-oriented 1-bit image, black where the framebuffer bit is clear
+void writePbm(const std::string& path, const uint8_t* frameBuffer) {
+  std::ofstream file(path, std::ios::binary);
+  file << "P4\n" << HalDisplay::DISPLAY_WIDTH << " " << HalDisplay::DISPLAY_HEIGHT << "\n";
+  for (uint32_t i = 0; i < HalDisplay::BUFFER_SIZE; i++) {
+    file.put(static_cast<char>(~frameBuffer[i]));
+  }
+}
+
+// Same starting state as the reader: white for BW, cleared for the grayscale passes
+void drawFrame(GfxRenderer& renderer, const Scene& scene, const int orientation, const int mode,
+               const std::string& workDir, SceneCounts& counts) {
+  renderer.setOrientation(static_cast<GfxRenderer::Orientation>(orientation));
+  renderer.setRenderMode(static_cast<GfxRenderer::RenderMode>(mode));
+  renderer.clearScreen(mode == GfxRenderer::BW ? 0xFF : 0x00);
+  scene.draw(renderer, workDir, counts);
+}
+
+std::string key(const Scene& scene, const int orientation, const int mode) {
+  return std::string(scene.name) + " " + ORIENTATION_NAMES[orientation] + " " + MODE_NAMES[mode];
+}
+
+std::map<std::string, uint64_t> readGolden(const std::string& path) {
+  std::map<std::string, uint64_t> golden;
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    const size_t split = line.find_last_of(' ');
+    golden[line.substr(0, split)] = std::stoull(line.substr(split + 1), nullptr, 16);
+  }
+  return golden;
+}
+
+// Each dark-on-white scene drawn once in BW_AND_GRAYSCALE mode has to give the same BW frame and grayscale planes as
+// the three separate passes, and the BW frame again once the grayscale layer has been shown
+int checkSinglePass(GfxRenderer& renderer, const HalDisplay& display, const std::string& workDir,
+                    const std::map<std::string, uint64_t>& golden) {
+  int mismatches = 0;
+  for (const auto& scene : SCENES) {
+    if (!scene.darkOnWhite) {
+      continue;
+    }
+    for (int orientation = 0; orientation < 4; orientation++) {
+      SceneCounts counts;
+      renderer.setOrientation(static_cast<GfxRenderer::Orientation>(orientation));
+      renderer.clearScreen();
+      if (!renderer.beginGrayscaleCapture()) {
+        printf("Failed to start a grayscale capture\n");
+        return 1;
+      }
+      scene.draw(renderer, workDir, counts);
+      renderer.endGrayscaleCapture();
+      const uint64_t bw = fnv1a(renderer.getFrameBuffer(), GfxRenderer::getBufferSize());
+      renderer.displayCapturedGrayscale();
+      const uint64_t planes[] = {bw, fnv1a(display.getGrayscaleLsb(), GfxRenderer::getBufferSize()),
+                                 fnv1a(display.getGrayscaleMsb(), GfxRenderer::getBufferSize())};
+      for (int mode = 0; mode < 3; mode++) {
+        const auto it = golden.find(key(scene, orientation, mode));
+        if (it != golden.end() && it->second != planes[mode]) {
+          printf("SINGLE PASS MISMATCH %s: expected %016" PRIx64 ", got %016" PRIx64 "\n",
+                 key(scene, orientation, mode).c_str(), it->second, planes[mode]);
+          mismatches++;
+        }
+      }
+      if (fnv1a(renderer.getFrameBuffer(), GfxRenderer::getBufferSize()) != bw) {
+        printf("SINGLE PASS MISMATCH %s %s: BW frame not restored\n", scene.name, ORIENTATION_NAMES[orientation]);
+        mismatches++;
+      }
+    }
+  }
+  renderer.setOrientation(GfxRenderer::Portrait);
+  return mismatches;
+}
+
+int runGolden(GfxRenderer& renderer, const HalDisplay& display, const std::string& workDir,
+              const std::string& goldenPath, const bool update, const bool dump) {
+  const auto golden = readGolden(goldenPath);
+  std::ostringstream updated;
+  updated << "# Framebuffer hashes (FNV-1a 64) for test/run_renderer_golden.sh; regenerate with --update\n";
+  int mismatches = 0, missing = 0, frames = 0;
+  for (const auto& scene : SCENES) {
+    for (int orientation = 0; orientation < 4; orientation++) {
+      for (int mode = 0; mode < 3; mode++) {
+        SceneCounts counts;
+        drawFrame(renderer, scene, orientation, mode, workDir, counts);
+        const uint64_t hash = fnv1a(renderer.getFrameBuffer(), GfxRenderer::getBufferSize());
+        const std::string name = key(scene, orientation, mode);
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016" PRIx64, hash);
+        updated << name << " " << hex << "\n";
+        frames++;
+
+        const auto it = golden.find(name);
+        const bool matches = it != golden.end() && it->second == hash;
+        if (!update && it == golden.end()) {
+          printf("MISSING  %s (%s)\n", name.c_str(), hex);
+          missing++;
+        } else if (!update && !matches) {
+          printf("MISMATCH %s: expected %016" PRIx64 ", got %s\n", name.c_str(), it->second, hex);
+          mismatches++;
+        }
+        if (dump) {
+          std::string file = name;
+          std::replace(file.begin(), file.end(), ' ', '_');
+          writePbm(workDir + "/" + file + ".pbm", renderer.getFrameBuffer());
+        }
+      }
+    }
+  }
+  renderer.setOrientation(GfxRenderer::Portrait);
+  renderer.setRenderMode(GfxRenderer::BW);
+
+  if (update) {
+    std::ofstream(goldenPath) << updated.str();
+    printf("Wrote %d hashes to %s\n", frames, goldenPath.c_str());
+    return 0;
+  }
+  printf("%d frames: %d matched, %d mismatched, %d missing\n", frames, frames - mismatches - missing, mismatches,
+         missing);
+  const int singlePassMismatches = checkSinglePass(renderer, display, workDir, golden);
+  printf("Single pass: %d mismatched\n", singlePassMismatches);
+  return mismatches + missing + singlePassMismatches > 0 ? 1 : 0;
+}
+
+// Each scene in every orientation and mode, repeated for about BENCH_SECONDS; clearing is not timed
+void runBench(GfxRenderer& renderer, const std::string& workDir) {
+  constexpr double BENCH_SECONDS = 0.5;
+  using Clock = std::chrono::steady_clock;
+  printf("%-20s %10s %14s %14s\n", "scene", "frames/s", "glyphs/s", "pixels/s");
+  double totalSeconds = 0;
+  SceneCounts total;
+  for (const auto& scene : SCENES) {
+    double seconds = 0;
+    uint64_t frames = 0;
+    SceneCounts counts;
+    while (seconds < BENCH_SECONDS) {
+      for (int orientation = 0; orientation < 4; orientation++) {
+        for (int mode = 0; mode < 3; mode++) {
+          renderer.setOrientation(static_cast<GfxRenderer::Orientation>(orientation));
+          renderer.setRenderMode(static_cast<GfxRenderer::RenderMode>(mode));
+          renderer.clearScreen(mode == GfxRenderer::BW ? 0xFF : 0x00);
+          const auto start = Clock::now();
+          scene.draw(renderer, workDir, counts);
+          seconds += std::chrono::duration<double>(Clock::now() - start).count();
+          frames++;
+        }
+      }
+    }
+    printf("%-20s %10.0f %14.0f %14.0f\n", scene.name, frames / seconds, counts.glyphs / seconds,
+           counts.pixels / seconds);
+    totalSeconds += seconds;
+    total.glyphs += counts.glyphs;
+    total.pixels += counts.pixels;
+  }
+  printf("%-20s %10s %14.0f %14.0f\n", "all", "", total.glyphs / totalSeconds, total.pixels / totalSeconds);
+
+  // Glyphs per second of the paragraph alone for each orientation: anti-aliased in each mode (the last column draws
+  // all three planes in one pass), then in the 1-bit UI font
+  printf("\n%-20s %12s %12s %12s %12s %12s\n", "glyphs/s", "bw", "lsb", "msb", "bw+gray", "1-bit bw");
+  for (int orientation = 0; orientation < 4; orientation++) {
+    renderer.setOrientation(static_cast<GfxRenderer::Orientation>(orientation));
+    printf("%-20s", ORIENTATION_NAMES[orientation]);
+    for (int column = 0; column < 5; column++) {
+      const int fontId = column == 4 ? UI_10_FONT_ID : BOOKERLY_14_FONT_ID;
+      const auto mode = static_cast<GfxRenderer::RenderMode>(column == 4 ? GfxRenderer::BW : column);
+      double seconds = 0;
+      SceneCounts counts;
+      while (seconds < BENCH_SECONDS / 2) {
+        renderer.setRenderMode(GfxRenderer::BW);
+        renderer.clearScreen(mode == GfxRenderer::BW || mode == GfxRenderer::BW_AND_GRAYSCALE ? 0xFF : 0x00);
+        if (mode == GfxRenderer::BW_AND_GRAYSCALE) {
+          renderer.beginGrayscaleCapture();
+        } else {
+          renderer.setRenderMode(mode);
+        }
+        const auto start = Clock::now();
+        int y = 20;
+        for (const char* line : PARAGRAPH) {
+          text(renderer, counts, fontId, 12, y, line);
+          y += renderer.getLineHeight(fontId);
+        }
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        if (mode == GfxRenderer::BW_AND_GRAYSCALE) {
+          renderer.endGrayscaleCapture();
+          renderer.displayCapturedGrayscale();
+        }
+      }
+      printf(" %12.0f", counts.glyphs / seconds);
+    }
+    printf("\n");
+  }
+  renderer.setOrientation(GfxRenderer::Portrait);
+  renderer.setRenderMode(GfxRenderer::BW);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool update = false, bench = false, dump = false;
+  int arg = 1;
+  for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++) {
+    if (strcmp(argv[arg], "--update") == 0) {
+      update = true;
+    } else if (strcmp(argv[arg], "--bench") == 0) {
+      bench = true;
+    } else if (strcmp(argv[arg], "--dump") == 0) {
+      dump = true;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", argv[arg]);
+      return 2;
+    }
+  }
+  if (argc - arg != 2) {
+    fprintf(stderr, "Usage: %s [--update | --bench] [--dump] <work dir> <golden file>\n", argv[0]);
+    return 2;
+  }
+  const std::string workDir = argv[arg];
+  const std::string goldenPath = argv[arg + 1];
+  if (!writeBitmaps(workDir)) {
+    fprintf(stderr, "Failed to write test bitmaps to %s\n", workDir.c_str());
+    return 2;
+  }
+
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  renderer.begin();
+  FontDecompressor fontDecompressor;
+  if (!fontDecompressor.init()) {
+    fprintf(stderr, "Failed to initialize the font decompressor\n");
+    return 2;
+  }
+  renderer.setFontDecompressor(&fontDecompressor);
+  renderer.insertFont(BOOKERLY_14_FONT_ID, bookerly14FontFamily);
+  renderer.insertFont(UI_10_FONT_ID, ui10FontFamily);
+  renderer.insertFont(UI_12_FONT_ID, ui12FontFamily);
+  renderer.insertFont(SMALL_FONT_ID, smallFontFamily);
+
+  const int result =
+      bench ? (runBench(renderer, workDir), 0) : runGolden(renderer, display, workDir, goldenPath, update, dump);
+  fontDecompressor.deinit();
+  return result;
+}
@@ -0,0 +1,100 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/layout_bench"
+BINARY="$BUILD_DIR/LayoutBenchmark"
+
+mkdir -p "$BUILD_DIR"
+
+SOURCES=(
+  "$ROOT_DIR/test/layout_bench/LayoutBenchmark.cpp"
+  "$ROOT_DIR/lib/Epub/Epub.cpp"
+  "$ROOT_DIR"/lib/Epub/Epub/*.cpp
+  "$ROOT_DIR"/lib/Epub/Epub/blocks/*.cpp
+  "$ROOT_DIR"/lib/Epub/Epub/converters/*.cpp
+  "$ROOT_DIR"/lib/Epub/Epub/css/*.cpp
+  "$ROOT_DIR"/lib/Epub/Epub/hyphenation/*.cpp
+  "$ROOT_DIR"/lib/Epub/Epub/parsers/*.cpp
+  "$ROOT_DIR"/lib/EpdFont/*.cpp
+  "$ROOT_DIR"/lib/GfxRenderer/*.cpp
+  "$ROOT_DIR/lib/PerfTrace/HeapTrace.cpp"
+  "$ROOT_DIR/lib/PerfTrace/PerfTrace.cpp"
+  "$ROOT_DIR/lib/PerfTrace/SdTrace.cpp"
+  "$ROOT_DIR/lib/FsHelpers/FsHelpers.cpp"
+  "$ROOT_DIR/lib/InflateReader/InflateReader.cpp"
+  "$ROOT_DIR/lib/JpegToBmpConverter/JpegToBmpConverter.cpp"
+  "$ROOT_DIR/lib/PngToBmpConverter/PngToBmpConverter.cpp"
+  "$ROOT_DIR/lib/Serialization/BufferedFs.cpp"
+  "$ROOT_DIR/lib/Utf8/Utf8.cpp"
+  "$ROOT_DIR/lib/ZipFile/ZipFile.cpp"
+  "$ROOT_DIR/lib/ZipFile/ZipIndex.cpp"
+)
+
+C_SOURCES=(
+  "$ROOT_DIR/lib/expat/xmlparse.c"
+  "$ROOT_DIR/lib/expat/xmlrole.c"
+  "$ROOT_DIR/lib/expat/xmltok.c"
+  "$ROOT_DIR/lib/picojpeg/picojpeg.c"
+  "$ROOT_DIR/lib/uzlib/src/tinflate.c"
+)
+
+# Same expat configuration as platformio.ini
+DEFINES=(
+  -DXML_GE=0
+  -DXML_CONTEXT_BYTES=1024
+  -DENABLE_HEAP_TRACE
+  -DENABLE_SD_TRACE
+)
+
+INCLUDES=(
+  -I"$ROOT_DIR/test/host"
+  -I"$ROOT_DIR/lib"
+  -I"$ROOT_DIR/lib/Epub"
+  -I"$ROOT_DIR/lib/EpdFont"
+  -I"$ROOT_DIR/lib/FsHelpers"
+  -I"$ROOT_DIR/lib/GfxRenderer"
+  -I"$ROOT_DIR/lib/PerfTrace"
+  -I"$ROOT_DIR/lib/InflateReader"
+  -I"$ROOT_DIR/lib/JpegToBmpConverter"
+  -I"$ROOT_DIR/lib/PngToBmpConverter"
+  -I"$ROOT_DIR/lib/Serialization"
+  -I"$ROOT_DIR/lib/Utf8"
+  -I"$ROOT_DIR/lib/ZipFile"
+  -I"$ROOT_DIR/lib/expat"
+  -I"$ROOT_DIR/lib/picojpeg"
+  -I"$ROOT_DIR/lib/uzlib/src"
+)
+
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -Wall
+  -Wextra
+  -Wno-unused-parameter
+  -ffunction-sections
+)
+
+OPTIONS=()
+while [ "$#" -gt 0 ] && [[ "$1" == --* ]]; do
+  OPTIONS+=("$1")
+  shift
+done
+
+# The heap budgets are measured on the bundled books, so they only apply to those
+if [ "$#" -eq 0 ]; then
+  OPTIONS+=("--heap-budgets=$ROOT_DIR/test/layout_bench/heap_budgets.txt")
+  set -- "$ROOT_DIR"/test/epubs/*.epub
+fi
+
+OBJECTS=()
+for src in "${C_SOURCES[@]}"; do
+  obj="$BUILD_DIR/$(basename "${src%.c}").o"
+  cc -O2 -ffunction-sections "${DEFINES[@]}" "${INCLUDES[@]}" -c "$src" -o "$obj"
+  OBJECTS+=("$obj")
+done
+
+c++ "${CXXFLAGS[@]}" "${DEFINES[@]}" "${INCLUDES[@]}" "${SOURCES[@]}" "${OBJECTS[@]}" -Wl,--gc-sections \
+  -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=free -o "$BINARY"
+
+"$BINARY" ${OPTIONS[@]+"${OPTIONS[@]}"} "$BUILD_DIR" "$@"
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/renderer_golden"
+BINARY="$BUILD_DIR/RendererGoldenTest"
+
+mkdir -p "$BUILD_DIR"
+
+SOURCES=(
+  "$ROOT_DIR/test/renderer_golden/RendererGoldenTest.cpp"
+  "$ROOT_DIR"/lib/EpdFont/*.cpp
+  "$ROOT_DIR"/lib/GfxRenderer/*.cpp
+  "$ROOT_DIR/lib/PerfTrace/PerfTrace.cpp"
+  "$ROOT_DIR/lib/InflateReader/InflateReader.cpp"
+  "$ROOT_DIR/lib/Utf8/Utf8.cpp"
+)
+
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -Wall
+  -Wextra
+  -DHOST_LOG_QUIET
+  -I"$ROOT_DIR/test/host"
+  -I"$ROOT_DIR/lib/EpdFont"
+  -I"$ROOT_DIR/lib/GfxRenderer"
+  -I"$ROOT_DIR/lib/PerfTrace"
+  -I"$ROOT_DIR/lib/InflateReader"
+  -I"$ROOT_DIR/lib/Utf8"
+  -I"$ROOT_DIR/lib/uzlib/src"
+  -ffunction-sections
+)
+
+cc -O2 -ffunction-sections -I"$ROOT_DIR/lib/uzlib/src" -c "$ROOT_DIR/lib/uzlib/src/tinflate.c" -o "$BUILD_DIR/tinflate.o"
+c++ "${CXXFLAGS[@]}" "${SOURCES[@]}" "$BUILD_DIR/tinflate.o" -Wl,--gc-sections -o "$BINARY"
+
+# Options: --update to rewrite the golden hashes, --bench for throughput, --dump to write the frames as PBM images
+"$BINARY" "$@" "$BUILD_DIR" "$ROOT_DIR/test/renderer_golden/golden.txt"
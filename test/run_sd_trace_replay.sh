@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/sd_trace"
+BINARY="$BUILD_DIR/SdTraceReplay"
+
+mkdir -p "$BUILD_DIR"
+
+c++ -std=c++20 -O2 -Wall -Wextra -I"$ROOT_DIR/lib/PerfTrace" "$ROOT_DIR/test/sd_trace/SdTraceReplay.cpp" -o "$BINARY"
+
+OPTIONS=()
+while [ "$#" -gt 0 ] && [[ "$1" == --* ]]; do
+  OPTIONS+=("$1")
+  shift
+done
+
+# Without a trace, record one from the layout benchmark laying out the bundled books
+if [ "$#" -eq 0 ]; then
+  "$ROOT_DIR/test/run_layout_bench.sh" --no-render --sd-trace="$BUILD_DIR/layout.sdtrace" > /dev/null
+  set -- "$BUILD_DIR/layout.sdtrace"
+fi
+
+"$BINARY" ${OPTIONS[@]+"${OPTIONS[@]}"} "$@"
@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/serialization_bench"
+BINARY="$BUILD_DIR/SerializationBenchmark"
+
+mkdir -p "$BUILD_DIR"
+
+SOURCES=(
+  "$ROOT_DIR/test/serialization_bench/SerializationBenchmark.cpp"
+  "$ROOT_DIR/lib/Serialization/BufferedFs.cpp"
+  "$ROOT_DIR/lib/Epub/Epub/BookMetadataCache.cpp"
+  "$ROOT_DIR/lib/Epub/Epub/PageArena.cpp"
+  "$ROOT_DIR/lib/Epub/Epub/SectionDictionary.cpp"
+  "$ROOT_DIR/lib/Epub/Epub/css/CssParser.cpp"
+  "$ROOT_DIR/lib/FsHelpers/FsHelpers.cpp"
+  "$ROOT_DIR/lib/ZipFile/ZipFile.cpp"
+  "$ROOT_DIR/lib/ZipFile/ZipIndex.cpp"
+  "$ROOT_DIR/lib/InflateReader/InflateReader.cpp"
+)
+
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -Wall
+  -Wextra
+  -I"$ROOT_DIR/test/host"
+  -I"$ROOT_DIR/lib/Epub"
+  -I"$ROOT_DIR/lib/Epub/Epub"
+  -I"$ROOT_DIR/lib/FsHelpers"
+  -I"$ROOT_DIR/lib/ZipFile"
+  -I"$ROOT_DIR/lib/InflateReader"
+  -I"$ROOT_DIR/lib/PerfTrace"
+  -I"$ROOT_DIR/lib/Serialization"
+  -I"$ROOT_DIR/lib/uzlib/src"
+  -ffunction-sections
+)
+
+if [ "$#" -eq 0 ]; then
+  set -- "$ROOT_DIR"/test/epubs/*.epub
+fi
+
+cc -O2 -ffunction-sections -I"$ROOT_DIR/lib/uzlib/src" -c "$ROOT_DIR/lib/uzlib/src/tinflate.c" -o "$BUILD_DIR/tinflate.o"
+c++ "${CXXFLAGS[@]}" "${SOURCES[@]}" "$BUILD_DIR/tinflate.o" -Wl,--gc-sections \
+  -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -o "$BINARY"
+
+"$BINARY" "$BUILD_DIR" "$@"
@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/zip_index_bench"
+BINARY="$BUILD_DIR/ZipIndexBenchmark"
+
+mkdir -p "$BUILD_DIR"
+
+SOURCES=(
+  "$ROOT_DIR/test/zip_index_bench/ZipIndexBenchmark.cpp"
+  "$ROOT_DIR/lib/ZipFile/ZipFile.cpp"
+  "$ROOT_DIR/lib/ZipFile/ZipIndex.cpp"
+  "$ROOT_DIR/lib/InflateReader/InflateReader.cpp"
+)
+
+CXXFLAGS=(
+  -std=c++20
+  -O2
+  -Wall
+  -Wextra
+  -I"$ROOT_DIR/test/host"
+  -I"$ROOT_DIR/lib/ZipFile"
+  -I"$ROOT_DIR/lib/InflateReader"
+  -I"$ROOT_DIR/lib/Serialization"
+  -I"$ROOT_DIR/lib/uzlib/src"
+  -ffunction-sections
+)
+
+cc -O2 -ffunction-sections -I"$ROOT_DIR/lib/uzlib/src" -c "$ROOT_DIR/lib/uzlib/src/tinflate.c" -o "$BUILD_DIR/tinflate.o"
+c++ "${CXXFLAGS[@]}" "${SOURCES[@]}" "$BUILD_DIR/tinflate.o" -Wl,--gc-sections -o "$BINARY"
+
+"$BINARY" "$BUILD_DIR" "$@"
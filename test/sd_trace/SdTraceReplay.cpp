@@ -0,0 +1,350 @@
+// Summarises an SD access trace recorded with ENABLE_SD_TRACE (see lib/PerfTrace/SdTrace.h): calls and bytes per
+// operation, read and write size histograms, seek distances and the files that took the most card time.
+//
+// With --replay, the trace is also played back against a POSIX directory holding a copy of the card, so a change to a
+// cache layout can be compared without the device: lay out a book both ways, copy each card image, and replay the
+// same reader session against both. Writes are replayed as zeros, so replay against a copy. --map rewrites a path
+// prefix first, e.g. to point a trace at a renamed cache directory.
+//
+// Usage: SdTraceReplay [--top=<n>] [--replay=<root>] [--map=<from>=<to>]... <trace file>
+
+#include <SdTrace.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using perf::SdOp;
+using perf::SdTraceRecord;
+
+constexpr int OP_COUNT = 5;
+constexpr const char* OP_NAMES[OP_COUNT] = {"open", "close", "read", "write", "seek"};
+
+// Upper bounds of the histogram buckets; the last bucket is everything above
+constexpr uint32_t SIZE_BUCKETS[] = {1, 16, 64, 256, 1024, 4096, 16384};
+constexpr uint32_t SEEK_BUCKETS[] = {0, 512, 4096, 65536, 1048576};
+
+struct Histogram {
+  std::vector<uint32_t> bounds;
+  std::vector<uint64_t> counts;
+
+  template <size_t N>
+  explicit Histogram(const uint32_t (&b)[N]) : bounds(b, b + N), counts(N + 1) {}
+
+  void add(const uint64_t value) {
+    size_t i = 0;
+    while (i < bounds.size() && value > bounds[i]) i++;
+    counts[i]++;
+  }
+
+  void print(const char* title) const {
+    printf("%s\n", title);
+    uint64_t total = 0;
+    for (const uint64_t c : counts) total += c;
+    if (total == 0) {
+      printf("  (none)\n");
+      return;
+    }
+    for (size_t i = 0; i < counts.size(); i++) {
+      char label[32];
+      if (i < bounds.size()) {
+        snprintf(label, sizeof(label), "<= %u", bounds[i]);
+      } else {
+        snprintf(label, sizeof(label), "> %u", bounds.back());
+      }
+      printf("  %-12s %10llu  %5.1f%%\n", label, static_cast<unsigned long long>(counts[i]), 100.0 * counts[i] / total);
+    }
+  }
+};
+
+struct OpTotals {
+  uint64_t calls = 0;
+  uint64_t bytes = 0;
+  uint64_t timeUs = 0;
+  uint64_t failed = 0;
+};
+
+struct FileTotals {
+  uint64_t calls = 0;
+  uint64_t reads = 0;
+  uint64_t bytesRead = 0;
+  uint64_t writes = 0;
+  uint64_t bytesWritten = 0;
+  uint64_t seeks = 0;
+  uint64_t timeUs = 0;
+  double replayUs = 0;
+};
+
+struct Trace {
+  perf::SdTraceHeader header{};
+  std::vector<SdTraceRecord> records;  // Oldest first
+  std::unordered_map<uint16_t, std::string> paths;
+
+  const std::string& path(const uint16_t id) const {
+    static const std::string unknown = "(not opened through HalStorage)";
+    const auto it = paths.find(id);
+    return it == paths.end() ? unknown : it->second;
+  }
+};
+
+bool loadTrace(const std::string& file, Trace& trace) {
+  FILE* f = fopen(file.c_str(), "rb");
+  if (!f) {
+    fprintf(stderr, "Cannot open %s\n", file.c_str());
+    return false;
+  }
+  auto& h = trace.header;
+  if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != perf::SD_TRACE_MAGIC || h.version != perf::SD_TRACE_VERSION ||
+      h.recordSize != sizeof(SdTraceRecord) || h.capacity == 0) {
+    fprintf(stderr, "%s is not a version %u SD trace\n", file.c_str(), perf::SD_TRACE_VERSION);
+    fclose(f);
+    return false;
+  }
+
+  // The ring holds the last `capacity` records; once it has wrapped, the oldest sits where the next would go
+  const uint32_t count = std::min(h.total, h.capacity);
+  std::vector<SdTraceRecord> ring(count);
+  if (count > 0 && fread(ring.data(), sizeof(SdTraceRecord), count, f) != count) {
+    fprintf(stderr, "%s is truncated\n", file.c_str());
+    fclose(f);
+    return false;
+  }
+  fclose(f);
+  const uint32_t oldest = h.total > h.capacity ? h.total % h.capacity : 0;
+  trace.records.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    trace.records.push_back(ring[(oldest + i) % count]);
+  }
+
+  std::ifstream paths(file + ".paths");
+  std::string line;
+  while (std::getline(paths, line)) {
+    const size_t space = line.find(' ');
+    if (space == std::string::npos) continue;
+    trace.paths[static_cast<uint16_t>(std::stoul(line.substr(0, space)))] = line.substr(space + 1);
+  }
+  return true;
+}
+
+void summarise(const Trace& trace, std::unordered_map<uint16_t, FileTotals>& files) {
+  OpTotals ops[OP_COUNT];
+  Histogram readSizes(SIZE_BUCKETS);
+  Histogram writeSizes(SIZE_BUCKETS);
+  Histogram seekDistances(SEEK_BUCKETS);
+  uint64_t backwardSeeks = 0;
+  std::unordered_map<uint16_t, uint64_t> positions;
+
+  for (const auto& r : trace.records) {
+    if (r.op >= OP_COUNT) continue;
+    OpTotals& op = ops[r.op];
+    op.calls++;
+    op.timeUs += r.durationUs;
+    if (r.flags & perf::SD_TRACE_FAILED) op.failed++;
+    FileTotals& file = files[r.pathId];
+    file.calls++;
+    file.timeUs += r.durationUs;
+
+    uint64_t& position = positions[r.pathId];
+    switch (static_cast<SdOp>(r.op)) {
+      case SdOp::Open:
+        position = 0;
+        break;
+      case SdOp::Read:
+        op.bytes += r.length;
+        readSizes.add(r.length);
+        file.reads++;
+        file.bytesRead += r.length;
+        position = r.offset + r.length;
+        break;
+      case SdOp::Write:
+        op.bytes += r.length;
+        writeSizes.add(r.length);
+        file.writes++;
+        file.bytesWritten += r.length;
+        position = r.offset + r.length;
+        break;
+      case SdOp::Seek:
+        // Distance from where the previous call on this file left off
+        seekDistances.add(r.offset > position ? r.offset - position : position - r.offset);
+        if (r.offset < position) backwardSeeks++;
+        file.seeks++;
+        position = r.offset;
+        break;
+      case SdOp::Close:
+        break;
+    }
+  }
+
+  const auto& h = trace.header;
+  const double spanS =
+      trace.records.empty() ? 0 : (trace.records.back().startUs - trace.records.front().startUs) / 1e6;
+  printf("%zu calls over %.1f s, %zu paths", trace.records.size(), spanS, trace.paths.size());
+  if (h.total > h.capacity) {
+    printf(" (the ring kept the last %u of %u calls)", h.capacity, h.total);
+  }
+  printf("\n\n%-8s %10s %14s %12s %10s %8s\n", "op", "calls", "bytes", "card ms", "mean us", "failed");
+  for (int i = 0; i < OP_COUNT; i++) {
+    const OpTotals& op = ops[i];
+    printf("%-8s %10llu %14llu %12.1f %10.1f %8llu\n", OP_NAMES[i], static_cast<unsigned long long>(op.calls),
+           static_cast<unsigned long long>(op.bytes), op.timeUs / 1000.0,
+           op.calls ? static_cast<double>(op.timeUs) / op.calls : 0.0, static_cast<unsigned long long>(op.failed));
+  }
+  printf("\n");
+  readSizes.print("Read sizes (bytes)");
+  writeSizes.print("Write sizes (bytes)");
+  seekDistances.print("Seek distance (bytes from the file's previous position)");
+  printf("  backward     %10llu\n", static_cast<unsigned long long>(backwardSeeks));
+}
+
+void printFiles(const Trace& trace, const std::unordered_map<uint16_t, FileTotals>& files, const size_t top,
+                const bool replayed) {
+  std::vector<std::pair<uint16_t, FileTotals>> sorted(files.begin(), files.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const auto& a, const auto& b) { return a.second.timeUs > b.second.timeUs; });
+  printf("\nFiles by card time (top %zu of %zu)\n", std::min(top, sorted.size()), sorted.size());
+  printf("  %10s %8s %8s %12s %8s %12s %8s", "card ms", "calls", "reads", "bytes read", "writes", "bytes written",
+         "seeks");
+  if (replayed) printf(" %10s", "replay ms");
+  printf("  path\n");
+  for (size_t i = 0; i < sorted.size() && i < top; i++) {
+    const FileTotals& f = sorted[i].second;
+    printf("  %10.1f %8llu %8llu %12llu %8llu %12llu %8llu", f.timeUs / 1000.0,
+           static_cast<unsigned long long>(f.calls), static_cast<unsigned long long>(f.reads),
+           static_cast<unsigned long long>(f.bytesRead), static_cast<unsigned long long>(f.writes),
+           static_cast<unsigned long long>(f.bytesWritten), static_cast<unsigned long long>(f.seeks));
+    if (replayed) printf(" %10.1f", f.replayUs / 1000.0);
+    printf("  %s\n", trace.path(sorted[i].first).c_str());
+  }
+}
+
+std::string replayPath(const std::string& path, const std::string& root,
+                       const std::vector<std::pair<std::string, std::string>>& maps) {
+  std::string mapped = path;
+  for (const auto& [from, to] : maps) {
+    if (mapped.compare(0, from.size(), from) == 0) {
+      mapped = to + mapped.substr(from.size());
+      break;
+    }
+  }
+  return root + mapped;
+}
+
+void replay(const Trace& trace, const std::string& root, const std::vector<std::pair<std::string, std::string>>& maps,
+            std::unordered_map<uint16_t, FileTotals>& files) {
+  using Clock = std::chrono::steady_clock;
+  std::unordered_map<uint16_t, int> fds;
+  std::vector<uint8_t> buffer;
+  double opUs[OP_COUNT] = {};
+  uint64_t skipped = 0;
+  uint64_t missing = 0;
+
+  for (const auto& r : trace.records) {
+    if (r.op >= OP_COUNT || r.pathId == 0 || (r.flags & perf::SD_TRACE_FAILED)) {
+      skipped++;
+      continue;
+    }
+    const auto op = static_cast<SdOp>(r.op);
+    auto fd = fds.find(r.pathId);
+    if (op != SdOp::Open && fd == fds.end()) {
+      skipped++;
+      continue;
+    }
+    if (buffer.size() < r.length) buffer.resize(r.length);
+
+    const auto start = Clock::now();
+    switch (op) {
+      case SdOp::Open: {
+        if (fd != fds.end()) close(fd->second);
+        const std::string path = replayPath(trace.path(r.pathId), root, maps);
+        const int flags = (r.flags & perf::SD_TRACE_WRITE_MODE) ? O_RDWR | O_CREAT : O_RDONLY;
+        const int opened = open(path.c_str(), flags, 0644);
+        if (opened < 0) {
+          missing++;
+          fds.erase(r.pathId);
+        } else {
+          fds[r.pathId] = opened;
+        }
+        break;
+      }
+      case SdOp::Close:
+        close(fd->second);
+        fds.erase(fd);
+        break;
+      case SdOp::Read:
+        if (pread(fd->second, buffer.data(), r.length, r.offset) < 0) skipped++;
+        break;
+      case SdOp::Write:
+        std::fill(buffer.begin(), buffer.begin() + r.length, 0);
+        if (pwrite(fd->second, buffer.data(), r.length, r.offset) < 0) skipped++;
+        break;
+      case SdOp::Seek:
+        lseek(fd->second, r.offset, SEEK_SET);
+        break;
+    }
+    const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    opUs[r.op] += us;
+    files[r.pathId].replayUs += us;
+  }
+  for (const auto& [id, fd] : fds) close(fd);
+
+  double total = 0;
+  for (const double us : opUs) total += us;
+  printf("\nReplay against %s: %.1f ms (", root.empty() ? "/" : root.c_str(), total / 1000.0);
+  for (int i = 0; i < OP_COUNT; i++) printf("%s%s %.1f ms", i ? ", " : "", OP_NAMES[i], opUs[i] / 1000.0);
+  printf("), %llu calls skipped, %llu files missing\n", static_cast<unsigned long long>(skipped),
+         static_cast<unsigned long long>(missing));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t top = 15;
+  bool doReplay = false;
+  std::string root;
+  std::vector<std::pair<std::string, std::string>> maps;
+  int arg = 1;
+  for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++) {
+    const char* opt = argv[arg];
+    if (strncmp(opt, "--top=", 6) == 0) {
+      top = strtoul(opt + 6, nullptr, 10);
+    } else if (strncmp(opt, "--replay=", 9) == 0) {
+      doReplay = true;
+      root = opt + 9;
+      // Trace paths are absolute, so the root must not end in a separator
+      while (!root.empty() && root.back() == '/') root.pop_back();
+    } else if (strncmp(opt, "--map=", 6) == 0 && strchr(opt + 6, '=')) {
+      const char* eq = strchr(opt + 6, '=');
+      maps.emplace_back(std::string(opt + 6, eq), std::string(eq + 1));
+    } else {
+      fprintf(stderr, "Unknown option %s\n", opt);
+      return 1;
+    }
+  }
+  if (argc - arg != 1) {
+    fprintf(stderr, "Usage: %s [--top=<n>] [--replay=<root>] [--map=<from>=<to>]... <trace file>\n", argv[0]);
+    return 1;
+  }
+
+  Trace trace;
+  if (!loadTrace(argv[arg], trace)) {
+    return 1;
+  }
+  std::unordered_map<uint16_t, FileTotals> files;
+  summarise(trace, files);
+  if (doReplay) {
+    replay(trace, root, maps, files);
+  }
+  printFiles(trace, files, top, doReplay);
+  return 0;
+}
@@ -0,0 +1,821 @@
+// Counts the card calls behind section, CSS and book.bin serialization, with and without the buffered
+// BufferedFsWriter/BufferedFsReader.
+//
+// Section files: the text of every chapter in the given EPUBs is split into fixed-advance lines and pages and
+// written in the section page layout (the same field order as Page/PageLine/TextBlock::serialize), once straight
+// to FsFile and once through BufferedFsWriter. Every page is then loaded back both ways and compared.
+// CSS and book.bin go through the real CssParser and BookMetadataCache, which only have the buffered path.
+//
+// Section format: every chapter is also written as its own section in the v14 layout (inline words, fixed-width
+// fields) and the v15 layout (SectionDictionary word/style references, varint positions, style runs), and the
+// file sizes and page load costs are compared. v15 pages are loaded both into per-line vectors and per-word strings
+// and, like Page::deserialize, into a single PageArena; heap allocations are counted for each. The first 200 pages
+// are then turned through in order, reopening the section for every page and with the file and LUT kept resident
+// like Section does.
+//
+// Usage: SerializationBenchmark <work dir> <epub>...
+
+#include <BookMetadataCache.h>
+#include <BufferedFs.h>
+#include <HalStorage.h>
+#include <Serialization.h>
+#include <ZipFile.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Epub/PageArena.h"
+#include "Epub/SectionDictionary.h"
+#include "Epub/blocks/BlockStyle.h"
+#include "Epub/css/CssParser.h"
+
+// Every heap allocation made by the benchmark and the libraries it links (see the --wrap flags in the run script)
+uint64_t heapAllocations = 0;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __wrap_malloc(const size_t size) {
+  heapAllocations++;
+  return __real_malloc(size);
+}
+void* __wrap_calloc(const size_t count, const size_t size) {
+  heapAllocations++;
+  return __real_calloc(count, size);
+}
+void* __wrap_realloc(void* ptr, const size_t size) {
+  heapAllocations++;
+  return __real_realloc(ptr, size);
+}
+}
+
+void* operator new(const size_t size) {
+  void* p = malloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+namespace {
+
+constexpr int PAGE_WIDTH = 464;
+constexpr int CHAR_ADVANCE = 9;
+constexpr int SPACE_ADVANCE = 5;
+constexpr int LINES_PER_PAGE = 24;
+constexpr int LINE_HEIGHT = 30;
+constexpr uint8_t TAG_LINE = 1;
+constexpr size_t PAGE_TURNS = 200;
+
+struct Line {
+  std::vector<std::string> words;
+  std::vector<uint16_t> xpos;
+  std::vector<uint8_t> styles;
+  BlockStyle blockStyle;
+};
+
+using PageLines = std::vector<Line>;
+
+// Central directory names, read with plain stdio so the benchmark does not depend on ZipFile internals
+std::vector<std::string> listEntries(const std::string& zipPath) {
+  std::vector<std::string> names;
+  FILE* f = fopen(zipPath.c_str(), "rb");
+  if (!f) return names;
+  fseek(f, 0, SEEK_END);
+  const long size = ftell(f);
+  std::vector<uint8_t> data(size);
+  fseek(f, 0, SEEK_SET);
+  const size_t got = fread(data.data(), 1, size, f);
+  fclose(f);
+  if (got != static_cast<size_t>(size)) return names;
+
+  const auto le16 = [&data](const size_t p) { return data[p] | data[p + 1] << 8; };
+  const auto le32 = [&data, &le16](const size_t p) { return le16(p) | static_cast<uint32_t>(le16(p + 2)) << 16; };
+  for (long p = size - 22; p >= 0; p--) {
+    if (le32(p) != 0x06054b50) continue;
+    size_t cd = le32(p + 16);
+    const int count = le16(p + 10);
+    for (int i = 0; i < count && cd + 46 <= data.size(); i++) {
+      const int nameLen = le16(cd + 28);
+      names.emplace_back(reinterpret_cast<const char*>(&data[cd + 46]), nameLen);
+      cd += 46 + nameLen + le16(cd + 30) + le16(cd + 32);
+    }
+    break;
+  }
+  return names;
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+  const size_t n = strlen(suffix);
+  return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Strips markup and lays the words out into lines and pages with a fixed advance per character
+std::vector<PageLines> layoutChapter(ZipFile& zip, const std::string& name) {
+  std::vector<PageLines> pages;
+  ZipFile::EntryReader reader;
+  if (!zip.openEntry(name.c_str(), reader)) return pages;
+
+  std::vector<std::string> words;
+  std::string word;
+  bool inTag = false;
+  uint8_t buf[1024];
+  int n;
+  while ((n = reader.read(buf, sizeof(buf))) > 0) {
+    for (int i = 0; i < n; i++) {
+      const char c = static_cast<char>(buf[i]);
+      if (c == '<') inTag = true;
+      if (!inTag && c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+        word += c;
+      } else if (!word.empty()) {
+        words.push_back(std::move(word));
+        word.clear();
+      }
+      if (c == '>') inTag = false;
+    }
+  }
+  if (!word.empty()) words.push_back(word);
+
+  PageLines page;
+  Line line;
+  int x = 0;
+  for (size_t i = 0; i < words.size(); i++) {
+    const int w = static_cast<int>(words[i].size()) * CHAR_ADVANCE;
+    if (x > 0 && x + w > PAGE_WIDTH) {
+      page.push_back(std::move(line));
+      line = {};
+      x = 0;
+      if (page.size() == LINES_PER_PAGE) {
+        pages.push_back(std::move(page));
+        page.clear();
+      }
+    }
+    line.words.push_back(words[i]);
+    line.xpos.push_back(x);
+    line.styles.push_back(i % 17 == 0 ? 2 : 0);
+    x += w + SPACE_ADVANCE;
+  }
+  if (!line.words.empty()) page.push_back(std::move(line));
+  if (!page.empty()) pages.push_back(std::move(page));
+  return pages;
+}
+
+// Same record layout as Page::serialize with PageLine/TextBlock elements and no footnotes
+template <typename Sink>
+void writePage(Sink& sink, const PageLines& page) {
+  serialization::writePod(sink, static_cast<uint16_t>(page.size()));
+  for (size_t l = 0; l < page.size(); l++) {
+    const Line& line = page[l];
+    serialization::writePod(sink, TAG_LINE);
+    serialization::writePod(sink, static_cast<int16_t>(0));
+    serialization::writePod(sink, static_cast<int16_t>(l * LINE_HEIGHT));
+    serialization::writePod(sink, static_cast<uint16_t>(line.words.size()));
+    for (const auto& w : line.words) serialization::writeString(sink, w);
+    for (const auto x : line.xpos) serialization::writePod(sink, x);
+    for (const auto s : line.styles) serialization::writePod(sink, s);
+    const BlockStyle& bs = line.blockStyle;
+    serialization::writePod(sink, bs.alignment);
+    serialization::writePod(sink, bs.textAlignDefined);
+    serialization::writePod(sink, bs.marginTop);
+    serialization::writePod(sink, bs.marginBottom);
+    serialization::writePod(sink, bs.marginLeft);
+    serialization::writePod(sink, bs.marginRight);
+    serialization::writePod(sink, bs.paddingTop);
+    serialization::writePod(sink, bs.paddingBottom);
+    serialization::writePod(sink, bs.paddingLeft);
+    serialization::writePod(sink, bs.paddingRight);
+    serialization::writePod(sink, bs.textIndent);
+    serialization::writePod(sink, bs.textIndentDefined);
+  }
+  serialization::writePod(sink, static_cast<uint16_t>(0));
+}
+
+template <typename Source>
+bool readPage(Source& source, PageLines& page) {
+  uint16_t count = 0;
+  serialization::readPod(source, count);
+  page.resize(count);
+  for (auto& line : page) {
+    uint8_t tag = 0;
+    int16_t x, y;
+    uint16_t wc = 0;
+    serialization::readPod(source, tag);
+    if (tag != TAG_LINE) return false;
+    serialization::readPod(source, x);
+    serialization::readPod(source, y);
+    serialization::readPod(source, wc);
+    line.words.resize(wc);
+    line.xpos.resize(wc);
+    line.styles.resize(wc);
+    for (auto& w : line.words) serialization::readString(source, w);
+    for (auto& v : line.xpos) serialization::readPod(source, v);
+    for (auto& s : line.styles) serialization::readPod(source, s);
+    BlockStyle& bs = line.blockStyle;
+    serialization::readPod(source, bs.alignment);
+    serialization::readPod(source, bs.textAlignDefined);
+    serialization::readPod(source, bs.marginTop);
+    serialization::readPod(source, bs.marginBottom);
+    serialization::readPod(source, bs.marginLeft);
+    serialization::readPod(source, bs.marginRight);
+    serialization::readPod(source, bs.paddingTop);
+    serialization::readPod(source, bs.paddingBottom);
+    serialization::readPod(source, bs.paddingLeft);
+    serialization::readPod(source, bs.paddingRight);
+    serialization::readPod(source, bs.textIndent);
+    serialization::readPod(source, bs.textIndentDefined);
+  }
+  uint16_t footnotes = 0;
+  serialization::readPod(source, footnotes);
+  return footnotes == 0;
+}
+
+// Same record layout as v15 Page::serialize with PageLine/TextBlock elements and no footnotes
+void writePageV15(BufferedFsWriter& writer, SectionDictionary& dictionary, const PageLines& page) {
+  serialization::writeVarUint(writer, page.size());
+  for (size_t l = 0; l < page.size(); l++) {
+    const Line& line = page[l];
+    serialization::writePod(writer, TAG_LINE);
+    serialization::writeVarInt(writer, 0);
+    serialization::writeVarInt(writer, static_cast<int32_t>(l * LINE_HEIGHT));
+    dictionary.writeStyle(writer, line.blockStyle);
+    serialization::writeVarUint(writer, line.words.size());
+    for (const auto& w : line.words) dictionary.writeWord(writer, w);
+    int32_t prevX = 0;
+    for (const auto x : line.xpos) {
+      serialization::writeVarInt(writer, x - prevX);
+      prevX = x;
+    }
+    uint32_t runCount = 0;
+    for (size_t i = 0; i < line.styles.size(); i++) {
+      if (i == 0 || line.styles[i] != line.styles[i - 1]) runCount++;
+    }
+    serialization::writeVarUint(writer, runCount);
+    for (size_t i = 0; i < line.styles.size();) {
+      size_t runEnd = i + 1;
+      while (runEnd < line.styles.size() && line.styles[runEnd] == line.styles[i]) runEnd++;
+      serialization::writePod(writer, line.styles[i]);
+      serialization::writeVarUint(writer, runEnd - i);
+      i = runEnd;
+    }
+  }
+  serialization::writeVarUint(writer, 0);
+}
+
+// The v15 page as it was decoded before the page arena: a vector per line field and a std::string per word
+bool readPageV15(ByteReader& reader, const SectionDictionary& dictionary, PageLines& page) {
+  uint32_t count = 0;
+  if (!serialization::readVarUint(reader, count)) return false;
+  page.resize(count);
+  for (auto& line : page) {
+    uint8_t tag = 0;
+    int32_t x, y;
+    uint32_t wc = 0;
+    serialization::readPod(reader, tag);
+    if (tag != TAG_LINE || !serialization::readVarInt(reader, x) || !serialization::readVarInt(reader, y) ||
+        !dictionary.readStyle(reader, line.blockStyle) || !serialization::readVarUint(reader, wc)) {
+      return false;
+    }
+    line.words.resize(wc);
+    line.xpos.resize(wc);
+    line.styles.clear();
+    for (auto& w : line.words) {
+      std::string_view view;
+      if (!dictionary.readWord(reader, view)) return false;
+      w.assign(view);
+    }
+    int32_t pos = 0;
+    for (auto& v : line.xpos) {
+      int32_t delta;
+      if (!serialization::readVarInt(reader, delta)) return false;
+      pos += delta;
+      v = static_cast<uint16_t>(pos);
+    }
+    uint32_t runCount = 0;
+    if (!serialization::readVarUint(reader, runCount)) return false;
+    for (uint32_t i = 0; i < runCount; i++) {
+      uint8_t style;
+      uint32_t runLength;
+      serialization::readPod(reader, style);
+      if (!serialization::readVarUint(reader, runLength) || runLength > wc - line.styles.size()) return false;
+      line.styles.insert(line.styles.end(), runLength, style);
+    }
+    if (line.styles.size() != wc) return false;
+  }
+  uint32_t footnotes = 0;
+  return serialization::readVarUint(reader, footnotes) && footnotes == 0;
+}
+
+struct ArenaLine {
+  const std::string_view* words;
+  const uint16_t* xpos;
+  const uint8_t* styles;
+  uint32_t count;
+  BlockStyle blockStyle;
+};
+
+// Mirrors Page::deserialize: one read into a PageArena, a validating pass to size it, then decoding into it with
+// words left in place as NUL-terminated slices
+const ArenaLine* loadPageArena(FsFile& file, const uint32_t size, const SectionDictionary& dictionary,
+                               PageArena& arena, uint32_t& lineCount) {
+  if (!arena.reserve(size) || file.read(arena.allocate(size, 1), size) != static_cast<int>(size)) return nullptr;
+
+  uint32_t words = 0;
+  {
+    ByteReader reader(arena.data(), size);
+    if (!serialization::readVarUint(reader, lineCount)) return nullptr;
+    for (uint32_t l = 0; l < lineCount; l++) {
+      uint8_t tag = 0;
+      int32_t x, y;
+      BlockStyle style;
+      uint32_t wc = 0, runCount = 0, covered = 0;
+      serialization::readPod(reader, tag);
+      if (tag != TAG_LINE || !serialization::readVarInt(reader, x) || !serialization::readVarInt(reader, y) ||
+          !dictionary.readStyle(reader, style) || !serialization::readVarUint(reader, wc)) {
+        return nullptr;
+      }
+      for (uint32_t i = 0; i < wc; i++) {
+        if (!dictionary.skipWord(reader)) return nullptr;
+      }
+      for (uint32_t i = 0; i < wc; i++) {
+        if (!serialization::readVarInt(reader, x)) return nullptr;
+      }
+      if (!serialization::readVarUint(reader, runCount)) return nullptr;
+      for (uint32_t i = 0; i < runCount; i++) {
+        uint32_t runLength;
+        if (!reader.take(1) || !serialization::readVarUint(reader, runLength)) return nullptr;
+        covered += runLength;
+      }
+      if (covered != wc) return nullptr;
+      words += wc;
+    }
+  }
+  const size_t decoded = PageArena::arrayFootprint<ArenaLine>(lineCount) +
+                         lineCount * (PageArena::arrayFootprint<std::string_view>(0) +
+                                      PageArena::arrayFootprint<uint16_t>(0) + PageArena::arrayFootprint<uint8_t>(0)) +
+                         words * (sizeof(std::string_view) + sizeof(uint16_t) + sizeof(uint8_t));
+  if (!arena.reserve(size + decoded)) return nullptr;
+
+  ByteReader reader(arena.data(), size);
+  serialization::readVarUint(reader, lineCount);
+  auto* lines = arena.allocateArray<ArenaLine>(lineCount);
+  for (uint32_t l = 0; l < lineCount; l++) {
+    ArenaLine& line = lines[l];
+    uint8_t tag;
+    int32_t x, y;
+    serialization::readPod(reader, tag);
+    serialization::readVarInt(reader, x);
+    serialization::readVarInt(reader, y);
+    dictionary.readStyle(reader, line.blockStyle);
+    serialization::readVarUint(reader, line.count);
+    auto* lineWords = arena.allocateArray<std::string_view>(line.count);
+    auto* xpos = arena.allocateArray<uint16_t>(line.count);
+    auto* styles = arena.allocateArray<uint8_t>(line.count);
+    if (!lineWords || !xpos || !styles) return nullptr;
+    for (uint32_t i = 0; i < line.count; i++) {
+      if (!dictionary.readWord(reader, lineWords[i])) return nullptr;
+    }
+    int32_t pos = 0;
+    for (uint32_t i = 0; i < line.count; i++) {
+      int32_t delta;
+      serialization::readVarInt(reader, delta);
+      pos += delta;
+      xpos[i] = static_cast<uint16_t>(pos);
+    }
+    uint32_t runCount, covered = 0;
+    serialization::readVarUint(reader, runCount);
+    for (uint32_t i = 0; i < runCount; i++) {
+      uint8_t style;
+      uint32_t runLength;
+      serialization::readPod(reader, style);
+      serialization::readVarUint(reader, runLength);
+      std::fill_n(styles + covered, runLength, style);
+      covered += runLength;
+    }
+    line.words = lineWords;
+    line.xpos = xpos;
+    line.styles = styles;
+  }
+  return lines;
+}
+
+bool sameLines(const ArenaLine* lines, const uint32_t lineCount, const PageLines& expected) {
+  if (!lines || lineCount != expected.size()) return false;
+  for (uint32_t l = 0; l < lineCount; l++) {
+    const Line& e = expected[l];
+    if (lines[l].count != e.words.size()) return false;
+    for (uint32_t i = 0; i < lines[l].count; i++) {
+      if (lines[l].words[i] != e.words[i] || lines[l].words[i].data()[e.words[i].size()] != '\0' ||
+          lines[l].xpos[i] != e.xpos[i] || lines[l].styles[i] != e.styles[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+struct Measure {
+  double micros = 0;
+  HostIoStats io;
+  uint64_t allocations = 0;
+};
+
+template <typename Fn>
+Measure measure(Fn&& fn) {
+  hostIoStats().reset();
+  const uint64_t allocationsBefore = heapAllocations;
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  Measure m;
+  m.micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  m.io = hostIoStats();
+  m.allocations = heapAllocations - allocationsBefore;
+  return m;
+}
+
+void printMeasure(const char* label, const Measure& m, const size_t units, const char* unitName) {
+  const double per = units ? static_cast<double>(units) : 1.0;
+  printf("%-28s %9.1f us/%s %5.2f opens/%s %8.1f writes/%s %8.1f reads/%s %6.1f seeks/%s %8.0f B read/%s "
+         "%8.1f allocs/%s\n",
+         label, m.micros / per, unitName, m.io.opens / per, unitName, m.io.writes / per, unitName, m.io.reads / per,
+         unitName, m.io.seeks / per, unitName, m.io.bytesRead / per, unitName, m.allocations / per, unitName);
+}
+
+// Writes a section-shaped file (page records followed by a LUT) and returns the page offsets
+template <bool Buffered>
+std::vector<uint32_t> writeSection(const std::string& path, const std::vector<PageLines>& pages) {
+  std::vector<uint32_t> lut;
+  FsFile file;
+  Storage.openFileForWrite("BEN", path, file);
+  if constexpr (Buffered) {
+    BufferedFsWriter writer(file);
+    for (const auto& page : pages) {
+      lut.push_back(writer.position());
+      writePage(writer, page);
+    }
+    for (const auto pos : lut) serialization::writePod(writer, pos);
+    writer.flush();
+  } else {
+    for (const auto& page : pages) {
+      lut.push_back(static_cast<uint32_t>(file.position()));
+      writePage(file, page);
+    }
+    for (const auto pos : lut) serialization::writePod(file, pos);
+  }
+  file.close();
+  return lut;
+}
+
+// Loads one page the way Section::loadPageFromSectionFile does: open, seek, decode, close
+template <bool Buffered>
+bool loadPage(const std::string& path, const uint32_t offset, PageLines& page) {
+  FsFile file;
+  if (!Storage.openFileForRead("BEN", path, file)) return false;
+  file.seek(offset);
+  bool ok;
+  if constexpr (Buffered) {
+    BufferedFsReader reader(file);
+    ok = readPage(reader, page);
+  } else {
+    ok = readPage(file, page);
+  }
+  file.close();
+  return ok;
+}
+
+// A chapter as its own section file in both layouts: pages, LUT and (v15) the dictionary
+struct ChapterSections {
+  std::vector<uint32_t> lutV14;
+  std::vector<uint32_t> lutV15;
+  uint32_t dictionaryOffset = 0;
+  uint32_t sizeV14 = 0;
+  uint32_t sizeV15 = 0;
+};
+
+ChapterSections writeChapterSections(const std::string& pathV14, const std::string& pathV15,
+                                     const std::vector<PageLines>& pages, SectionDictionary& dictionary) {
+  ChapterSections sections;
+  FsFile file;
+  Storage.openFileForWrite("BEN", pathV14, file);
+  {
+    BufferedFsWriter writer(file);
+    for (const auto& page : pages) {
+      sections.lutV14.push_back(writer.position());
+      writePage(writer, page);
+    }
+    for (const auto pos : sections.lutV14) serialization::writePod(writer, pos);
+    writer.flush();
+    sections.sizeV14 = writer.position();
+  }
+  file.close();
+
+  Storage.openFileForWrite("BEN", pathV15, file);
+  {
+    BufferedFsWriter writer(file);
+    dictionary.beginBuild();
+    for (const auto& page : pages) {
+      sections.lutV15.push_back(writer.position());
+      writePageV15(writer, dictionary, page);
+    }
+    for (const auto pos : sections.lutV15) serialization::writePod(writer, pos);
+    sections.dictionaryOffset = writer.position();
+    dictionary.write(writer);
+    dictionary.endBuild();
+    writer.flush();
+    sections.sizeV15 = writer.position();
+  }
+  file.close();
+  return sections;
+}
+
+bool sameFile(const std::string& a, const std::string& b) {
+  FILE* fa = fopen(a.c_str(), "rb");
+  FILE* fb = fopen(b.c_str(), "rb");
+  bool same = fa && fb;
+  while (same) {
+    const int ca = fgetc(fa);
+    const int cb = fgetc(fb);
+    same = ca == cb;
+    if (ca == EOF || cb == EOF) break;
+  }
+  if (fa) fclose(fa);
+  if (fb) fclose(fb);
+  return same;
+}
+
+bool samePage(const PageLines& a, const PageLines& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].words != b[i].words || a[i].xpos != b[i].xpos || a[i].styles != b[i].styles) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    fprintf(stderr, "Usage: %s <work dir> <epub>...\n", argv[0]);
+    return 1;
+  }
+  const std::string workDir = argv[1];
+  bool ok = true;
+
+  for (int arg = 2; arg < argc; arg++) {
+    const std::string epubPath = argv[arg];
+    const auto names = listEntries(epubPath);
+    std::vector<std::string> chapters;
+    std::vector<std::string> stylesheets;
+    for (const auto& name : names) {
+      if (endsWith(name, ".xhtml") || endsWith(name, ".html") || endsWith(name, ".htm")) chapters.push_back(name);
+      if (endsWith(name, ".css")) stylesheets.push_back(name);
+    }
+
+    std::vector<PageLines> pages;
+    std::vector<std::vector<PageLines>> chapterPages;
+    {
+      ZipFile zip(epubPath);
+      for (const auto& chapter : chapters) {
+        chapterPages.push_back(layoutChapter(zip, chapter));
+        for (const auto& p : chapterPages.back()) pages.push_back(p);
+      }
+    }
+    printf("\n%s: %zu chapters, %zu pages, %zu stylesheets\n", epubPath.c_str(), chapters.size(), pages.size(),
+           stylesheets.size());
+
+    // Section build and page load
+    const std::string directPath = workDir + "/section_direct.bin";
+    const std::string bufferedPath = workDir + "/section_buffered.bin";
+    std::vector<uint32_t> lut;
+    const auto directBuild = measure([&] { lut = writeSection<false>(directPath, pages); });
+    const auto bufferedBuild = measure([&] { writeSection<true>(bufferedPath, pages); });
+    printMeasure("section build, direct", directBuild, pages.size(), "page");
+    printMeasure("section build, buffered", bufferedBuild, pages.size(), "page");
+    if (!sameFile(directPath, bufferedPath)) {
+      fprintf(stderr, "Buffered section file differs from the direct one\n");
+      ok = false;
+    }
+
+    std::vector<size_t> order(pages.size());
+    std::mt19937 rng(7);
+    for (auto& i : order) i = rng() % pages.size();
+    std::vector<PageLines> direct(order.size());
+    std::vector<PageLines> buffered(order.size());
+    const auto directLoad = measure([&] {
+      for (size_t i = 0; i < order.size(); i++) ok &= loadPage<false>(bufferedPath, lut[order[i]], direct[i]);
+    });
+    const auto bufferedLoad = measure([&] {
+      for (size_t i = 0; i < order.size(); i++) ok &= loadPage<true>(bufferedPath, lut[order[i]], buffered[i]);
+    });
+    printMeasure("page load, direct", directLoad, order.size(), "page");
+    printMeasure("page load, buffered", bufferedLoad, order.size(), "page");
+    for (size_t i = 0; i < order.size(); i++) {
+      if (!samePage(direct[i], buffered[i]) || !samePage(direct[i], pages[order[i]])) {
+        fprintf(stderr, "Page %zu does not round-trip\n", order[i]);
+        ok = false;
+        break;
+      }
+    }
+
+    // Section format: v14 against v15, one section per chapter
+    if (!pages.empty()) {
+      std::vector<ChapterSections> sections;
+      std::vector<SectionDictionary> dictionaries(chapterPages.size());
+      uint64_t bytesV14 = 0, bytesV15 = 0, dictionaryBytes = 0, internedWords = 0;
+      for (size_t c = 0; c < chapterPages.size(); c++) {
+        const std::string base = workDir + "/chapter_" + std::to_string(c);
+        sections.push_back(
+            writeChapterSections(base + "_v14.bin", base + "_v15.bin", chapterPages[c], dictionaries[c]));
+        bytesV14 += sections.back().sizeV14;
+        bytesV15 += sections.back().sizeV15;
+        dictionaryBytes += sections.back().sizeV15 - sections.back().dictionaryOffset;
+        internedWords += dictionaries[c].wordCount();
+      }
+      printf("%-28s %9llu bytes v14 %9llu bytes v15 (%.1f%%), %llu interned words, %llu dictionary bytes\n",
+             "section size", static_cast<unsigned long long>(bytesV14), static_cast<unsigned long long>(bytesV15),
+             bytesV14 ? 100.0 * bytesV15 / bytesV14 : 0.0, static_cast<unsigned long long>(internedWords),
+             static_cast<unsigned long long>(dictionaryBytes));
+
+      // Opening a v15 section reads its dictionary once, page loads then only resolve references in memory
+      std::vector<SectionDictionary> loaded(chapterPages.size());
+      const auto open = measure([&] {
+        for (size_t c = 0; c < chapterPages.size(); c++) {
+          FsFile file;
+          Storage.openFileForRead("BEN", workDir + "/chapter_" + std::to_string(c) + "_v15.bin", file);
+          BufferedFsReader reader(file);
+          ok &= reader.seek(sections[c].dictionaryOffset) && loaded[c].read(reader);
+        }
+      });
+      printMeasure("v15 dictionary load", open, chapterPages.size(), "sect");
+
+      std::vector<std::pair<size_t, size_t>> pageOrder;
+      for (size_t i = 0; i < pages.size(); i++) {
+        const size_t c = rng() % chapterPages.size();
+        if (!chapterPages[c].empty()) pageOrder.emplace_back(c, rng() % chapterPages[c].size());
+      }
+      std::vector<PageLines> v14(pageOrder.size());
+      std::vector<PageLines> v15(pageOrder.size());
+      std::vector<std::string> pathsV14, pathsV15;
+      for (size_t c = 0; c < chapterPages.size(); c++) {
+        pathsV14.push_back(workDir + "/chapter_" + std::to_string(c) + "_v14.bin");
+        pathsV15.push_back(workDir + "/chapter_" + std::to_string(c) + "_v15.bin");
+      }
+      const auto pageRange = [&](const size_t c, const size_t p) {
+        const auto& lut = sections[c].lutV15;
+        const uint32_t end = p + 1 < lut.size() ? lut[p + 1] : sections[c].dictionaryOffset - 4 * lut.size();
+        return std::make_pair(lut[p], end - lut[p]);
+      };
+      const auto loadV14 = measure([&] {
+        for (size_t i = 0; i < pageOrder.size(); i++) {
+          const auto [c, p] = pageOrder[i];
+          ok &= loadPage<true>(pathsV14[c], sections[c].lutV14[p], v14[i]);
+        }
+      });
+      const auto loadV15 = measure([&] {
+        for (size_t i = 0; i < pageOrder.size(); i++) {
+          const auto [c, p] = pageOrder[i];
+          const auto [start, size] = pageRange(c, p);
+          FsFile file;
+          ok &= Storage.openFileForRead("BEN", pathsV15[c], file) && file.seek(start);
+          std::vector<uint8_t> bytes(size);
+          ok &= file.read(bytes.data(), size) == static_cast<int>(size);
+          ByteReader reader(bytes.data(), size);
+          ok &= readPageV15(reader, loaded[c], v15[i]);
+        }
+      });
+      // Each page is checked as it is loaded, since its arena goes away with the next page like on the device
+      bool arenaPagesMatch = true;
+      const auto loadArena = measure([&] {
+        for (size_t i = 0; i < pageOrder.size(); i++) {
+          const auto [c, p] = pageOrder[i];
+          const auto [start, size] = pageRange(c, p);
+          FsFile file;
+          ok &= Storage.openFileForRead("BEN", pathsV15[c], file) && file.seek(start);
+          PageArena arena;
+          uint32_t lineCount = 0;
+          const ArenaLine* lines = loadPageArena(file, size, loaded[c], arena, lineCount);
+          arenaPagesMatch &= sameLines(lines, lineCount, chapterPages[c][p]);
+        }
+      });
+      printMeasure("page load, v14", loadV14, pageOrder.size(), "page");
+      printMeasure("page load, v15 vectors", loadV15, pageOrder.size(), "page");
+      printMeasure("page load, v15 arena", loadArena, pageOrder.size(), "page");
+      ok &= arenaPagesMatch;
+      for (size_t i = 0; i < pageOrder.size(); i++) {
+        const auto& expected = chapterPages[pageOrder[i].first][pageOrder[i].second];
+        if (!samePage(v14[i], expected) || !samePage(v15[i], expected)) {
+          fprintf(stderr, "v15 page %zu of chapter %zu does not round-trip\n", pageOrder[i].second,
+                  pageOrder[i].first);
+          ok = false;
+          break;
+        }
+      }
+
+      // Reading straight through: every turn reopening the section and reading its LUT entries, against
+      // Section keeping the file open with the LUT resident (one open and LUT read per chapter)
+      std::vector<std::pair<size_t, size_t>> turns;
+      for (size_t c = 0; c < chapterPages.size() && turns.size() < PAGE_TURNS; c++) {
+        for (size_t p = 0; p < chapterPages[c].size() && turns.size() < PAGE_TURNS; p++) turns.emplace_back(c, p);
+      }
+      bool turnPagesMatch = true;
+      const auto reopenTurns = measure([&] {
+        for (const auto& [c, p] : turns) {
+          const uint32_t lutOffset = sections[c].dictionaryOffset - 4 * sections[c].lutV15.size();
+          const size_t lutEntries = p + 1 < sections[c].lutV15.size() ? 2 : 1;
+          uint32_t headerLutOffset = 0;
+          uint32_t range[2] = {0, lutOffset};
+          FsFile file;
+          // The bench sections have no header, reading the first word stands in for the header lutOffset read
+          ok &= Storage.openFileForRead("BEN", pathsV15[c], file) && file.seek(0) &&
+                file.read(&headerLutOffset, 4) == 4 && file.seek(lutOffset + 4 * p) &&
+                file.read(range, 4 * lutEntries) == static_cast<int>(4 * lutEntries) && file.seek(range[0]);
+          PageArena arena;
+          uint32_t lineCount = 0;
+          const ArenaLine* lines = loadPageArena(file, range[1] - range[0], loaded[c], arena, lineCount);
+          turnPagesMatch &= sameLines(lines, lineCount, chapterPages[c][p]);
+        }
+      });
+      const auto residentTurns = measure([&] {
+        FsFile file;
+        std::vector<uint32_t> lut;
+        size_t openChapter = SIZE_MAX;
+        for (const auto& [c, p] : turns) {
+          if (c != openChapter) {
+            const uint32_t lutOffset = sections[c].dictionaryOffset - 4 * sections[c].lutV15.size();
+            const int lutBytes = 4 * sections[c].lutV15.size();
+            file.close();
+            lut.assign(sections[c].lutV15.size() + 1, lutOffset);
+            ok &= Storage.openFileForRead("BEN", pathsV15[c], file) && file.seek(lutOffset) &&
+                  file.read(lut.data(), lutBytes) == lutBytes;
+            openChapter = c;
+          }
+          ok &= file.seek(lut[p]);
+          PageArena arena;
+          uint32_t lineCount = 0;
+          const ArenaLine* lines = loadPageArena(file, lut[p + 1] - lut[p], loaded[c], arena, lineCount);
+          turnPagesMatch &= sameLines(lines, lineCount, chapterPages[c][p]);
+        }
+      });
+      printMeasure("page turns, reopen", reopenTurns, turns.size(), "turn");
+      printMeasure("page turns, resident", residentTurns, turns.size(), "turn");
+      ok &= turnPagesMatch;
+    }
+
+    // CSS rules cache through the real CssParser
+    CssParser css(workDir);
+    {
+      ZipFile zip(epubPath);
+      for (const auto& sheet : stylesheets) {
+        ZipFile::EntryReader reader;
+        if (zip.openEntry(sheet.c_str(), reader)) css.loadFromStream(reader);
+      }
+    }
+    const size_t rules = css.ruleCount();
+    if (rules > 0) {
+      const auto save = measure([&] { ok &= css.saveToCache(); });
+      const auto load = measure([&] { ok &= css.loadFromCache(); });
+      printMeasure("css cache save", save, rules, "rule");
+      printMeasure("css cache load", load, rules, "rule");
+      ok &= css.ruleCount() == rules;
+    }
+
+    // book.bin through the real BookMetadataCache, with one TOC entry per chapter
+    if (!chapters.empty()) {
+      BookMetadataCache cache(workDir);
+      const auto build = measure([&] {
+        ok &= cache.beginWrite() && cache.beginContentOpfPass();
+        for (const auto& chapter : chapters) cache.createSpineEntry(chapter);
+        ok &= cache.endContentOpfPass() && cache.beginTocPass();
+        for (const auto& chapter : chapters) cache.createTocEntry("Chapter " + chapter, chapter, "", 1);
+        ok &= cache.endTocPass() && cache.endWrite();
+        ok &= cache.buildBookBin(epubPath, {"Title", "Author", "en", "", ""});
+        cache.cleanupTmpFiles();
+      });
+      printMeasure("book.bin build", build, chapters.size(), "item");
+
+      BookMetadataCache reader(workDir);
+      ok &= reader.load();
+      const auto lookups = measure([&] {
+        for (int i = 0; i < reader.getSpineCount(); i++) {
+          ok &= reader.getSpineEntry(i).href == chapters[i];
+          ok &= reader.getTocEntry(i).spineIndex == i;
+        }
+      });
+      printMeasure("book.bin spine+toc lookup", lookups, chapters.size(), "item");
+    }
+  }
+
+  if (!ok) {
+    fprintf(stderr, "Serialization benchmark found mismatches\n");
+    return 1;
+  }
+  printf("\nAll pages, CSS rules and book.bin entries round-tripped\n");
+  return 0;
+}
@@ -0,0 +1,222 @@
+// Compares zip entry lookups with and without the persistent ZipIndex on a synthetic archive.
+// Each lookup uses a fresh ZipFile, the way Epub does, so the baseline pays the central directory scan.
+//
+// Usage: ZipIndexBenchmark <work dir> [entries] [lookups]
+
+#include <HalStorage.h>
+#include <ZipFile.h>
+#include <ZipIndex.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct SyntheticEntry {
+  std::string name;
+  uint32_t size;
+};
+
+void putLe16(std::vector<uint8_t>& out, const uint16_t v) {
+  out.push_back(v & 0xFF);
+  out.push_back(v >> 8);
+}
+
+void putLe32(std::vector<uint8_t>& out, const uint32_t v) {
+  putLe16(out, v & 0xFFFF);
+  putLe16(out, v >> 16);
+}
+
+// Writes a STORED zip with entry names shaped like a large image-heavy EPUB. The end record claims eocdEntries
+// entries, the real count unless given.
+std::vector<SyntheticEntry> writeSyntheticZip(const std::string& path, const int entryCount,
+                                              const int eocdEntries = -1) {
+  std::vector<SyntheticEntry> entries;
+  std::vector<uint8_t> body;
+  std::vector<uint8_t> centralDir;
+  std::mt19937 rng(1234);
+
+  for (int i = 0; i < entryCount; i++) {
+    char name[96];
+    if (i % 3 == 0) {
+      snprintf(name, sizeof(name), "OEBPS/Text/chapter_%05d.xhtml", i);
+    } else {
+      snprintf(name, sizeof(name), "OEBPS/Images/page_%05d_%u.jpg", i, static_cast<unsigned>(rng() % 1000));
+    }
+    const std::string entryName = name;
+    const uint32_t size = 16 + rng() % 240;
+    const uint32_t localHeaderOffset = body.size();
+    // Local extra field differs from the central one, as it does in real archives
+    const uint16_t localExtraLen = (i % 7 == 0) ? 8 : 0;
+
+    putLe32(body, 0x04034b50);
+    putLe16(body, 10);  // version needed
+    putLe16(body, 0);   // flags
+    putLe16(body, 0);   // method: stored
+    putLe32(body, 0);   // time/date
+    putLe32(body, 0);   // crc (unchecked)
+    putLe32(body, size);
+    putLe32(body, size);
+    putLe16(body, entryName.size());
+    putLe16(body, localExtraLen);
+    body.insert(body.end(), entryName.begin(), entryName.end());
+    body.insert(body.end(), localExtraLen, 0);
+    for (uint32_t b = 0; b < size; b++) body.push_back(static_cast<uint8_t>(i + b));
+
+    putLe32(centralDir, 0x02014b50);
+    putLe16(centralDir, 20);  // version made by
+    putLe16(centralDir, 10);  // version needed
+    putLe16(centralDir, 0);   // flags
+    putLe16(centralDir, 0);   // method
+    putLe32(centralDir, 0);   // time/date
+    putLe32(centralDir, 0);   // crc
+    putLe32(centralDir, size);
+    putLe32(centralDir, size);
+    putLe16(centralDir, entryName.size());
+    putLe16(centralDir, 0);  // extra
+    putLe16(centralDir, 0);  // comment
+    putLe16(centralDir, 0);  // disk
+    putLe16(centralDir, 0);  // internal attrs
+    putLe32(centralDir, 0);  // external attrs
+    putLe32(centralDir, localHeaderOffset);
+    centralDir.insert(centralDir.end(), entryName.begin(), entryName.end());
+
+    entries.push_back({entryName, size});
+  }
+
+  std::vector<uint8_t> eocd;
+  putLe32(eocd, 0x06054b50);
+  putLe16(eocd, 0);
+  putLe16(eocd, 0);
+  putLe16(eocd, eocdEntries < 0 ? entryCount : eocdEntries);
+  putLe16(eocd, eocdEntries < 0 ? entryCount : eocdEntries);
+  putLe32(eocd, centralDir.size());
+  putLe32(eocd, body.size());
+  putLe16(eocd, 0);
+
+  FILE* f = fopen(path.c_str(), "wb");
+  fwrite(body.data(), 1, body.size(), f);
+  fwrite(centralDir.data(), 1, centralDir.size(), f);
+  fwrite(eocd.data(), 1, eocd.size(), f);
+  fclose(f);
+  return entries;
+}
+
+struct PassResult {
+  double microsPerLookup;
+  double readsPerLookup;
+  double bytesPerLookup;
+  int failures;
+};
+
+// Runs every lookup through a fresh ZipFile: stat the entry, then open it and read its first bytes
+PassResult runPass(const std::string& zipPath, const ZipIndex* index, const std::vector<SyntheticEntry>& entries,
+                   const std::vector<int>& order) {
+  hostIoStats().reset();
+  int failures = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const int i : order) {
+    ZipFile zip(zipPath, index);
+    size_t size = 0;
+    ZipFile::EntryReader reader;
+    uint8_t first = 0;
+    if (!zip.getInflatedFileSize(entries[i].name.c_str(), &size) || size != entries[i].size ||
+        !zip.openEntry(entries[i].name.c_str(), reader) || reader.read(&first, 1) != 1 ||
+        first != static_cast<uint8_t>(i)) {
+      failures++;
+    }
+  }
+  const double elapsed =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  const auto& stats = hostIoStats();
+  return {elapsed / order.size(), static_cast<double>(stats.reads) / order.size(),
+          static_cast<double>(stats.bytesRead) / order.size(), failures};
+}
+
+void printPass(const char* label, const PassResult& r) {
+  printf("%-22s %10.1f us/lookup %8.1f reads/lookup %10.0f bytes/lookup  failures=%d\n", label, r.microsPerLookup,
+         r.readsPerLookup, r.bytesPerLookup, r.failures);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const std::string workDir = argc > 1 ? argv[1] : "build/zip_index_bench";
+  const int entryCount = argc > 2 ? std::stoi(argv[2]) : 5000;
+  const int lookupCount = argc > 3 ? std::stoi(argv[3]) : 2000;
+
+  const std::string zipPath = workDir + "/synthetic.zip";
+  const std::string indexPath = workDir + "/zip_index.bin";
+  const auto entries = writeSyntheticZip(zipPath, entryCount);
+
+  std::vector<int> randomOrder(lookupCount);
+  std::mt19937 rng(42);
+  for (auto& i : randomOrder) i = static_cast<int>(rng() % entryCount);
+  std::vector<int> sequentialOrder(lookupCount);
+  for (int i = 0; i < lookupCount; i++) sequentialOrder[i] = i % entryCount;
+
+  printf("Synthetic archive: %d entries, %d lookups per pass\n", entryCount, lookupCount);
+
+  printPass("scan, random", runPass(zipPath, nullptr, entries, randomOrder));
+  printPass("scan, sequential", runPass(zipPath, nullptr, entries, sequentialOrder));
+
+  ZipIndex index(indexPath);
+  {
+    ZipFile zip(zipPath);
+    hostIoStats().reset();
+    const auto start = std::chrono::steady_clock::now();
+    if (!index.build(zip) || !index.load(zip)) {
+      std::cerr << "Failed to build zip index" << std::endl;
+      return 1;
+    }
+    const double elapsed =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("Index build: %.1f ms, %llu reads, %llu writes, %u entries\n", elapsed,
+           static_cast<unsigned long long>(hostIoStats().reads), static_cast<unsigned long long>(hostIoStats().writes),
+           index.size());
+  }
+
+  const auto indexedRandom = runPass(zipPath, &index, entries, randomOrder);
+  const auto indexedSequential = runPass(zipPath, &index, entries, sequentialOrder);
+  printPass("index, random", indexedRandom);
+  printPass("index, sequential", indexedSequential);
+
+  // Every entry must resolve through the index exactly as it does through the central directory
+  std::vector<int> all(entryCount);
+  for (int i = 0; i < entryCount; i++) all[i] = i;
+  const auto verify = runPass(zipPath, &index, entries, all);
+  if (verify.failures != 0 || indexedRandom.failures != 0 || indexedSequential.failures != 0) {
+    std::cerr << "Indexed lookups failed: " << verify.failures << std::endl;
+    return 1;
+  }
+  ZipFile::FileStatSlim missing = {};
+  if (index.find("OEBPS/Text/does_not_exist.xhtml", &missing)) {
+    std::cerr << "Lookup of a missing entry succeeded" << std::endl;
+    return 1;
+  }
+  printf("All %d entries verified through the index\n", entryCount);
+
+  // Writers that wrap or skip the 16-bit entry count in the end record must still get every entry indexed
+  const std::string understatedPath = workDir + "/understated.zip";
+  const auto understated = writeSyntheticZip(understatedPath, entryCount, entryCount % 1000);
+  ZipIndex understatedIndex(workDir + "/understated_index.bin");
+  {
+    ZipFile zip(understatedPath);
+    if (!understatedIndex.build(zip) || !understatedIndex.load(zip)) {
+      std::cerr << "Failed to build zip index with an understated entry count" << std::endl;
+      return 1;
+    }
+  }
+  const auto understatedVerify = runPass(understatedPath, &understatedIndex, understated, all);
+  if (understatedVerify.failures != 0) {
+    std::cerr << "Indexed lookups failed with an understated entry count: " << understatedVerify.failures
+              << std::endl;
+    return 1;
+  }
+  printf("All %d entries verified with the end record claiming %d\n", entryCount, entryCount % 1000);
+  return 0;
+}